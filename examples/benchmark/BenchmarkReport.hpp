@@ -0,0 +1,156 @@
+#pragma once
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <sys/resource.h>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace ecad::benchmark {
+
+///peak resident set size of the process so far, in KB
+inline size_t PeakRssKB()
+{
+    struct rusage usage;
+    if (0 != ::getrusage(RUSAGE_SELF, &usage)) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;//bytes on macos
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+struct StageResult
+{
+    std::string name;
+    double seconds{0};
+    size_t size{0};//problem size of the stage, e.g. primitives, elements or nodes
+    size_t peakRssKB{0};
+    size_t rssGrowthKB{0};//growth of the peak rss during the stage
+    bool success{true};
+};
+
+/**
+ * @brief collects the timing and memory of each pipeline stage,
+ *        the results are written as json and can be compared with a previous run
+ */
+class BenchmarkReport
+{
+public:
+    using Config = std::vector<std::pair<std::string, std::string> >;
+    explicit BenchmarkReport(std::string name) : m_name(std::move(name)) {}
+
+    template <typename Value>
+    void AddConfig(const std::string & key, const Value & value)
+    {
+        m_config.emplace_back(key, std::to_string(value));
+    }
+
+    ///runs and times a stage, func returns the problem size of the stage or 0 on failure
+    bool Run(const std::string & name, const std::function<size_t()> & func)
+    {
+        StageResult result;
+        result.name = name;
+        auto rss = PeakRssKB();
+        auto start = std::chrono::steady_clock::now();
+        result.size = func();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        result.seconds = elapsed.count();
+        result.success = result.size > 0;
+        result.peakRssKB = PeakRssKB();
+        result.rssGrowthKB = result.peakRssKB - rss;
+        std::cout << std::left << std::setw(24) << name << std::right << std::setw(12) << std::fixed << std::setprecision(4) << result.seconds << "s"
+                  << std::setw(12) << result.size << std::setw(12) << result.peakRssKB << "KB" << (result.success ? "" : "  FAILED") << std::endl;
+        m_stages.emplace_back(std::move(result));
+        return m_stages.back().success;
+    }
+
+    const std::vector<StageResult> & Stages() const { return m_stages; }
+
+    bool WriteJson(const std::string & filename) const
+    {
+        std::ofstream out(filename);
+        if (not out.is_open()) return false;
+        double total{0};
+        out << "{\n";
+        out << "  \"benchmark\": \"" << m_name << "\",\n";
+        out << "  \"config\": {";
+        for (size_t i = 0; i < m_config.size(); ++i)
+            out << (i ? ", " : "") << "\"" << m_config.at(i).first << "\": " << m_config.at(i).second;
+        out << "},\n";
+        out << "  \"stages\": [\n";
+        for (size_t i = 0; i < m_stages.size(); ++i) {
+            const auto & stage = m_stages.at(i);
+            total += stage.seconds;
+            out << "    {\"name\": \"" << stage.name << "\", \"seconds\": " << std::setprecision(6) << stage.seconds
+                << ", \"size\": " << stage.size << ", \"peak_rss_kb\": " << stage.peakRssKB << ", \"rss_growth_kb\": " << stage.rssGrowthKB
+                << ", \"success\": " << (stage.success ? "true" : "false") << "}" << (i + 1 < m_stages.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n";
+        out << "  \"total_seconds\": " << total << ",\n";
+        out << "  \"peak_rss_kb\": " << PeakRssKB() << "\n";
+        out << "}\n";
+        return out.good();
+    }
+
+    /**
+     * @brief compares the stages with the ones of a baseline json written by WriteJson(),
+     *        a stage regresses if it is slower than (1 + tolerance) x baseline and by more than minSeconds,
+     *        or its rss growth exceeds (1 + tolerance) x baseline by more than minRssKB
+     * @return number of regressed stages, or -1 if the baseline can not be read
+     */
+    int Compare(const std::string & baseline, double tolerance, double minSeconds = 0.05, size_t minRssKB = 10240) const
+    {
+        namespace pt = boost::property_tree;
+        pt::ptree root;
+        try { pt::read_json(baseline, root); }
+        catch (const pt::json_parser_error & e) {
+            std::cerr << "failed to read baseline " << baseline << ": " << e.what() << std::endl;
+            return -1;
+        }
+
+        for (const auto & [key, value] : m_config) {
+            auto base = root.get_optional<std::string>("config." + key);
+            if (base && *base != value)
+                std::cout << "warning: config " << key << " differs from baseline: " << value << " vs " << *base << std::endl;
+        }
+
+        std::map<std::string, std::pair<double, size_t> > base;
+        if (auto stages = root.get_child_optional("stages"); stages) {
+            for (const auto & [_, stage] : *stages)
+                base.emplace(stage.get<std::string>("name"), std::make_pair(stage.get<double>("seconds", 0), stage.get<size_t>("rss_growth_kb", 0)));
+        }
+
+        int regressions{0};
+        std::cout << std::left << std::setw(24) << "stage" << std::right << std::setw(12) << "baseline" << std::setw(12) << "current" << std::setw(10) << "ratio" << std::endl;
+        for (const auto & stage : m_stages) {
+            auto iter = base.find(stage.name);
+            if (iter == base.cend()) {
+                std::cout << std::left << std::setw(24) << stage.name << std::right << std::setw(12) << "-" << std::setw(12) << stage.seconds << std::endl;
+                continue;
+            }
+            auto [seconds, rssGrowth] = iter->second;
+            double ratio = seconds > 0 ? stage.seconds / seconds : 1;
+            bool slow = stage.seconds > seconds * (1 + tolerance) && stage.seconds - seconds > minSeconds;
+            bool heavy = stage.rssGrowthKB > rssGrowth * (1 + tolerance) && stage.rssGrowthKB - rssGrowth > minRssKB;
+            bool failed = not stage.success;
+            std::cout << std::left << std::setw(24) << stage.name << std::right << std::setw(12) << seconds << std::setw(12) << stage.seconds
+                      << std::setw(10) << std::setprecision(2) << ratio << std::setprecision(4)
+                      << (slow ? "  SLOWER" : "") << (heavy ? "  MEMORY" : "") << (failed ? "  FAILED" : "") << std::endl;
+            if (slow || heavy || failed) regressions++;
+        }
+        return regressions;
+    }
+
+private:
+    std::string m_name;
+    Config m_config;
+    std::vector<StageResult> m_stages;
+};
+
+} // namespace ecad::benchmark
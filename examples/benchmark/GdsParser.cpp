@@ -0,0 +1,46 @@
+#include <boost/stacktrace.hpp>
+#include <filesystem>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <csignal>
+
+#include "extension/gds/EGdsFileIO.h"
+#include "Synthetic.hpp"
+
+void SignalHandler(int signum)
+{
+    ::signal(signum, SIG_DFL);
+    std::cout << boost::stacktrace::stacktrace();
+    ::raise(SIGABRT);
+}
+
+int main(int argc, char * argv[])
+{
+    ::signal(SIGSEGV, &SignalHandler);
+    ::signal(SIGABRT, &SignalHandler);
+
+    using namespace ecad::ext::gds;
+    using ecad::benchmark::SyntheticGdsWriter;
+    size_t cells = argc > 1 ? std::stoul(argv[1]) : 200;
+    size_t polygons = argc > 2 ? std::stoul(argv[2]) : 20000;
+    size_t threads = argc > 3 ? std::stoul(argv[3]) : std::thread::hardware_concurrency();
+
+    auto filename = (std::filesystem::temp_directory_path() / "ecad_synthetic.gds").string();
+    if (not SyntheticGdsWriter(filename).Write(cells, polygons, 16)) return EXIT_FAILURE;
+    auto size = std::filesystem::file_size(filename);
+    std::cout << "synthetic gds: " << size / 1024.0 / 1024.0 << " MB, " << cells << " cells x " << polygons << " polygons" << std::endl;
+
+    for (size_t t : {size_t(1), threads}) {
+        EGdsDB db;
+        auto start = std::chrono::steady_clock::now();
+        if (not EGdsReader(db)(filename, t)) return EXIT_FAILURE;
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        size_t objects{0};
+        for (const auto & cell : db.Cells()) objects += cell.objects.size();
+        std::cout << "threads: " << t << ", cells: " << db.Cells().size() << ", objects: " << objects
+                  << ", time: " << elapsed.count() << "s, throughput: " << size / 1024.0 / 1024.0 / elapsed.count() << " MB/s" << std::endl;
+    }
+    std::filesystem::remove(filename);
+    return EXIT_SUCCESS;
+}
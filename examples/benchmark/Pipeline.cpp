@@ -0,0 +1,211 @@
+#include <boost/stacktrace.hpp>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <csignal>
+#include <map>
+
+#include "solver/thermal/network/ThermalNetworkSolver.h"
+#include "solver/thermal/utils/EPrismThermalNetworkBuilder.h"
+#include "solver/thermal/EThermalNetworkSolver.h"
+#include "BenchmarkReport.hpp"
+#include "Synthetic.hpp"
+
+void SignalHandler(int signum)
+{
+    ::signal(signum, SIG_DFL);
+    std::cout << boost::stacktrace::stacktrace();
+    ::raise(SIGABRT);
+}
+
+void PrintUsage()
+{
+    std::cout << "usage: Benchmark_Pipeline.exe [--layers n] [--primitives n] [--instances n] [--components n] [--grid n] [--nodes n]\n"
+              << "                              [--threads n] [--work-dir dir] [--output results.json] [--baseline baseline.json] [--tolerance 0.2]\n"
+              << "runs the synthetic import, flatten, merge, mapping, mesh, network build and solve stages,\n"
+              << "exits with 2 if any stage regresses against the baseline" << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+    ::signal(SIGSEGV, &SignalHandler);
+    ::signal(SIGABRT, &SignalHandler);
+
+    using namespace ecad;
+    using namespace ecad::benchmark;
+
+    std::map<std::string, std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string key(argv[i]);
+        if (key == "-h" || key == "--help" || key.substr(0, 2) != "--" || i + 1 >= argc) {
+            PrintUsage();
+            return key == "-h" || key == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        args.emplace(key.substr(2), argv[++i]);
+    }
+    auto arg = [&args](const std::string & key, auto value) {
+        auto iter = args.find(key);
+        if (iter == args.cend()) return value;
+        if constexpr (std::is_same_v<decltype(value), std::string>) return iter->second;
+        else if constexpr (std::is_floating_point_v<decltype(value)>) return std::stod(iter->second);
+        else return decltype(value)(std::stoul(iter->second));
+    };
+
+    SyntheticLayoutSettings layoutSettings;
+    layoutSettings.layers = arg("layers", layoutSettings.layers);
+    layoutSettings.primitives = arg("primitives", layoutSettings.primitives);
+    layoutSettings.instances = arg("instances", layoutSettings.instances);
+    layoutSettings.components = arg("components", layoutSettings.components);
+    size_t grid = arg("grid", size_t(100));
+    size_t nodes = arg("nodes", size_t(32));
+    size_t threads = arg("threads", size_t(std::max(1u, std::thread::hardware_concurrency())));
+    double tolerance = arg("tolerance", 0.2);
+    std::string output = arg("output", std::string("benchmark.json"));
+    std::string baseline = arg("baseline", std::string{});
+    std::string workDir = arg("work-dir", (std::filesystem::temp_directory_path() / "ecad_benchmark").string());
+    std::filesystem::create_directories(workDir);
+
+    auto & eDataMgr = EDataMgr::Instance();
+    eDataMgr.Init(ELogLevel::Warn, workDir);
+    eDataMgr.SetThreads(threads);
+
+    BenchmarkReport report("pipeline");
+    report.AddConfig("layers", layoutSettings.layers);
+    report.AddConfig("primitives", layoutSettings.primitives);
+    report.AddConfig("instances", layoutSettings.instances);
+    report.AddConfig("components", layoutSettings.components);
+    report.AddConfig("grid", grid);
+    report.AddConfig("nodes", nodes);
+    report.AddConfig("threads", threads);
+
+    //import
+    //the synthetic file is written before the stage, only the import is timed
+    auto gds = workDir + "/synthetic.gds";
+    if (not SyntheticGdsWriter(gds).Write(layoutSettings.instances, layoutSettings.primitives, layoutSettings.layers)) {
+        std::cerr << "failed to write " << gds << std::endl;
+        eDataMgr.ShutDown(false);
+        return EXIT_FAILURE;
+    }
+    report.Run("gds_import", [&]() -> size_t {
+        auto database = eDataMgr.CreateDatabaseFromGds("SyntheticGds", gds);
+        return database ? std::filesystem::file_size(gds) : 0;
+    });
+
+    //layout
+    Ptr<ICell> cell{nullptr};
+    Ptr<ILayoutView> layout{nullptr};
+    report.Run("layout_generate", [&]() -> size_t {
+        cell = GenerateSyntheticLayout("Synthetic", layoutSettings);
+        return cell ? layoutSettings.layers * layoutSettings.primitives : 0;
+    });
+    if (cell && report.Run("flatten", [&]() -> size_t {
+            if (not cell->GetDatabase()->Flatten(cell, threads)) return 0;
+            layout = cell->GetFlattenedLayoutView();
+            return layout ? layout->GetPrimitiveCollection()->Size() : 0;
+        })) {
+        report.Run("polygon_merge", [&]() -> size_t {
+            ELayoutPolygonMergeSettings mergeSettings(threads, {});
+            if (not layout->MergeLayerPolygons(mergeSettings)) return 0;
+            return layout->GetPrimitiveCollection()->Size();
+        });
+
+        EMetalFractionMappingSettings mfSettings(threads, {});
+        mfSettings.grid = {grid, grid};
+        mfSettings.mergeGeomBeforeMapping = false;
+        report.Run("metal_fraction_mapping", [&]() -> size_t {
+            return layout->GenerateMetalFractionMapping(mfSettings) ? grid * grid * layoutSettings.layers : 0;
+        });
+
+        CPtr<EGridThermalModel> gridModel{nullptr};
+        report.Run("grid_model", [&]() -> size_t {
+            EGridThermalModelExtractionSettings gridSettings(workDir, threads, {});
+            gridSettings.metalFractionMappingSettings = mfSettings;
+            gridSettings.botUniformBC.type = EThermalBoundaryConditionType::HTC;
+            gridSettings.botUniformBC.value = 2750;
+            gridModel = dynamic_cast<CPtr<EGridThermalModel> >(layout->ExtractThermalModel(gridSettings));
+            return gridModel ? gridModel->TotalGrids() : 0;
+        });
+        if (gridModel) {
+            report.Run("grid_static_solve", [&]() -> size_t {
+                solver::EGridThermalNetworkStaticSolver solver(*gridModel);
+                solver.settings.threads = threads;
+                solver.settings.dumpResults = false;
+                std::vector<EFloat> temperatures;
+                auto [minT, maxT] = solver.Solve(temperatures);
+                return minT < maxT ? temperatures.size() : 0;
+            });
+        }
+
+        CPtr<EPrismThermalModel> prismModel{nullptr};
+        report.Run("prism_mesh", [&]() -> size_t {
+            EPrismThermalModelExtractionSettings prismSettings(workDir, threads, {});
+            prismSettings.botUniformBC.type = EThermalBoundaryConditionType::HTC;
+            prismSettings.botUniformBC.value = 2750;
+            prismModel = dynamic_cast<CPtr<EPrismThermalModel> >(layout->ExtractThermalModel(prismSettings));
+            return prismModel ? prismModel->TotalElements() : 0;
+        });
+        if (prismModel) {
+            report.Run("prism_network_build", [&]() -> size_t {
+                solver::EPrismThermalNetworkBuilder<Float32> builder(*prismModel);
+                std::vector<Float32> iniT(prismModel->TotalElements(), ETemperature::Celsius2Kelvins(25));
+                auto network = builder.Build(iniT, threads);
+                return network ? network->Size() : 0;
+            });
+            report.Run("prism_static_solve", [&]() -> size_t {
+                solver::EPrismThermalNetworkStaticSolver solver(*prismModel);
+                solver.settings.threads = threads;
+                solver.settings.dumpResults = false;
+                std::vector<EFloat> temperatures;
+                auto [minT, maxT] = solver.Solve(temperatures);
+                return minT < maxT ? temperatures.size() : 0;
+            });
+            report.Run("prism_transient_solve", [&]() -> size_t {
+                EThermalTransientExcitation excitation = [](EFloat t, size_t) { return std::abs(std::sin(t)); };
+                solver::EPrismThermalNetworkTransientSolver solver(*prismModel, excitation);
+                solver.settings.threads = threads;
+                solver.settings.dumpResults = false;
+                solver.settings.duration = 1;
+                solver.settings.step = 0.01;
+                solver.settings.integrator = EThermalTransientIntegratorType::BackwardEuler;
+                solver.settings.probs = {0, prismModel->TotalElements() / 2, prismModel->TotalElements() - 1};
+                auto [minT, maxT] = solver.Solve();
+                return minT <= maxT ? prismModel->TotalElements() : 0;
+            });
+        }
+    }
+
+    //network
+    thermal::model::ThermalNetwork<Float64> network(0);
+    report.Run("network_generate", [&]() -> size_t {
+        network = GenerateSyntheticNetwork<Float64>(nodes, nodes, nodes);
+        return network.Size();
+    });
+    report.Run("network_static_solve", [&]() -> size_t {
+        thermal::solver::ThermalNetworkSolver<Float64> solver(static_cast<int>(EThermalNetworkStaticSolverType::ConjugateGradient));
+        std::vector<Float64> results;
+        return solver.Solve(network.Freeze(), ETemperature::Celsius2Kelvins(25), results) ? results.size() : 0;
+    });
+
+    eDataMgr.ShutDown(false);
+    std::filesystem::remove(gds);
+
+    int res = EXIT_SUCCESS;
+    if (not report.WriteJson(output)) {
+        std::cerr << "failed to write " << output << std::endl;
+        res = EXIT_FAILURE;
+    }
+    else std::cout << "results: " << output << std::endl;
+
+    for (const auto & stage : report.Stages())
+        if (not stage.success) res = EXIT_FAILURE;
+
+    if (not baseline.empty()) {
+        auto regressions = report.Compare(baseline, tolerance);
+        if (regressions < 0) res = EXIT_FAILURE;
+        else if (regressions > 0) {
+            std::cout << regressions << " stage(s) regressed against " << baseline << std::endl;
+            res = 2;
+        }
+    }
+    return res;
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include "solver/thermal/network/ThermalNetwork.h"
+#include "EDataMgr.h"
+
+namespace ecad::benchmark {
+
+///writes a synthetic gds library, cells x polygons boundaries of 5 points each, every cell refers to the previous one
+class SyntheticGdsWriter
+{
+public:
+    explicit SyntheticGdsWriter(const std::string & filename) : m_out(filename, std::ios::binary) {}
+
+    bool Write(size_t cells, size_t polygons, size_t layers)
+    {
+        if (not m_out.is_open()) return false;
+        Record(0x00, 0x02, Int2({600}));
+        Record(0x01, 0x02, Int2(std::vector<int>(12, 0)));
+        Record(0x02, 0x06, Str("SYNTHETIC"));
+        Record(0x03, 0x05, Real8({1e-3, 1e-9}));
+        for (size_t c = 0; c < cells; ++c) {
+            Record(0x05, 0x02, Int2(std::vector<int>(12, 0)));
+            Record(0x06, 0x06, Str("CELL_" + std::to_string(c)));
+            for (size_t p = 0; p < polygons; ++p) {
+                int x = (p % 1000) * 100, y = int(p / 1000) * 100;
+                Record(0x08, 0x00, {});
+                Record(0x0d, 0x02, Int2({int(p % layers)}));
+                Record(0x0e, 0x02, Int2({0}));
+                Record(0x10, 0x03, Int4({x, y, x + 80, y, x + 80, y + 80, x, y + 80, x, y}));
+                Record(0x11, 0x00, {});
+            }
+            if (c > 0) {
+                Record(0x0a, 0x00, {});
+                Record(0x12, 0x06, Str("CELL_" + std::to_string(c - 1)));
+                Record(0x10, 0x03, Int4({0, 0}));
+                Record(0x11, 0x00, {});
+            }
+            Record(0x07, 0x00, {});
+        }
+        Record(0x04, 0x00, {});
+        return m_out.good();
+    }
+
+private:
+    using Bytes = std::vector<unsigned char>;
+    void Record(unsigned char type, unsigned char dataType, const Bytes & data)
+    {
+        size_t size = data.size() + 4;
+        unsigned char head[4] = {static_cast<unsigned char>(size >> 8), static_cast<unsigned char>(size & 0xff), type, dataType};
+        m_out.write(reinterpret_cast<const char *>(head), 4);
+        m_out.write(reinterpret_cast<const char *>(data.data()), data.size());
+    }
+
+    static Bytes Int2(const std::vector<int> & values)
+    {
+        Bytes bytes;
+        for (auto v : values) { bytes.push_back((v >> 8) & 0xff); bytes.push_back(v & 0xff); }
+        return bytes;
+    }
+
+    static Bytes Int4(const std::vector<int> & values)
+    {
+        Bytes bytes;
+        for (auto v : values)
+            for (int shift = 24; shift >= 0; shift -= 8) bytes.push_back((v >> shift) & 0xff);
+        return bytes;
+    }
+
+    static Bytes Real8(const std::vector<double> & values)
+    {
+        Bytes bytes;
+        for (auto v : values) {
+            int exponent = 0;
+            double mantissa = std::abs(v);
+            while (mantissa >= 1) { mantissa /= 16; exponent++; }
+            while (mantissa > 0 && mantissa < 1.0 / 16) { mantissa *= 16; exponent--; }
+            auto bits = static_cast<unsigned long long>(std::ldexp(mantissa, 56));
+            bytes.push_back((v < 0 ? 0x80 : 0) | ((exponent + 64) & 0x7f));
+            for (int shift = 48; shift >= 0; shift -= 8) bytes.push_back((bits >> shift) & 0xff);
+        }
+        return bytes;
+    }
+
+    static Bytes Str(std::string str)
+    {
+        if (str.size() % 2) str.push_back('\0');
+        return Bytes(str.begin(), str.end());
+    }
+
+private:
+    std::ofstream m_out;
+};
+
+/**
+ * @brief a hierarchical layout of layers x primitives random rectangles, the rectangles are placed in a tile cell
+ *        which is instantiated instances x instances times in the top cell, the powered components sit on the top layer
+ */
+struct SyntheticLayoutSettings
+{
+    size_t layers = 4;
+    size_t primitives = 2000;//per layer, after flatten
+    size_t instances = 4;//per row and column
+    size_t components = 4;
+    EFloat tileSize = 10000;//um
+    EFloat thickness = 35;//um
+    unsigned int seed = 0;
+};
+
+inline Ptr<ICell> GenerateSyntheticLayout(const std::string & name, const SyntheticLayoutSettings & settings)
+{
+    auto & eDataMgr = EDataMgr::Instance();
+    auto database = eDataMgr.CreateDatabase(name);
+    if (nullptr == database) return nullptr;
+
+    auto matCu = database->CreateMaterialDef("Cu");
+    matCu->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(398));
+    matCu->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(380));
+    matCu->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(8850));
+
+    auto matFR4 = database->CreateMaterialDef("FR4");
+    matFR4->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(0.3));
+    matFR4->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(1100));
+    matFR4->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(1850));
+
+    auto matSiC = database->CreateMaterialDef("SiC");
+    matSiC->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(370));
+    matSiC->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(750));
+    matSiC->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(3210));
+
+    ECoordUnits coordUnits(ECoordUnits::Unit::Micrometer);
+    database->SetCoordUnits(coordUnits);
+
+    const size_t instances = std::max<size_t>(1, settings.instances);
+    const EFloat tile = settings.tileSize, size = tile * instances;
+    auto topCell = eDataMgr.CreateCircuitCell(database, "TopCell");
+    auto topLayout = topCell->GetLayoutView();
+    topLayout->SetBoundary(std::make_unique<EPolygon>(eDataMgr.CreatePolygon(coordUnits, {{0, 0}, {size, 0}, {size, size}, {0, size}})));
+
+    auto tileCell = eDataMgr.CreateCircuitCell(database, "TileCell");
+    auto tileLayout = tileCell->GetLayoutView();
+    tileLayout->SetBoundary(std::make_unique<EPolygon>(eDataMgr.CreatePolygon(coordUnits, {{0, 0}, {tile, 0}, {tile, tile}, {0, tile}})));
+
+    auto layerMap = eDataMgr.CreateLayerMap(database, "TileLayerMap");
+    std::vector<ELayerId> topLayers, tileLayers;
+    for (size_t i = 0; i < settings.layers; ++i) {
+        auto lyrName = "Layer" + std::to_string(i);
+        EFloat elevation = -EFloat(i) * settings.thickness;
+        auto topLayer = topLayout->AppendLayer(eDataMgr.CreateStackupLayer(lyrName, ELayerType::ConductingLayer, elevation, settings.thickness, matCu->GetName(), matFR4->GetName()));
+        auto tileLayer = tileLayout->AppendLayer(eDataMgr.CreateStackupLayer(lyrName, ELayerType::ConductingLayer, elevation, settings.thickness, matCu->GetName(), matFR4->GetName()));
+        layerMap->SetMapping(tileLayer, topLayer);
+        topLayers.emplace_back(topLayer);
+        tileLayers.emplace_back(tileLayer);
+    }
+
+    //random rectangles with overlaps, so the polygon merge has real work to do
+    std::mt19937 rng(settings.seed);
+    std::uniform_real_distribution<EFloat> loc(0, tile * 0.95), len(tile * 0.005, tile * 0.05);
+    auto net = eDataMgr.CreateNet(tileLayout, "Net");
+    const size_t perTile = (settings.primitives + instances * instances - 1) / (instances * instances);
+    for (auto layer : tileLayers) {
+        for (size_t p = 0; p < perTile; ++p) {
+            FPoint2D ll(loc(rng), loc(rng));
+            FPoint2D ur(std::min(tile, ll[0] + len(rng)), std::min(tile, ll[1] + len(rng)));
+            eDataMgr.CreateGeometry2D(tileLayout, layer, net->GetNetId(), eDataMgr.CreateShapeRectangle(coordUnits, ll, ur));
+        }
+    }
+
+    for (size_t i = 0; i < instances; ++i) {
+        for (size_t j = 0; j < instances; ++j) {
+            auto instName = "Tile_" + std::to_string(i) + "_" + std::to_string(j);
+            auto inst = eDataMgr.CreateCellInst(topLayout, instName, tileLayout, eDataMgr.CreateTransform2D(coordUnits, 1, 0, {tile * i, tile * j}));
+            inst->SetLayerMap(layerMap);
+        }
+    }
+
+    auto compDef = eDataMgr.CreateComponentDef(database, "Die");
+    EFloat half = tile * 0.1;
+    compDef->SetBoundary(eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(-half, -half), FPoint2D(half, half)));
+    compDef->SetMaterial(matSiC->GetName());
+    compDef->SetSolderFillingMaterial(matCu->GetName());
+    compDef->SetHeight(300);
+    for (size_t i = 0; i < settings.components; ++i) {
+        EFloat x = size * (i + 1) / (settings.components + 1);
+        auto comp = eDataMgr.CreateComponent(topLayout, "Die" + std::to_string(i), compDef, topLayers.front(), eDataMgr.CreateTransform2D(coordUnits, 1, 0, {x, size / 2}), false);
+        comp->SetLossPower(ETemperature::Celsius2Kelvins(25), 10);
+    }
+    return topCell;
+}
+
+///a nx x ny x nz grid network with unit resistances, heat flows into the top face and leaves from the bottom face
+template <typename Scalar>
+inline thermal::model::ThermalNetwork<Scalar> GenerateSyntheticNetwork(size_t nx, size_t ny, size_t nz)
+{
+    using Network = thermal::model::ThermalNetwork<Scalar>;
+    Network network(nx * ny * nz);
+    auto index = [&](size_t x, size_t y, size_t z) { return z * nx * ny + y * nx + x; };
+    std::vector<typename Network::Edge> edges;
+    edges.reserve(3 * network.Size());
+    for (size_t z = 0; z < nz; ++z) {
+        for (size_t y = 0; y < ny; ++y) {
+            for (size_t x = 0; x < nx; ++x) {
+                auto i = index(x, y, z);
+                network.SetC(i, 1);
+                if (x + 1 < nx) edges.emplace_back(Network::MakeEdge(i, index(x + 1, y, z), 1));
+                if (y + 1 < ny) edges.emplace_back(Network::MakeEdge(i, index(x, y + 1, z), 1));
+                if (z + 1 < nz) edges.emplace_back(Network::MakeEdge(i, index(x, y, z + 1), 1));
+                if (0 == z) network.SetHF(i, 1);
+                if (z + 1 == nz) network.SetHTC(i, 1);
+            }
+        }
+    }
+    network.AppendEdges(edges);
+    return network;
+}
+
+} // namespace ecad::benchmark
@@ -116,6 +116,8 @@ void ecad_init_datamgr(py::module_ & m)
             { return EDataMgr::Instance().SetThreads(threads); })
         .def("threads", []
             { return EDataMgr::Instance().Threads(); })   
+        .def("set_model_cache", [](const std::string & dir, size_t limit)
+            { return EDataMgr::Instance().SetModelCache(dir, limit); })
 
     ;
 }
@@ -178,6 +178,10 @@ void ecad_init_basic(py::module_ & m)
         .value("LLT", EThermalNetworkStaticSolverType::LLT)
         .value("LDLT", EThermalNetworkStaticSolverType::LDLT)
         .value("CONJUGATE_GRADIENT", EThermalNetworkStaticSolverType::ConjugateGradient)
+        .value("IC_CONJUGATE_GRADIENT", EThermalNetworkStaticSolverType::ICConjugateGradient)
+        .value("ILUT_BICGSTAB", EThermalNetworkStaticSolverType::ILUTBiCGSTAB)
+        .value("AMG_CONJUGATE_GRADIENT", EThermalNetworkStaticSolverType::AMGConjugateGradient)
+        .value("ALGEBRAIC_MULTIGRID", EThermalNetworkStaticSolverType::AlgebraicMultigrid)
     ;
 
     py::class_<EPoint2D>(m, "Point2D")
@@ -367,12 +371,27 @@ void ecad_init_basic(py::module_ & m)
         .def_readwrite("solver_type", &EThermalStaticSettings::solverType)
     ;
 
+    py::enum_<EThermalTransientIntegratorType>(m, "ThermalTransientIntegratorType")
+        .value("EXPLICIT", EThermalTransientIntegratorType::Explicit)
+        .value("BACKWARD_EULER", EThermalTransientIntegratorType::BackwardEuler)
+        .value("TR_BDF2", EThermalTransientIntegratorType::TRBDF2)
+        .value("BDF", EThermalTransientIntegratorType::BDF)
+    ;
+
     py::class_<EThermalModelReductionSettings>(m, "ThermalModelReductionSettings")
         .def_readwrite("order", &EThermalModelReductionSettings::order)
+        .def_readwrite("parametric", &EThermalModelReductionSettings::parametric)
+        .def_readwrite("bucket", &EThermalModelReductionSettings::bucket)
         .def_readwrite("rom_load_file", &EThermalModelReductionSettings::romLoadFile)
         .def_readwrite("rom_save_file", &EThermalModelReductionSettings::romSaveFile)
     ;
     
+    py::class_<EThermalSampleSinkSettings>(m, "ThermalSampleSinkSettings")
+        .def_readwrite("binary", &EThermalSampleSinkSettings::binary)
+        .def_readwrite("decimation", &EThermalSampleSinkSettings::decimation)
+        .def_readwrite("chunk_rows", &EThermalSampleSinkSettings::chunkRows)
+    ;
+
     py::class_<EThermalTransientSettings, EThermalSettings>(m, "ThermalTransientSettings")
         .def(py::init<size_t>())
         .def_readwrite("verbose", &EThermalTransientSettings::verbose)
@@ -384,7 +403,9 @@ void ecad_init_basic(py::module_ & m)
         .def_readwrite("relative_error", &EThermalTransientSettings::relativeError)
         .def_readwrite("min_sampling_interval", &EThermalTransientSettings::minSamplingInterval)
         .def_readwrite("sampling_window", &EThermalTransientSettings::samplingWindow)
+        .def_readwrite("integrator", &EThermalTransientSettings::integrator)
         .def_readwrite("mor", &EThermalTransientSettings::mor)
+        .def_readwrite("sink", &EThermalTransientSettings::sink)
     ;
 
     py::class_<EThermalSimulationSetup>(m, "ThermalSimulationSetup")
@@ -68,11 +68,17 @@ void ecad_init_design(py::module_ & m)
         .def("get_layer_iter", &ILayoutView::GetLayerIter)
         .def("get_primitive_iter", &ILayoutView::GetPrimitiveIter)
         .def("flatten", &ILayoutView::Flatten)
+        .def("modify_stackup_layer_thickness", &ILayoutView::ModifyStackupLayerThickness)
         .def("run_thermal_simulation", [](ILayoutView & layout, const EThermalStaticSimulationSetup & simulationSetup){
             std::vector<EFloat> temperatures;
             auto range = layout.RunThermalSimulation(simulationSetup, temperatures);
             return std::make_tuple(range.first, range.second, temperatures);
         })
+        .def("run_thermal_simulation", [](ILayoutView & layout, const EThermalStaticSimulationSetup & simulationSetup, const std::vector<EThermalStaticExcitation> & cases){
+            std::vector<std::vector<EFloat> > temperatures;
+            auto ranges = layout.RunThermalSimulation(simulationSetup, cases, temperatures);
+            return std::make_tuple(ranges, temperatures);
+        })
         .def("run_thermal_simulation", py::overload_cast<const EThermalTransientSimulationSetup &, const EThermalTransientExcitation &>(&ILayoutView::RunThermalSimulation))
     ;
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "PyEcadCommon.hpp"
 #include "utility/ELayoutRetriever.h"
+#include "solver/thermal/network/utils/SampleSink.h"
 
 void ecad_init_utility(py::module_ & m)
 {
@@ -14,4 +15,16 @@ void ecad_init_utility(py::module_ & m)
         })
     ;
 
+    py::class_<thermal::utils::BinarySampleReader>(m, "ThermalSampleReader")
+        .def(py::init<>())
+        .def(py::init<const std::string &>())
+        .def("read", &thermal::utils::BinarySampleReader::Read)
+        .def("probes", &thermal::utils::BinarySampleReader::Probes)
+        .def("samples", &thermal::utils::BinarySampleReader::Samples)
+        .def("ids", &thermal::utils::BinarySampleReader::Ids)
+        .def("names", &thermal::utils::BinarySampleReader::Names)
+        .def("units", &thermal::utils::BinarySampleReader::Units)
+        .def("times", &thermal::utils::BinarySampleReader::Times)
+        .def("values", &thermal::utils::BinarySampleReader::Values)
+    ;
 }
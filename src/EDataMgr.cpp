@@ -382,6 +382,22 @@ ECAD_INLINE size_t EDataMgr::CircleDiv() const
     return m_settings.circleDiv;
 }
 
+ECAD_INLINE void EDataMgr::SetModelCache(const std::string & dir, size_t limit)
+{
+    m_settings.modelCacheDir = dir;
+    m_settings.modelCacheLimit = limit;
+}
+
+ECAD_INLINE const std::string & EDataMgr::ModelCacheDir() const
+{
+    return m_settings.modelCacheDir;
+}
+
+ECAD_INLINE size_t EDataMgr::ModelCacheLimit() const
+{
+    return m_settings.modelCacheLimit;
+}
+
 ECAD_INLINE void EDataMgr::Init(ELogLevel level, const std::string & workDir)
 {   
     //threads
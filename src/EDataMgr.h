@@ -122,6 +122,10 @@ public:
 
     size_t CircleDiv() const;
 
+    void SetModelCache(const std::string & dir, size_t limit = 0);
+    const std::string & ModelCacheDir() const;
+    size_t ModelCacheLimit() const;
+
     static EDataMgr & Instance();
 
 private:
@@ -26,6 +26,8 @@ struct EDataMgrSettings
     char hierSep = '/';
     size_t threads = 1;
     size_t circleDiv = 16;
+    std::string modelCacheDir;//disabled if empty
+    size_t modelCacheLimit = 0;//bytes, unlimited if 0
 };
 
 struct ELayoutPolygonMergeSettings : public ECadSettings
@@ -435,6 +437,10 @@ enum class EThermalNetworkStaticSolverType
     LLT = 2,
     LDLT = 3,
     ConjugateGradient = 10,
+    ICConjugateGradient = 11,//incomplete Cholesky preconditioned
+    ILUTBiCGSTAB = 12,//incomplete LU with threshold preconditioned BiCGSTAB, ILUT is nonsymmetric so CG does not apply
+    AMGConjugateGradient = 13,//smoothed aggregation algebraic multigrid preconditioned
+    AlgebraicMultigrid = 14,//standalone multigrid V-cycles
 };
 
 struct EThermalSettings
@@ -463,15 +469,33 @@ struct EThermalStaticSimulationSetup : public EThermalSimulationSetup
     EThermalStaticSettings settings;
 };
 
+using EThermalStaticExcitation = std::function<EFloat(size_t)>;//ratio = f(scenario), range[0, 1]
 using EThermalTransientExcitation = std::function<EFloat(EFloat, size_t)>;//ratio = f(t, scenario), range[0, 1]
 
+enum class EThermalTransientIntegratorType
+{
+    Explicit = 0,//odeint runge kutta dopri5 if adaptive, modified midpoint otherwise
+    BackwardEuler = 1,
+    TRBDF2 = 2,
+    BDF = 3,//variable order up to 5
+};
+
 struct EThermalModelReductionSettings
 {
     size_t order = 0;
+    bool parametric = false;//temperature dependent runs reuse the projection basis and only project the changed network, the basis is not refreshed within a bucket
+    EFloat bucket = 0;//unit: K, one basis per bucket of the mean temperature, 0 means one basis for the whole run
     std::string romLoadFile;
     std::string romSaveFile;
 };
 
+struct EThermalSampleSinkSettings
+{
+    bool binary = false;//stream probe samples to workDir/trans.bin instead of keeping them in memory
+    size_t decimation = 1;//keep every n-th sample
+    size_t chunkRows = 1024;//samples buffered before a chunk is flushed to the file
+};
+
 struct EThermalTransientSettings : public EThermalSettings
 {
     bool verbose{false};
@@ -483,7 +507,9 @@ struct EThermalTransientSettings : public EThermalSettings
     EFloat relativeError{1e-6};
     EFloat minSamplingInterval{0};
     EFloat samplingWindow{0};
+    EThermalTransientIntegratorType integrator{EThermalTransientIntegratorType::Explicit};
     EThermalModelReductionSettings mor;
+    EThermalSampleSinkSettings sink;
     explicit EThermalTransientSettings(size_t threads) : EThermalSettings(threads) {}
     virtual ~EThermalTransientSettings() = default;
 };
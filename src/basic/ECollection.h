@@ -273,6 +273,7 @@ public:
 
     template <typename value_t>
     void Append(value_t && value) { m_collection.push_back(std::forward<value_t>(value)); }
+    void Reserve(size_t size) { m_collection.reserve(size); }
 
     const T & At(size_t index) const { return m_collection.at(index); }
     const T & Front() const { return m_collection.front(); }
@@ -20,6 +20,8 @@ class ECAD_API EUidGenerator
 #endif//ECAD_BOOST_SERIALIZATION_SUPPORT
 public:
     EUid GetNextUid() { return m_uid++; }
+    ///reserves n consecutive uids at once, returns the first one
+    EUid Reserve(size_t n) { return m_uid.fetch_add(static_cast<EUid>(n)); }
     void Reset() { m_uid.store(0); }
 private:
     std::atomic_int32_t m_uid = 0;
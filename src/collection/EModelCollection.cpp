@@ -42,12 +42,23 @@ ECAD_INLINE CPtr<IModel> EModelCollection::FindModel(EModelType type) const
     return BaseCollection::At(type).get();
 }
 
+ECAD_INLINE Ptr<IModel> EModelCollection::GetModel(EModelType type)
+{
+    if (not BaseCollection::Count(type)) return nullptr;
+    return BaseCollection::operator[](type).get();
+}
+
 ECAD_INLINE bool EModelCollection::AddModel(UPtr<IModel> model)
 {
     if (nullptr == model) return false;
     return BaseCollection::Insert(model->GetModelType(), std::move(model), true);
 }
 
+ECAD_INLINE bool EModelCollection::RemoveModel(EModelType type)
+{
+    return BaseCollection::Get().erase(type) > 0;
+}
+
 ECAD_INLINE size_t EModelCollection::Size() const
 {
     return BaseCollection::Size();
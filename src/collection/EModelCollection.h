@@ -22,7 +22,9 @@ public:
     EModelCollection & operator= (const EModelCollection & other);
 
     CPtr<IModel> FindModel(EModelType type) const override;
+    Ptr<IModel> GetModel(EModelType type) override;
     bool AddModel(UPtr<IModel> model) override;
+    bool RemoveModel(EModelType type) override;
 
     size_t Size() const override;
     void Clear() override;
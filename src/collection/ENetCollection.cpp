@@ -77,6 +77,19 @@ ECAD_INLINE Ptr<INet> ENetCollection::AddNet(UPtr<INet> net)
     return At(name).get();
 }
 
+ECAD_INLINE ENetId ENetCollection::AddNets(std::vector<UPtr<INet> > nets)
+{
+    auto uid = m_uidGen.Reserve(nets.size());
+    for (size_t i = 0; i < nets.size(); ++i) {
+        auto name = NextNetName(nets[i]->GetName());
+        nets[i]->SetName(name);
+        nets[i]->SetNetId(static_cast<ENetId>(uid + i));
+        Insert(name, std::move(nets[i]));
+    }
+    ResetNetIdLUT();
+    return static_cast<ENetId>(uid);
+}
+
 
 ECAD_INLINE NetIter ENetCollection::GetNetIter() const
 {
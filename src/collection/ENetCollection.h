@@ -27,6 +27,8 @@ public:
     Ptr<INet> FindNetByNetId(ENetId netId) const override;
     Ptr<INet> CreateNet(const std::string & name) override;
     Ptr<INet> AddNet(UPtr<INet> net) override;
+    ///the nets get one block of consecutive ids, returns the id of the first one
+    ENetId AddNets(std::vector<UPtr<INet> > nets) override;
 
     NetIter GetNetIter() const override;
     size_t Size() const override;
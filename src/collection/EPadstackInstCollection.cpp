@@ -89,6 +89,11 @@ ECAD_INLINE PadstackInstIter EPadstackInstCollection::GetPadstackInstIter() cons
     return PadstackInstIter(new EPadstackInstIterator(*this));
 }
 
+ECAD_INLINE void EPadstackInstCollection::Reserve(size_t size)
+{
+    BaseCollection::Reserve(size);
+}
+
 ECAD_INLINE size_t EPadstackInstCollection::Size() const
 {
     return BaseCollection::Size();
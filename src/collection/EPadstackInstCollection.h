@@ -31,6 +31,8 @@ public:
 
     PadstackInstIter GetPadstackInstIter() const override;
 
+    void Reserve(size_t size) override;
+
     size_t Size() const override;
 protected:
     virtual ECollectionType GetType() const override { return ECollectionType::PadstackInst; }
@@ -96,6 +96,11 @@ ECAD_INLINE UPtr<IPrimitive> EPrimitiveCollection::PopBack()
     return tail;
 }
 
+ECAD_INLINE void EPrimitiveCollection::Reserve(size_t size)
+{
+    BaseCollection::Reserve(size);
+}
+
 ECAD_INLINE size_t EPrimitiveCollection::Size() const
 {
     return BaseCollection::Size();
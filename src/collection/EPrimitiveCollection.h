@@ -34,6 +34,7 @@ public:
 
     PrimitiveIter GetPrimitiveIter() const override;
     UPtr<IPrimitive> PopBack() override;
+    void Reserve(size_t size) override;
     size_t Size() const override;
     void Clear() override;
     
@@ -11,11 +11,15 @@ namespace ecad {
 template <typename Archive>
 ECAD_INLINE void ECellInst::serialize(Archive & ar, const unsigned int version)
 {
-    ECAD_UNUSED(version)
     boost::serialization::void_cast_register<ECellInst, ICellInst>();
     ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(EHierarchyObj);
     ar & boost::serialization::make_nvp("def_layout", m_defLayout);
     ar & boost::serialization::make_nvp("layer_map", m_layerMap);
+    if (version < 1) return;
+    ar & boost::serialization::make_nvp("cols", m_cols);
+    ar & boost::serialization::make_nvp("rows", m_rows);
+    ar & boost::serialization::make_nvp("col_pitch", m_colPitch);
+    ar & boost::serialization::make_nvp("row_pitch", m_rowPitch);
 }
 
 ECAD_SERIALIZATION_FUNCTIONS_IMP(ECellInst)
@@ -81,5 +85,43 @@ ECAD_INLINE CPtr<ILayerMap> ECellInst::GetLayerMap() const
     return m_layerMap;
 }
 
+ECAD_INLINE void ECellInst::SetArray(size_t cols, size_t rows, const EVector2D & colPitch, const EVector2D & rowPitch)
+{
+    ECAD_ASSERT(cols > 0 && rows > 0)
+    m_cols = std::max<size_t>(1, cols);
+    m_rows = std::max<size_t>(1, rows);
+    m_colPitch = colPitch;
+    m_rowPitch = rowPitch;
+}
+
+ECAD_INLINE void ECellInst::GetArray(size_t & cols, size_t & rows, EVector2D & colPitch, EVector2D & rowPitch) const
+{
+    cols = m_cols;
+    rows = m_rows;
+    colPitch = m_colPitch;
+    rowPitch = m_rowPitch;
+}
+
+ECAD_INLINE bool ECellInst::isArray() const
+{
+    return Placements() > 1;
+}
+
+ECAD_INLINE size_t ECellInst::Placements() const
+{
+    return m_cols * m_rows;
+}
+
+ECAD_INLINE ETransform2D ECellInst::GetPlacementTransform(size_t index) const
+{
+    ECAD_ASSERT(index < Placements())
+    auto transform = ICellInst::GetTransform();
+    if (not isArray()) return transform;
+    auto c = static_cast<ECoord>(index % m_cols), r = static_cast<ECoord>(index / m_cols);
+    EVector2D offset(c * m_colPitch[0] + r * m_rowPitch[0], c * m_colPitch[1] + r * m_rowPitch[1]);
+    transform.Append(makeETransform2D(1, 0, offset));
+    return transform;
+}
+
 
 }//namespace ecad
\ No newline at end of file
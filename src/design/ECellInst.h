@@ -28,6 +28,12 @@ public:
     void SetLayerMap(CPtr<ILayerMap> layerMap) override;
     CPtr<ILayerMap> GetLayerMap() const override;
 
+    void SetArray(size_t cols, size_t rows, const EVector2D & colPitch, const EVector2D & rowPitch) override;
+    void GetArray(size_t & cols, size_t & rows, EVector2D & colPitch, EVector2D & rowPitch) const override;
+    bool isArray() const override;
+    size_t Placements() const override;
+    ETransform2D GetPlacementTransform(size_t index) const override;
+
 protected:
     ///Copy
     virtual Ptr<ECellInst> CloneImp() const override { return new ECellInst(*this); }
@@ -37,7 +43,12 @@ protected:
 private:
     CPtr<ILayoutView> m_defLayout{nullptr};
     CPtr<ILayerMap> m_layerMap{nullptr};
+    size_t m_cols{1}, m_rows{1};
+    EVector2D m_colPitch{0, 0}, m_rowPitch{0, 0};
 };
 
 }//namespace ecad
-ECAD_SERIALIZATION_CLASS_EXPORT_KEY(ecad::ECellInst)
\ No newline at end of file
+ECAD_SERIALIZATION_CLASS_EXPORT_KEY(ecad::ECellInst)
+#ifdef ECAD_BOOST_SERIALIZATION_SUPPORT
+BOOST_CLASS_VERSION(ecad::ECellInst, 1)
+#endif//ECAD_BOOST_SERIALIZATION_SUPPORT
\ No newline at end of file
@@ -14,6 +14,7 @@ ECAD_SERIALIZATION_CLASS_EXPORT_IMP(ecad::ELayoutView)
 #include "utility/ELayout2CtmUtility.h"
 #include "utility/ELayoutModifier.h"
 #include "utility/ELayoutRetriever.h"
+#include "utility/EModelCache.h"
 
 #include "interface/IHierarchyObjCollection.h"
 #include "interface/IPadstackInstCollection.h"
@@ -32,6 +33,9 @@ ECAD_SERIALIZATION_CLASS_EXPORT_IMP(ecad::ELayoutView)
 #include "interface/ICell.h"
 
 #include "basic/EShape.h"
+#include "EDataMgr.h"
+
+#include "generic/tools/FileSystem.hpp"
 
 namespace ecad {
 
@@ -333,8 +337,16 @@ ECAD_INLINE CPtr<IModel> ELayoutView::ExtractLayerCutModel(const ELayerCutModelE
         ECAD_TRACE("reuse exist layer cut model");
         return model;
     }
+    utils::EModelCache cache(EDataMgr::Instance().ModelCacheDir(), EDataMgr::Instance().ModelCacheLimit());
+    auto key = cache.isEnabled() ? cache.Key(this, settings, toString(EModelType::LayerCut)) : std::string{};
+    if (auto cached = cache.Load(key, this); cached) {
+        collection->AddModel(std::move(cached));
+        return collection->FindModel(EModelType::LayerCut);
+    }
     collection->AddModel(extraction::EGeometryModelExtraction::GenerateLayerCutModel(this, settings));
-    return collection->FindModel(EModelType::LayerCut);
+    model = collection->FindModel(EModelType::LayerCut);
+    cache.Save(key, model);
+    return model;
 }
 
 ECAD_INLINE CPtr<IModel> ELayoutView::ExtractThermalModel(const EThermalModelExtractionSettings & settings)
@@ -346,8 +358,18 @@ ECAD_INLINE CPtr<IModel> ELayoutView::ExtractThermalModel(const EThermalModelExt
         ECAD_TRACE("reuse exist %1% model", toString(modelType));
         return model;
     }
+    utils::EModelCache cache(EDataMgr::Instance().ModelCacheDir(), EDataMgr::Instance().ModelCacheLimit());
+    auto key = cache.isEnabled() ? cache.Key(this, settings, toString(modelType)) : std::string{};
+    if (not settings.forceRebuild) {
+        if (auto cached = cache.Load(key, this); cached) {
+            collection->AddModel(std::move(cached));
+            return collection->FindModel(modelType);
+        }
+    }
     collection->AddModel(extraction::EThermalModelExtraction::GenerateThermalModel(this, settings));
-    return collection->FindModel(modelType);
+    model = collection->FindModel(modelType);
+    cache.Save(key, model);
+    return model;
 }
 
 ECAD_INLINE EPair<EFloat, EFloat> ELayoutView::RunThermalSimulation(const EThermalStaticSimulationSetup & simulationSetup, std::vector<EFloat> & temperatures)
@@ -362,6 +384,17 @@ ECAD_INLINE EPair<EFloat, EFloat> ELayoutView::RunThermalSimulation(const ETherm
     return sim.RunStaticSimulation(temperatures);
 }
 
+ECAD_INLINE std::vector<EPair<EFloat, EFloat> > ELayoutView::RunThermalSimulation(const EThermalStaticSimulationSetup & simulationSetup, const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures)
+{
+    temperatures.clear();
+    if (nullptr == simulationSetup.extractionSettings) return {};
+    auto model = ExtractThermalModel(*simulationSetup.extractionSettings);
+    if (nullptr == model) return {};
+
+    simulation::EThermalSimulation sim(model, simulationSetup);
+    return sim.RunStaticSimulation(cases, temperatures);
+}
+
 ECAD_INLINE EPair<EFloat, EFloat> ELayoutView::RunThermalSimulation(const EThermalTransientSimulationSetup & simulationSetup, const EThermalTransientExcitation & excitation)
 {
     if (nullptr == simulationSetup.extractionSettings)
@@ -369,6 +402,30 @@ ECAD_INLINE EPair<EFloat, EFloat> ELayoutView::RunThermalSimulation(const ETherm
     auto model = ExtractThermalModel(*simulationSetup.extractionSettings);
     if (nullptr == model) return {invalidFloat, invalidFloat};
 
+    //the reduced-order model of a temperature independent network is cached with the extracted model
+    const auto & settings = simulationSetup.settings;
+    utils::EModelCache cache(EDataMgr::Instance().ModelCacheDir(), EDataMgr::Instance().ModelCacheLimit());
+    if (cache.isEnabled() && settings.mor.order > 0 && not settings.temperatureDepend &&
+        settings.mor.romLoadFile.empty() && settings.mor.romSaveFile.empty()) {
+        EThermalTransientSimulationSetup setup(simulationSetup.workDir, settings.threads, {});
+        setup.monitors = simulationSetup.monitors;
+        setup.settings = settings;
+        setup.extractionSettings = simulationSetup.extractionSettings->Clone();
+
+        auto tag = "rom_" + std::to_string(settings.mor.order) + "_" + std::to_string(settings.envTemperature.inKelvins());
+        for (const auto & monitor : simulationSetup.monitors)
+            tag += "_" + std::to_string(monitor[0]) + "_" + std::to_string(monitor[1]) + "_" + std::to_string(monitor[2]);
+        auto romFile = cache.Path(cache.Key(this, *simulationSetup.extractionSettings, tag), "rom");
+        if (generic::fs::FileExists(romFile)) cache.Touch(romFile);
+        setup.settings.mor.romLoadFile = romFile;
+        setup.settings.mor.romSaveFile = romFile;
+
+        simulation::EThermalSimulation sim(model, setup);
+        auto res = sim.RunTransientSimulation(excitation);
+        cache.Evict();
+        return res;
+    }
+
     simulation::EThermalSimulation sim(model, simulationSetup);
     return sim.RunTransientSimulation(excitation);
 }
@@ -109,6 +109,7 @@ public:
 
     ///Simulation
     EPair<EFloat, EFloat> RunThermalSimulation(const EThermalStaticSimulationSetup & simulationSetup, std::vector<EFloat> & temperatures) override;
+    std::vector<EPair<EFloat, EFloat> > RunThermalSimulation(const EThermalStaticSimulationSetup & simulationSetup, const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) override;
     EPair<EFloat, EFloat> RunThermalSimulation(const EThermalTransientSimulationSetup & simulationSetup, const EThermalTransientExcitation & excitation) override;
 
     ///Flatten
@@ -4,6 +4,7 @@
 #include "extension/kicad/ECadExtKiCadHandler.h"
 #include "extension/gds/ECadExtGdsHandler.h"
 #include "extension/xfl/ECadExtXflHandler.h"
+#include "EDataMgr.h"
 namespace ecad::ext {
 
 ECAD_INLINE Ptr<IDatabase> CreateDatabaseFromDomDmc(const std::string & name, const std::string & dmc, const std::string & dom, std::string * err)
@@ -14,7 +15,7 @@ ECAD_INLINE Ptr<IDatabase> CreateDatabaseFromDomDmc(const std::string & name, co
 
 ECAD_INLINE Ptr<IDatabase> CreateDatabaseFromKiCad(const std::string & name, const std::string & kicad, std::string * err)
 {
-    kicad::ECadExtKiCadHandler handler(kicad);
+    kicad::ECadExtKiCadHandler handler(kicad, EDataMgr::Instance().Threads());
     return handler.CreateDatabase(name, err); 
 }
 
@@ -26,7 +27,7 @@ ECAD_INLINE Ptr<IDatabase> CreateDatabaseFromGds(const std::string & name, const
 
 ECAD_INLINE Ptr<IDatabase> CreateDatabaseFromXfl(const std::string & name, const std::string & xfl, std::string * err)
 {
-    xfl::ECadExtXflHandler handler(xfl);
+    xfl::ECadExtXflHandler handler(xfl, 12, EDataMgr::Instance().Threads());
     return handler.CreateDatabase(name, err);
 }
 
@@ -0,0 +1,30 @@
+#include "EMappedFile.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+namespace ecad::ext {
+
+ECAD_INLINE EMappedFile::EMappedFile(std::string_view filename)
+{
+    m_fd = ::open(std::string(filename).c_str(), O_RDONLY);
+    if (m_fd < 0) return;
+
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0 || st.st_size <= 0) return;
+
+    auto data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED) return;
+    ::madvise(data, st.st_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const unsigned char *>(data);
+    m_size = st.st_size;
+}
+
+ECAD_INLINE EMappedFile::~EMappedFile()
+{
+    if (m_data) ::munmap(const_cast<unsigned char *>(m_data), m_size);
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+}//namespace ecad::ext
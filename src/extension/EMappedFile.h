@@ -0,0 +1,26 @@
+#pragma once
+#include "basic/ECadCommon.h"
+#include <string_view>
+namespace ecad::ext {
+
+///read only memory map of a whole file, isOpen() is false if the file can not be mapped
+class ECAD_API EMappedFile
+{
+public:
+    explicit EMappedFile(std::string_view filename);
+    ~EMappedFile();
+
+    EMappedFile(const EMappedFile &) = delete;
+    EMappedFile & operator= (const EMappedFile &) = delete;
+
+    bool isOpen() const { return m_data != nullptr; }
+    const unsigned char * Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    int m_fd{-1};
+    size_t m_size{0};
+    const unsigned char * m_data{nullptr};
+};
+
+}//namespace ecad::ext
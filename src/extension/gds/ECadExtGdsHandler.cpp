@@ -20,7 +20,7 @@ ECAD_INLINE Ptr<IDatabase> ECadExtGdsHandler::CreateDatabase(const std::string &
 {
     EGdsDB db;
     EGdsReader reader(db);
-    if (not reader(m_gdsFile)) return nullptr;
+    if (not reader(m_gdsFile, EDataMgr::Instance().Threads())) return nullptr;
 
     auto & eMgr = EDataMgr::Instance();
     if (eMgr.OpenDatabase(name)){
@@ -207,11 +207,20 @@ ECAD_INLINE void ECadExtGdsHandler::ImportOneCellRefArray(CPtr<EGdsCellRefArray>
     auto iLayoutViewDef = iCellDef->GetLayoutView();
     if(nullptr == iLayoutViewDef) return;//todo, error report;
 
-    for(size_t i = 0; i < arr->positions.size(); ++i){
-        auto name = arr->refCell + "_inst_" + std::to_string(i);
-        auto transform = makeETransform2D(arr->scale, arr->rotation, arr->positions[i]);
-        eMgr.CreateCellInst(iLayoutView, name, iLayoutViewDef, transform);
-    }
+    //AREF keeps one instance with a column/row record, positions are the origin and the displacements of all columns and all rows
+    if(arr->positions.size() < 3 || 0 == arr->cols || 0 == arr->rows) return;//todo, error report
+    const auto & origin = arr->positions[0];
+    auto name = arr->refCell + "_inst";
+    auto transform = makeETransform2D(arr->scale, arr->rotation, origin);
+    auto cellInst = eMgr.CreateCellInst(iLayoutView, name, iLayoutViewDef, transform);
+    if(nullptr == cellInst) return;
+
+    auto pitch = [&origin](const EPoint2D & p, size_t n) {
+        return EVector2D((p[0] - origin[0]) / static_cast<ECoord>(n), (p[1] - origin[1]) / static_cast<ECoord>(n));
+    };
+    auto colPitch = pitch(arr->positions[1], arr->cols);
+    auto rowPitch = pitch(arr->positions[2], arr->rows);
+    cellInst->SetArray(arr->cols, arr->rows, colPitch, rowPitch);
 }
 
 ECAD_INLINE void ECadExtGdsHandler::Reset()
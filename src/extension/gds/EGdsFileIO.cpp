@@ -1,6 +1,7 @@
 #include "EGdsFileIO.h"
 
 #include "EGdsParser.h"
+#include "generic/thread/ThreadPool.hpp"
 #include <fstream>
 namespace ecad {
 
@@ -16,24 +17,81 @@ ECAD_INLINE EGdsReader::~EGdsReader()
 {
 }
 
-ECAD_INLINE bool EGdsReader::operator() (std::string_view filename)
+ECAD_INLINE bool EGdsReader::operator() (std::string_view filename, size_t threads)
 {
-    // calculate file size 
-    std::ifstream in (filename.data());
-    if (not in.good()) return false;
-    std::streampos begin = in.tellg();
-    in.seekg(0, std::ios::end);
-    std::streampos end = in.tellg();
-    m_fileSize = (end-begin);
-    in.close();
-	// reset temporary data 
-    m_status = EGdsRecords::UNKNOWN;
-    Reset();
-	m_unsupportRecords.assign(EGdsRecords::UNKNOWN, 0); 
-    // read gds 
-    bool res = EGdsParser(*this)(filename);
+    EMappedFile file(filename);
+    if (not file.isOpen()) {
+        // calculate file size
+        std::ifstream in (filename.data(), std::ios::binary);
+        if (not in.good()) return false;
+        std::streampos begin = in.tellg();
+        in.seekg(0, std::ios::end);
+        std::streampos end = in.tellg();
+        m_fileSize = (end-begin);
+        in.close();
+        Begin(EGdsRecords::UNKNOWN);
+        bool res = EGdsParser(*this)(filename);
+        PrintUnsupportedRecords();
+        return res;
+    }
+
+    m_fileSize = file.Size();
+	// reset temporary data
+    Begin(EGdsRecords::UNKNOWN);
+    // read gds
+    bool res{true};
+    const auto data = file.Data();
+    auto structures = threads > 1 ? EGdsParser::ScanStructures(data, m_fileSize) : std::vector<EGdsParser::Span>{};
+    if (structures.size() > 1) {
+        res = EGdsParser(*this)(data, data + structures.front().first);
+        res = res && ReadStructures(data, structures, threads);
+        res = res && EGdsParser(*this)(data + structures.back().second, data + m_fileSize);
+    }
+    else res = EGdsParser(*this)(data, data + m_fileSize);
 	PrintUnsupportedRecords();
-	return res; 
+	return res;
+}
+
+ECAD_INLINE bool EGdsReader::ReadStructures(const unsigned char * data, const std::vector<std::pair<size_t, size_t> > & structures, size_t threads)
+{
+    std::vector<EGdsDB> dbs(structures.size());
+    std::vector<std::vector<size_t> > unsupportRecords(structures.size());
+    std::vector<char> results(structures.size(), true);
+    auto read = [&](size_t i) {
+        EGdsReader reader(dbs[i]);
+        reader.Begin(EGdsRecords::BGNLIB);
+        results[i] = EGdsParser(reader)(data + structures.at(i).first, data + structures.at(i).second);
+        unsupportRecords[i] = std::move(reader.m_unsupportRecords);
+    };
+    {
+        generic::thread::ThreadPool pool(threads);
+        for (size_t i = 0; i < structures.size(); ++i)
+            pool.Submit(std::bind(read, i));
+    }
+
+    //merge in file order, same as decoding the structures one by one
+    for (size_t i = 0; i < structures.size(); ++i) {
+        if (not results[i]) return false;
+        auto & db = dbs[i];
+        m_db.Layers().insert(db.Layers().begin(), db.Layers().end());
+        for (auto & cell : db.Cells()) {
+            m_db.AddCell(cell.name);
+            auto & objects = m_db.Cells().back().objects;
+            if (objects.empty()) objects = std::move(cell.objects);
+            else std::move(cell.objects.begin(), cell.objects.end(), std::back_inserter(objects));
+        }
+        for (size_t r = 0; r < unsupportRecords[i].size(); ++r)
+            m_unsupportRecords[r] += unsupportRecords[i][r];
+    }
+    m_status = EGdsRecords::BGNLIB;
+    return true;
+}
+
+ECAD_INLINE void EGdsReader::Begin(EGdsRecords::EnumType status)
+{
+    m_status = status;
+    Reset();
+	m_unsupportRecords.assign(EGdsRecords::UNKNOWN, 0);
 }
 
 ECAD_INLINE void EGdsReader::Reset()
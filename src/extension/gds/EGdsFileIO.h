@@ -12,7 +12,8 @@ public:
     EGdsReader(EGdsDB & db);
     virtual ~EGdsReader();
 
-    virtual bool operator() (std::string_view filename);
+    ///maps the file, structures are decoded concurrently if threads > 1
+    virtual bool operator() (std::string_view filename, size_t threads = 1);
 
     virtual void ReadBitArray(const EGdsRecords::EnumType & recordType, const EGdsData::EnumType & dataType, const std::vector<int> & data);
     virtual void ReadInteger2(const EGdsRecords::EnumType & recordType, const EGdsData::EnumType & dataType, const std::vector<int> & data);
@@ -25,7 +26,10 @@ public:
     virtual void ReadBeginEnd(const EGdsRecords::EnumType & recordType);
 protected:
     virtual void Reset();
+    virtual void Begin(EGdsRecords::EnumType status);
     virtual void PrintUnsupportedRecords();
+    ///decodes the structures one reader each, then merges them in file order
+    bool ReadStructures(const unsigned char * data, const std::vector<std::pair<size_t, size_t> > & structures, size_t threads);
 
 protected:
     EGdsDB & m_db;
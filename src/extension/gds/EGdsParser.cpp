@@ -3,6 +3,7 @@
 #include "extension/gds/EGdsFileIO.h"
 #include <fstream>
 #include <cstring>
+#include <cmath>
 namespace ecad {
 
 namespace ext {
@@ -18,7 +19,7 @@ ECAD_INLINE EGdsParser::EGdsParser(EGdsReader & reader)
 }
 
 ECAD_INLINE EGdsParser::~EGdsParser()
-{   
+{
     if (m_buffer) {
         delete [] m_buffer;
         m_buffer = nullptr;
@@ -27,7 +28,12 @@ ECAD_INLINE EGdsParser::~EGdsParser()
 
 ECAD_INLINE bool EGdsParser::operator() (std::string_view filename)
 {
-    std::ifstream fp(filename.data());
+    EGdsMappedFile file(filename);
+    if (file.isOpen())
+        return (*this)(file.Data(), file.Data() + file.Size());
+
+    //fall back to the buffered stream if the file can not be mapped
+    std::ifstream fp(filename.data(), std::ios::binary);
     if (not fp.good()) {
         //todo, report error
         return false;
@@ -44,32 +50,9 @@ ECAD_INLINE bool EGdsParser::operator() (std::istream & fp)
 	int noRead;
 	int noBytes;
 	unsigned char * record{nullptr};
-    int indentAmount;
-	int recordType;
-	int dataType;
-	int expectedDataType;
-    EGdsRecords::EnumType enumRecordType;
-    EGdsData::EnumType enumDataType;
-    [[maybe_unused]] EGdsData::EnumType enumExpectedDataType;
-	int intKtr;
-	int dataKtr;
-	int exponentKtr;
-	[[maybe_unused]] int corruptKtr;
-	unsigned int displayInteger;
-#ifdef ECAD_EXT_GDS_DEBUG_MODE
-	unsigned int hexDisplayInteger;
-#endif 
-	char displayChar1;
-	char displayChar2;
-	int bitArray;
-	int realSign;
-	int realExponent;
-	unsigned long long realMantissaInt;
-	double realMantissaFloat;
-	double displayFloat;
 
 	/* start out with no indent */
-    indentAmount = 0;
+    m_indentAmount = 0;
 
     while (1){
         noByteArray = (unsigned char*)Parse(fp, noRead, 2);
@@ -81,172 +64,167 @@ ECAD_INLINE bool EGdsParser::operator() (std::istream & fp)
             break;
         }
         noBytes = noByteArray[0] * 256 + noByteArray[1];
+        if(noBytes == 0) continue;//null padding words after ENDLIB
+        if(noBytes < 4) break;//Error: It's a corrupt file!
 
-        if(noBytes != 0){
-            record = (unsigned char*)Parse(fp, noRead, noBytes - 2);
-
-            if(noRead != noBytes - 2){
-                //Error: Couldn't read all of record!
-                //Error: It should have had %1% bytes, could only read %2% of them!, noBytes, noRead + 2
-                //Error: It's a corrupt file!
-                break;
-            }
+        record = (unsigned char*)Parse(fp, noRead, noBytes - 2);
+        if(noRead != noBytes - 2){
+            //Error: Couldn't read all of record!
+            //Error: It should have had %1% bytes, could only read %2% of them!, noBytes, noRead + 2
+            //Error: It's a corrupt file!
+            break;
         }
+        ParseRecord(record, noRead);
+	}
 
-        recordType = record[0];
-        FindRecordType(recordType, enumRecordType, expectedDataType);
-
-        dataType = record[1];
-        FindDataType(dataType, enumDataType);
+	return true;
+}
 
-        /* if it's a ENDSTR or ENDEL, subtract from indent */
-        if(enumRecordType == EGdsRecords::ENDSTR ||
-            enumRecordType == EGdsRecords::ENDEL){
-            if(indentAmount >= 2)
-                indentAmount -= 2;
+ECAD_INLINE bool EGdsParser::operator() (const unsigned char * begin, const unsigned char * end)
+{
+    m_indentAmount = 0;
+    const unsigned char * p = begin;
+    while (p + 2 <= end) {
+        size_t noBytes = (size_t(p[0]) << 8) | p[1];
+        if (noBytes == 0) {//null padding words after ENDLIB
+            p += 2;
+            continue;
         }
-
-        if(expectedDataType != 0xffff && expectedDataType != dataType){
-            ///Error, todo
+        if (noBytes < 4 || p + noBytes > end) {
+            //Error: It's a corrupt file!
+            break;
         }
+        ParseRecord(p + 2, noBytes - 2);
+        p += noBytes;
+    }
+    return true;
+}
 
-        if (expectedDataType == EGdsData::BIT_ARRAY){
-            std::vector<int> vBitArray;
-            vBitArray.reserve((noRead - 2) >> 1);
-            for(dataKtr = 2; dataKtr < noRead; dataKtr += 2){
-                /* use bit shifting instread of multiplication */
-                bitArray = (record[dataKtr] << 8) + record[dataKtr + 1];
-                vBitArray.push_back(bitArray);
-            }
-            m_reader.ReadBitArray(enumRecordType, enumDataType, vBitArray);
+ECAD_INLINE std::vector<EGdsParser::Span> EGdsParser::ScanStructures(const unsigned char * data, size_t size)
+{
+    std::vector<Span> structures;
+    size_t offset{0}, begin{0};
+    while (offset + 4 <= size) {
+        size_t noBytes = (size_t(data[offset]) << 8) | data[offset + 1];
+        if (noBytes == 0) {
+            offset += 2;
+            continue;
         }
-        else if(expectedDataType == EGdsData::INTEGER_2){
-            std::vector<int> vInteger;
-            vInteger.reserve((noRead - 2) >> 1);
-            for(dataKtr = 2; dataKtr < noRead; dataKtr += 2){
-                displayInteger = record[dataKtr];
-                displayInteger <<= 8;
-                displayInteger += record[dataKtr + 1];
-                if (displayInteger & 0x8000){	/* negative number, 2's comp */
-                    displayInteger &= 0x7fff;
-                    displayInteger ^= 0x7fff;
-                    displayInteger +=  1;
-                    displayInteger *= -1;
-                } 
-                vInteger.push_back(displayInteger);
-            }
-            m_reader.ReadInteger2(enumRecordType, enumDataType, vInteger);
+        if (noBytes < 4 || offset + noBytes > size) break;
+        auto recordType = data[offset + 2];
+        if (recordType == EGdsRecords::BGNSTR) begin = offset;
+        else if (recordType == EGdsRecords::ENDSTR) structures.emplace_back(begin, offset + noBytes);
+        offset += noBytes;
+    }
+    return structures;
+}
+
+ECAD_INLINE void EGdsParser::ParseRecord(const unsigned char * record, int noRead)
+{
+    int dataKtr;
+	int expectedDataType;
+    EGdsRecords::EnumType enumRecordType;
+    EGdsData::EnumType enumDataType;
+
+    FindRecordType(record[0], enumRecordType, expectedDataType);
+    FindDataType(record[1], enumDataType);
+
+    /* if it's a ENDSTR or ENDEL, subtract from indent */
+    if(enumRecordType == EGdsRecords::ENDSTR ||
+        enumRecordType == EGdsRecords::ENDEL){
+        if(m_indentAmount >= 2)
+            m_indentAmount -= 2;
+    }
+
+    if(expectedDataType != 0xffff && expectedDataType != record[1]){
+        ///Error, todo
+    }
+
+    //GDSII real: sign bit, 7 bits excess-64 exponent of 16, then a 24 or 56 bits mantissa
+    auto real = [record](int dataKtr, int bytes) {
+        unsigned long long realMantissaInt = 0;
+        for (int exponentKtr = 1; exponentKtr < bytes; exponentKtr++){
+            realMantissaInt <<= 8;
+            realMantissaInt += record[dataKtr + exponentKtr];
         }
-		else if (expectedDataType == EGdsData::INTEGER_4){
-            std::vector<int> vInteger;
-            vInteger.reserve((noRead - 2) >> 1);
-            for(dataKtr = 2; dataKtr < noRead; dataKtr += 4){
-                displayInteger = 0;
-                for(intKtr = 0; intKtr < 4; intKtr++){
-                    displayInteger <<= 8;
-                    displayInteger += record[dataKtr + intKtr];
-                }
-                if(displayInteger & 0x80000000){	/* negative number, 2's comp */
-                    displayInteger &= 0x7fffffff;
-                    displayInteger ^= 0x7fffffff;
-                    displayInteger +=  1;
-                    displayInteger *= -1;
-                }
-                vInteger.push_back(displayInteger);
-            }
-            m_reader.ReadInteger4(enumRecordType, enumDataType, vInteger);
+        int realExponent = (record[dataKtr] & 0x7f) - 64;
+        double displayFloat = std::ldexp(double(realMantissaInt), 4 * realExponent - 8 * (bytes - 1));
+        return (record[dataKtr] & 0x80) ? -displayFloat : displayFloat;
+    };
+
+    if (expectedDataType == EGdsData::BIT_ARRAY){
+        m_integers.clear();
+        for(dataKtr = 2; dataKtr < noRead; dataKtr += 2){
+            /* use bit shifting instread of multiplication */
+            m_integers.push_back((record[dataKtr] << 8) + record[dataKtr + 1]);
         }
-        else if(expectedDataType == EGdsData::REAL_4){
-            std::vector<double> vFloat;
-            vFloat.reserve((noRead - 2) >> 2);
-            for (dataKtr = 2; dataKtr < noRead; dataKtr += 4){
-                realSign = record[dataKtr] & 0x80;
-                realExponent = (record[dataKtr] & 0x7f) - 64;
-                realMantissaInt = 0;
-                for (exponentKtr = 1; exponentKtr < 4; exponentKtr++){
-                    realMantissaInt <<= 8;
-                    realMantissaInt += record[dataKtr + exponentKtr];
-                }
-                realMantissaFloat = (double)realMantissaInt / std::pow(2, 24);
-                displayFloat = realMantissaFloat * std::pow(16, (float)realExponent);
-                if (realSign) displayFloat *= -1;
-                vFloat.push_back(displayFloat);
-            }
-            m_reader.ReadReal4(enumRecordType, enumDataType, vFloat);
+        m_reader.ReadBitArray(enumRecordType, enumDataType, m_integers);
+    }
+    else if(expectedDataType == EGdsData::INTEGER_2){
+        m_integers.clear();
+        for(dataKtr = 2; dataKtr < noRead; dataKtr += 2){
+            /* 2's comp */
+            m_integers.push_back(static_cast<int16_t>((record[dataKtr] << 8) | record[dataKtr + 1]));
         }
-        else if (expectedDataType == EGdsData::REAL_8){
-            std::vector<double> vFloat;
-            vFloat.reserve((noRead - 2) >> 3);
-            for (dataKtr = 2; dataKtr < noRead; dataKtr += 8){
-                realSign = record[dataKtr] & 0x80;
-                realExponent = (record[dataKtr] & 0x7f) - 64;
-                realMantissaInt = 0;
-                for (exponentKtr = 1; exponentKtr < 8; exponentKtr++){
-                    realMantissaInt <<= 8;
-                    realMantissaInt += record[dataKtr + exponentKtr];
-                }
-                realMantissaFloat = (double)realMantissaInt / std::pow(2, 56);
-                displayFloat = realMantissaFloat * std::pow(16, (float)realExponent);
-                if (realSign) displayFloat *= -1;
-                vFloat.push_back(displayFloat);
-            }
-            m_reader.ReadReal8(enumRecordType, enumDataType, vFloat);
+        m_reader.ReadInteger2(enumRecordType, enumDataType, m_integers);
+    }
+    else if (expectedDataType == EGdsData::INTEGER_4){
+        m_integers.clear();
+        for(dataKtr = 2; dataKtr < noRead; dataKtr += 4){
+            uint32_t displayInteger = (uint32_t(record[dataKtr]) << 24) | (uint32_t(record[dataKtr + 1]) << 16) |
+                                      (uint32_t(record[dataKtr + 2]) << 8) | uint32_t(record[dataKtr + 3]);
+            m_integers.push_back(static_cast<int32_t>(displayInteger));
         }
-        else if (expectedDataType == EGdsData::STRING){
-            std::string str;
-            str.reserve((noRead - 2) >> 1); 
-            for (dataKtr = 2; dataKtr < noRead; dataKtr += 2)
-            {
-                displayChar1 = record[dataKtr];
-                displayChar2 = record[dataKtr + 1];
-
-                if (displayChar1 == '\0') break; /* quit early if encounter null character */
-                else if (!std::isprint (displayChar1)){
-                    displayChar1 = '.';
-                }
-                str.push_back(displayChar1);
-
-                if (displayChar2 == '\0') break; /* quit early if encounter null character */
-                else if (!std::isprint (displayChar2)){
-                    displayChar2 = '.';
-                }
-                str.push_back(displayChar2);
+        m_reader.ReadInteger4(enumRecordType, enumDataType, m_integers);
+    }
+    else if(expectedDataType == EGdsData::REAL_4){
+        m_floats.clear();
+        for (dataKtr = 2; dataKtr < noRead; dataKtr += 4)
+            m_floats.push_back(real(dataKtr, 4));
+        m_reader.ReadReal4(enumRecordType, enumDataType, m_floats);
+    }
+    else if (expectedDataType == EGdsData::REAL_8){
+        m_floats.clear();
+        for (dataKtr = 2; dataKtr < noRead; dataKtr += 8)
+            m_floats.push_back(real(dataKtr, 8));
+        m_reader.ReadReal8(enumRecordType, enumDataType, m_floats);
+    }
+    else if (expectedDataType == EGdsData::STRING){
+        m_string.clear();
+        for (dataKtr = 2; dataKtr < noRead; ++dataKtr){
+            char displayChar = record[dataKtr];
+            if (displayChar == '\0') break; /* quit early if encounter null character */
+            else if (!std::isprint(static_cast<unsigned char>(displayChar))){
+                displayChar = '.';
             }
-            m_reader.ReadString(enumRecordType, enumDataType, str);
+            m_string.push_back(displayChar);
         }
-        else
-        {
-            if (expectedDataType != EGdsData::NO_DATA){
+        m_reader.ReadString(enumRecordType, enumDataType, m_string);
+    }
+    else
+    {
+        if (expectedDataType != EGdsData::NO_DATA){
 #ifdef ECAD_EXT_GDS_DEBUG_MODE
-                for (dataKtr = 2; dataKtr < noRead; dataKtr++){
-                    //"Error: 0x%02x # RAW(UNKNOWN)\n", record[dataKtr]);
-                }
-#endif 
+            for (dataKtr = 2; dataKtr < noRead; dataKtr++){
+                //"Error: 0x%02x # RAW(UNKNOWN)\n", record[dataKtr]);
             }
-            else m_reader.ReadBeginEnd(enumRecordType); 
+#endif
         }
+        else m_reader.ReadBeginEnd(enumRecordType);
+    }
 
-        /* if it's a BGNSTR or the beginning of an element, add to indent */
-        if( enumRecordType == EGdsRecords::BGNSTR ||
-            enumRecordType == EGdsRecords::BOUNDARY ||
-            enumRecordType == EGdsRecords::PATH ||
-            enumRecordType == EGdsRecords::SREF ||
-            enumRecordType == EGdsRecords::AREF ||
-            enumRecordType == EGdsRecords::TEXT ||
-            enumRecordType == EGdsRecords::TEXTNODE ||
-            enumRecordType == EGdsRecords::NODE ||
-            enumRecordType == EGdsRecords::BOX ){
-            indentAmount += ECAD_EXT_GDS_NO_SPACES_TO_INDENT;
-        }
-		else
-		{
-#ifdef ECAD_EXT_GDS_DEBUG_MODE
-			/* if it was a NULL record */
-#endif 
-		}
-	}
-
-	return true;
+    /* if it's a BGNSTR or the beginning of an element, add to indent */
+    if( enumRecordType == EGdsRecords::BGNSTR ||
+        enumRecordType == EGdsRecords::BOUNDARY ||
+        enumRecordType == EGdsRecords::PATH ||
+        enumRecordType == EGdsRecords::SREF ||
+        enumRecordType == EGdsRecords::AREF ||
+        enumRecordType == EGdsRecords::TEXT ||
+        enumRecordType == EGdsRecords::TEXTNODE ||
+        enumRecordType == EGdsRecords::NODE ||
+        enumRecordType == EGdsRecords::BOX ){
+        m_indentAmount += ECAD_EXT_GDS_NO_SPACES_TO_INDENT;
+    }
 }
 
 ECAD_INLINE const char * EGdsParser::Parse(std::istream & fp, int & noRead, size_t n)
@@ -302,6 +280,6 @@ ECAD_INLINE void EGdsParser::FindDataType(int numeric, EGdsData::EnumType & data
     dataType = GdsDataType(numeric);
 }
 
-}//namespace gds   
+}//namespace gds
 }//namespace ext
 }//namespace ecad
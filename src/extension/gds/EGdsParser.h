@@ -1,6 +1,7 @@
 #pragma once
 #include "EGdsObjects.h"
 #include "EGdsRecords.h"
+#include "extension/EMappedFile.h"
 #include <istream>
 
 #define ECAD_EXT_GDS_NO_SPACES_TO_INDENT 2
@@ -12,14 +13,22 @@ class EGdsReader;
 class ECAD_API EGdsParser
 {
 public:
+    using Span = std::pair<size_t, size_t>;
     EGdsParser(EGdsReader & reader);
     virtual ~EGdsParser();
 
     bool operator() (std::string_view filename);
     bool operator() (std::istream & fp);
+    ///decodes the records in [begin, end) in place, e.g. a range of a mapped file
+    bool operator() (const unsigned char * begin, const unsigned char * end);
+
+    ///offsets of every structure, from its BGNSTR record to the end of its ENDSTR record, only the record headers are visited
+    static std::vector<Span> ScanStructures(const unsigned char * data, size_t size);
 
 protected:
     CPtr<char> Parse(std::istream & fp, int & noRead, size_t n);
+    ///record points to the record type, noRead is the record size without the two length bytes
+    void ParseRecord(const unsigned char * record, int noRead);
     void FindRecordType(int numeric, EGdsRecords::EnumType & recordType, int & expectedDataType);
     void FindDataType(int numeric, EGdsData::EnumType & dataType);
 
@@ -29,8 +38,13 @@ protected:
     Ptr<char> m_bptr{nullptr};
     size_t m_bcap;//buffer capacity
     size_t m_blen;//current buffer size, from m_bptr to m_buffer + m_bcap
+    int m_indentAmount{0};
+    //decoded data, reused by all records
+    std::vector<int> m_integers;
+    std::vector<double> m_floats;
+    std::string m_string;
 };
 
-}//namespace gds   
+}//namespace gds
 }//namespace ext
 }//namespace ecad
\ No newline at end of file
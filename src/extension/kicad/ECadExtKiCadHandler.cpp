@@ -1,29 +1,15 @@
 #include "ECadExtKiCadHandler.h"
 #include "EDataMgr.h"
 
+#include "generic/thread/ThreadPool.hpp"
+
 namespace ecad::ext::kicad {
 
 using namespace generic;
 
-ECAD_INLINE ECadExtKiCadHandler::ECadExtKiCadHandler(const std::string & kicadFile)
- : m_filename(kicadFile)
+ECAD_INLINE ECadExtKiCadHandler::ECadExtKiCadHandler(const std::string & kicadFile, size_t threads)
+ : m_filename(kicadFile), m_threads(std::max<size_t>(1, threads))
 {
-    m_functions.emplace("layers"   , std::bind(&ECadExtKiCadHandler::ExtractLayer    , this, std::placeholders::_1));
-    m_functions.emplace("setup"    , std::bind(&ECadExtKiCadHandler::ExtractSetup    , this, std::placeholders::_1));
-    m_functions.emplace("stackup"  , std::bind(&ECadExtKiCadHandler::ExtractStackup  , this, std::placeholders::_1));
-    m_functions.emplace("net"      , std::bind(&ECadExtKiCadHandler::ExtractNet      , this, std::placeholders::_1));
-    m_functions.emplace("footprint", std::bind(&ECadExtKiCadHandler::ExtractFootprint, this, std::placeholders::_1));
-    m_functions.emplace("segment"  , std::bind(&ECadExtKiCadHandler::ExtractSegment  , this, std::placeholders::_1));
-    m_functions.emplace("zone"     , std::bind(&ECadExtKiCadHandler::ExtractZone     , this, std::placeholders::_1));
-    m_functions.emplace("via"      , std::bind(&ECadExtKiCadHandler::ExtractVia      , this, std::placeholders::_1));
-    m_functions.emplace("pad"      , std::bind(&ECadExtKiCadHandler::ExtractPad      , this, std::placeholders::_1));
-    m_functions.emplace("fp_arc"   , std::bind(&ECadExtKiCadHandler::ExtractArc      , this, std::placeholders::_1));
-    m_functions.emplace("gr_arc"   , std::bind(&ECadExtKiCadHandler::ExtractArc      , this, std::placeholders::_1));
-    m_functions.emplace("fp_line"  , std::bind(&ECadExtKiCadHandler::ExtractLine     , this, std::placeholders::_1));
-    m_functions.emplace("gr_line"  , std::bind(&ECadExtKiCadHandler::ExtractLine     , this, std::placeholders::_1));
-    m_functions.emplace("fp_poly"  , std::bind(&ECadExtKiCadHandler::ExtractPoly     , this, std::placeholders::_1));
-    m_functions.emplace("fp_circle", std::bind(&ECadExtKiCadHandler::ExtractCircle   , this, std::placeholders::_1));
-    m_functions.emplace("gr_circle", std::bind(&ECadExtKiCadHandler::ExtractCircle   , this, std::placeholders::_1));
 }
 
 ECAD_INLINE Ptr<IDatabase> ECadExtKiCadHandler::CreateDatabase(const std::string & name, Ptr<std::string> err)
@@ -40,33 +26,140 @@ ECAD_INLINE Ptr<IDatabase> ECadExtKiCadHandler::CreateDatabase(const std::string
 
 ECAD_INLINE bool ECadExtKiCadHandler::ExtractKiCadObjects(Ptr<std::string> err)
 {
-    Tree tree;
+    //top level items are handed over as soon as they are parsed, geometry items are extracted by batches,
+    //concurrently if threads > 1, and merged in file order afterwards
+    constexpr size_t batchSize = 256;
+    m_kicad.reset(new Database);
+    m_noNamePadId = 0;
+
+    bool res{true};
     EKiCadParser parser;
-    if (not parser(m_filename.data(), tree)) {
+    std::vector<UPtr<Batch> > batches(1);
+    batches.back().reset(new Batch);
+    {
+        UPtr<thread::ThreadPool> pool;
+        if (m_threads > 1) pool.reset(new thread::ThreadPool(m_threads));
+        auto submit = [&] {
+            auto batch = batches.back().get();
+            if (pool) pool->Submit(std::bind(&ECadExtKiCadHandler::ExtractBatch, this, std::ref(*batch)));
+            else ExtractBatch(*batch);
+            batches.emplace_back(new Batch);
+        };
+        res = parser(m_filename, [&](Tree && node) {
+            if (not isGeometry(node.keyword)) {
+                //layers are read by the geometry items in flight, wait for them and restart the pool afterwards
+                if (pool && (Keyword::Layers == node.keyword || Keyword::Setup == node.keyword)) {
+                    pool.reset();
+                    ExtractNode(node, *m_kicad);
+                    pool.reset(new thread::ThreadPool(m_threads));
+                    return;
+                }
+                return ExtractNode(node, *m_kicad);
+            }
+            batches.back()->items.emplace_back(std::move(node));
+            if (batchSize == batches.back()->items.size()) submit();
+        });
+        if (res && not batches.back()->items.empty()) submit();
+    }
+    if (not res) {
         if(err) *err = fmt::Fmt2Str("Error: failed to parse %1%.", m_filename);
         return false; 
     }
-    
-    m_kicad.reset(new Database);
-    m_current.comp = m_kicad.get();
-    for (auto & node : tree.branches)
-        ExtractNode(node);
+
+    for (auto & batch : batches)
+        MergeBatch(*batch);
     return true;
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractNode(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractBatch(Batch & batch)
+{
+    batch.parts.resize(batch.items.size());
+    for (size_t i = 0; i < batch.items.size(); ++i)
+        ExtractNode(batch.items.at(i), batch.parts.at(i));
+    batch.items = std::vector<Tree>{};
+}
+
+ECAD_INLINE void ECadExtKiCadHandler::MergeBatch(Batch & batch)
 {
-    auto iter = m_functions.find(node.value);
-    if (iter != m_functions.cend())
-        iter->second(node);
+    auto append = [](auto & to, auto & from) {
+        to.insert(to.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+    };
+    for (auto & part : batch.parts) {
+        //unnamed pads are numbered in file order
+        for (auto & pad : part.pads) {
+            if (pad.name.empty())
+                pad.name = "Unnamed" + std::to_string(m_noNamePadId++);
+        }
+        Component * comp = m_kicad.get();
+        if (not part.name.empty()) {
+            comp = &m_kicad->AddComponent(part.name);
+            comp->flipped = part.flipped;
+            comp->layerId = part.layerId;
+            comp->location = part.location;
+            comp->angle = part.angle;
+        }
+        append(comp->vias, part.vias);
+        append(comp->arcs, part.arcs);
+        append(comp->pads, part.pads);
+        append(comp->lines, part.lines);
+        append(comp->polys, part.polys);
+        append(comp->zones, part.zones);
+        append(comp->circles, part.circles);
+        append(comp->segments, part.segments);
+    }
+    batch = Batch{};
+}
+
+ECAD_INLINE bool ECadExtKiCadHandler::isGeometry(Keyword keyword)
+{
+    switch (keyword) {
+        case Keyword::Footprint :
+        case Keyword::Segment :
+        case Keyword::Zone :
+        case Keyword::Via :
+        case Keyword::Pad :
+        case Keyword::FpArc :
+        case Keyword::GrArc :
+        case Keyword::FpLine :
+        case Keyword::GrLine :
+        case Keyword::FpPoly :
+        case Keyword::FpCircle :
+        case Keyword::GrCircle :
+            return true;
+        default :
+            return false;
+    }
+}
+
+ECAD_INLINE void ECadExtKiCadHandler::ExtractNode(const Tree & node, Component & comp)
+{
+    switch (node.keyword) {
+        case Keyword::Layers : return ExtractLayer(node);
+        case Keyword::Setup : return ExtractSetup(node);
+        case Keyword::Stackup : return ExtractStackup(node);
+        case Keyword::Net : return ExtractNet(node);
+        case Keyword::Footprint : return ExtractFootprint(node, comp);
+        case Keyword::Segment : return ExtractSegment(node, comp);
+        case Keyword::Zone : return ExtractZone(node, comp);
+        case Keyword::Via : return ExtractVia(node, comp);
+        case Keyword::Pad : return ExtractPad(node, comp);
+        case Keyword::FpArc :
+        case Keyword::GrArc : return ExtractArc(node, comp);
+        case Keyword::FpLine :
+        case Keyword::GrLine : return ExtractLine(node, comp);
+        case Keyword::FpPoly : return ExtractPoly(node, comp);
+        case Keyword::FpCircle :
+        case Keyword::GrCircle : return ExtractCircle(node, comp);
+        default : return;
+    }
 }
 
 ECAD_INLINE void ECadExtKiCadHandler::ExtractLayer(const Tree & node)
 {
     for (const auto & sub : node.branches) {   
-        EIndex id = std::stoi(sub.value);         
-        auto name = sub.branches.at(0).value;
-        auto & layer = m_kicad->AddLayer(id, name);
+        EIndex id{invalidIndex};
+        GetValue(sub.value, id);
+        auto & layer = m_kicad->AddLayer(id, std::string(sub.branches.at(0).value));
         layer.SetGroup(sub.branches.at(1).value);
         if (sub.branches.size() > 2)
             layer.attr = sub.branches.at(2).value;
@@ -76,25 +169,25 @@ ECAD_INLINE void ECadExtKiCadHandler::ExtractLayer(const Tree & node)
 ECAD_INLINE void ECadExtKiCadHandler::ExtractSetup(const Tree & node)
 {
     for (const auto & sub : node.branches)
-        ExtractNode(sub);
+        ExtractNode(sub, *m_kicad);
 }
 
 ECAD_INLINE void ECadExtKiCadHandler::ExtractStackup(const Tree & node)
 {
     for (const auto & sub : node.branches) {
-        if ("layer" == sub.value) {
+        if (Keyword::Layer == sub.keyword) {
             auto iter = sub.branches.begin();
             if (auto layer = m_kicad->FindLayer(iter->value); layer) {
                 for (iter = std::next(iter); iter != sub.branches.end(); ++iter) {
-                    if ("type" == iter->value)
+                    if (Keyword::Type == iter->keyword)
                         layer->SetType(iter->branches.front().value);
-                    else if ("thickness" == iter->value)
+                    else if (Keyword::Thickness == iter->keyword)
                         GetValue(iter->branches, layer->thickness);
-                    else if ("material" == iter->value)
+                    else if (Keyword::Material == iter->keyword)
                         GetValue(iter->branches, layer->material);
-                    else if ("epsilon_r" == iter->value)
+                    else if (Keyword::EpsilonR == iter->keyword)
                         GetValue(iter->branches, layer->epsilonR);
-                    else if ("loss_tangent" == iter->value)
+                    else if (Keyword::LossTangent == iter->keyword)
                         GetValue(iter->branches, layer->lossTangent);
                 }
             }
@@ -106,181 +199,177 @@ ECAD_INLINE void ECadExtKiCadHandler::ExtractStackup(const Tree & node)
 ECAD_INLINE void ECadExtKiCadHandler::ExtractNet(const Tree & node)
 {
     EIndex netId{invalidIndex};
-    auto & netName = node.branches.at(1).value;
     GetValue(node.branches, netId);
-    m_kicad->AddNet(netId, netName);
+    m_kicad->AddNet(netId, std::string(node.branches.at(1).value));
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractFootprint(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractFootprint(const Tree & node, Component & comp)
 {
     auto iter = node.branches.begin();
-    auto & comp = m_kicad->AddComponent(iter->value);
-    m_current.comp = &comp;
+    comp.name = iter->value;
     for (iter = std::next(iter); iter != node.branches.end(); ++iter) {
         const auto & branches = iter->branches;
-        if ("layer" == iter->value) {
+        if (Keyword::Layer == iter->keyword) {
             auto layer = m_kicad->FindLayer(branches.front().value);
             comp.layerId = layer ? layer->id : invalidIndex;
             comp.flipped = (0 != comp.layerId);
         }
-        else if ("at" == iter->value)
+        else if (Keyword::At == iter->keyword)
             TryGetValue(branches, comp.location[0], comp.location[1], comp.angle);
-        else if ("pad" == iter->value)
-            ExtractPad(*iter);
-        else
-            ExtractNode(*iter);         
+        else if (Keyword::Pad == iter->keyword)
+            ExtractPad(*iter, comp);
+        else if (isGeometry(iter->keyword))
+            ExtractNode(*iter, comp);         
     }
-    m_current.comp = m_kicad.get();
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractSegment(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractSegment(const Tree & node, Component & comp)
 {
     Segment segment;
     for (const auto & sub : node.branches) {
-        if ("start" == sub.value)
+        if (Keyword::Start == sub.keyword)
             GetValue(sub.branches, segment.start[0], segment.start[1]);
-        else if ("end" == sub.value)
+        else if (Keyword::End == sub.keyword)
             GetValue(sub.branches, segment.end[0], segment.end[1]);
-        else if ("width" == sub.value)
+        else if (Keyword::Width == sub.keyword)
             GetValue(sub.branches, segment.width);
-        else if ("net" == sub.value)
+        else if (Keyword::Net == sub.keyword)
             GetValue(sub.branches, segment.netId);
-        else if ("layer" == sub.value) {
+        else if (Keyword::Layer == sub.keyword) {
             if (auto layer = m_kicad->FindLayer(sub.branches.front().value); layer)
                 segment.layerId = layer->id;
         }
     }
-    m_current.comp->segments.emplace_back(std::move(segment));
+    comp.segments.emplace_back(std::move(segment));
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractZone(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractZone(const Tree & node, Component & comp)
 {
     Zone zone;
     for (const auto & sub : node.branches) {
-        if ("net" == sub.value)
+        if (Keyword::Net == sub.keyword)
             GetValue(sub.branches, zone.netId);
-        else if ("layer" == sub.value) {
+        else if (Keyword::Layer == sub.keyword) {
             if (auto layer = m_kicad->FindLayer(sub.branches.front().value); layer)
                 zone.layerId = layer->id;
         }
-        else if ("polygon" == sub.value) {
+        else if (Keyword::Polygon == sub.keyword) {
             for (const auto & polygon : sub.branches) {
-                if ("pts" == polygon.value)
+                if (Keyword::Pts == polygon.keyword)
                     ExtractPoints(polygon, zone.polygon);
             }
         }
-        else if ("filled_polygon" == sub.value) {
+        else if (Keyword::FilledPolygon == sub.keyword) {
            for (const auto & polygon : sub.branches) {
-                if ("pts" == polygon.value)
+                if (Keyword::Pts == polygon.keyword)
                     ExtractPoints(polygon, zone.filledPolygons.emplace_back(Points{}));
             }
         }
     }
-    m_current.comp->zones.emplace_back(std::move(zone));
+    comp.zones.emplace_back(std::move(zone));
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractVia(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractVia(const Tree & node, Component & comp)
 {
     Via via;
     via.type = Via::Type::THROUGH;
     for (const auto & sub : node.branches) {
-        if ("at" == sub.value)
+        if (Keyword::At == sub.keyword)
             GetValue(sub.branches, via.pos[0], via.pos[1]);
-        else if ("size" == sub.value)
+        else if (Keyword::Size == sub.keyword)
             GetValue(sub.branches, via.size);
-        else if ("net" == sub.value)
+        else if (Keyword::Net == sub.keyword)
             GetValue(sub.branches, via.netId);
-        else if ("layers" == sub.value) {
+        else if (Keyword::Layers == sub.keyword) {
             for (size_t i = 0; i < via.layers.size(); ++i) {
                 if (auto layer = m_kicad->FindLayer(sub.branches.at(i).value); layer)
                     via.layers[i] = layer->id;
             }
         }
-        else if ("micro" == sub.value)
+        else if (Keyword::Micro == sub.keyword)
             via.type = Via::Type::MICRO;
-        else if ("bline" == sub.value)
+        else if (Keyword::Blind == sub.keyword)
             via.type = Via::Type::BLIND_BURIED;
     }
-    m_current.comp->vias.emplace_back(std::move(via));
+    comp.vias.emplace_back(std::move(via));
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractCircle(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractCircle(const Tree & node, Component & comp)
 {
     Circle circle;
     for (const auto & sub : node.branches) {
-        if ("center" == sub.value)
+        if (Keyword::Center == sub.keyword)
             GetValue(sub.branches, circle.center[0], circle.center[1]);
-        else if ("end" == sub.value)
+        else if (Keyword::End == sub.keyword)
             GetValue(sub.branches, circle.end[0], circle.end[1]);
-        else if ("stroke" == sub.value)
+        else if (Keyword::Stroke == sub.keyword)
             ExtractStroke(sub, circle);
     }
-    m_current.comp->circles.emplace_back(std::move(circle));
+    comp.circles.emplace_back(std::move(circle));
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractPoly(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractPoly(const Tree & node, Component & comp)
 {
     Poly poly;
     for (const auto & sub : node.branches) {
-        if ("pts" == sub.value)
+        if (Keyword::Pts == sub.keyword)
             ExtractPoints(sub, poly.shape);
-        else if ("stroke" == sub.value)
+        else if (Keyword::Stroke == sub.keyword)
             ExtractStroke(sub, poly);
     }
-    m_current.comp->polys.emplace_back(std::move(poly));
+    comp.polys.emplace_back(std::move(poly));
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractArc(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractArc(const Tree & node, Component & comp)
 {
     Arc arc;
     GetValue(node.branches.at(0).branches, arc.start[0], arc.start[1]);
     GetValue(node.branches.at(1).branches, arc.end[0], arc.end[1]);
     GetValue(node.branches.at(2).branches, arc.angle);
     GetValue(node.branches.at(4).branches, arc.width);
-    m_current.comp->arcs.emplace_back(std::move(arc));
+    comp.arcs.emplace_back(std::move(arc));
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractLine(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractLine(const Tree & node, Component & comp)
 {
     Line line;
     for (const auto & sub : node.branches) {
-        if ("start" == sub.value)
+        if (Keyword::Start == sub.keyword)
             GetValue(sub.branches, line.start[0], line.start[1]);
-        else if ("end" == sub.value)
+        else if (Keyword::End == sub.keyword)
             GetValue(sub.branches, line.end[0], line.end[1]);
-        else if ("stroke" == sub.value)
+        else if (Keyword::Stroke == sub.keyword)
             ExtractStroke(sub, line);
     }
-    m_current.comp->lines.emplace_back(std::move(line));
+    comp.lines.emplace_back(std::move(line));
 }
 
-ECAD_INLINE void ECadExtKiCadHandler::ExtractPad(const Tree & node)
+ECAD_INLINE void ECadExtKiCadHandler::ExtractPad(const Tree & node, Component & comp)
 {
+    //unnamed pads keep an empty name until they are merged
     Pad pad;
     auto iter = node.branches.begin();
     pad.name = iter->value; iter++;
-    if (pad.name.empty())
-        pad.name = "Unnamed" + std::to_string(m_current.noNamePadId++);
     pad.SetType(iter->value); iter++;
     pad.SetShape(iter->value); iter++;
     for (; iter != node.branches.end(); ++iter) {
-        if ("at" == iter->value)
+        if (Keyword::At == iter->keyword)
             TryGetValue(iter->branches, pad.pos[0], pad.pos[1], pad.angle);
-        else if ("size" == iter->value)
+        else if (Keyword::Size == iter->keyword)
             GetValue(iter->branches, pad.size[0], pad.size[1]);
-        else if ("layers" == iter->value) {
+        else if (Keyword::Layers == iter->keyword) {
             for (const auto & lyrNode : iter->branches) {
                 if (auto layer = m_kicad->FindLayer(lyrNode.value); layer)
                     pad.layers.emplace_back(layer->id);
             }
         }
-        else if ("roundrect_rratio" == iter->value)
+        else if (Keyword::RoundrectRratio == iter->keyword)
             GetValue(iter->branches, pad.roundrectRatio);
-        else if ("net" == iter->value)
+        else if (Keyword::Net == iter->keyword)
             GetValue(iter->branches, pad.netId);
-        else if ("primitives" == iter->value) {
+        else if (Keyword::Primitives == iter->keyword) {
             for (const auto & primNode : iter->branches) {
-                if ("gr_poly" == primNode.value) {
+                if (Keyword::GrPoly == primNode.keyword) {
                     ExtractPoints(primNode.branches.front(), pad.shapePolygon);
                 }
             }
@@ -300,7 +389,7 @@ ECAD_INLINE void ECadExtKiCadHandler::ExtractPad(const Tree & node)
         pad.shapePolygon.emplace_back(x2, y2);
         pad.shapePolygon.emplace_back(x1, y2);
     }
-    m_current.comp->pads.emplace_back(std::move(pad));
+    comp.pads.emplace_back(std::move(pad));
 }
 
 ECAD_INLINE void ECadExtKiCadHandler::ExtractPoints(const Tree & node, std::vector<FPoint2D> & points)
@@ -319,13 +408,13 @@ ECAD_INLINE void ECadExtKiCadHandler::ExtractPoints(const Tree & node, std::vect
 ECAD_INLINE void ECadExtKiCadHandler::ExtractStroke(const Tree & node, Stroke & stroke)
 {
     for (const auto & sub : node.branches) {
-        if ("width" == sub.value)
+        if (Keyword::Width == sub.keyword)
             GetValue(sub.branches, stroke.width);
-        else if ("type" == sub.value)
+        else if (Keyword::Type == sub.keyword)
             stroke.SetType(sub.branches.front().value);
-        else if ("fill" == sub.value)
+        else if (Keyword::Fill == sub.keyword)
             stroke.SetFill(sub.branches.front().value);
-        else if ("layer" == sub.value) {
+        else if (Keyword::Layer == sub.keyword) {
             if (auto layer = m_kicad->FindLayer(sub.branches.front().value); layer)
                 stroke.layer = layer->id;
         }
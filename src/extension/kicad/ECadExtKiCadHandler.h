@@ -2,6 +2,7 @@
 #include "basic/ECadCommon.h"
 #include "EKiCadObjects.h"
 #include "EKiCadParser.h"
+#include <charconv>
 namespace ecad {
 
 class INet;
@@ -16,27 +17,38 @@ namespace kicad {
 class ECAD_API ECadExtKiCadHandler
 {
 public:
-    explicit ECadExtKiCadHandler(const std::string & kicadFile);
+    explicit ECadExtKiCadHandler(const std::string & kicadFile, size_t threads = 1);
     Ptr<IDatabase> CreateDatabase(const std::string & name, Ptr<std::string> err = nullptr);
+    ///parsed kicad objects of the last CreateDatabase()
+    CPtr<Database> GetKiCadDatabase() const { return m_kicad.get(); }
 
 private:
+    ///top level items parsed but not extracted yet, each item is extracted into its own part
+    struct Batch
+    {
+        std::vector<Tree> items;
+        std::vector<Component> parts;
+    };
+
     bool ExtractKiCadObjects(Ptr<std::string> err = nullptr);
+    void ExtractBatch(Batch & batch);
+    void MergeBatch(Batch & batch);
 
-    void ExtractNode(const Tree & node);
+    void ExtractNode(const Tree & node, Component & comp);
     void ExtractLayer(const Tree & node);
     void ExtractSetup(const Tree & node);
     void ExtractStackup(const Tree & node);
     void ExtractNet(const Tree & node);
-    void ExtractFootprint(const Tree & node);
-    void ExtractSegment(const Tree & node);
-    void ExtractZone(const Tree & node);
-    void ExtractVia(const Tree & node);
+    void ExtractFootprint(const Tree & node, Component & comp);
+    void ExtractSegment(const Tree & node, Component & comp);
+    void ExtractZone(const Tree & node, Component & comp);
+    void ExtractVia(const Tree & node, Component & comp);
 
-    void ExtractCircle(const Tree & node);
-    void ExtractArc(const Tree & node);
-    void ExtractPoly(const Tree & node);
-    void ExtractLine(const Tree & node);
-    void ExtractPad(const Tree & node);
+    void ExtractCircle(const Tree & node, Component & comp);
+    void ExtractArc(const Tree & node, Component & comp);
+    void ExtractPoly(const Tree & node, Component & comp);
+    void ExtractLine(const Tree & node, Component & comp);
+    void ExtractPad(const Tree & node, Component & comp);
 
     void ExtractPoints(const Tree & node, Points & points);
     void ExtractStroke(const Tree & node, Stroke & stroke);
@@ -45,13 +57,15 @@ private:
     void CreateEcadLayers(Ptr<ILayoutView> layout);
     void CreateEcadNets(Ptr<ILayoutView> layout);
     void CreateLayoutBoundary(Ptr<ILayoutView> layout);
-    
-    template <typename... Args>
-    static void GetValue(const std::string & s, Args & ...args)
+
+    ///geometry items only read the layers, so they can be extracted concurrently
+    static bool isGeometry(Keyword keyword);
+
+    template <typename Arg>
+    static void GetValue(std::string_view s, Arg & arg)
     {
-        static std::stringstream ss;
-        ss.str(s); ss.clear();
-        (ss >> ... >> args);
+        if constexpr (std::is_same_v<Arg, std::string>) arg = std::string(s);
+        else std::from_chars(s.data(), s.data() + s.size(), arg);
     }
 
     template <typename... Args>
@@ -88,11 +102,9 @@ private:
 
 private:
     std::string m_filename;
+    size_t m_threads{1};
     UPtr<Database> m_kicad{nullptr};
     Ptr<IDatabase> m_database{nullptr};
-
-    //func lut
-    std::unordered_map<std::string, std::function<void(const Tree &)>> m_functions;
     
     // kicad-ecad lut
     struct Lut
@@ -101,15 +113,7 @@ private:
         std::unordered_map<EIndex, CPtr<INet>> net;
     };
     Lut m_lut;
-    
-    //current state
-    struct State
-    {
-        EIndex noNamePadId{0};
-        Component * comp = nullptr;
-        void Reset() { *this = State{}; }
-    };
-    State m_current;
+    EIndex m_noNamePadId{0};
 };
 
 }//namespace kicad
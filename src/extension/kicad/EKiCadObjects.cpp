@@ -3,19 +3,19 @@
 namespace ecad::ext::kicad {
 
 
-ECAD_INLINE void Stroke::SetType(const std::string & str)
+ECAD_INLINE void Stroke::SetType(std::string_view str)
 {
     if ("solid" == str)
         type = Type::SOLID;
 }
 
-ECAD_INLINE void Stroke::SetFill(const std::string & str)
+ECAD_INLINE void Stroke::SetFill(std::string_view str)
 {
     if ("solid" == str)
         fill = Fill::SOLID;
 }
 
-ECAD_INLINE void Pad::SetType(const std::string & str)
+ECAD_INLINE void Pad::SetType(std::string_view str)
 {
     if ("smd" == str)
         type = Type::SMD;
@@ -29,7 +29,7 @@ ECAD_INLINE void Pad::SetType(const std::string & str)
         type = Type::UNKNOWN;
 }
 
-ECAD_INLINE void Pad::SetShape(const std::string & str)
+ECAD_INLINE void Pad::SetShape(std::string_view str)
 {
     if ("rect" == str)
         shape = Shape::RECT;
@@ -45,7 +45,7 @@ ECAD_INLINE void Pad::SetShape(const std::string & str)
         shape = Shape::UNKNOWN;
 }
 
-ECAD_INLINE void Layer::SetType(const std::string & str)
+ECAD_INLINE void Layer::SetType(std::string_view str)
 {
     if ("Top Silk Screen" == str or "Bottom Silk Screen" == str)
         type = Type::SILK_SCREEN;
@@ -61,7 +61,7 @@ ECAD_INLINE void Layer::SetType(const std::string & str)
         type = Type::MIXED;
 }
 
-ECAD_INLINE void Layer::SetGroup(const std::string & str)
+ECAD_INLINE void Layer::SetGroup(std::string_view str)
 {
     if ("power" == str)
         group = Group::POWER;
@@ -104,9 +104,9 @@ ECAD_INLINE Ptr<Net> Database::FindNet(const std::string & name)
     return iter->second;
 }
 
-ECAD_INLINE Ptr<Layer> Database::FindLayer(const std::string & name)
+ECAD_INLINE Ptr<Layer> Database::FindLayer(std::string_view name)
 {
-    auto iter = layers.find(name);
+    auto iter = layers.find(std::string(name));
     if (iter == layers.end()) return nullptr;
     return &(iter->second);
 }
@@ -43,8 +43,8 @@ struct Stroke
     EIndex layer{invalidIndex};
     EFloat width{0};
     virtual ~Stroke() = default;
-    virtual void SetType(const std::string & str);
-    virtual void SetFill(const std::string & str);
+    virtual void SetType(std::string_view str);
+    virtual void SetFill(std::string_view str);
 };
 
 struct Arc : public Stroke
@@ -95,8 +95,8 @@ struct Layer
 
     Layer(EIndex id, std::string name) : id(id), name(std::move(name)) {}
 
-    void SetGroup(const std::string & str);
-    void SetType(const std::string & str);
+    void SetGroup(std::string_view str);
+    void SetType(std::string_view str);
 };
 
 struct Via
@@ -133,7 +133,7 @@ struct Pad
     enum class Shape { UNKNOWN, RECT, ROUNDRECT, CIRCLE, OVAL, TRAPEZOID }; 
     Type type{Type::UNKNOWN};
     Shape shape{Shape::UNKNOWN};
-    EIndex netId;
+    EIndex netId{invalidIndex};
     EFloat angle{0};
     EFloat roundrectRatio{0};
     FPoint2D pos;
@@ -141,8 +141,8 @@ struct Pad
     std::string name{};
     Points shapePolygon;
     std::vector<EIndex> layers;
-    void SetType(const std::string & str);
-    void SetShape(const std::string & str);
+    void SetType(std::string_view str);
+    void SetShape(std::string_view str);
 };
 
 struct Net
@@ -196,7 +196,7 @@ struct Database : public Component
     // find
     Ptr<Net> FindNet(EIndex id);
     Ptr<Net> FindNet(const std::string & name);
-    Ptr<Layer> FindLayer(const std::string & name);   
+    Ptr<Layer> FindLayer(std::string_view name);   
 };
 
 } // namespace ecad::ext::kicad
\ No newline at end of file
@@ -1,116 +1,133 @@
 #include "EKiCadParser.h"
 #include "EKiCadObjects.h"
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
 namespace ecad::ext::kicad {
 
-ECAD_INLINE EKiCadParser::EKiCadParser()
+namespace detail {
+ECAD_ALWAYS_INLINE bool isWhitespace(char c)
 {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
-ECAD_INLINE bool EKiCadParser::operator() (std::string_view filename, Tree & tree)
+ECAD_ALWAYS_INLINE bool isDelimiter(char c)
 {
-    std::ifstream in(filename.data());
-    if (not in.good()) {
-        //todo, report error
-        return false;
-    }
+    return isWhitespace(c) || c == '(' || c == ')';
+}
+}//namespace detail
 
-    tree = ReadTree(in);
-    return true;
+ECAD_INLINE EKiCadParser::EKiCadParser()
+{
 }
 
-Tree EKiCadParser::ReadTree(std::istream & in)
+ECAD_INLINE EKiCadParser::~EKiCadParser()
 {
-    char c;
-    ReadUntil(in, '(');
-    ReadWhitespace(in);
-    auto t = Tree{ReadNodeName(in), {}};
-    for(;;) {
-        ReadWhitespace(in);
-        auto b = in.peek();
-        if (b == EOF) break;
-        if (b == ')') {
-            in.get(c);
-            break;
-        }
-        if (b == '(') {
-            t.branches.emplace_back(ReadTree(in));
-            continue;
-        }
-        if (b == '"') {
-            in.get(c);
-            t.branches.emplace_back(ReadQuotedString(in));
-            in.get(c);
-            continue;
+}
+
+ECAD_INLINE bool EKiCadParser::operator() (std::string_view filename, const Callback & callback)
+{
+    m_file.reset(new EMappedFile(filename));
+    if (m_file->isOpen()) {
+        m_pos = reinterpret_cast<const char *>(m_file->Data());
+        m_end = m_pos + m_file->Size();
+    }
+    else {
+        std::ifstream in(filename.data());
+        if (not in.good()) {
+            //todo, report error
+            return false;
         }
-        t.branches.emplace_back(ReadString(in));
+        std::stringstream ss;
+        ss << in.rdbuf();
+        m_buffer = ss.str();
+        m_pos = m_buffer.data();
+        m_end = m_pos + m_buffer.size();
     }
-    return t;
+    return Parse(callback);
 }
 
-Tree EKiCadParser::ReadString(std::istream & in)
+ECAD_INLINE Keyword EKiCadParser::Intern(std::string_view symbol)
 {
-    std::string s;
+    static const std::unordered_map<std::string_view, Keyword> keywords {
+        {"at", Keyword::At}, {"blind", Keyword::Blind}, {"center", Keyword::Center}, {"end", Keyword::End},
+        {"epsilon_r", Keyword::EpsilonR}, {"filled_polygon", Keyword::FilledPolygon}, {"fill", Keyword::Fill}, {"footprint", Keyword::Footprint},
+        {"fp_arc", Keyword::FpArc}, {"fp_circle", Keyword::FpCircle}, {"fp_line", Keyword::FpLine}, {"fp_poly", Keyword::FpPoly},
+        {"gr_arc", Keyword::GrArc}, {"gr_circle", Keyword::GrCircle}, {"gr_line", Keyword::GrLine}, {"gr_poly", Keyword::GrPoly},
+        {"layer", Keyword::Layer}, {"layers", Keyword::Layers}, {"loss_tangent", Keyword::LossTangent}, {"material", Keyword::Material},
+        {"micro", Keyword::Micro}, {"net", Keyword::Net}, {"pad", Keyword::Pad}, {"polygon", Keyword::Polygon}, {"primitives", Keyword::Primitives},
+        {"pts", Keyword::Pts}, {"roundrect_rratio", Keyword::RoundrectRratio}, {"segment", Keyword::Segment}, {"setup", Keyword::Setup},
+        {"size", Keyword::Size}, {"stackup", Keyword::Stackup}, {"start", Keyword::Start}, {"stroke", Keyword::Stroke},
+        {"thickness", Keyword::Thickness}, {"type", Keyword::Type}, {"via", Keyword::Via}, {"width", Keyword::Width}, {"zone", Keyword::Zone}
+    };
+    if (symbol.empty() || symbol.front() < 'a' || symbol.front() > 'z') return Keyword::Unknown;
+    auto iter = keywords.find(symbol);
+    return iter == keywords.cend() ? Keyword::Unknown : iter->second;
+}
+
+ECAD_INLINE bool EKiCadParser::Parse(const Callback & callback)
+{
+    while (m_pos < m_end && *m_pos != '(') ++m_pos;
+    if (m_pos == m_end) return false;
+    ++m_pos;
+    ReadWhitespace();
+    ReadAtom();//root name
+
     for (;;) {
-        auto b = in.peek();
-        if (b == '\t' || b == '\n' || b == '\r' || b == ')' || b == ' ')
-            break;
-        char c;
-        in.get(c);
-        s.push_back(c);
+        ReadWhitespace();
+        if (m_pos == m_end) return false;
+        if (*m_pos == ')') {
+            ++m_pos;
+            return true;
+        }
+        if (*m_pos == '(') callback(ReadTree());
+        else if (*m_pos == '"') ReadQuotedString();
+        else ReadAtom();
     }
-    return Tree{s, {}};    
 }
 
-Tree EKiCadParser::ReadQuotedString(std::istream & in)
+ECAD_INLINE Tree EKiCadParser::ReadTree()
 {
-    char c;
-    std::string s;
-    // s.push_back('"');
-    auto a = in.peek();
+    ++m_pos;//'('
+    ReadWhitespace();
+    auto t = ReadAtom();
     for (;;) {
-        auto b = in.peek();
-        if (b == '"' && a != '\\')
+        ReadWhitespace();
+        if (m_pos == m_end) break;
+        if (*m_pos == ')') {
+            ++m_pos;
             break;
-        in.get(c);
-        s.push_back(c);
-        a = b;
+        }
+        if (*m_pos == '(') t.branches.emplace_back(ReadTree());
+        else if (*m_pos == '"') t.branches.emplace_back(ReadQuotedString());
+        else t.branches.emplace_back(ReadAtom());
     }
-    // s.push_back('"');
-    return Tree{s, {}};
+    return t;
 }
 
-std::string EKiCadParser::ReadNodeName(std::istream & in)
+ECAD_INLINE Tree EKiCadParser::ReadAtom()
 {
-    char c;
-    std::string s;
-    for(;;) {
-        auto b = in.peek();
-        if (b == '\t' || b == '\n' || b == '\r' || b == ' ' || b == ')') break;
-        in.get(c);
-        s.push_back(c);
-    }
-    return s;
+    auto begin = m_pos;
+    while (m_pos < m_end && not detail::isDelimiter(*m_pos)) ++m_pos;
+    std::string_view value(begin, m_pos - begin);
+    return Tree{value, Intern(value), {}};
 }
 
-bool EKiCadParser::ReadUntil(std::istream & in, char c)
+ECAD_INLINE Tree EKiCadParser::ReadQuotedString()
 {
-    char input;
-    while(in.get(input)) {
-        if (input == c)
-            return false;
+    auto begin = ++m_pos;//'"'
+    while (m_pos < m_end && *m_pos != '"') {
+        if (*m_pos == '\\' && m_pos + 1 < m_end) ++m_pos;
+        ++m_pos;
     }
-    return true;
+    std::string_view value(begin, m_pos - begin);
+    if (m_pos < m_end) ++m_pos;//'"'
+    return Tree{value, Keyword::Unknown, {}};
 }
 
-void EKiCadParser::ReadWhitespace(std::istream & in)
+ECAD_INLINE void EKiCadParser::ReadWhitespace()
 {
-    char c;
-    for (;;) {
-        auto b = in.peek();
-        if (b != '\t' && b != '\n' && b != '\r' && b != ' ')
-            break;
-        in.get(c);
-    }
+    while (m_pos < m_end && detail::isWhitespace(*m_pos)) ++m_pos;
 }
 
-} // namespace ecad::ext::kicad
\ No newline at end of file
+} // namespace ecad::ext::kicad
@@ -1,31 +1,52 @@
 #pragma once
 #include "basic/ECadCommon.h"
+#include "extension/EMappedFile.h"
 #include <string_view>
-#include <istream>
+#include <functional>
 
 namespace ecad::ext::kicad {
 
+///interned node names and symbols, the values of quoted strings are never interned
+enum class Keyword : uint8_t
+{
+    Unknown,
+    At, Blind, Center, End, EpsilonR, FilledPolygon, Fill, Footprint, FpArc, FpCircle, FpLine, FpPoly,
+    GrArc, GrCircle, GrLine, GrPoly, Layer, Layers, LossTangent, Material, Micro, Net, Pad, Polygon, Primitives,
+    Pts, RoundrectRratio, Segment, Setup, Size, Stackup, Start, Stroke, Thickness, Type, Via, Width, Zone
+};
+
+///values are views of the parsed buffer, so a tree is only valid as long as the parser that produced it
 struct Tree
 {
-    std::string value;
+    std::string_view value;
+    Keyword keyword{Keyword::Unknown};
     std::vector<Tree> branches;
 };
 
 class ECAD_API EKiCadParser
 {
 public:
+    using Callback = std::function<void(Tree &&)>;
     EKiCadParser();
-    virtual ~EKiCadParser() = default;
+    virtual ~EKiCadParser();
 
-    bool operator() (std::string_view filename, Tree & tree);
+    ///parses the root node and passes each of its children to callback as soon as the child is closed
+    bool operator() (std::string_view filename, const Callback & callback);
+
+    static Keyword Intern(std::string_view symbol);
+
+protected:
+    bool Parse(const Callback & callback);
+    Tree ReadTree();
+    Tree ReadAtom();
+    Tree ReadQuotedString();
+    void ReadWhitespace();
 
 protected:
-    Tree ReadTree(std::istream & in);
-    Tree ReadString(std::istream & in);
-    Tree ReadQuotedString(std::istream & in);
-    std::string ReadNodeName(std::istream & in);
-    bool ReadUntil(std::istream & in, char c);
-    void ReadWhitespace(std::istream & in);
+    UPtr<EMappedFile> m_file;
+    std::string m_buffer;//file content if it can not be mapped
+    const char * m_pos{nullptr};
+    const char * m_end{nullptr};
 };
 
-}//namespace ecad::ext::kicad
\ No newline at end of file
+}//namespace ecad::ext::kicad
@@ -1,6 +1,7 @@
 #include "ECadExtXflHandler.h"
 
 #include "generic/geometry/Utility.hpp"
+#include "generic/thread/ThreadPool.hpp"
 #include "generic/tools/Format.hpp"
 #include "design/EMaterialProp.h"
 #include "basic/ETransform.h"
@@ -12,8 +13,8 @@ namespace xfl {
 
 namespace fmt = generic::fmt;
 
-ECAD_INLINE ECadExtXflHandler::ECadExtXflHandler(const std::string & xflFile, size_t circleDiv)
- : m_xflFile(xflFile), m_circleDiv(circleDiv) {}
+ECAD_INLINE ECadExtXflHandler::ECadExtXflHandler(const std::string & xflFile, size_t circleDiv, size_t threads)
+ : m_xflFile(xflFile), m_circleDiv(circleDiv), m_threads(std::max<size_t>(1, threads)) {}
 
 ECAD_INLINE Ptr<IDatabase> ECadExtXflHandler::CreateDatabase(const std::string & name, std::string * err)
 {
@@ -25,7 +26,7 @@ ECAD_INLINE Ptr<IDatabase> ECadExtXflHandler::CreateDatabase(const std::string &
 
     Reset();
 
-    EXflReader reader(*m_xflDB);
+    EXflReader reader(*m_xflDB, m_threads);
     if (not reader(m_xflFile)) {
         if (err) *err = fmt::Fmt2Str("Error: failed to parse  %1%.", m_xflFile);
         return nullptr;
@@ -224,128 +225,177 @@ ECAD_INLINE void ECadExtXflHandler::ImportNets(Ptr<ILayoutView> layout)
 
 ECAD_INLINE void ECadExtXflHandler::ImportConnObjs(Ptr<ILayoutView> layout)
 {
-    auto & mgr = EDataMgr::Instance();
-    EShapeGetter eShapeGetter(m_scale, m_circleDiv);
+    //the shapes of the routes are made concurrently if threads > 1, then added to the layout in file order
+    const auto & routes = m_xflDB->routes;
+    std::vector<std::vector<ConnObj> > connObjs(routes.size());
+    if (m_threads > 1 && routes.size() > 1) {
+        //contiguous route ranges, a few per thread to balance uneven routes
+        size_t chunk = (routes.size() + m_threads * 4 - 1) / (m_threads * 4);
+        generic::thread::ThreadPool pool(m_threads);
+        for (size_t start = 0; start < routes.size(); start += chunk)
+            pool.Submit(std::bind(&ECadExtXflHandler::ExtractConnObjsInRange, this, start, std::min(start + chunk, routes.size()), std::ref(connObjs)));
+    }
+    else ExtractConnObjsInRange(0, routes.size(), connObjs);
+
+    size_t geometries{0}, psInsts{0};
+    for (const auto & objs : connObjs) {
+        for (const auto & obj : objs) {
+            if (obj.shape) geometries++;
+            else psInsts++;
+        }
+    }
+    auto primitives = layout->GetPrimitiveCollection();
+    primitives->Reserve(primitives->Size() + geometries);
+    auto padstackInsts = layout->GetPadstackInstCollection();
+    padstackInsts->Reserve(padstackInsts->Size() + psInsts);
 
-    for(const auto & route : m_xflDB->routes) {
-        auto net = mgr.FindNetByName(layout, route.net);
+    auto & mgr = EDataMgr::Instance();
+    for (size_t i = 0; i < routes.size(); ++i) {
+        auto net = mgr.FindNetByName(layout, routes.at(i).net);
         if(nullptr == net){
             //todo, error handle
             continue;
         }
-        size_t i = 0;
         auto netId = net->GetNetId();
-        while(i < route.objects.size()) {
-            auto & instObj = route.objects[i++];
-            //inst path
-            if(auto * instPath = boost::get<InstPath>(&instObj)) {
-                auto layer = m_metalLyrIdMap.find(instPath->layer);
-                if(layer == m_metalLyrIdMap.end()) {
-                    //todo, error handle
-                    continue;
-                }
-                auto shape = eShapeGetter(instPath->path);
-                auto polygon = dynamic_cast<Ptr<EPolygon> >(shape.get());
-                if(!polygon || polygon->shape.Size() == 0){
-                    //todo, error handle
-                    continue;
-                }
-                auto ePath = mgr.CreateShapePath(polygon->shape.GetPoints(), instPath->width * m_scale);
-                [[maybe_unused]] auto ePrim = mgr.CreateGeometry2D(layout, layer->second, netId, std::move(ePath));
+        for (auto & connObj : connObjs.at(i)) {
+            if (connObj.shape) {
+                [[maybe_unused]] auto ePrim = mgr.CreateGeometry2D(layout, connObj.layer, netId, std::move(connObj.shape));
                 ECAD_ASSERT(ePrim != nullptr)
+                continue;
             }
-            //inst padstack
-            else if(auto * instVia = boost::get<InstVia>(&instObj)) {
-                auto sLayer = m_metalLyrIdMap.find(instVia->sLayer);
-                auto eLayer = m_metalLyrIdMap.find(instVia->eLayer);
-                if(sLayer == m_metalLyrIdMap.end() ||
-                    eLayer == m_metalLyrIdMap.end()) {
-                        //todo, error handle
-                        continue;
-                }
 
-                auto layerMap = mgr.FindLayerMapByName(m_database, instVia->name);
-                if (nullptr == layerMap) {
-                    //todo, error handle
-                    continue;
-                }
+            auto layerMap = mgr.FindLayerMapByName(m_database, connObj.via->name);
+            if (nullptr == layerMap) {
+                //todo, error handle
+                continue;
+            }
 
-                auto psDef = mgr.FindPadstackDefByName(m_database, instVia->name);
-                if (nullptr == psDef) {
-                    //todo, error handle
-                    continue;
-                }
+            auto psDef = mgr.FindPadstackDefByName(m_database, connObj.via->name);
+            if (nullptr == psDef) {
+                //todo, error handle
+                continue;
+            }
+
+            auto name = GetNextPadstackInstName(connObj.via->name);
+            [[maybe_unused]] auto psInst = mgr.CreatePadstackInst(layout, name, psDef, netId, connObj.layer, connObj.botLayer, layerMap, connObj.transform);
+            ECAD_ASSERT(psInst != nullptr)
+        }
+    }
+}
+
+ECAD_INLINE void ECadExtXflHandler::ExtractConnObjsInRange(size_t begin, size_t end, std::vector<std::vector<ConnObj> > & connObjs) const
+{
+    for (size_t i = begin; i < end; ++i)
+        ExtractConnObjs(m_xflDB->routes.at(i), connObjs.at(i));
+}
 
-                const auto & m = instVia->mirror;
-                EMirror2D mirror = (m == 'Y' || m == '1') ? EMirror2D::Y : EMirror2D::No;
-                auto trans = makeETransform2D(1.0, math::Rad(instVia->rot), makeEPoint2D(instVia->loc), mirror);
-                
-                auto name = GetNextPadstackInstName(instVia->name);
-                [[maybe_unused]] auto psInst = mgr.CreatePadstackInst(layout, name, psDef, netId, sLayer->second, eLayer->second, layerMap, trans);
-                ECAD_ASSERT(psInst != nullptr)
+ECAD_INLINE void ECadExtXflHandler::ExtractConnObjs(const Route & route, std::vector<ConnObj> & connObjs) const
+{
+    auto & mgr = EDataMgr::Instance();
+    EShapeGetter eShapeGetter(m_scale, m_circleDiv);
+    auto addGeometry = [&connObjs](ELayerId layer, UPtr<EShape> shape) {
+        ConnObj connObj;
+        connObj.layer = layer;
+        connObj.shape = std::move(shape);
+        connObjs.emplace_back(std::move(connObj));
+    };
+
+    size_t i = 0;
+    connObjs.reserve(route.objects.size());
+    while(i < route.objects.size()) {
+        auto & instObj = route.objects[i++];
+        //inst path
+        if(auto * instPath = boost::get<InstPath>(&instObj)) {
+            auto layer = m_metalLyrIdMap.find(instPath->layer);
+            if(layer == m_metalLyrIdMap.end()) {
+                //todo, error handle
+                continue;
             }
-            //inst bondwire
-            else if (auto * instBw = boost::get<InstBondwire>(&instObj); instBw) {
-                //todo
+            auto shape = eShapeGetter(instPath->path);
+            auto polygon = dynamic_cast<Ptr<EPolygon> >(shape.get());
+            if(!polygon || polygon->shape.Size() == 0){
+                //todo, error handle
                 continue;
             }
-            //inst annular
-            else if (auto * instAnnular = boost::get<InstAnnular>(&instObj); instAnnular) {
-                auto layer = m_metalLyrIdMap.find(instAnnular->layer);
-                if (layer == m_metalLyrIdMap.end()) {
+            addGeometry(layer->second, mgr.CreateShapePath(polygon->shape.GetPoints(), instPath->width * m_scale));
+        }
+        //inst padstack
+        else if(auto * instVia = boost::get<InstVia>(&instObj)) {
+            auto sLayer = m_metalLyrIdMap.find(instVia->sLayer);
+            auto eLayer = m_metalLyrIdMap.find(instVia->eLayer);
+            if(sLayer == m_metalLyrIdMap.end() ||
+                eLayer == m_metalLyrIdMap.end()) {
                     //todo, error handle
                     continue;
-                }
-                auto shape = eShapeGetter(instAnnular->annular);
-                if (!shape->isValid()) {
+            }
+
+            const auto & m = instVia->mirror;
+            EMirror2D mirror = (m == 'Y' || m == '1') ? EMirror2D::Y : EMirror2D::No;
+            ConnObj connObj;
+            connObj.layer = sLayer->second;
+            connObj.botLayer = eLayer->second;
+            connObj.via = instVia;
+            connObj.transform = makeETransform2D(1.0, math::Rad(instVia->rot), makeEPoint2D(instVia->loc), mirror);
+            connObjs.emplace_back(std::move(connObj));
+        }
+        //inst bondwire
+        else if (auto * instBw = boost::get<InstBondwire>(&instObj); instBw) {
+            //todo
+            continue;
+        }
+        //inst annular
+        else if (auto * instAnnular = boost::get<InstAnnular>(&instObj); instAnnular) {
+            auto layer = m_metalLyrIdMap.find(instAnnular->layer);
+            if (layer == m_metalLyrIdMap.end()) {
+                //todo, error handle
+                continue;
+            }
+            auto shape = eShapeGetter(instAnnular->annular);
+            if (!shape->isValid()) {
+                //todo, error handle
+                continue;
+            }
+            shape->Transform(makeETransform2D(1.0, 0.0, makeEPoint2D(instAnnular->loc)));
+            addGeometry(layer->second, std::move(shape));
+        }
+        //others
+        else {
+            //ignore if first shape is hole
+            if (isHole(instObj)) continue;
+            auto [lyr, shape] = makeEShapeFromInstObject(&mgr, eShapeGetter, instObj);
+            auto layer = m_metalLyrIdMap.find(lyr);
+            if (layer == m_metalLyrIdMap.end()) {
+                //todo, error handle
+                continue;
+            }
+            if (nullptr == shape) continue;
+            std::list<UPtr<EShape> > holes;
+            while(i < route.objects.size()) {
+                const auto & instHole = route.objects[i++];
+                if(!isHole(instHole)) { i--; break; }
+                auto [nextLyr, nextShape] = makeEShapeFromInstObject(&mgr, eShapeGetter, instHole);
+                if(nextLyr != lyr || nullptr == nextShape) { i--; break; }
+                holes.emplace_back(std::move(nextShape));
+            }
+            if (holes.empty()) {
+                if(!shape->isValid()) {
                     //todo, error handle
                     continue;
                 }
-                shape->Transform(makeETransform2D(1.0, 0.0, makeEPoint2D(instAnnular->loc)));
-                [[maybe_unused]] auto ePrim = mgr.CreateGeometry2D(layout, layer->second, netId, std::move(shape));
-                ECAD_ASSERT(ePrim != nullptr)
+                addGeometry(layer->second, std::move(shape));
             }
-            //others
             else {
-                //ignore if first shape is hole
-                if (isHole(instObj)) continue;
-                auto [lyr, shape] = makeEShapeFromInstObject(&mgr, eShapeGetter, instObj);
-                auto layer = m_metalLyrIdMap.find(lyr);
-                if (layer == m_metalLyrIdMap.end()) {
+                auto pwh = std::make_unique<EPolygonWithHoles>();
+                auto & data = pwh->shape;
+                data.outline = shape->GetContour();
+                for(const auto & hole : holes){
+                    data.holes.emplace_back(hole->GetContour());
+                }
+                if(!pwh->isValid()) {
                     //todo, error handle
                     continue;
                 }
-                if (nullptr == shape) continue;
-                std::list<UPtr<EShape> > holes;
-                while(i < route.objects.size()) {
-                    const auto & instHole = route.objects[i++];
-                    if(!isHole(instHole)) { i--; break; }
-                    auto [nextLyr, nextShape] = makeEShapeFromInstObject(&mgr, eShapeGetter, instHole);
-                    if(nextLyr != lyr || nullptr == nextShape) { i--; break; }
-                    holes.emplace_back(std::move(nextShape));
-                }
-                if (holes.empty()) {
-                    if(!shape->isValid()) {
-                        //todo, error handle
-                        continue;
-                    }
-                    [[maybe_unused]] auto ePrim = mgr.CreateGeometry2D(layout, layer->second, netId, std::move(shape));
-                    ECAD_ASSERT(ePrim != nullptr)
-                }
-                else {
-                    auto pwh = std::make_unique<EPolygonWithHoles>();
-                    auto & data = pwh->shape;
-                    data.outline = shape->GetContour();
-                    for(const auto & hole : holes){
-                        data.holes.emplace_back(hole->GetContour());
-                    }
-                    if(!pwh->isValid()) {
-                        //todo, error handle
-                        continue;
-                    }
-                    [[maybe_unused]] auto ePrim = mgr.CreateGeometry2D(layout, layer->second, netId, std::move(pwh));
-                    ECAD_ASSERT(ePrim != nullptr)
-                }
+                addGeometry(layer->second, std::move(pwh));
             }
         }
     }
@@ -1,5 +1,6 @@
 #pragma once
 #include "basic/ECadCommon.h"
+#include "basic/ETransform.h"
 #include "EXflObjects.h"
 namespace ecad {
 
@@ -13,7 +14,7 @@ namespace xfl {
 class ECAD_API ECadExtXflHandler
 {
 public:
-    explicit ECadExtXflHandler(const std::string & xflFile, size_t circleDiv = 12);
+    explicit ECadExtXflHandler(const std::string & xflFile, size_t circleDiv = 12, size_t threads = 1);
     Ptr<IDatabase> CreateDatabase(const std::string & name, std::string * err = nullptr);
 
 private:
@@ -30,8 +31,21 @@ private:
 private:
     std::string m_xflFile;
     size_t m_circleDiv = 12;
+    size_t m_threads = 1;
 
 private:
+    ///route object converted to ecad, a geometry if shape is not nullptr, a padstack instance of via otherwise
+    struct ConnObj
+    {
+        ELayerId layer{ELayerId::noLayer};//top layer of padstack instance
+        ELayerId botLayer{ELayerId::noLayer};
+        UPtr<EShape> shape{nullptr};
+        CPtr<InstVia> via{nullptr};
+        ETransform2D transform;
+    };
+    void ExtractConnObjs(const Route & route, std::vector<ConnObj> & connObjs) const;
+    void ExtractConnObjsInRange(size_t begin, size_t end, std::vector<std::vector<ConnObj> > & connObjs) const;
+
     std::string GetNextPadstackInstName(const std::string & defName);
     std::pair<int, UPtr<EShape> > makeEShapeFromInstObject(EDataMgr * mgr, const EShapeGetter & eShapeGetter, const InstObject & instObj) const;
     bool isHole(const InstObject & instObj) const;
@@ -369,10 +369,10 @@ struct Component
 
 struct EXflDB
 {
-    Unit unit;
-    double scale;
-    Version version;
-    bool hasBoardGeom;
+    Unit unit{Unit::Millimeter};
+    double scale{1.0};
+    Version version{0, 0};
+    bool hasBoardGeom{false};
     BoardGeom boardGeom;
     std::string designType;
     std::vector<Net> nets;
@@ -1,8 +1,10 @@
 #pragma once
 #include "basic/ECadAlias.h"
+#include "extension/EMappedFile.h"
 #include "EXflObjects.h"
 
 #include "generic/tools/StringHelper.hpp"
+#include "generic/thread/ThreadPool.hpp"
 #include "generic/tools/Parser.hpp"
 #include <boost/fusion/include/adapt_struct.hpp>
 #include <boost/spirit/include/phoenix_bind.hpp>
@@ -13,6 +15,7 @@
 #include <boost/phoenix/stl.hpp>
 #include <boost/bind/bind.hpp>
 #include <boost/variant.hpp>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -59,31 +62,227 @@ namespace phx = boost::phoenix;
 namespace spirit = boost::spirit;
 namespace ascii = boost::spirit::ascii;
 
+///parses an xfl file from a memory map, the record sections (materials, layers, shapes, padstacks, vias, parts, nets and routes)
+///are cut at their tags and split into chunks of whole records, the chunks are parsed concurrently if threads > 1 and
+///merged in file order, so the database is the same as a sequential parse of the whole file
 struct EXflReader
 {
+    enum class Section { Others, Material, Layer, Shape, Padstack, Via, Part, Netlist, Route };
+    struct Chunk
+    {
+        Section section{Section::Others};//others is the text between record sections, parsed by the whole grammar
+        const char * begin{nullptr};
+        const char * end{nullptr};
+        bool res{false};
+        EXflDB db;
+    };
+
     EXflDB & db;
-    explicit EXflReader(EXflDB & db) : db(db) { db.Clear(); }
+    size_t threads{1};
+    explicit EXflReader(EXflDB & db, size_t threads = 1) : db(db), threads(std::max<size_t>(1, threads)) { db.Clear(); }
     
     bool operator() (const std::string & xflFile)
     {
-        std::ifstream in;
-		in.open(xflFile.c_str(), std::ios::in);
-		if(!in.is_open()) return false;
-
-		in.unsetf(std::ios::skipws);// No white space skipping!
-		auto str = std::string(std::istreambuf_iterator<char>(in.rdbuf()), std::istreambuf_iterator<char>());
-		auto iter = str.cbegin();
-		auto end = str.cend();
-
-        using Skipper = SkipperGrammar<std::string::const_iterator>;
-        using ErrorHandler = ErrorHandler<std::string::const_iterator>;
-
-        Skipper skipper;
-        ErrorHandler errHandler(iter, end);
-        EXflGrammar<std::string::const_iterator, Skipper> grammar(db, errHandler);
-        
-        bool res = qi::phrase_parse(iter, end, grammar, skipper);
-        return res && iter == end;
+        std::string buffer;//file content if it can not be mapped
+        const char * begin{nullptr}, * end{nullptr};
+        EMappedFile file(xflFile);
+        if (file.isOpen()) {
+            begin = reinterpret_cast<const char *>(file.Data());
+            end = begin + file.Size();
+        }
+        else {
+            std::ifstream in(xflFile.c_str(), std::ios::in);
+            if (not in.is_open()) return false;
+            buffer.assign(std::istreambuf_iterator<char>(in.rdbuf()), std::istreambuf_iterator<char>());
+            begin = buffer.data();
+            end = begin + buffer.size();
+        }
+
+        constexpr size_t chunkSize = 256 * 1024;
+        auto chunks = Split(begin, end, threads > 1 ? chunkSize : std::numeric_limits<size_t>::max());
+        {
+            UPtr<thread::ThreadPool> pool;
+            if (threads > 1) pool.reset(new thread::ThreadPool(threads));
+            for (auto & chunk : chunks) {
+                if (Section::Others == chunk->section) continue;
+                if (pool) pool->Submit(std::bind(&EXflReader::Parse, std::ref(*chunk)));
+                else Parse(*chunk);
+            }
+            //the header values are set in file order
+            for (auto & chunk : chunks) {
+                if (Section::Others != chunk->section) continue;
+                CopyHeader(db, chunk->db);
+                Parse(*chunk);
+                CopyHeader(chunk->db, db);
+            }
+        }
+        for (const auto & chunk : chunks)
+            if (not chunk->res) return false;
+
+        Merge(chunks);
+        return true;
+    }
+
+    static void Parse(Chunk & chunk)
+    {
+        using Iterator = const char *;
+        SkipperGrammar<Iterator> skipper;
+        ErrorHandler<Iterator> errHandler(chunk.begin, chunk.end);
+        EXflGrammar<Iterator, SkipperGrammar<Iterator> > grammar(chunk.db, errHandler);
+
+        auto iter = chunk.begin;
+        chunk.res = qi::phrase_parse(iter, chunk.end, grammar.Records(chunk.section), skipper) && iter == chunk.end;
+    }
+
+    ///cuts the record sections out of the file, a record section hidden in any other section stays in the text parsed by the whole grammar
+    static std::vector<UPtr<Chunk> > Split(const char * begin, const char * end, size_t chunkSize)
+    {
+        std::vector<UPtr<Chunk> > chunks;
+        auto add = [&chunks](Section section, const char * b, const char * e) {
+            if (b >= e) return;
+            auto chunk = new Chunk;
+            chunk->section = section;
+            chunk->begin = b;
+            chunk->end = e;
+            chunks.emplace_back(chunk);
+        };
+
+        auto text = begin, pos = begin;
+        while (pos < end) {
+            auto line = pos;
+            auto tag = ReadTag(pos, end);
+            if (auto section = GetSection(tag); section != Section::Others) {
+                auto body = pos;
+                auto bodyEnd = FindEndTag(pos, end, tag);
+                if (nullptr == bodyEnd) break;
+                add(Section::Others, text, line);
+                SplitRecords(section, body, bodyEnd, chunkSize, add);
+                text = pos;
+            }
+            else if (not tag.empty() && not isEndTag(tag) && not isHeaderTag(tag)) {
+                //skipped to the first end tag as the grammar does for the other sections
+                for (NextLine(pos, end); pos < end; NextLine(pos, end))
+                    if (isEndTag(ReadTag(pos, end))) break;
+            }
+            NextLine(pos, end);
+        }
+        add(Section::Others, text, end);
+        return chunks;
+    }
+
+    ///splits after the closing brace of a record once the chunk is larger than chunkSize
+    template <typename Add>
+    static void SplitRecords(Section section, const char * begin, const char * end, size_t chunkSize, Add && add)
+    {
+        size_t depth{0};
+        auto chunkBegin = begin;
+        for (auto pos = begin; pos < end; ++pos) {
+            if ('"' == *pos || '#' == *pos) {
+                pos = std::find(pos + 1, end, '"' == *pos ? '"' : '\n');
+                if (pos == end) break;
+            }
+            else if ('{' == *pos) ++depth;
+            else if ('}' == *pos && depth > 0 && 0 == --depth && size_t(pos + 1 - chunkBegin) >= chunkSize) {
+                add(section, chunkBegin, pos + 1);
+                chunkBegin = pos + 1;
+            }
+        }
+        add(section, chunkBegin, end);
+    }
+
+    ///name of the tag at the line start, e.g. "material" for ".material", empty if the line does not start with a tag
+    static std::string_view ReadTag(const char *& pos, const char * end)
+    {
+        while (pos < end && (' ' == *pos || '\t' == *pos)) ++pos;
+        if (pos == end || '.' != *pos) return std::string_view{};
+        return ReadWord(++pos, end);
+    }
+
+    static std::string_view ReadWord(const char *& pos, const char * end)
+    {
+        auto begin = pos;
+        while (pos < end && (std::isalnum(static_cast<unsigned char>(*pos)) || '_' == *pos || '.' == *pos || '-' == *pos)) ++pos;
+        return std::string_view(begin, pos - begin);
+    }
+
+    ///returns the line start of ".end tag" and moves pos behind it, nullptr if the section is not closed
+    static const char * FindEndTag(const char *& pos, const char * end, std::string_view tag)
+    {
+        for (NextLine(pos, end); pos < end; NextLine(pos, end)) {
+            auto line = pos;
+            if (not Equals(ReadTag(pos, end), "end") || pos == end || ' ' != *pos) continue;
+            if (Equals(ReadWord(++pos, end), tag)) return line;
+        }
+        return nullptr;
+    }
+
+    static void NextLine(const char *& pos, const char * end)
+    {
+        pos = std::find(pos, end, '\n');
+        if (pos < end) ++pos;
+    }
+
+    static Section GetSection(std::string_view tag)
+    {
+        static const std::pair<std::string_view, Section> sections[] = {
+            {"material", Section::Material}, {"layer", Section::Layer}, {"shape", Section::Shape}, {"padstack", Section::Padstack},
+            {"via", Section::Via}, {"part", Section::Part}, {"netlist", Section::Netlist}, {"route", Section::Route}
+        };
+        for (const auto & [name, section] : sections)
+            if (Equals(tag, name)) return section;
+        return Section::Others;
+    }
+
+    static bool isEndTag(std::string_view tag)
+    {
+        return tag.size() >= 3 && Equals(tag.substr(0, 3), "end");
+    }
+
+    ///single line tags
+    static bool isHeaderTag(std::string_view tag)
+    {
+        return Equals(tag, "version") || Equals(tag, "unit") || Equals(tag, "design_type") || Equals(tag, "scale");
+    }
+
+    static bool Equals(std::string_view a, std::string_view b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    static void CopyHeader(const EXflDB & from, EXflDB & to)
+    {
+        to.unit = from.unit;
+        to.scale = from.scale;
+        to.version = from.version;
+        to.designType = from.designType;
+        to.hasBoardGeom = from.hasBoardGeom;
+        to.boardGeom = from.boardGeom;
+    }
+
+    void Merge(std::vector<UPtr<Chunk> > & chunks)
+    {
+        auto merge = [this, &chunks](auto member) {
+            size_t size{0};
+            for (const auto & chunk : chunks)
+                size += (chunk->db.*member).size();
+            auto & to = db.*member;
+            to.reserve(to.size() + size);
+            for (auto & chunk : chunks) {
+                auto & from = chunk->db.*member;
+                to.insert(to.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+                from = std::decay_t<decltype(from)>{};
+            }
+        };
+        merge(&EXflDB::materials);
+        merge(&EXflDB::layers);
+        merge(&EXflDB::templates);
+        merge(&EXflDB::padstacks);
+        merge(&EXflDB::vias);
+        merge(&EXflDB::parts);
+        merge(&EXflDB::nets);
+        merge(&EXflDB::routes);
     }
 
 	template <typename Iterator>
@@ -119,6 +318,14 @@ struct EXflReader
 		qi::rule<Iterator, Skipper> netAttrSection;
 		qi::rule<Iterator, Skipper> netlistSection;
 		qi::rule<Iterator, Skipper> routeSection;
+		qi::rule<Iterator, Skipper> materials;
+		qi::rule<Iterator, Skipper> layers;
+		qi::rule<Iterator, Skipper> shapes;
+		qi::rule<Iterator, Skipper> padstacks;
+		qi::rule<Iterator, Skipper> vias;
+		qi::rule<Iterator, Skipper> parts;
+		qi::rule<Iterator, Skipper> nets;
+		qi::rule<Iterator, Skipper> routes;
 		qi::rule<Iterator, std::string(), Skipper> unknownSection;
 		qi::rule<Iterator, std::string(), Skipper> startTag;
 		qi::rule<Iterator, void(std::string), Skipper> endTag;
@@ -212,31 +419,19 @@ struct EXflReader
 				| (lexeme[no_case[".scale"]] >> double_) [phx::bind(&EXflGrammar::ScaleHandle, this, _1)]
 			;
 
-            materialSection = lexeme[no_case[".material"]] >>
-				*(
-					material[phx::bind(&EXflGrammar::MaterialHandle, this, _1)]
-				) >>
-				lexeme[no_case[".end material"]]
-			;
+            materialSection = lexeme[no_case[".material"]] >> materials >> lexeme[no_case[".end material"]];
+			materials = *(material[phx::bind(&EXflGrammar::MaterialHandle, this, _1)]);
 			
 			materialFreqSection = lexeme[no_case[".material_frequency"]] >>
 				*(char_ - lexeme[no_case[".end material_frequency"]]) >>//todo
 				lexeme[no_case[".end material_frequency"]]
 			;
 
-			layerSection = lexeme[no_case[".layer"]] >>
-				*(
-					layer[phx::bind(&EXflGrammar::LayerHandle, this, _1)]
-				) >>
-				lexeme[no_case[".end layer"]]
-			;
+			layerSection = lexeme[no_case[".layer"]] >> layers >> lexeme[no_case[".end layer"]];
+			layers = *(layer[phx::bind(&EXflGrammar::LayerHandle, this, _1)]);
 
-			shapeSection = lexeme[no_case[".shape"]] >>
-				*(
-					shape[phx::bind(&EXflGrammar::ShapeHandle, this, _1)]
-				) >>
-				lexeme[no_case[".end shape"]]
-			;
+			shapeSection = lexeme[no_case[".shape"]] >> shapes >> lexeme[no_case[".end shape"]];
+			shapes = *(shape[phx::bind(&EXflGrammar::ShapeHandle, this, _1)]);
 			
 			boardGeomSection = lexeme[no_case[".board_geom"]] >>
 				-(
@@ -249,20 +444,14 @@ struct EXflReader
 				lexeme[no_case[".end board_geom"]]
 			;
 
-			padstackSection = lexeme[no_case[".padstack"]] >>
-				*(padstack[phx::bind(&EXflGrammar::PadstackHandle, this, _1)]) >>
-				lexeme[no_case[".end padstack"]]
-			;
+			padstackSection = lexeme[no_case[".padstack"]] >> padstacks >> lexeme[no_case[".end padstack"]];
+			padstacks = *(padstack[phx::bind(&EXflGrammar::PadstackHandle, this, _1)]);
 
-			viaSection = lexeme[no_case[".via"]] >>
-				*(via[phx::bind(&EXflGrammar::ViaHandle, this, _1)]) >>
-				lexeme[no_case[".end via"]]
-			;
+			viaSection = lexeme[no_case[".via"]] >> vias >> lexeme[no_case[".end via"]];
+			vias = *(via[phx::bind(&EXflGrammar::ViaHandle, this, _1)]);
 
-			partSection = lexeme[no_case[".part"]] >>
-				*(part[phx::bind(&EXflGrammar::PartHandle, this, _1)]) >>
-				lexeme[no_case[".end part"]]
-			;
+			partSection = lexeme[no_case[".part"]] >> parts >> lexeme[no_case[".end part"]];
+			parts = *(part[phx::bind(&EXflGrammar::PartHandle, this, _1)]);
 
 			componentSection = lexeme[no_case[".component"]] >>
 				*(char_ - lexeme[no_case[".end component"]]) >>//todo
@@ -274,15 +463,11 @@ struct EXflReader
 				lexeme[no_case[".end netattr"]]
 			;
 
-			netlistSection = lexeme[no_case[".netlist"]] >>
-				*net [phx::bind(&EXflGrammar::NetHandle, this, _1)] >>
-				lexeme[no_case[".end netlist"]]
-			;
+			netlistSection = lexeme[no_case[".netlist"]] >> nets >> lexeme[no_case[".end netlist"]];
+			nets = *(net[phx::bind(&EXflGrammar::NetHandle, this, _1)]);
 
-			routeSection = lexeme[no_case[".route"]] >>
-				*(route[phx::bind(&EXflGrammar::RouteHandle, this, _1)]) >>
-				lexeme[no_case[".end route"]]
-			;
+			routeSection = lexeme[no_case[".route"]] >> routes >> lexeme[no_case[".end route"]];
+			routes = *(route[phx::bind(&EXflGrammar::RouteHandle, this, _1)]);
 
 			unknownSection =
 				startTag[_val = _1] >>
@@ -476,6 +661,22 @@ struct EXflReader
             );
         }
 
+		///records of a section without its tags, the whole grammar for others
+		const qi::rule<Iterator, Skipper> & Records(Section section) const
+		{
+			switch (section) {
+				case Section::Material : return materials;
+				case Section::Layer : return layers;
+				case Section::Shape : return shapes;
+				case Section::Padstack : return padstacks;
+				case Section::Via : return vias;
+				case Section::Part : return parts;
+				case Section::Netlist : return nets;
+				case Section::Route : return routes;
+				default : return expression;
+			}
+		}
+
         void VersionHandle(int major, int minor)
         {
             //std::cout << "Version: " << major << "." << minor << std::endl;
@@ -3,6 +3,7 @@
 #include "model/geometry/utils/ELayerCutModelBuilder.h"
 #include "model/geometry/ELayerCutModel.h"
 #include "utility/ELayoutRetriever.h"
+#include "utility/EInstancedLayout.h"
 #include "interface/Interface.h"
 
 #include "generic/tools/FileSystem.hpp"
@@ -11,6 +12,7 @@
 namespace ecad::extraction {
 
 using namespace ecad::model;
+using ecad::utils::EInstancedLayout;
 
 ECAD_INLINE UPtr<IModel> EGeometryModelExtraction::GenerateLayerCutModel(Ptr<ILayoutView> layout, const ELayerCutModelExtractionSettings & settings)
 {
@@ -40,6 +42,28 @@ ECAD_INLINE UPtr<IModel> EGeometryModelExtraction::GenerateLayerCutModel(Ptr<ILa
     auto scale2Meter = coordUnits.toUnit(coordUnits.toCoord(1), ECoordUnits::Unit::Meter);
     std::unordered_map<ELayerId, std::pair<EFloat, EFloat> > layerElevationThicknessMap;
     std::unordered_map<ELayerId, std::pair<EMaterialId, EMaterialId> > layerMaterialMap;
+    auto addGeometry = [&](ENetId netId, ELayerId lyrId, CPtr<EShape> shape) {
+        auto matIt = layerMaterialMap.find(lyrId);
+        if (matIt == layerMaterialMap.cend()) {
+            auto layer = layout->GetLayerCollection()->FindLayerByLayerId(lyrId);
+            if (nullptr == layer) { ECAD_ASSERT(false) return; }
+            auto stackupLayer = layer->GetStackupLayerFromLayer();
+            ECAD_ASSERT(nullptr != stackupLayer)
+            auto condMat = layout->GetDatabase()->FindMaterialDefByName(stackupLayer->GetConductingMaterial());
+            auto dielMat = layout->GetDatabase()->FindMaterialDefByName(stackupLayer->GetDielectricMaterial());
+            ECAD_ASSERT(condMat && dielMat)
+            matIt = layerMaterialMap.emplace(lyrId, std::make_pair(condMat->GetMaterialId(), dielMat->GetMaterialId())).first;
+        }
+        const auto & [condMatId, dielMatId] = matIt->second;
+        auto iter = layerElevationThicknessMap.find(lyrId);
+        if (iter == layerElevationThicknessMap.cend()) {
+            check = retriever->GetLayerHeightThickness(lyrId, elevation, thickness);
+            ECAD_ASSERT(check)
+            iter = layerElevationThicknessMap.emplace(lyrId, std::make_pair(elevation, thickness)).first;
+        }
+        std::tie(elevation, thickness) = iter->second;
+        builder.AddShape(netId, condMatId, dielMatId, shape, elevation, thickness);
+    };
     auto primitives = layout->GetPrimitiveCollection();
     for (size_t i = 0; i < primitives->Size(); ++i) {
         auto prim = primitives->GetPrimitive(i);
@@ -84,31 +108,19 @@ ECAD_INLINE UPtr<IModel> EGeometryModelExtraction::GenerateLayerCutModel(Ptr<ILa
             }
         }
         else if (auto geom = prim->GetGeometry2DFromPrimitive(); geom) {
-            auto shape = geom->GetShape();
-            auto netId = prim->GetNet();
-            auto lyrId = prim->GetLayer();
-            auto matIt = layerMaterialMap.find(lyrId);
-            if (matIt == layerMaterialMap.cend()) {
-                auto layer = layout->GetLayerCollection()->FindLayerByLayerId(lyrId);
-                if (nullptr == layer) { ECAD_ASSERT(false) continue; }
-                auto stackupLayer = layer->GetStackupLayerFromLayer();
-                ECAD_ASSERT(nullptr != stackupLayer)
-                auto condMat = layout->GetDatabase()->FindMaterialDefByName(stackupLayer->GetConductingMaterial());
-                auto dielMat = layout->GetDatabase()->FindMaterialDefByName(stackupLayer->GetDielectricMaterial());
-                ECAD_ASSERT(condMat && dielMat)
-                matIt = layerMaterialMap.emplace(lyrId, std::make_pair(condMat->GetMaterialId(), dielMat->GetMaterialId())).first;
-            }
-            const auto & [condMatId, dielMatId] = matIt->second;
-            auto iter = layerElevationThicknessMap.find(lyrId);
-            if (iter == layerElevationThicknessMap.cend()) {
-                check = retriever->GetLayerHeightThickness(lyrId, elevation, thickness);
-                ECAD_ASSERT(check)
-                iter = layerElevationThicknessMap.emplace(lyrId, std::make_pair(elevation, thickness)).first;
-            }
-            std::tie(elevation, thickness) = iter->second;
-            builder.AddShape(netId, condMatId, dielMatId, shape, elevation, thickness);
+            addGeometry(prim->GetNet(), prim->GetLayer(), geom->GetShape());
         }        
     }
+
+    //geometries of the cell instances are placed lazily instead of flattening the layout, their nets are local to the cell definitions
+    EInstancedLayout instances(layout);
+    auto shapeIter = instances.GetShapeIter();
+    while (auto * shape = shapeIter->Next()) {
+        if (shape->master == layout || noLayer == shape->layer) continue;
+        if (nullptr == shape->primitive->GetGeometry2DFromPrimitive()) continue;
+        if (auto placed = shape->GetShape(); placed)
+            addGeometry(ENetId::noNet, shape->layer, placed.get());
+    }
     auto psInstIter = layout->GetPadstackInstIter();
     while (auto psInst = psInstIter->Next()){
         auto netId = psInst->GetNet();
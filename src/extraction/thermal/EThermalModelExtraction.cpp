@@ -13,6 +13,8 @@
 #include "generic/geometry/Mesh2D.hpp"
 #include "interface/Interface.h"
 
+#include <boost/functional/hash.hpp>
+
 namespace ecad::extraction {
 
 using namespace ecad::model;
@@ -229,10 +231,14 @@ ECAD_INLINE UPtr<IModel> EThermalModelExtraction::GeneratePrismThermalModel(Ptr<
         auto & prismLayer = model->layers.at(index);
         auto & idMap = templateIdMap.emplace(prismLayer.id, std::unordered_map<size_t, size_t>{}).first->second;    
         auto triangulation = model->GetLayerPrismTemplate(index);
+        ECAD_ASSERT(compact->hasPolygon(prismLayer.id))
+        std::vector<size_t> pids;
+        std::vector<EPoint2D> ctPoints(triangulation->triangles.size());
+        for (size_t it = 0; it < triangulation->triangles.size(); ++it)
+            ctPoints[it] = tri::TriangulationUtility<EPoint2D>::GetCenter(*triangulation, it).Cast<ECoord>();
+        query.SearchPolygons(prismLayer.id, ctPoints, pids, settings.threads);
         for (size_t it = 0; it < triangulation->triangles.size(); ++it) {
-            ECAD_ASSERT(compact->hasPolygon(prismLayer.id))
-            auto ctPoint = tri::TriangulationUtility<EPoint2D>::GetCenter(*triangulation, it).Cast<ECoord>();
-            auto pid = query.SearchPolygon(prismLayer.id, ctPoint);
+            auto pid = pids.at(it);
             if (pid == invalidIndex) continue;;
             if (fluidMaterials.count(compact->GetMaterialId(pid))) continue;
             if (EMaterialId::noMaterial == compact->GetMaterialId(pid)) continue;
@@ -245,7 +251,7 @@ ECAD_INLINE UPtr<IModel> EThermalModelExtraction::GeneratePrismThermalModel(Ptr<
             if (iter != powerBlocks.cend() &&
                 prismLayer.id == compact->GetLayerIndexByHeight(iter->second.range.high)) {
                 auto area = tri::TriangulationUtility<EPoint2D>::GetTriangleArea(*triangulation, it);
-                ele.powerRatio = area / compact->GetAllPolygonData().at(pid).Area();
+                ele.powerRatio = area / query.GetPolygonArea(pid);
                 ele.powerScenario = iter->second.scen;
                 ele.powerLut = iter->second.power;
             }
@@ -337,26 +343,46 @@ ECAD_INLINE UPtr<IModel> EThermalModelExtraction::GenerateStackupPrismThermalMod
     const auto & coordUnits = layout->GetDatabase()->GetCoordUnits();
 
     //mesh, todo steiner points
+    //layers are keyed by the hash of their polygon indices including the imprinted upper layer, 
+    //identical layers share one prism template by reference even if they are not adjacent
     using PrismTemplate = typename EPrismThermalModel::PrismTemplate;
-    std::vector<std::vector<EPolygonData>> layerPolygons{compact->GetLayerPolygons(0)};
-    std::vector<SPtr<PrismTemplate>> prismTemplates{std::make_shared<PrismTemplate>()};
-    std::unordered_map<size_t, size_t> layer2Template{{0, 0}};
-    for (size_t i = 1; i < compact->TotalLayers(); ++i) {
-        auto indices = compact->GetLayerPolygonIndices(i);
-        if (indices != compact->GetLayerPolygonIndices(i - 1)) {
-            auto polygons = compact->GetLayerPolygons(i);
-            if (settings.meshSettings.imprintUpperLayer) {
-                const auto & upperLyr = layerPolygons.back();
-                polygons.insert(polygons.end(), upperLyr.begin(), upperLyr.end());
-            }
-            layerPolygons.emplace_back(std::move(polygons));
-            prismTemplates.emplace_back(new PrismTemplate);
+    std::vector<std::vector<size_t>> templatePolygons;
+    std::vector<SPtr<PrismTemplate>> prismTemplates;
+    std::unordered_multimap<size_t, size_t> templateHashes;//[hash, template]
+    std::unordered_map<size_t, size_t> layer2Template;
+    for (size_t i = 0; i < compact->TotalLayers(); ++i) {
+        if (i > 0 && compact->GetLayerPolygonIndices(i) == compact->GetLayerPolygonIndices(i - 1)) {
+            layer2Template.emplace(i, layer2Template.at(i - 1));
+            continue;
+        }
+        auto indices = *compact->GetLayerPolygonIndices(i);
+        if (i > 0 && settings.meshSettings.imprintUpperLayer) {
+            const auto & upperLyr = templatePolygons.at(layer2Template.at(i - 1));
+            indices.insert(indices.end(), upperLyr.begin(), upperLyr.end());
         }
-        layer2Template.emplace(i, prismTemplates.size() - 1);
+        auto hash = boost::hash_range(indices.begin(), indices.end());
+        auto [begin, end] = templateHashes.equal_range(hash);
+        auto iter = std::find_if(begin, end, [&](const auto & item){ return templatePolygons.at(item.second) == indices; });
+        if (iter != end) {
+            layer2Template.emplace(i, iter->second);
+            continue;
+        }
+        templateHashes.emplace(hash, prismTemplates.size());
+        layer2Template.emplace(i, prismTemplates.size());
+        templatePolygons.emplace_back(std::move(indices));
+        prismTemplates.emplace_back(new PrismTemplate);
+    }
+
+    const auto & allPolygons = compact->GetAllPolygonData();
+    std::vector<std::vector<EPolygonData>> layerPolygons(templatePolygons.size());
+    for (size_t i = 0; i < templatePolygons.size(); ++i) {
+        layerPolygons[i].reserve(templatePolygons.at(i).size());
+        for (auto pid : templatePolygons.at(i))
+            layerPolygons[i].emplace_back(allPolygons.at(pid));
     }
     
     std::vector<EPoint2D> steinerPoints;//todo, bwu
-    ECAD_TRACE("generate mesh for %1% layers", prismTemplates.size());
+    ECAD_TRACE("generate mesh for %1% of %2% layers", prismTemplates.size(), compact->TotalLayers());
     if (settings.threads > 1) {
         generic::thread::ThreadPool pool(settings.threads);
         for (size_t i = 0; i < prismTemplates.size(); ++i) {
@@ -399,10 +425,14 @@ ECAD_INLINE UPtr<IModel> EThermalModelExtraction::GenerateStackupPrismThermalMod
         auto & prismLayer = model->layers.at(index);
         auto & idMap = templateIdMap.emplace(prismLayer.id, std::unordered_map<size_t, size_t>{}).first->second;    
         auto triangulation = model->GetLayerPrismTemplate(index);
+        ECAD_ASSERT(compact->hasPolygon(prismLayer.id))
+        std::vector<size_t> pids;
+        std::vector<EPoint2D> ctPoints(triangulation->triangles.size());
+        for (size_t it = 0; it < triangulation->triangles.size(); ++it)
+            ctPoints[it] = tri::TriangulationUtility<EPoint2D>::GetCenter(*triangulation, it).Cast<ECoord>();
+        query.SearchPolygons(prismLayer.id, ctPoints, pids, settings.threads);
         for (size_t it = 0; it < triangulation->triangles.size(); ++it) {
-            ECAD_ASSERT(compact->hasPolygon(prismLayer.id))
-            auto ctPoint = tri::TriangulationUtility<EPoint2D>::GetCenter(*triangulation, it).Cast<ECoord>();
-            auto pid = query.SearchPolygon(prismLayer.id, ctPoint);
+            auto pid = pids.at(it);
             if (pid == invalidIndex) continue;;
             if (fluidMaterials.count(compact->GetMaterialId(pid))) continue;
             if (EMaterialId::noMaterial == compact->GetMaterialId(pid)) continue;
@@ -415,7 +445,7 @@ ECAD_INLINE UPtr<IModel> EThermalModelExtraction::GenerateStackupPrismThermalMod
             if (iter != powerBlocks.cend() &&
                 prismLayer.id == compact->GetLayerIndexByHeight(iter->second.range.high)) {
                 auto area = tri::TriangulationUtility<EPoint2D>::GetTriangleArea(*triangulation, it);
-                ele.powerRatio = area / compact->GetAllPolygonData().at(pid).Area();
+                ele.powerRatio = area / query.GetPolygonArea(pid);
                 ele.powerScenario = iter->second.scen;
                 ele.powerLut = iter->second.power;
             }
@@ -19,6 +19,13 @@ public:
     virtual CPtr<ILayoutView> GetFlattenedLayoutView() const = 0;
     virtual void SetLayerMap(CPtr<ILayerMap> layerMap) = 0;
     virtual CPtr<ILayerMap> GetLayerMap() const = 0;
+    ///places the definition cols x rows times, placement (c, r) is shifted by c * colPitch + r * rowPitch after the instance transform
+    virtual void SetArray(size_t cols, size_t rows, const EVector2D & colPitch, const EVector2D & rowPitch) = 0;
+    virtual void GetArray(size_t & cols, size_t & rows, EVector2D & colPitch, EVector2D & rowPitch) const = 0;
+    virtual bool isArray() const = 0;
+    ///number of placements, 1 if not an array
+    virtual size_t Placements() const = 0;
+    virtual ETransform2D GetPlacementTransform(size_t index) const = 0;
 };
 
 }//namespace ecad
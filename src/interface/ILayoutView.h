@@ -126,6 +126,7 @@ public:
 
     ///Thermal Simulation
     virtual EPair<EFloat, EFloat> RunThermalSimulation(const EThermalStaticSimulationSetup & simulationSetup, std::vector<EFloat> & temperatures) = 0;
+    virtual std::vector<EPair<EFloat, EFloat> > RunThermalSimulation(const EThermalStaticSimulationSetup & simulationSetup, const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) = 0;
     virtual EPair<EFloat, EFloat> RunThermalSimulation(const EThermalTransientSimulationSetup & simulationSetup, const EThermalTransientExcitation & excitation) = 0;
 
     ///Mapping
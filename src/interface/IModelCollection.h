@@ -9,7 +9,9 @@ class ECAD_API IModelCollection : public Clonable<IModelCollection>
 public:
     virtual ~IModelCollection() = default;
     virtual CPtr<IModel> FindModel(EModelType type) const = 0;
+    virtual Ptr<IModel> GetModel(EModelType type) = 0;
     virtual bool AddModel(UPtr<IModel> model) = 0;
+    virtual bool RemoveModel(EModelType type) = 0;
     virtual size_t Size() const = 0;
     virtual void Clear() = 0;
 };
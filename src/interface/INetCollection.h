@@ -13,6 +13,7 @@ public:
     virtual Ptr<INet> FindNetByNetId(ENetId netId) const = 0;
     virtual Ptr<INet> CreateNet(const std::string & name) = 0;
     virtual Ptr<INet> AddNet(UPtr<INet> net) = 0;
+    virtual ENetId AddNets(std::vector<UPtr<INet> > nets) = 0;
     virtual NetIter GetNetIter() const = 0;
     virtual size_t Size() const = 0;
     virtual void Clear() = 0;
@@ -22,6 +22,8 @@ public:
 
     virtual PadstackInstIter GetPadstackInstIter() const = 0;
 
+    virtual void Reserve(size_t size) = 0;
+
     virtual size_t Size() const = 0;
 };
 }//namespace ecad
@@ -23,6 +23,7 @@ public:
     virtual void Map(CPtr<ILayerMap> lyrMap) = 0;
     virtual PrimitiveIter GetPrimitiveIter() const = 0;
     virtual UPtr<IPrimitive> PopBack() = 0;
+    virtual void Reserve(size_t size) = 0;
     virtual size_t Size() const = 0;
 };
 }//namespace ecad
@@ -8,12 +8,14 @@ namespace utils {
 class ELayerCutModelQuery;
 class ELayerCutModelBuilder;
 } // namespace utils
+namespace io { class ELayerCutModelBinaryIO; }
 class ECAD_API ELayerCutModel : public IModel
 {
     ECAD_SERIALIZATION_FUNCTIONS_DECLARATION
 public:
     friend class utils::ELayerCutModelQuery;
     friend class utils::ELayerCutModelBuilder;
+    friend class io::ELayerCutModelBinaryIO;
     using Height = int;
     struct LayerRange
     {
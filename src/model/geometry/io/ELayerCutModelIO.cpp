@@ -0,0 +1,333 @@
+#include "ELayerCutModelIO.h"
+#include "model/io/EModelBinaryFormat.h"
+
+#include <algorithm>
+namespace ecad::model::io {
+
+namespace detail {
+ECAD_ALWAYS_INLINE void WritePoints(EModelChunkWriter & chunk, const std::vector<const std::vector<EPoint2D> *> & rows)
+{
+    std::vector<size_t> offsets(1, 0);
+    std::vector<ECoord> coords;
+    for (auto row : rows) {
+        for (const auto & point : *row)
+            coords.insert(coords.end(), {point[0], point[1]});
+        offsets.emplace_back(coords.size() / 2);
+    }
+    chunk.WriteArray(offsets);
+    chunk.WriteArray(coords);
+}
+
+ECAD_ALWAYS_INLINE bool ReadPoints(EModelChunkReader & chunk, std::vector<std::vector<EPoint2D> > & rows)
+{
+    const size_t * offsets{nullptr};
+    const ECoord * coords{nullptr};
+    size_t size{0}, total{0};
+    if (not chunk.ViewArray(offsets, size) || not chunk.ViewArray(coords, total)) return false;
+    if (0 == size || offsets[size - 1] * 2 != total) return false;
+    rows.resize(size - 1);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (offsets[i] > offsets[i + 1]) return false;
+        rows[i].reserve(offsets[i + 1] - offsets[i]);
+        for (auto j = offsets[i]; j < offsets[i + 1]; ++j)
+            rows[i].emplace_back(coords[j * 2], coords[j * 2 + 1]);
+    }
+    return true;
+}
+}//namespace detail
+
+ECAD_INLINE bool ELayerCutModelBinaryIO::Write(std::string_view filename, const ELayerCutModel & model, std::string * err)
+{
+    EModelBinaryWriter writer(filename, model.GetModelType());
+    if (not writer.isOpen()) return detail::Error(err, "Error: fail to open: " + std::string(filename));
+
+    //meta
+    {
+        EModelChunkWriter chunk;
+        chunk.Write<EFloat>(model.m_vScale2Int);
+
+        std::vector<int32_t> nets(model.m_nets.size()), materials(model.m_materials.size());
+        std::transform(model.m_nets.cbegin(), model.m_nets.cend(), nets.begin(), [](auto n){ return static_cast<int32_t>(n); });
+        std::transform(model.m_materials.cbegin(), model.m_materials.cend(), materials.begin(), [](auto m){ return static_cast<int32_t>(m); });
+        chunk.WriteArray(nets);
+        chunk.WriteArray(materials);
+
+        std::vector<ELayerCutModel::Height> ranges;
+        ranges.reserve(model.m_ranges.size() * 2);
+        for (const auto & range : model.m_ranges)
+            ranges.insert(ranges.end(), {range.high, range.low});
+        chunk.WriteArray(ranges);
+
+        detail::WritePoints(chunk, {&model.m_steinerPoints});
+
+        std::vector<ELayerCutModel::Height> heights;
+        std::vector<size_t> indices;
+        for (const auto & [height, index] : model.m_height2Index) {
+            heights.emplace_back(height);
+            indices.emplace_back(index);
+        }
+        chunk.WriteArray(heights);
+        chunk.WriteArray(indices);
+        chunk.WriteArray(model.m_layerOrder);
+
+        //sliced layers share the polygon indices
+        std::vector<size_t> layers, lists;
+        std::vector<const std::vector<size_t> *> rows;
+        std::unordered_map<CPtr<std::vector<size_t> >, size_t> listIndices;
+        for (const auto & [layer, polygons] : model.m_lyrPolygons) {
+            auto [iter, added] = listIndices.emplace(polygons.get(), rows.size());
+            if (added) rows.emplace_back(polygons.get());
+            layers.emplace_back(layer);
+            lists.emplace_back(iter->second);
+        }
+        std::vector<size_t> offsets(1, 0), polygons;
+        for (auto row : rows) {
+            polygons.insert(polygons.end(), row->begin(), row->end());
+            offsets.emplace_back(polygons.size());
+        }
+        chunk.WriteArray(layers);
+        chunk.WriteArray(lists);
+        chunk.WriteArray(offsets);
+        chunk.WriteArray(polygons);
+        writer.AddChunk(EModelChunk::Meta, 0, chunk);
+    }
+
+    //polygons
+    {
+        std::vector<const std::vector<EPoint2D> *> rows;
+        rows.reserve(model.m_polygons.size());
+        for (const auto & polygon : model.m_polygons)
+            rows.emplace_back(&polygon.GetPoints());
+        EModelChunkWriter chunk;
+        detail::WritePoints(chunk, rows);
+        writer.AddChunk(EModelChunk::Polygons, 0, chunk);
+    }
+
+    //bondwires
+    {
+        auto size = model.m_bondwires.size();
+        std::vector<int32_t> nets(size), materials(size);
+        std::vector<EFloat> radius(size), currents(size), heights;
+        std::vector<size_t> scenarios(size), offsets(1, 0);
+        std::vector<const std::vector<EPoint2D> *> rows;
+        for (size_t i = 0; i < size; ++i) {
+            const auto & bw = model.m_bondwires.at(i);
+            nets[i] = static_cast<int32_t>(bw.netId);
+            materials[i] = static_cast<int32_t>(bw.matId);
+            radius[i] = bw.radius;
+            currents[i] = bw.current;
+            scenarios[i] = bw.scenario;
+            heights.insert(heights.end(), bw.heights.cbegin(), bw.heights.cend());
+            offsets.emplace_back(heights.size());
+            rows.emplace_back(&bw.pt2ds);
+        }
+        EModelChunkWriter chunk;
+        chunk.WriteArray(nets);
+        chunk.WriteArray(materials);
+        chunk.WriteArray(radius);
+        chunk.WriteArray(currents);
+        chunk.WriteArray(scenarios);
+        chunk.WriteArray(offsets);
+        chunk.WriteArray(heights);
+        detail::WritePoints(chunk, rows);
+        writer.AddChunk(EModelChunk::Bondwires, 0, chunk);
+    }
+
+    //power blocks
+    {
+        std::vector<size_t> keys, polygons, scenarios, lutIndices;
+        std::vector<ELayerCutModel::Height> ranges;
+        std::vector<CPtr<ELookupTable1D> > luts;
+        std::unordered_map<CPtr<ELookupTable1D>, size_t> indices;
+        for (const auto & [key, block] : model.m_powerBlocks) {
+            keys.emplace_back(key);
+            polygons.emplace_back(block.polygon);
+            ranges.insert(ranges.end(), {block.range.high, block.range.low});
+            scenarios.emplace_back(block.scen);
+            if (nullptr == block.power) {
+                lutIndices.emplace_back(invalidIndex);
+                continue;
+            }
+            auto [iter, added] = indices.emplace(block.power.get(), luts.size());
+            if (added) luts.emplace_back(block.power.get());
+            lutIndices.emplace_back(iter->second);
+        }
+        EModelChunkWriter lutChunk;
+        WriteLookupTables(lutChunk, luts);
+        writer.AddChunk(EModelChunk::LookupTables, 0, lutChunk);
+
+        EModelChunkWriter chunk;
+        chunk.WriteArray(keys);
+        chunk.WriteArray(polygons);
+        chunk.WriteArray(ranges);
+        chunk.WriteArray(scenarios);
+        chunk.WriteArray(lutIndices);
+        writer.AddChunk(EModelChunk::PowerBlocks, 0, chunk);
+    }
+
+    //settings
+    {
+        EModelChunkWriter chunk;
+        WriteLayerCutSettings(chunk, model.m_settings);
+        writer.AddChunk(EModelChunk::Settings, 0, chunk);
+    }
+
+    if (not writer.Close()) return detail::Error(err, "Error: fail to write: " + std::string(filename));
+    return true;
+}
+
+ECAD_INLINE UPtr<ELayerCutModel> ELayerCutModelBinaryIO::Read(std::string_view filename, std::string * err)
+{
+    EModelBinaryReader reader(filename);
+    if (not reader.isOpen() || reader.GetModelType() != EModelType::LayerCut) {
+        detail::Error(err, "Error: invalid layer cut model file: " + std::string(filename));
+        return nullptr;
+    }
+
+    auto model = std::make_unique<ELayerCutModel>();
+    EModelChunkReader chunk;
+    if (not reader.GetChunk(EModelChunk::Settings, 0, chunk, err)) return nullptr;
+    if (not ReadLayerCutSettings(chunk, model->m_settings)) {
+        detail::Error(err, "Error: corrupted settings chunk");
+        return nullptr;
+    }
+
+    //meta
+    {
+        if (not reader.GetChunk(EModelChunk::Meta, 0, chunk, err)) return nullptr;
+        std::vector<int32_t> nets, materials;
+        std::vector<ELayerCutModel::Height> ranges, heights;
+        std::vector<std::vector<EPoint2D> > steinerPoints;
+        std::vector<size_t> indices, layers, lists, offsets, polygons;
+        chunk.Read(model->m_vScale2Int);
+        chunk.ReadArray(nets);
+        chunk.ReadArray(materials);
+        chunk.ReadArray(ranges);
+        bool valid = detail::ReadPoints(chunk, steinerPoints) && 1 == steinerPoints.size();
+        chunk.ReadArray(heights);
+        chunk.ReadArray(indices);
+        chunk.ReadArray(model->m_layerOrder);
+        chunk.ReadArray(layers);
+        chunk.ReadArray(lists);
+        chunk.ReadArray(offsets);
+        chunk.ReadArray(polygons);
+        valid = valid && chunk.isValid() && 0 == ranges.size() % 2 && heights.size() == indices.size() &&
+                layers.size() == lists.size() && not offsets.empty() && offsets.back() == polygons.size();
+        if (not valid) {
+            detail::Error(err, "Error: corrupted meta chunk");
+            return nullptr;
+        }
+
+        model->m_nets.reserve(nets.size());
+        for (auto net : nets) model->m_nets.emplace_back(ENetId(net));
+        model->m_materials.reserve(materials.size());
+        for (auto material : materials) model->m_materials.emplace_back(EMaterialId(material));
+        model->m_ranges.reserve(ranges.size() / 2);
+        for (size_t i = 0; i < ranges.size(); i += 2)
+            model->m_ranges.emplace_back(ranges[i], ranges[i + 1]);
+        model->m_steinerPoints = std::move(steinerPoints.front());
+        for (size_t i = 0; i < heights.size(); ++i)
+            model->m_height2Index.emplace(heights[i], indices[i]);
+
+        std::vector<SPtr<std::vector<size_t> > > rows(offsets.size() - 1);
+        for (size_t i = 0; i < rows.size(); ++i)
+            rows[i] = std::make_shared<std::vector<size_t> >(polygons.begin() + offsets[i], polygons.begin() + offsets[i + 1]);
+        for (size_t i = 0; i < layers.size(); ++i) {
+            if (lists[i] >= rows.size()) {
+                detail::Error(err, "Error: corrupted meta chunk");
+                return nullptr;
+            }
+            model->m_lyrPolygons.emplace(layers[i], rows[lists[i]]);
+        }
+    }
+
+    //polygons
+    {
+        if (not reader.GetChunk(EModelChunk::Polygons, 0, chunk, err)) return nullptr;
+        std::vector<std::vector<EPoint2D> > rows;
+        if (not detail::ReadPoints(chunk, rows)) {
+            detail::Error(err, "Error: corrupted polygon chunk");
+            return nullptr;
+        }
+        model->m_polygons.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i)
+            model->m_polygons[i].Set(std::move(rows[i]));
+    }
+
+    //bondwires
+    {
+        if (not reader.GetChunk(EModelChunk::Bondwires, 0, chunk, err)) return nullptr;
+        std::vector<int32_t> nets, materials;
+        std::vector<EFloat> radius, currents, heights;
+        std::vector<size_t> scenarios, offsets;
+        std::vector<std::vector<EPoint2D> > pt2ds;
+        chunk.ReadArray(nets); chunk.ReadArray(materials);
+        chunk.ReadArray(radius); chunk.ReadArray(currents);
+        chunk.ReadArray(scenarios); chunk.ReadArray(offsets); chunk.ReadArray(heights);
+        auto size = nets.size();
+        if (not detail::ReadPoints(chunk, pt2ds) || materials.size() != size || radius.size() != size || currents.size() != size ||
+            scenarios.size() != size || offsets.size() != size + 1 || offsets.back() != heights.size() || pt2ds.size() != size) {
+            detail::Error(err, "Error: corrupted bondwire chunk");
+            return nullptr;
+        }
+        model->m_bondwires.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            auto & bw = model->m_bondwires[i];
+            bw.netId = ENetId(nets[i]);
+            bw.matId = EMaterialId(materials[i]);
+            bw.radius = radius[i];
+            bw.current = currents[i];
+            bw.scenario = scenarios[i];
+            bw.heights.assign(heights.begin() + offsets[i], heights.begin() + offsets[i + 1]);
+            bw.pt2ds = std::move(pt2ds[i]);
+        }
+    }
+
+    //power blocks
+    {
+        std::vector<SPtr<ELookupTable1D> > luts;
+        if (not reader.GetChunk(EModelChunk::LookupTables, 0, chunk, err)) return nullptr;
+        if (not ReadLookupTables(chunk, luts)) {
+            detail::Error(err, "Error: corrupted lookup table chunk");
+            return nullptr;
+        }
+        if (not reader.GetChunk(EModelChunk::PowerBlocks, 0, chunk, err)) return nullptr;
+        std::vector<size_t> keys, polygons, scenarios, lutIndices;
+        std::vector<ELayerCutModel::Height> ranges;
+        chunk.ReadArray(keys); chunk.ReadArray(polygons); chunk.ReadArray(ranges);
+        chunk.ReadArray(scenarios); chunk.ReadArray(lutIndices);
+        auto size = keys.size();
+        if (not chunk.isValid() || polygons.size() != size || ranges.size() != size * 2 || scenarios.size() != size || lutIndices.size() != size) {
+            detail::Error(err, "Error: corrupted power block chunk");
+            return nullptr;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            SPtr<ELookupTable1D> lut{nullptr};
+            if (lutIndices[i] < luts.size()) lut = luts[lutIndices[i]];
+            else if (invalidIndex != lutIndices[i]) {
+                detail::Error(err, "Error: invalid lookup table index of power block " + std::to_string(keys[i]));
+                return nullptr;
+            }
+            ELayerCutModel::LayerRange range(ranges[i * 2], ranges[i * 2 + 1]);
+            model->m_powerBlocks.emplace(keys[i], ELayerCutModel::PowerBlock(polygons[i], range, scenarios[i], lut));
+        }
+    }
+    return model;
+}
+
+ECAD_INLINE bool ELayerCutModelBinaryIO::ReadPolygons(std::string_view filename, std::vector<EPolygonData> & polygons, std::string * err)
+{
+    EModelBinaryReader reader(filename);
+    if (not reader.isOpen()) return detail::Error(err, "Error: invalid model file: " + std::string(filename));
+
+    EModelChunkReader chunk;
+    if (not reader.GetChunk(EModelChunk::Polygons, 0, chunk, err)) return false;
+    std::vector<std::vector<EPoint2D> > rows;
+    if (not detail::ReadPoints(chunk, rows)) return detail::Error(err, "Error: corrupted polygon chunk");
+    polygons.resize(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i)
+        polygons[i].Set(std::move(rows[i]));
+    return true;
+}
+
+} // namespace ecad::model::io
@@ -0,0 +1,17 @@
+#pragma once
+#include "model/geometry/ELayerCutModel.h"
+
+namespace ecad::model::io {
+
+///native binary container of the layer cut model, see EModelBinaryFormat
+class ECAD_API ELayerCutModelBinaryIO
+{
+public:
+    static bool Write(std::string_view filename, const ELayerCutModel & model, std::string * err = nullptr);
+    static UPtr<ELayerCutModel> Read(std::string_view filename, std::string * err = nullptr);
+
+    ///reads the polygons only
+    static bool ReadPolygons(std::string_view filename, std::vector<EPolygonData> & polygons, std::string * err = nullptr);
+};
+
+} // namespace ecad::model::io
@@ -1,12 +1,18 @@
 #include "ELayerCutModelQuery.h"
 #include "model/geometry/ELayerCutModel.h"
 
+#include "generic/thread/ThreadPool.hpp"
+
 namespace ecad {
 namespace model {
 namespace utils {
 ECAD_INLINE ELayerCutModelQuery::ELayerCutModelQuery(CPtr<ELayerCutModel> model)
  : m_model(model)
 {
+    m_areas.reserve(m_model->m_polygons.size());
+    for (const auto & polygon : m_model->m_polygons)
+        m_areas.emplace_back(polygon.Area());
+
     const auto & layerPolygons = m_model->m_lyrPolygons;
     for (size_t lyr = 0; lyr < m_model->TotalLayers(); ++lyr) {
         if (lyr > 0 && layerPolygons.at(lyr) == layerPolygons.at(lyr - 1))
@@ -22,21 +28,49 @@ ECAD_INLINE ELayerCutModelQuery::ELayerCutModelQuery(CPtr<ELayerCutModel> model)
 }
 
 ECAD_INLINE size_t ELayerCutModelQuery::SearchPolygon(size_t layer, const EPoint2D & pt) const
+{
+    std::vector<RtVal> buffer;
+    return SearchPolygon(layer, pt, buffer);
+}
+
+ECAD_INLINE void ELayerCutModelQuery::SearchPolygons(size_t layer, const std::vector<EPoint2D> & pts, std::vector<size_t> & results, size_t threads) const
+{
+    results.assign(pts.size(), invalidIndex);
+    if (not m_model->hasPolygon(layer)) return;
+
+    //the rtree is read only here, so the chunks share it without locking
+    threads = std::max<size_t>(1, std::min(threads, pts.size() / 1024));
+    if (threads > 1) {
+        size_t chunk = (pts.size() + threads * 4 - 1) / (threads * 4);
+        generic::thread::ThreadPool pool(threads);
+        for (size_t start = 0; start < pts.size(); start += chunk)
+            pool.Submit(std::bind(&ELayerCutModelQuery::SearchPolygonsInRange, this, layer, std::ref(pts), std::ref(results), start, std::min(start + chunk, pts.size())));
+    }
+    else SearchPolygonsInRange(layer, pts, results, 0, pts.size());
+}
+
+ECAD_INLINE size_t ELayerCutModelQuery::SearchPolygon(size_t layer, const EPoint2D & pt, std::vector<RtVal> & buffer) const
 {
     if (not m_model->hasPolygon(layer)) return invalidIndex;
 
-    std::vector<RtVal> results;
-    m_rtrees.at(layer)->query(boost::geometry::index::intersects(EBox2D(pt, pt)), std::back_inserter(results));
-    if (results.empty()) return invalidIndex;
+    buffer.clear();
+    m_rtrees.at(layer)->query(boost::geometry::index::intersects(EBox2D(pt, pt)), std::back_inserter(buffer));
+    //the smallest polygon that contains the point
+    size_t pid = invalidIndex;
     const auto & polygons = m_model->m_polygons;
-    auto cmp = [&](auto i1, auto i2){ return polygons.at(i1).Area() > polygons.at(i2).Area(); };
-    std::priority_queue<size_t, std::vector<size_t>, decltype(cmp)> pq(cmp);
-    for (const auto & result : results) {
+    for (const auto & result : buffer) {
+        if (pid != invalidIndex && not (m_areas.at(result.second) < m_areas.at(pid))) continue;
         if (generic::geometry::Contains(polygons.at(result.second), pt))
-            pq.emplace(result.second);
+            pid = result.second;
     }
-    if (not pq.empty()) return pq.top();
-    return invalidIndex;
+    return pid;
+}
+
+ECAD_INLINE void ELayerCutModelQuery::SearchPolygonsInRange(size_t layer, const std::vector<EPoint2D> & pts, std::vector<size_t> & results, size_t start, size_t end) const
+{
+    std::vector<RtVal> buffer;
+    for (size_t i = start; i < end; ++i)
+        results[i] = SearchPolygon(layer, pts.at(i), buffer);
 }
 
 }//namespace utils
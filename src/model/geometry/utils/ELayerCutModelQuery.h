@@ -16,9 +16,17 @@ public:
     virtual ~ELayerCutModelQuery() = default;
 
     size_t SearchPolygon(size_t layer, const EPoint2D & pt) const;
+    ///batched search of one layer, results[i] is the polygon of pts[i] or invalidIndex, the points are searched in parallel chunks
+    void SearchPolygons(size_t layer, const std::vector<EPoint2D> & pts, std::vector<size_t> & results, size_t threads = 1) const;
+    EFloat GetPolygonArea(size_t pid) const { return m_areas.at(pid); }
     
+protected:
+    size_t SearchPolygon(size_t layer, const EPoint2D & pt, std::vector<RtVal> & buffer) const;
+    void SearchPolygonsInRange(size_t layer, const std::vector<EPoint2D> & pts, std::vector<size_t> & results, size_t start, size_t end) const;
+
 protected:
     CPtr<ELayerCutModel> m_model{nullptr};
+    std::vector<EFloat> m_areas;
     mutable std::unordered_map<size_t, std::shared_ptr<Rtree> > m_rtrees;
 };
 } // namespace utils
@@ -0,0 +1,275 @@
+#include "EModelBinaryFormat.h"
+#include "extension/EMappedFile.h"
+#include "basic/ELookupTable.h"
+#include "basic/ECadSettings.h"
+
+#include "generic/tools/FileSystem.hpp"
+namespace ecad::model::io {
+
+namespace detail {
+inline static constexpr char MAGIC[8] = {'E', 'C', 'A', 'D', 'M', 'D', 'L', '\0'};
+inline static constexpr uint32_t FORMAT_VERSION = 1;
+
+struct Header
+{
+    char magic[8];
+    uint32_t format;
+    uint32_t version;
+    int32_t modelType;
+    uint32_t reserved;
+    uint64_t tableOffset;
+    uint64_t chunks;
+};
+
+struct TableEntry
+{
+    uint32_t tag;
+    uint32_t reserved;
+    uint64_t index, offset, size, checksum;
+};
+
+ECAD_ALWAYS_INLINE uint64_t AlignUp(uint64_t size)
+{
+    return (size + 7) & ~uint64_t(7);
+}
+}//namespace detail
+
+ECAD_INLINE void EModelChunkWriter::WriteString(std::string_view str)
+{
+    WriteArray(str.data(), str.size());
+}
+
+ECAD_INLINE void EModelChunkWriter::Align()
+{
+    m_data.resize(detail::AlignUp(m_data.size()), '\0');
+}
+
+ECAD_INLINE bool EModelChunkReader::ReadString(std::string & str)
+{
+    const char * data{nullptr};
+    size_t size{0};
+    if (not ViewArray(data, size)) return false;
+    str.assign(data, size);
+    return true;
+}
+
+ECAD_INLINE bool EModelChunkReader::Skip(size_t size)
+{
+    if (not m_valid || m_pos + size > m_data.size()) return m_valid = false;
+    m_pos += size;
+    return true;
+}
+
+ECAD_INLINE void EModelChunkReader::Align()
+{
+    m_pos = std::min<size_t>(detail::AlignUp(m_pos), m_data.size());
+}
+
+ECAD_INLINE EModelBinaryWriter::EModelBinaryWriter(std::string_view filename, EModelType type)
+ : m_type(type)
+{
+    auto dir = fs::DirName(filename);
+    if (not dir.empty() && not fs::CreateDir(dir)) return;
+    m_out.open(filename.data(), std::ios::binary | std::ios::trunc);
+    if (not m_out.is_open()) return;
+
+    //the table offset is patched on close
+    detail::Header header{};
+    m_out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    m_offset = sizeof(header);
+}
+
+ECAD_INLINE EModelBinaryWriter::~EModelBinaryWriter()
+{
+    Close();
+}
+
+ECAD_INLINE bool EModelBinaryWriter::AddChunk(EModelChunk tag, size_t index, const EModelChunkWriter & chunk)
+{
+    if (not m_out.is_open()) return false;
+    const auto & data = chunk.Data();
+    Entry entry{static_cast<uint32_t>(tag), 0, index, m_offset, data.size(), EModelBinaryReader::Checksum(data.data(), data.size())};
+    m_out.write(data.data(), data.size());
+    auto padding = detail::AlignUp(data.size()) - data.size();
+    for (size_t i = 0; i < padding; ++i) m_out.put('\0');
+    m_offset += data.size() + padding;
+    m_entries.emplace_back(std::move(entry));
+    return m_out.good();
+}
+
+ECAD_INLINE bool EModelBinaryWriter::Close()
+{
+    if (not m_out.is_open()) return false;
+    for (const auto & entry : m_entries) {
+        detail::TableEntry e{entry.tag, 0, entry.index, entry.offset, entry.size, entry.checksum};
+        m_out.write(reinterpret_cast<const char *>(&e), sizeof(e));
+    }
+
+    detail::Header header{};
+    std::memcpy(header.magic, detail::MAGIC, sizeof(header.magic));
+    header.format = detail::FORMAT_VERSION;
+    header.version = toInt(CURRENT_VERSION);
+    header.modelType = static_cast<int32_t>(m_type);
+    header.tableOffset = m_offset;
+    header.chunks = m_entries.size();
+    m_out.seekp(0);
+    m_out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    bool good = m_out.good();
+    m_out.close();
+    return good;
+}
+
+ECAD_INLINE EModelBinaryReader::EModelBinaryReader(std::string_view filename)
+{
+    m_file.reset(new ext::EMappedFile(filename));
+    if (not m_file->isOpen() || m_file->Size() < sizeof(detail::Header)) return;
+
+    detail::Header header;
+    std::memcpy(&header, m_file->Data(), sizeof(header));
+    if (std::memcmp(header.magic, detail::MAGIC, sizeof(header.magic)) != 0) return;
+    if (header.format != detail::FORMAT_VERSION || header.version != toInt(CURRENT_VERSION)) return;
+    if (header.tableOffset > m_file->Size() ||
+        header.chunks > (m_file->Size() - header.tableOffset) / sizeof(detail::TableEntry)) return;
+
+    auto table = m_file->Data() + header.tableOffset;
+    for (size_t i = 0; i < header.chunks; ++i) {
+        detail::TableEntry e;
+        std::memcpy(&e, table + i * sizeof(e), sizeof(e));
+        if (e.offset > header.tableOffset || e.size > header.tableOffset - e.offset) return;
+        m_entries.emplace(std::make_pair(e.tag, e.index), std::array<uint64_t, 3>{e.offset, e.size, e.checksum});
+    }
+    m_type = static_cast<EModelType>(header.modelType);
+    m_open = true;
+}
+
+ECAD_INLINE EModelBinaryReader::~EModelBinaryReader()
+{
+}
+
+ECAD_INLINE size_t EModelBinaryReader::Chunks(EModelChunk tag) const
+{
+    auto t = static_cast<uint32_t>(tag);
+    auto begin = m_entries.lower_bound(std::make_pair(t, uint64_t{0}));
+    auto end = m_entries.lower_bound(std::make_pair(t + 1, uint64_t{0}));
+    return std::distance(begin, end);
+}
+
+ECAD_INLINE bool EModelBinaryReader::hasChunk(EModelChunk tag, size_t index) const
+{
+    return m_entries.count(std::make_pair(static_cast<uint32_t>(tag), uint64_t(index)));
+}
+
+ECAD_INLINE bool EModelBinaryReader::GetChunk(EModelChunk tag, size_t index, EModelChunkReader & reader, std::string * err) const
+{
+    auto iter = m_entries.find(std::make_pair(static_cast<uint32_t>(tag), uint64_t(index)));
+    if (not m_open || iter == m_entries.cend()) {
+        if (err) *err = "Error: missing chunk " + std::to_string(static_cast<uint32_t>(tag)) + ":" + std::to_string(index);
+        return false;
+    }
+    const auto & [offset, size, checksum] = iter->second;
+    auto data = m_file->Data() + offset;
+    if (Checksum(data, size) != checksum) {
+        if (err) *err = "Error: checksum mismatch of chunk " + std::to_string(static_cast<uint32_t>(tag)) + ":" + std::to_string(index);
+        return false;
+    }
+    reader = EModelChunkReader(std::string_view(reinterpret_cast<const char *>(data), size));
+    return true;
+}
+
+ECAD_INLINE uint64_t EModelBinaryReader::Checksum(const void * data, size_t size)
+{
+    //FNV-1a over 8 byte words, the tail is hashed byte by byte
+    constexpr uint64_t prime = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull;
+    auto bytes = reinterpret_cast<const unsigned char *>(data);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i)
+        hash = (hash ^ bytes[i]) * prime;
+    return hash;
+}
+
+ECAD_INLINE void WriteLookupTables(EModelChunkWriter & chunk, const std::vector<CPtr<ELookupTable1D> > & luts)
+{
+    std::vector<uint64_t> offsets(1, 0);
+    std::vector<EFloat> keys, values;
+    for (auto lut : luts) {
+        auto table = const_cast<Ptr<ELookupTable1D>>(lut);
+        for (auto iter = table->begin(); iter != table->end(); ++iter) {
+            keys.emplace_back(iter->first);
+            values.emplace_back(iter->second);
+        }
+        offsets.emplace_back(keys.size());
+    }
+    chunk.WriteArray(offsets);
+    chunk.WriteArray(keys);
+    chunk.WriteArray(values);
+}
+
+ECAD_INLINE bool ReadLookupTables(EModelChunkReader & chunk, std::vector<SPtr<ELookupTable1D> > & luts)
+{
+    size_t size{0}, keySize{0}, valueSize{0};
+    const uint64_t * offsets{nullptr};
+    const EFloat * keys{nullptr}, * values{nullptr};
+    if (not chunk.ViewArray(offsets, size) || not chunk.ViewArray(keys, keySize) || not chunk.ViewArray(values, valueSize)) return false;
+    if (0 == size || keySize != valueSize || offsets[size - 1] != keySize) return false;
+
+    luts.clear();
+    luts.reserve(size - 1);
+    for (size_t i = 0; i + 1 < size; ++i) {
+        if (offsets[i] > offsets[i + 1]) return false;
+        auto lut = std::make_shared<ELookupTable1D>();
+        for (auto j = offsets[i]; j < offsets[i + 1]; ++j)
+            lut->AddSample(keys[j], values[j]);
+        luts.emplace_back(std::move(lut));
+    }
+    return true;
+}
+
+ECAD_INLINE void WriteBoxes(EModelChunkWriter & chunk, const std::vector<FBox2D> & boxes)
+{
+    std::vector<EFloat> coords;
+    coords.reserve(boxes.size() * 4);
+    for (const auto & box : boxes)
+        coords.insert(coords.end(), {box[0][0], box[0][1], box[1][0], box[1][1]});
+    chunk.WriteArray(coords);
+}
+
+ECAD_INLINE bool ReadBoxes(EModelChunkReader & chunk, std::vector<FBox2D> & boxes)
+{
+    std::vector<EFloat> coords;
+    if (not chunk.ReadArray(coords) || coords.size() % 4) return false;
+    boxes.clear();
+    for (size_t i = 0; i < coords.size(); i += 4)
+        boxes.emplace_back(FPoint2D(coords[i], coords[i + 1]), FPoint2D(coords[i + 2], coords[i + 3]));
+    return true;
+}
+
+ECAD_INLINE void WriteLayerCutSettings(EModelChunkWriter & chunk, const ELayerCutModelExtractionSettings & settings)
+{
+    chunk.Write<uint8_t>(settings.dumpSketchImg);
+    chunk.Write<uint8_t>(settings.addCircleCenterAsSteinerPoint);
+    chunk.Write<uint64_t>(settings.layerCutPrecision);
+    chunk.Write<EFloat>(settings.layerTransitionRatio);
+    WriteBoxes(chunk, settings.imprintBox);
+}
+
+ECAD_INLINE bool ReadLayerCutSettings(EModelChunkReader & chunk, ELayerCutModelExtractionSettings & settings)
+{
+    uint8_t dumpSketchImg{0}, addCircleCenterAsSteinerPoint{0};
+    uint64_t layerCutPrecision{0};
+    chunk.Read(dumpSketchImg);
+    chunk.Read(addCircleCenterAsSteinerPoint);
+    chunk.Read(layerCutPrecision);
+    chunk.Read(settings.layerTransitionRatio);
+    settings.dumpSketchImg = dumpSketchImg;
+    settings.addCircleCenterAsSteinerPoint = addCircleCenterAsSteinerPoint;
+    settings.layerCutPrecision = layerCutPrecision;
+    return ReadBoxes(chunk, settings.imprintBox) && chunk.isValid();
+}
+
+}//namespace ecad::model::io
@@ -0,0 +1,205 @@
+#pragma once
+#include "basic/ECadCommon.h"
+#include <string_view>
+#include <cstring>
+#include <fstream>
+#include <array>
+#include <map>
+namespace ecad {
+class ELookupTable1D;
+struct ELayerCutModelExtractionSettings;
+namespace ext { class EMappedFile; }
+namespace model::io {
+
+/**
+ * @brief native container of the large models, a fixed header, the chunk payloads and a chunk table at the end,
+ *        every chunk is 8 bytes aligned and has its own checksum, so a reader maps the file and only touches the chunks it asks for
+ */
+enum class EModelChunk : uint32_t
+{
+    Meta = 1,
+    LookupTables = 3,
+    Points = 4,
+    Layer = 5,//one chunk per layer, the index is the layer index
+    Prisms = 6,
+    Contacts = 7,//index 0 top, 1 bot
+    Lines = 8,
+    Polygons = 9,
+    Bondwires = 10,
+    PowerBlocks = 11,
+    PrismTemplates = 12,//one chunk per distinct template, the index is the template index
+    Settings = 13,
+};
+
+///append only payload of one chunk, arrays are 8 bytes aligned so that they can be viewed in place
+class ECAD_API EModelChunkWriter
+{
+public:
+    template <typename T>
+    void Write(const T & value);
+
+    template <typename T>
+    void WriteArray(const T * data, size_t size);
+
+    template <typename T>
+    void WriteArray(const std::vector<T> & data) { WriteArray(data.data(), data.size()); }
+
+    void WriteString(std::string_view str);
+
+    const std::string & Data() const { return m_data; }
+    std::string & Data() { return m_data; }
+
+private:
+    void Align();
+    std::string m_data;
+};
+
+class ECAD_API EModelChunkReader
+{
+public:
+    EModelChunkReader() = default;
+    explicit EModelChunkReader(std::string_view data) : m_data(data) {}
+
+    ///false once a read ran past the end of the chunk
+    bool isValid() const { return m_valid; }
+
+    template <typename T>
+    bool Read(T & value);
+
+    template <typename T>
+    bool ReadArray(std::vector<T> & data);
+
+    ///zero copy, the data is valid as long as the reader that produced the chunk
+    template <typename T>
+    bool ViewArray(const T * & data, size_t & size);
+
+    bool ReadString(std::string & str);
+    std::string_view Data() const { return m_data; }
+
+private:
+    bool Skip(size_t size);
+    void Align();
+
+private:
+    std::string_view m_data;
+    size_t m_pos{0};
+    bool m_valid{true};
+};
+
+class ECAD_API EModelBinaryWriter
+{
+public:
+    explicit EModelBinaryWriter(std::string_view filename, EModelType type);
+    ~EModelBinaryWriter();
+
+    bool isOpen() const { return m_out.is_open(); }
+    bool AddChunk(EModelChunk tag, size_t index, const EModelChunkWriter & chunk);
+    ///writes the chunk table, nothing can be added afterwards
+    bool Close();
+
+private:
+    struct Entry { uint32_t tag; uint32_t reserved; uint64_t index, offset, size, checksum; };
+    std::ofstream m_out;
+    uint64_t m_offset{0};
+    std::vector<Entry> m_entries;
+    EModelType m_type;
+};
+
+class ECAD_API EModelBinaryReader
+{
+public:
+    explicit EModelBinaryReader(std::string_view filename);
+    ~EModelBinaryReader();
+
+    bool isOpen() const { return m_open; }
+    EModelType GetModelType() const { return m_type; }
+    size_t Chunks(EModelChunk tag) const;
+    bool hasChunk(EModelChunk tag, size_t index = 0) const;
+    ///the checksum is verified for each access, returns false if the chunk is missing or corrupted
+    bool GetChunk(EModelChunk tag, size_t index, EModelChunkReader & reader, std::string * err = nullptr) const;
+
+    static uint64_t Checksum(const void * data, size_t size);
+
+private:
+    bool m_open{false};
+    UPtr<ext::EMappedFile> m_file;
+    EModelType m_type{EModelType::Invalid};
+    std::map<std::pair<uint32_t, uint64_t>, std::array<uint64_t, 3> > m_entries;//[tag, index] -> [offset, size, checksum]
+};
+
+namespace detail {
+ECAD_ALWAYS_INLINE bool Error(std::string * err, std::string msg)
+{
+    if (err) *err = std::move(msg);
+    return false;
+}
+}//namespace detail
+
+///lookup tables are stored as [offsets, keys, values]
+ECAD_API void WriteLookupTables(EModelChunkWriter & chunk, const std::vector<CPtr<ELookupTable1D> > & luts);
+ECAD_API bool ReadLookupTables(EModelChunkReader & chunk, std::vector<SPtr<ELookupTable1D> > & luts);
+
+///boxes are stored as [llx, lly, urx, ury]
+ECAD_API void WriteBoxes(EModelChunkWriter & chunk, const std::vector<FBox2D> & boxes);
+ECAD_API bool ReadBoxes(EModelChunkReader & chunk, std::vector<FBox2D> & boxes);
+
+///layer cut settings field by field, booleans are stored as bytes
+ECAD_API void WriteLayerCutSettings(EModelChunkWriter & chunk, const ELayerCutModelExtractionSettings & settings);
+ECAD_API bool ReadLayerCutSettings(EModelChunkReader & chunk, ELayerCutModelExtractionSettings & settings);
+
+template <typename T>
+ECAD_ALWAYS_INLINE void EModelChunkWriter::Write(const T & value)
+{
+    static_assert(std::is_trivially_copyable<T>::value);
+    m_data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+ECAD_ALWAYS_INLINE void EModelChunkWriter::WriteArray(const T * data, size_t size)
+{
+    static_assert(std::is_trivially_copyable<T>::value);
+    Write<uint64_t>(size);
+    Write<uint64_t>(sizeof(T));
+    Align();
+    m_data.append(reinterpret_cast<const char *>(data), size * sizeof(T));
+    Align();
+}
+
+template <typename T>
+ECAD_ALWAYS_INLINE bool EModelChunkReader::Read(T & value)
+{
+    static_assert(std::is_trivially_copyable<T>::value);
+    if (not Skip(sizeof(T))) return false;
+    std::memcpy(&value, m_data.data() + m_pos - sizeof(T), sizeof(T));
+    return true;
+}
+
+template <typename T>
+ECAD_ALWAYS_INLINE bool EModelChunkReader::ReadArray(std::vector<T> & data)
+{
+    const T * view{nullptr};
+    size_t size{0};
+    if (not ViewArray(view, size)) return false;
+    data.resize(size);
+    if (size) std::memcpy(data.data(), view, size * sizeof(T));
+    return true;
+}
+
+template <typename T>
+ECAD_ALWAYS_INLINE bool EModelChunkReader::ViewArray(const T * & data, size_t & size)
+{
+    static_assert(std::is_trivially_copyable<T>::value);
+    uint64_t count{0}, bytes{0};
+    if (not Read(count) || not Read(bytes)) return false;
+    if (bytes != sizeof(T)) return m_valid = false;
+    Align();
+    auto begin = m_pos;
+    if (count > (m_data.size() - std::min(m_pos, m_data.size())) / sizeof(T) || not Skip(count * sizeof(T))) return m_valid = false;
+    data = reinterpret_cast<const T *>(m_data.data() + begin);
+    size = count;
+    Align();
+    return true;
+}
+
+}//namespace model::io
+}//namespace ecad
@@ -294,6 +294,7 @@ ECAD_INLINE bool EGridThermalModel::SetResolution(EFloat x, EFloat y)
 {
     if(math::LT<EFloat>(x, 0) || math::LT<FCoord>(y, 0)) return false;
     m_resolution = std::array<FCoord, 2>{x, y};
+    ReleaseSolverCache();
     return true;
 }
 
@@ -323,12 +324,14 @@ ECAD_INLINE size_t EGridThermalModel::AppendLayer(EGridThermalLayer layer)
         layer.SetTopLayer(botLayer.GetName());
     }
     m_stackupLayers.emplace_back(std::move(layer));
+    ReleaseSolverCache();
     return m_stackupLayers.size() - 1;
 }
 
 ECAD_INLINE void EGridThermalModel::AppendJumpConnection(ESize3D start, ESize3D end, EFloat alpha)
 {
     m_jumpConnects.emplace_back(std::move(start), std::move(end), alpha);
+    ReleaseSolverCache();
 }
 
 ECAD_INLINE const std::vector<std::tuple<ESize3D, ESize3D, EFloat> > & EGridThermalModel::GetJumpConnections() const
@@ -89,18 +89,14 @@ ECAD_INLINE void EPrismThermalModel::BuildPrismModel(EFloat scaleH2Unit, EFloat
 {
     m_scaleH2Unit = scaleH2Unit;
     m_scale2Meter = scale2Meter;
+    ReleaseSolverCache();
     m_indexOffset = std::vector<size_t>{0};
     for (size_t i = 0; i < TotalLayers(); ++i)
         m_indexOffset.emplace_back(m_indexOffset.back() + layers.at(i).TotalElements());
     
+    //one point plane per layer interface indexed by the template vertex, the bottom plane of a layer is the top plane of the next one
     const auto & triangles = m_prismTemplates.at(0)->triangles;
-    std::unordered_map<size_t, std::unordered_map<size_t, size_t> > templateIdMap;
-    auto getPtIdxMap = [&templateIdMap](size_t lyrIdx) -> std::unordered_map<size_t, size_t> & {
-        auto iter = templateIdMap.find(lyrIdx);
-        if (iter == templateIdMap.cend())
-            iter = templateIdMap.emplace(lyrIdx, std::unordered_map<size_t, size_t>{}).first;
-        return iter->second;
-    };
+    std::vector<std::vector<size_t> > planes(TotalLayers() + 1, std::vector<size_t>(m_prismTemplates.at(0)->points.size(), invalidIndex));
     
     auto total = TotalPrismElements();
     m_points.clear();
@@ -111,22 +107,16 @@ ECAD_INLINE void EPrismThermalModel::BuildPrismModel(EFloat scaleH2Unit, EFloat
         auto & instance = m_prisms.emplace_back(lyrIdx, eleIdx);
  
         //points
-        auto & topPtIdxMap = getPtIdxMap(lyrIdx);
-        auto & botPtIdxMap = getPtIdxMap(lyrIdx + 1);
+        auto & topPlane = planes[lyrIdx];
+        auto & botPlane = planes[lyrIdx + 1];
         const auto & vertices = triangles.at(element.templateId).vertices;
         for (size_t v = 0; v < vertices.size(); ++v) {
-            auto topVtxIter = topPtIdxMap.find(vertices.at(v));
-            if (topVtxIter == topPtIdxMap.cend()) {
-                auto ptIdx = AddPoint(GetPoint(lyrIdx, eleIdx, v));
-                topVtxIter = topPtIdxMap.emplace(vertices.at(v), ptIdx).first;
-            }
-            instance.vertices[v] = topVtxIter->second;
-            auto botVtxIter = botPtIdxMap.find(vertices.at(v));
-            if (botVtxIter == botPtIdxMap.cend()) {
-                auto ptIdx = AddPoint(GetPoint(lyrIdx, eleIdx, v + 3));
-                botVtxIter = botPtIdxMap.emplace(vertices.at(v), ptIdx).first;
-            }
-            instance.vertices[v + 3] = botVtxIter->second;
+            auto & top = topPlane[vertices.at(v)];
+            if (invalidIndex == top) top = AddPoint(GetPoint(lyrIdx, eleIdx, v));
+            instance.vertices[v] = top;
+            auto & bot = botPlane[vertices.at(v)];
+            if (invalidIndex == bot) bot = AddPoint(GetPoint(lyrIdx, eleIdx, v + 3));
+            instance.vertices[v + 3] = bot;
         }
 
         //neighbors
@@ -151,6 +141,7 @@ ECAD_INLINE void EPrismThermalModel::BuildPrismModel(EFloat scaleH2Unit, EFloat
 
 ECAD_INLINE void EPrismThermalModel::AddBondWiresFromLayerCutModel(CPtr<ELayerCutModel> lcm)
 {
+    ReleaseSolverCache();
     utils::EPrismThermalModelQuery query(this);
     for (const auto & bondwire : lcm->GetAllBondwires()) {
         const auto & pts = bondwire.pt2ds;
@@ -184,6 +175,31 @@ ECAD_INLINE void EPrismThermalModel::AddBondWiresFromLayerCutModel(CPtr<ELayerCu
     }
 }
 
+ECAD_INLINE bool EPrismThermalModel::UpdateStackupThickness(EFloat elevation, EFloat thickness, EFloat newThickness)
+{
+    if (not (thickness > 0 && newThickness > 0)) return false;
+    if (generic::math::EQ<EFloat>(thickness, newThickness)) return true;
+
+    //heights above the stackup layer are kept, heights inside are scaled and heights below are shifted
+    auto low = elevation - thickness;
+    auto ratio = newThickness / thickness;
+    auto delta = newThickness - thickness;
+    auto update = [&](EFloat height) -> EFloat {
+        if (height >= elevation) return height;
+        if (height > low) return elevation - (elevation - height) * ratio;
+        return height - delta;
+    };
+
+    for (auto & layer : layers) {
+        auto bot = update(layer.elevation - layer.thickness);
+        layer.elevation = update(layer.elevation);
+        layer.thickness = layer.elevation - bot;
+    }
+    for (auto & point : m_points)
+        point[2] = update(point[2]);
+    return true;
+}
+
 size_t EPrismThermalModel::AddPoint(FPoint3D point)
 {
     m_points.emplace_back(std::move(point));
@@ -22,6 +22,7 @@ namespace model {
 
 class ELayerCutModel;
 namespace utils { class EPrismThermalModelQuery; }
+namespace io { class EPrismThermalModelBinaryIO; }
 
 struct ECAD_API LineElement
 {
@@ -168,6 +169,7 @@ protected:
     EPrismThermalModel();
 public:
     friend class utils::EPrismThermalModelQuery;
+    friend class io::EPrismThermalModelBinaryIO;
     using BlockBC = std::pair<EBox2D, EThermalBoundaryCondition>;
     using PrismTemplate = tri::Triangulation<EPoint2D>;
     
@@ -178,6 +180,8 @@ public:
     SPtr<PrismTemplate> GetLayerPrismTemplate(size_t layer) const;
 
     CPtr<IMaterialDefCollection> GetMaterialLibrary() const;
+    CPtr<ILayoutView> GetLayoutView() const { return m_layout; }
+    void SetLayoutView(CPtr<ILayoutView> layout) { m_layout = layout; }
 
     void AddBlockBC(EOrientation orient, EBox2D block, EThermalBoundaryCondition bc);
     const std::vector<BlockBC> & GetBlockBCs(EOrientation orient) const { return m_blockBCs.at(orient); }
@@ -187,6 +191,8 @@ public:
 
     void BuildPrismModel(EFloat scaleH2Unit, EFloat scale2Meter);
     void AddBondWiresFromLayerCutModel(CPtr<ELayerCutModel> lcm);
+    ///changes the stackup range [elevation - thickness, elevation] to newThickness in place, the mesh topology is kept
+    bool UpdateStackupThickness(EFloat elevation, EFloat thickness, EFloat newThickness);
     EFloat CoordScale2Meter(int order = 1) const;
     EFloat UnitScale2Meter(int order = 1) const;  
     size_t TotalLayers() const;
@@ -12,6 +12,7 @@ namespace utils {
 class EStackupPrismThermalModelQuery;
 class EStackupPrismThermalModelBuilder;
 }
+namespace io { class EPrismThermalModelBinaryIO; }
 
 class ECAD_API EStackupPrismThermalModel : public EPrismThermalModel
 {
@@ -20,6 +21,7 @@ class ECAD_API EStackupPrismThermalModel : public EPrismThermalModel
 public:
     friend class utils::EStackupPrismThermalModelQuery;
     friend class utils::EStackupPrismThermalModelBuilder;
+    friend class io::EPrismThermalModelBinaryIO;
     explicit EStackupPrismThermalModel(CPtr<ILayoutView> layout, EPrismThermalModelExtractionSettings settings);
     virtual ~EStackupPrismThermalModel() = default;
     void SearchElementIndices(const std::vector<FPoint3D> & monitors, std::vector<size_t> & indices) const override;
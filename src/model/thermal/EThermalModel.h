@@ -2,6 +2,8 @@
 #include "basic/ECadCommon.h"
 #include "interface/IModel.h"
 #include "utility/EMetalFractionMapping.h"
+#include <typeindex>
+#include <mutex>
 
 namespace boost::math::interpolators {
 template <class RandomAccessContainer> class pchip;
@@ -16,6 +18,46 @@ namespace model {
 
 using namespace generic::geometry;
 
+/**
+ * @brief static solver kept between simulations of a model, typed by the solver class,
+ *        a simulation takes the solver out and keeps it back when done, so concurrent simulations never share one
+ */
+class ECAD_API EThermalSolverCache
+{
+public:
+    EThermalSolverCache() = default;
+    EThermalSolverCache(const EThermalSolverCache &) {}//a copied model starts without solver
+    EThermalSolverCache & operator= (const EThermalSolverCache &) { Release(); return *this; }
+
+    ///nullptr if there is no solver of this type
+    template <typename Solver>
+    SPtr<Solver> Take()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (nullptr == m_solver || m_type != std::type_index(typeid(Solver))) return nullptr;
+        return std::static_pointer_cast<Solver>(std::exchange(m_solver, nullptr));
+    }
+
+    template <typename Solver>
+    void Keep(SPtr<Solver> solver)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_type = std::type_index(typeid(Solver));
+        m_solver = std::move(solver);
+    }
+
+    void Release()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_solver.reset();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::type_index m_type{typeid(void)};
+    SPtr<void> m_solver{nullptr};
+};
+
 class ECAD_API EThermalModel : public IModel
 {
     ECAD_SERIALIZATION_FUNCTIONS_DECLARATION
@@ -27,8 +69,14 @@ public:
 
     virtual void SearchElementIndices(const std::vector<FPoint3D> & monitors, std::vector<size_t> & indices) const {};
 
+    ///static solver kept between simulations of this model, its symbolic analysis is reused while the network pattern is unchanged,
+    ///the solver is released once the network structure of the model changes
+    EThermalSolverCache & GetSolverCache() const { return m_solverCache; }
+    void ReleaseSolverCache() { m_solverCache.Release(); }
+
 protected:
     std::unordered_map<EOrientation, EThermalBoundaryCondition> m_uniformBC;
+    mutable EThermalSolverCache m_solverCache;//not serialized
 };
 
 using EGridData = OccupancyGridMap<EFloat>;
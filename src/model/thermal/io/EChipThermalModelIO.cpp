@@ -1,8 +1,15 @@
 #include "model/thermal/io/EChipThermalModelIO.h"
+#include "utility/ETarGzArchive.h"
+#include "EDataMgr.h"
 
+#include "generic/thread/ThreadPool.hpp"
 #include "generic/tools/StringHelper.hpp"
 #include "generic/tools/FileSystem.hpp"
 #include "generic/tools/Format.hpp"
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
 
 namespace ecad {
 namespace model {
@@ -12,11 +19,42 @@ using namespace generic::str;
 using namespace generic::fmt;
 using namespace generic::fs;
 
+namespace detail {
+ECAD_INLINE void DecodeCTMv1Power(std::string_view data, EGridData & powers, std::string & err)
+{
+    ParseCTMv1Power(data, powers, &err);
+}
+
+ECAD_INLINE void EncodeCTMv1Power(const EGridData & powers, std::string & data)
+{
+    data = WriteCTMv1Power(powers);
+}
+
+ECAD_INLINE std::string CTMv1PowerFileName(size_t index)
+{
+    return Fmt2Str("power_T[%1%].ctm", index + 1);
+}
+}//namespace detail
+
 ECAD_API UPtr<EChipThermalModelV1> makeChipThermalModelFromCTMv1File(std::string_view filename, std::string * err)
 {
     using namespace detail;
-    auto dir = UntarCTMv1File(filename, err);
-    if(dir.empty()) {
+    //the entries are parsed straight from the archive, no temp folder is created
+    utils::ETarGzReader reader(filename);
+    if (not reader.isOpen()) {
+        if(err) *err = Fmt2Str("Error: failed to open the file %1%", filename);
+        return nullptr;
+    }
+
+    std::string name, data, header, density;
+    std::unordered_map<std::string, std::string> powerData;
+    while (reader.Next(name, data)) {
+        auto base = name.substr(name.find_last_of('/') + 1);
+        if (base == "CTM_header.txt") header = std::move(data);
+        else if (base == "metal_density.ctm") density = std::move(data);
+        else if (StartsWith(base, "power_T[")) powerData.emplace(std::move(base), std::move(data));
+    }
+    if (not reader.isGood()) {
         if(err) *err = Fmt2Str("Error: failed to unarchive the file %1%", filename);
         return nullptr;
     }
@@ -24,65 +62,85 @@ ECAD_API UPtr<EChipThermalModelV1> makeChipThermalModelFromCTMv1File(std::string
     auto model = std::make_unique<EChipThermalModelV1>();
 
     //header
-    auto headerFile = dir + GENERIC_FOLDER_SEPS + "CTM_header.txt";
-    if(!ParseCTMv1HeaderFile(headerFile, model->header, err)) return nullptr;
+    std::istringstream headerStream(header);
+    if(!ParseCTMv1Header(headerStream, "CTM_header.txt", model->header, err)) return nullptr;
     
-    //power
+    //power, the tables of different temperatures are decoded in parallel
     auto tiles = model->header.tiles;
+    const auto & temperatures = model->header.temperatures;
+    std::vector<std::string_view> powerViews(temperatures.size());
+    for(size_t i = 0; i < temperatures.size(); ++i) {
+        auto iter = powerData.find(CTMv1PowerFileName(i));
+        if (iter == powerData.cend()) {
+            if(err) *err = Fmt2Str("Error: missing %1% in %2%", CTMv1PowerFileName(i), filename);
+            return nullptr;
+        }
+        powerViews[i] = iter->second;
+    }
+    std::vector<std::string> powerErrs(temperatures.size());
+    std::vector<EGridData> powers(temperatures.size(), EGridData(tiles.x, tiles.y));
+    if (auto threads = std::min(EDataMgr::Instance().Threads(), temperatures.size()); threads > 1) {
+        generic::thread::ThreadPool pool(threads);
+        for (size_t i = 0; i < temperatures.size(); ++i)
+            pool.Submit(std::bind(&DecodeCTMv1Power, powerViews.at(i), std::ref(powers.at(i)), std::ref(powerErrs.at(i))));
+    }
+    else {
+        for (size_t i = 0; i < temperatures.size(); ++i)
+            DecodeCTMv1Power(powerViews.at(i), powers.at(i), powerErrs.at(i));
+    }
     model->powers = std::make_shared<EGridPowerModel>(tiles);
-    for(size_t i = 0; i < model->header.temperatures.size(); ++i) {
-        auto temperature = model->header.temperatures.at(i);
-        auto powerFile = dir + GENERIC_FOLDER_SEPS + Fmt2Str("power_T[%1%].ctm", i + 1);
-        EGridData powers(tiles.x, tiles.y);
-        if(!ParseCTMv1PowerFile(powerFile, powers, err)) return nullptr;
-        model->powers->GetTable().AddSample(temperature, std::move(powers));
+    for(size_t i = 0; i < temperatures.size(); ++i) {
+        if (not powerErrs.at(i).empty()) {
+            if(err) *err = powerErrs.at(i);
+            return nullptr;
+        }
+        model->powers->GetTable().AddSample(temperatures.at(i), std::move(powers[i]));
     }
 
     //density
-    std::vector<SPtr<EGridData> > density;
+    std::vector<SPtr<EGridData> > densities;
     for(size_t i = 0; i < model->header.layers.size(); ++i)
-        density.push_back(std::make_shared<EGridData>(tiles.x, tiles.y));
-    auto densityFile = dir + GENERIC_FOLDER_SEPS + "metal_density.ctm";
-    if(!ParseCTMv1DensityFile(densityFile, tiles.x * tiles.y, density, err)) return nullptr;
+        densities.push_back(std::make_shared<EGridData>(tiles.x, tiles.y));
+    if(!ParseCTMv1Density(density, tiles.x * tiles.y, densities, err)) return nullptr;
     for(size_t i = 0; i < model->header.layers.size(); ++i)
-        model->densities.insert(std::make_pair(model->header.layers[i].name, density[i]));
+        model->densities.insert(std::make_pair(model->header.layers[i].name, densities[i]));
 
     return model;
 }
 
 ECAD_INLINE bool GenerateCTMv1FileFromChipThermalModelV1(const EChipThermalModelV1 & model, std::string_view dirName, std::string_view filename, std::string * err)
 {
-    auto ctmDir = std::string(dirName) + GENERIC_FOLDER_SEPS + std::string(filename);
-    if (not CreateDir(ctmDir)) {
-        if(err) *err = Fmt2Str("Error: unwritable folder: %1%.", ctmDir);
-        return false;
-    }
-    
     using namespace detail;
     if(model.header.temperatures.size() < 5) {
         if(err) *err = "Error: at least 5 temperature points needed in ctm header!";
         return false;
     }
 
-    //header
-    std::string headerFile = ctmDir + GENERIC_FOLDER_SEPS + "CTM_header.txt";
-    if(!WriteCTMv1HeaderFile(headerFile, model.header, err)) return false;
-
     //power
     if(!model.powers) {
         if(err) *err = "Error: missing power data in ctm model!";
         return false;
     }
-    const auto & powers = *(model.powers);
-    for(size_t i = 0; i < model.header.temperatures.size(); ++i) {
-        auto temperature = model.header.temperatures.at(i);
-        auto table = powers.GetTable().GetTable(temperature);
+    const auto & temperatures = model.header.temperatures;
+    std::vector<CPtr<EGridData> > tables;
+    for(size_t i = 0; i < temperatures.size(); ++i) {
+        auto temperature = temperatures.at(i);
+        auto table = model.powers->GetTable().GetTable(temperature);
         if(nullptr == table) {
             if(err) *err = Fmt2Str("Error: failed to get power table at temperature: %1%", temperature);
             return false;
         }
-        std::string powerFile = ctmDir + GENERIC_FOLDER_SEPS + Fmt2Str("power_T[%1%].ctm", i + 1);
-        if(!WriteCTMv1PowerFile(powerFile, *table, err)) return false;
+        tables.emplace_back(table);
+    }
+    std::vector<std::string> powers(tables.size());
+    if (auto threads = std::min(EDataMgr::Instance().Threads(), tables.size()); threads > 1) {
+        generic::thread::ThreadPool pool(threads);
+        for (size_t i = 0; i < tables.size(); ++i)
+            pool.Submit(std::bind(&EncodeCTMv1Power, std::cref(*tables.at(i)), std::ref(powers.at(i))));
+    }
+    else {
+        for (size_t i = 0; i < tables.size(); ++i)
+            EncodeCTMv1Power(*tables.at(i), powers.at(i));
     }
 
     //density
@@ -98,13 +156,26 @@ ECAD_INLINE bool GenerateCTMv1FileFromChipThermalModelV1(const EChipThermalModel
 
     FPoint2D rf = model.header.size[0];
     size_t size = model.header.tiles.x * model.header.tiles.y;
-    std::string densityFile = ctmDir + GENERIC_FOLDER_SEPS + "metal_density.ctm";
-    if(!WriteCTMv1DensityFile(densityFile, size, model.header.resolution, rf, density, err)) return false;
+    std::string densityData;
+    if(!WriteCTMv1Density(densityData, size, model.header.resolution, rf, density, err)) return false;
 
-    //make package
+    //make package, the entries are written straight into the archive
     std::string ctmFile = std::string(dirName) + GENERIC_FOLDER_SEPS + std::string(filename) + ".tar.gz";
-    if(!GenerateCTMv1Package(ctmDir, ctmFile, false, err)) return false;
-
+    utils::ETarGzWriter writer(ctmFile);
+    if (not writer.isOpen()) {
+        if(err) *err = Fmt2Str("Error: unwritable file: %1%.", ctmFile);
+        return false;
+    }
+    std::ostringstream header;
+    WriteCTMv1Header(header, model.header);
+    bool res = writer.Add("CTM_header.txt", header.str());
+    for(size_t i = 0; i < powers.size(); ++i)
+        res = res && writer.Add(CTMv1PowerFileName(i), powers.at(i));
+    res = res && writer.Add("metal_density.ctm", densityData);
+    if (not writer.Close() || not res) {
+        if(err) *err = Fmt2Str("Error: failed to generate ctm package: %1%.", ctmFile);
+        return false;
+    }
     return true;
 }
 
@@ -150,9 +221,31 @@ ECAD_INLINE std::string UntarCTMv1File(std::string_view filename, std::string *
     if (PathExists(untarDir)) RemoveDir(untarDir);
     CreateDir(untarDir);
 
-    std::string cmd = "tar -zxf" + std::string(filename) + " -C " + untarDir;
-    int res = std::system(cmd.c_str());
-    return res == 0 ? untarDir : std::string{};
+    //entries must stay inside the untar folder
+    auto isSafe = [](const std::filesystem::path & path) {
+        if (path.empty() || path == "." || path.is_absolute() || path.has_root_path()) return false;
+        return std::none_of(path.begin(), path.end(), [](const auto & item){ return item == ".."; });
+    };
+
+    bool good{true};
+    std::string name, data;
+    utils::ETarGzReader reader(filename);
+    while (reader.isOpen() && reader.Next(name, data)) {
+        auto entry = std::filesystem::path(name).lexically_normal();
+        if (not isSafe(entry)) { good = false; break; }
+        auto path = std::filesystem::path(untarDir) / entry;
+        if (not CreateDir(path.parent_path())) { good = false; break; }
+        std::ofstream out(path, std::ios::out | std::ios::binary);
+        out.write(data.data(), data.size());
+        out.close();
+        if (out.fail()) { good = false; break; }
+    }
+    if (not reader.isOpen() || not reader.isGood() || not good) {
+        if(err) *err = Fmt2Str("Error: failed to unarchive the file %1%", filename);
+        RemoveDir(untarDir);
+        return std::string{};
+    }
+    return untarDir;
 }
 
 ECAD_INLINE bool ParseCTMv1HeaderFile(std::string_view filename, ECTMv1Header & header, std::string * err)
@@ -162,7 +255,11 @@ ECAD_INLINE bool ParseCTMv1HeaderFile(std::string_view filename, ECTMv1Header &
         if(err) *err = Fmt2Str("Error: failed to open file %1%!", filename);
         return false;
     }
+    return ParseCTMv1Header(fp, filename, header, err);
+}
 
+ECAD_INLINE bool ParseCTMv1Header(std::istream & fp, std::string_view filename, ECTMv1Header & header, std::string * err)
+{
     auto decrypt = [err](const std::string & s, size_t len) {
         auto tmp = s;
         std::for_each(tmp.begin(), tmp.end(), [&](char & c){ c -= 3 * len + 22; });
@@ -326,8 +423,6 @@ ECAD_INLINE bool ParseCTMv1HeaderFile(std::string_view filename, ECTMv1Header &
             }
         }  
     }
-
-    fp.close();
     return true;
 }
 
@@ -338,12 +433,22 @@ ECAD_INLINE bool ParseCTMv1PowerFile(std::string_view filename, EGridData & powe
         if (err) *err = Fmt2Str("Error: failed to open file %1%!", filename);
         return false;
     }
+    std::string data((std::istreambuf_iterator<char>(fp)), std::istreambuf_iterator<char>());
+    return ParseCTMv1Power(data, powers, err);
+}
 
+ECAD_INLINE bool ParseCTMv1Power(std::string_view data, EGridData & powers, std::string * err)
+{
+    size_t size = std::min(powers.Size(), data.size() / sizeof(float));
+    if (size < powers.Size()) {
+        if (err) *err = Fmt2Str("Error: power data has %1% of %2% tiles!", size, powers.Size());
+        return false;
+    }
     float f;
-    size_t i = 0, size = powers.Size();
-    while(fp.read(reinterpret_cast<char*>(&f), sizeof(float)) && i < size) { powers[i++] = f; }
-    
-    fp.close();
+    for (size_t i = 0; i < size; ++i) {
+        std::memcpy(&f, data.data() + i * sizeof(float), sizeof(float));
+        powers[i] = f;
+    }
     return true;
 }
 
@@ -354,28 +459,26 @@ ECAD_API bool ParseCTMv1DensityFile(std::string_view filename, const size_t size
         if(err) *err = Fmt2Str("Error: failed to open file %1%!", filename);
         return false;
     }
+    std::string data((std::istreambuf_iterator<char>(fp)), std::istreambuf_iterator<char>());
+    return ParseCTMv1Density(data, size, density, err);
+}
 
-    int id;
+ECAD_INLINE bool ParseCTMv1Density(std::string_view data, const size_t size, std::vector<SPtr<EGridData> > & density, std::string * err)
+{
+    //id, 4 float number for tile box, density of all layers in LAYER section
+    const size_t record = sizeof(int) + sizeof(float) * (4 + density.size());
+    if (data.size() < record * size) {
+        if(err) *err = Fmt2Str("Error: metal density data has %1% of %2% tiles!", data.size() / record, size);
+        return false;
+    }
     float f;
-    size_t i = 0;
-    while(!fp.eof() && i < size) {
-        //id
-        fp.read(reinterpret_cast<char*>(&id), sizeof(int));
-
-        //4 float number for tile box
-        for(size_t j = 0; j < 4; ++j)
-            fp.read(reinterpret_cast<char*>(&f), sizeof(float));
-        
-        //density of all layers in LAYER section
-        for(size_t j = 0; j < density.size(); ++j) {
-            fp.read(reinterpret_cast<char*>(&f), sizeof(float));
+    for (size_t i = 0; i < size; ++i) {
+        auto p = data.data() + i * record + sizeof(int) + sizeof(float) * 4;
+        for (size_t j = 0; j < density.size(); ++j) {
+            std::memcpy(&f, p + j * sizeof(float), sizeof(float));
             (*density[j])[i] = f;
         }
-
-        i++;
     }
-
-    fp.close();
     return true;
 }
 
@@ -386,7 +489,12 @@ ECAD_INLINE bool WriteCTMv1HeaderFile(std::string_view filename, const ECTMv1Hea
         if(err) *err = Fmt2Str("Error: failed to open file: %1%.", filename);
         return false;
     }
+    WriteCTMv1Header(out, header);
+    return true;
+}
 
+ECAD_INLINE void WriteCTMv1Header(std::ostream & out, const ECTMv1Header & header)
+{
     auto encryptFunc = [](std::string s, size_t len) {
         std::for_each(s.begin(), s.end(), [&](char & c) {c += 3 * len + 22; });
         return s;
@@ -446,9 +554,6 @@ ECAD_INLINE bool WriteCTMv1HeaderFile(std::string_view filename, const ECTMv1Hea
         out << GENERIC_DEFAULT_EOL;
     }
     out << "}" << GENERIC_DEFAULT_EOL;
-
-    out.close();
-    return true;
 }
 
 ECAD_INLINE bool WriteCTMv1PowerFile(std::string_view filename, const EGridData & powers, std::string * err)
@@ -458,17 +563,39 @@ ECAD_INLINE bool WriteCTMv1PowerFile(std::string_view filename, const EGridData
         if(err) *err = Fmt2Str("Error: failed to open file: %1%.", filename);
         return false;
     }
+    auto data = WriteCTMv1Power(powers);
+    out.write(data.data(), data.size());
+    out.close();
+    return true;
+}
 
+ECAD_INLINE std::string WriteCTMv1Power(const EGridData & powers)
+{
     float temp;
+    std::string data(powers.Size() * sizeof(float), '\0');
     for(size_t i = 0; i < powers.Size(); ++i) {
         temp = powers[i];
-        out.write(reinterpret_cast<char*>(&temp), sizeof(float)); 
+        std::memcpy(data.data() + i * sizeof(float), &temp, sizeof(float));
     }
+    return data;
+}
+
+ECAD_INLINE bool WriteCTMv1DensityFile(std::string_view filename, const size_t size, EFloat res, const FPoint2D & ref, const std::vector<SPtr<EGridData> > & density, std::string * err)
+{
+    std::string data;
+    if (not WriteCTMv1Density(data, size, res, ref, density, err)) return false;
+
+    std::ofstream out(filename.data(), std::ios::out |std::ios::binary);
+    if (not out.is_open()) {
+        if (err) *err = Fmt2Str("Error: failed to open file: %1%.", filename);
+        return false;
+    }
+    out.write(data.data(), data.size());
     out.close();
     return true;
 }
 
-ECAD_INLINE bool WriteCTMv1DensityFile(std::string_view filename, const size_t size, EFloat res, const FPoint2D & ref, const std::vector<SPtr<EGridData> > & density, std::string * err)
+ECAD_INLINE bool WriteCTMv1Density(std::string & data, const size_t size, EFloat res, const FPoint2D & ref, const std::vector<SPtr<EGridData> > & density, std::string * err)
 {
     if (density.empty()) return false;
     for (const auto & layer : density) {
@@ -482,43 +609,51 @@ ECAD_INLINE bool WriteCTMv1DensityFile(std::string_view filename, const size_t s
         }
     } 
 
-    std::ofstream out(filename.data(), std::ios::out |std::ios::binary);
-    if (not out.is_open()) {
-        if (err) *err = Fmt2Str("Error: failed to open file: %1%.", filename);
-        return false;
-    }
+    auto append = [&data](const auto & value) {
+        data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
 
     int id = 0;
     float temp;
     auto nx = density.front()->Width();
     auto ny = density.front()->Height();
+    data.clear();
+    data.reserve(size * (sizeof(int) + sizeof(float) * (4 + density.size())));
     for (size_t x = 0; x < nx; ++x) {
         float x0 = ref[0] + x * res, x1 = x0 + res;
         for (size_t y = 0; y < ny; ++y) {
             id++;
             float y0 = ref[1] + y * res, y1 = y0 + res;
-            out.write(reinterpret_cast<char*>(&id), sizeof(int));
-            out.write(reinterpret_cast<char*>(&x0), sizeof(float));
-            out.write(reinterpret_cast<char*>(&y0), sizeof(float));
-            out.write(reinterpret_cast<char*>(&x1), sizeof(float));
-            out.write(reinterpret_cast<char*>(&y1), sizeof(float));         
-
+            append(id);
+            append(x0);
+            append(y0);
+            append(x1);
+            append(y1);
             for(auto layer : density) {
                 temp = (*layer)(x, y);
-                out.write(reinterpret_cast<char*>(&temp), sizeof(float));         
+                append(temp);
             }
         }
     }
-
-    out.close();
     return true;
 }
 
 ECAD_INLINE bool GenerateCTMv1Package(std::string_view dirName, const std::string & packName, bool removeDir, std::string * err)
 {
-    std::string cmd = Fmt2Str("tar zcf %1% -C %2% .", packName, dirName);
-    int res = std::system(cmd.c_str());
-    if (res == 0 && FileExists(packName)) {
+    bool res{false};
+    std::error_code ec;
+    if (utils::ETarGzWriter writer(packName); writer.isOpen()) {
+        res = true;
+        for (const auto & entry : std::filesystem::recursive_directory_iterator(dirName, ec)) {
+            if (not entry.is_regular_file()) continue;
+            std::ifstream in(entry.path(), std::ios::in | std::ios::binary);
+            std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            auto name = std::filesystem::relative(entry.path(), dirName, ec).generic_string();
+            res = res && in.good() && writer.Add(name, data);
+        }
+        res = writer.Close() && res && not ec;
+    }
+    if (res && FileExists(packName)) {
         if(removeDir) RemoveDir(dirName);
         return true;
     }
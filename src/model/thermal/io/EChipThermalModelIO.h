@@ -18,6 +18,14 @@ ECAD_API bool ParseCTMv1HeaderFile(std::string_view filename, ECTMv1Header & hea
 ECAD_API bool ParseCTMv1PowerFile(std::string_view filename, EGridData & powers, std::string * err = nullptr);
 ECAD_API bool ParseCTMv1DensityFile(std::string_view filename, const size_t size, std::vector<SPtr<EGridData> > & density, std::string * err = nullptr);
 
+///in memory variants, used to read and write the package entries directly
+ECAD_API bool ParseCTMv1Header(std::istream & in, std::string_view name, ECTMv1Header & header, std::string * err = nullptr);
+ECAD_API bool ParseCTMv1Power(std::string_view data, EGridData & powers, std::string * err = nullptr);
+ECAD_API bool ParseCTMv1Density(std::string_view data, const size_t size, std::vector<SPtr<EGridData> > & density, std::string * err = nullptr);
+ECAD_API void WriteCTMv1Header(std::ostream & out, const ECTMv1Header & header);
+ECAD_API std::string WriteCTMv1Power(const EGridData & powers);
+ECAD_API bool WriteCTMv1Density(std::string & data, const size_t size, FCoord res, const FPoint2D & ref, const std::vector<SPtr<EGridData> > & density, std::string * err = nullptr);
+
 ECAD_API bool WriteCTMv1HeaderFile(std::string_view filename, const ECTMv1Header & header, std::string * err = nullptr);
 ECAD_API bool WriteCTMv1PowerFile(std::string_view filename, const EGridData & powers, std::string * err = nullptr);
 ECAD_API bool WriteCTMv1DensityFile(std::string_view filename, const size_t size, FCoord res, const FPoint2D & ref, const std::vector<SPtr<EGridData> > & density, std::string * err = nullptr);
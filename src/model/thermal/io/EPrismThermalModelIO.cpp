@@ -1,5 +1,10 @@
 #include "EPrismThermalModelIO.h"
+#include "model/thermal/EStackupPrismThermalModel.h"
+#include "model/io/EModelBinaryFormat.h"
+#include "basic/ELookupTable.h"
+
 #include "generic/tools/Color.hpp"
+#include <algorithm>
 namespace ecad::model::io {
 
 template <typename Scalar>
@@ -70,4 +75,663 @@ ECAD_INLINE bool GenerateVTKFile(std::string_view filename, const EPrismThermalM
 template ECAD_INLINE bool GenerateVTKFile<Float32>(std::string_view filename, const EPrismThermalModel & model, const std::vector<Float32> * temperature, std::string * err);
 template ECAD_INLINE bool GenerateVTKFile<Float64>(std::string_view filename, const EPrismThermalModel & model, const std::vector<Float64> * temperature, std::string * err);
 
+namespace detail {
+ECAD_ALWAYS_INLINE void WriteIndexCSR(EModelChunkWriter & chunk, const std::vector<const std::vector<size_t> *> & rows)
+{
+    std::vector<size_t> offsets(1, 0), indices;
+    for (auto row : rows) {
+        indices.insert(indices.end(), row->begin(), row->end());
+        offsets.emplace_back(indices.size());
+    }
+    chunk.WriteArray(offsets);
+    chunk.WriteArray(indices);
+}
+
+ECAD_ALWAYS_INLINE bool ViewCSR(EModelChunkReader & chunk, size_t rows, const size_t * & offsets, const size_t * & indices)
+{
+    size_t size{0}, total{0};
+    if (not chunk.ViewArray(offsets, size) || not chunk.ViewArray(indices, total)) return false;
+    return size == rows + 1 && offsets[rows] == total;
+}
+
+ECAD_ALWAYS_INLINE void WriteBC(EModelChunkWriter & chunk, const EThermalBoundaryCondition & bc)
+{
+    chunk.Write<int32_t>(static_cast<int32_t>(bc.type));
+    chunk.Write<EFloat>(bc.value);
+}
+
+ECAD_ALWAYS_INLINE void ReadBC(EModelChunkReader & chunk, EThermalBoundaryCondition & bc)
+{
+    int32_t type{0};
+    chunk.Read(type);
+    chunk.Read(bc.value);
+    bc.type = EThermalBoundaryConditionType(type);
+}
+
+ECAD_ALWAYS_INLINE void WriteBlockBCs(EModelChunkWriter & chunk, const std::vector<EThermalModelExtractionSettings::BlockBoundaryCondition> & bcs)
+{
+    std::vector<FBox2D> boxes;
+    std::vector<int32_t> types;
+    std::vector<EFloat> values;
+    for (const auto & [box, bc] : bcs) {
+        boxes.emplace_back(box);
+        types.emplace_back(static_cast<int32_t>(bc.type));
+        values.emplace_back(bc.value);
+    }
+    WriteBoxes(chunk, boxes);
+    chunk.WriteArray(types);
+    chunk.WriteArray(values);
+}
+
+ECAD_ALWAYS_INLINE bool ReadBlockBCs(EModelChunkReader & chunk, std::vector<EThermalModelExtractionSettings::BlockBoundaryCondition> & bcs)
+{
+    std::vector<FBox2D> boxes;
+    std::vector<int32_t> types;
+    std::vector<EFloat> values;
+    if (not ReadBoxes(chunk, boxes) || not chunk.ReadArray(types) || not chunk.ReadArray(values)) return false;
+    if (boxes.size() != types.size() || boxes.size() != values.size()) return false;
+    bcs.clear();
+    for (size_t i = 0; i < boxes.size(); ++i)
+        bcs.emplace_back(boxes[i], EThermalBoundaryCondition(values[i], EThermalBoundaryConditionType(types[i])));
+    return true;
+}
+
+///the extraction settings field by field, booleans are stored as bytes
+ECAD_ALWAYS_INLINE void WriteSettings(EModelChunkWriter & chunk, const EPrismThermalModelExtractionSettings & settings)
+{
+    chunk.Write<uint8_t>(settings.forceRebuild);
+    chunk.Write<uint64_t>(settings.threads);
+    chunk.WriteString(settings.workDir);
+    WriteBC(chunk, settings.topUniformBC);
+    WriteBC(chunk, settings.botUniformBC);
+    WriteBlockBCs(chunk, settings.topBlockBC);
+    WriteBlockBCs(chunk, settings.botBlockBC);
+    chunk.Write<EFloat>(settings.envTemperature.value);
+    chunk.Write<int32_t>(static_cast<int32_t>(settings.envTemperature.unit));
+
+    const auto & mesh = settings.meshSettings;
+    chunk.Write<EFloat>(mesh.minAlpha);
+    chunk.Write<EFloat>(mesh.minLen);
+    chunk.Write<EFloat>(mesh.maxLen);
+    chunk.Write<EFloat>(mesh.tolerance);
+    chunk.Write<uint64_t>(mesh.iteration);
+    chunk.Write<uint8_t>(mesh.dumpMeshFile);
+    chunk.Write<uint8_t>(mesh.genMeshByLayer);
+    chunk.Write<uint8_t>(mesh.imprintUpperLayer);
+
+    const auto & merge = settings.polygonMergeSettings;
+    chunk.Write<uint64_t>(merge.threads);
+    chunk.Write<uint8_t>(merge.mtByLayer);
+    chunk.Write<uint8_t>(merge.includePadstackInst);
+    chunk.Write<uint8_t>(merge.includeDielectricLayer);
+    chunk.Write<uint8_t>(merge.skipTopBotDielectricLayers);
+    chunk.WriteString(merge.outFile);
+    std::vector<int32_t> nets;
+    for (auto net : merge.selectNets) nets.emplace_back(static_cast<int32_t>(net));
+    std::sort(nets.begin(), nets.end());
+    chunk.WriteArray(nets);
+
+    WriteLayerCutSettings(chunk, settings.layerCutSettings);
+}
+
+ECAD_ALWAYS_INLINE bool ReadSettings(EModelChunkReader & chunk, EPrismThermalModelExtractionSettings & settings)
+{
+    auto readFlag = [&chunk](bool & flag) {
+        uint8_t value{0};
+        chunk.Read(value);
+        flag = value;
+    };
+    auto readSize = [&chunk](size_t & size) {
+        uint64_t value{0};
+        chunk.Read(value);
+        size = value;
+    };
+    readFlag(settings.forceRebuild);
+    readSize(settings.threads);
+    chunk.ReadString(settings.workDir);
+    ReadBC(chunk, settings.topUniformBC);
+    ReadBC(chunk, settings.botUniformBC);
+    if (not ReadBlockBCs(chunk, settings.topBlockBC) || not ReadBlockBCs(chunk, settings.botBlockBC)) return false;
+    int32_t unit{0};
+    chunk.Read(settings.envTemperature.value);
+    chunk.Read(unit);
+    settings.envTemperature.unit = ETemperatureUnit(unit);
+
+    auto & mesh = settings.meshSettings;
+    chunk.Read(mesh.minAlpha);
+    chunk.Read(mesh.minLen);
+    chunk.Read(mesh.maxLen);
+    chunk.Read(mesh.tolerance);
+    readSize(mesh.iteration);
+    readFlag(mesh.dumpMeshFile);
+    readFlag(mesh.genMeshByLayer);
+    readFlag(mesh.imprintUpperLayer);
+
+    auto & merge = settings.polygonMergeSettings;
+    readSize(merge.threads);
+    readFlag(merge.mtByLayer);
+    readFlag(merge.includePadstackInst);
+    readFlag(merge.includeDielectricLayer);
+    readFlag(merge.skipTopBotDielectricLayers);
+    chunk.ReadString(merge.outFile);
+    std::vector<int32_t> nets;
+    if (not chunk.ReadArray(nets)) return false;
+    merge.selectNets.clear();
+    for (auto net : nets) merge.selectNets.emplace(ENetId(net));
+
+    return ReadLayerCutSettings(chunk, settings.layerCutSettings);
+}
+
+///template points and triangles, [x, y] coordinates, 3 vertices and 3 neighbors per triangle
+ECAD_ALWAYS_INLINE void WritePrismTemplate(EModelChunkWriter & chunk, const EPrismThermalModel::PrismTemplate & prismTemplate)
+{
+    std::vector<ECoord> coords;
+    coords.reserve(prismTemplate.points.size() * 2);
+    for (const auto & point : prismTemplate.points)
+        coords.insert(coords.end(), {point[0], point[1]});
+    std::vector<size_t> vertices, neighbors;
+    vertices.reserve(prismTemplate.triangles.size() * 3);
+    neighbors.reserve(prismTemplate.triangles.size() * 3);
+    for (const auto & triangle : prismTemplate.triangles) {
+        for (size_t k = 0; k < 3; ++k) {
+            vertices.emplace_back(triangle.vertices[k]);
+            neighbors.emplace_back(triangle.neighbors[k]);
+        }
+    }
+    chunk.WriteArray(coords);
+    chunk.WriteArray(vertices);
+    chunk.WriteArray(neighbors);
+}
+
+ECAD_ALWAYS_INLINE bool ReadPrismTemplate(EModelChunkReader & chunk, EPrismThermalModel::PrismTemplate & prismTemplate)
+{
+    const ECoord * coords{nullptr};
+    const size_t * vertices{nullptr}, * neighbors{nullptr};
+    size_t size{0}, vtxSize{0}, nbSize{0};
+    chunk.ViewArray(coords, size);
+    chunk.ViewArray(vertices, vtxSize);
+    chunk.ViewArray(neighbors, nbSize);
+    if (not chunk.isValid() || size % 2 || vtxSize % 3 || vtxSize != nbSize) return false;
+
+    prismTemplate.points.resize(size / 2);
+    for (size_t i = 0; i < prismTemplate.points.size(); ++i)
+        prismTemplate.points[i] = EPoint2D(coords[i * 2], coords[i * 2 + 1]);
+    prismTemplate.triangles.resize(vtxSize / 3);
+    for (size_t i = 0; i < prismTemplate.triangles.size(); ++i) {
+        auto & triangle = prismTemplate.triangles[i];
+        for (size_t k = 0; k < 3; ++k) {
+            if (vertices[i * 3 + k] >= prismTemplate.points.size()) return false;
+            triangle.vertices[k] = static_cast<std::decay_t<decltype(triangle.vertices[k])> >(vertices[i * 3 + k]);
+            triangle.neighbors[k] = static_cast<std::decay_t<decltype(triangle.neighbors[k])> >(neighbors[i * 3 + k]);
+        }
+    }
+    return true;
+}
+}//namespace detail
+
+ECAD_INLINE bool EPrismThermalModelBinaryIO::Write(std::string_view filename, const EPrismThermalModel & model, std::string * err)
+{
+    EModelBinaryWriter writer(filename, model.GetModelType());
+    if (not writer.isOpen()) return detail::Error(err, "Error: fail to open: " + std::string(filename));
+
+    //meta
+    std::unordered_map<CPtr<EPrismThermalModel::PrismTemplate>, size_t> templates;
+    std::vector<CPtr<EPrismThermalModel::PrismTemplate> > uniqueTemplates;
+    {
+        EModelChunkWriter chunk;
+        chunk.Write<EFloat>(model.m_scaleH2Unit);
+        chunk.Write<EFloat>(model.m_scale2Meter);
+        chunk.Write<uint64_t>(model.layers.size());
+        chunk.WriteArray(model.m_indexOffset);
+
+        std::vector<int32_t> orients, types;
+        std::vector<EFloat> values;
+        for (auto orient : {EOrientation::Top, EOrientation::Bot}) {
+            auto bc = model.GetUniformBC(orient);
+            if (nullptr == bc) continue;
+            orients.emplace_back(static_cast<int32_t>(orient));
+            types.emplace_back(static_cast<int32_t>(bc->type));
+            values.emplace_back(bc->value);
+        }
+        chunk.WriteArray(orients);
+        chunk.WriteArray(types);
+        chunk.WriteArray(values);
+
+        orients.clear(); types.clear(); values.clear();
+        std::vector<ECoord> boxes;
+        for (const auto & [orient, bcs] : model.m_blockBCs) {
+            for (const auto & [box, bc] : bcs) {
+                orients.emplace_back(static_cast<int32_t>(orient));
+                boxes.insert(boxes.end(), {box[0][0], box[0][1], box[1][0], box[1][1]});
+                types.emplace_back(static_cast<int32_t>(bc.type));
+                values.emplace_back(bc.value);
+            }
+        }
+        chunk.WriteArray(orients);
+        chunk.WriteArray(boxes);
+        chunk.WriteArray(types);
+        chunk.WriteArray(values);
+
+        //layer to template index, layers sharing a template share its chunk
+        std::vector<size_t> templateLayers, templateIndices;
+        for (const auto & [layer, prismTemplate] : model.m_prismTemplates) {
+            auto [iter, added] = templates.emplace(prismTemplate.get(), templates.size());
+            if (added) uniqueTemplates.emplace_back(prismTemplate.get());
+            templateLayers.emplace_back(layer);
+            templateIndices.emplace_back(iter->second);
+        }
+        chunk.WriteArray(templateLayers);
+        chunk.WriteArray(templateIndices);
+        writer.AddChunk(EModelChunk::Meta, 0, chunk);
+    }
+
+    //settings and prism templates
+    {
+        EModelChunkWriter chunk;
+        detail::WriteSettings(chunk, model.m_settings);
+        writer.AddChunk(EModelChunk::Settings, 0, chunk);
+    }
+    for (size_t i = 0; i < uniqueTemplates.size(); ++i) {
+        EModelChunkWriter chunk;
+        detail::WritePrismTemplate(chunk, *uniqueTemplates.at(i));
+        writer.AddChunk(EModelChunk::PrismTemplates, i, chunk);
+    }
+
+    //lookup tables, shared by the elements
+    std::unordered_map<CPtr<ELookupTable1D>, size_t> lutIndices;
+    {
+        std::vector<CPtr<ELookupTable1D> > luts;
+        for (const auto & layer : model.layers) {
+            for (const auto & element : layer.elements) {
+                if (nullptr == element.powerLut) continue;
+                if (lutIndices.emplace(element.powerLut.get(), luts.size()).second)
+                    luts.emplace_back(element.powerLut.get());
+            }
+        }
+        EModelChunkWriter chunk;
+        WriteLookupTables(chunk, luts);
+        writer.AddChunk(EModelChunk::LookupTables, 0, chunk);
+    }
+
+    //points
+    {
+        std::vector<EFloat> coords;
+        coords.reserve(model.m_points.size() * 3);
+        for (const auto & point : model.m_points)
+            coords.insert(coords.end(), {point[0], point[1], point[2]});
+        EModelChunkWriter chunk;
+        chunk.WriteArray(coords);
+        writer.AddChunk(EModelChunk::Points, 0, chunk);
+    }
+
+    //layers
+    for (size_t i = 0; i < model.layers.size(); ++i) {
+        const auto & layer = model.layers.at(i);
+        auto size = layer.elements.size();
+        std::vector<int32_t> netIds(size), matIds(size);
+        std::vector<EFloat> powerRatios(size);
+        std::vector<size_t> ids(size), templateIds(size), scenarios(size), luts(size), neighbors(size * 5);
+        for (size_t j = 0; j < size; ++j) {
+            const auto & element = layer.elements.at(j);
+            netIds[j] = static_cast<int32_t>(element.netId);
+            matIds[j] = static_cast<int32_t>(element.matId);
+            powerRatios[j] = element.powerRatio;
+            ids[j] = element.id;
+            templateIds[j] = element.templateId;
+            scenarios[j] = element.powerScenario;
+            luts[j] = element.powerLut ? lutIndices.at(element.powerLut.get()) : invalidIndex;
+            std::copy(element.neighbors.cbegin(), element.neighbors.cend(), neighbors.begin() + j * 5);
+        }
+        EModelChunkWriter chunk;
+        chunk.Write<uint64_t>(layer.id);
+        chunk.Write<EFloat>(layer.elevation);
+        chunk.Write<EFloat>(layer.thickness);
+        chunk.WriteArray(netIds);
+        chunk.WriteArray(matIds);
+        chunk.WriteArray(powerRatios);
+        chunk.WriteArray(ids);
+        chunk.WriteArray(templateIds);
+        chunk.WriteArray(scenarios);
+        chunk.WriteArray(luts);
+        chunk.WriteArray(neighbors);
+        writer.AddChunk(EModelChunk::Layer, i, chunk);
+    }
+
+    //prism instances
+    {
+        auto size = model.m_prisms.size();
+        std::vector<size_t> layers(size), elements(size), vertices(size * 6), neighbors(size * 5);
+        for (size_t i = 0; i < size; ++i) {
+            const auto & prism = model.m_prisms.at(i);
+            layers[i] = prism.layer;
+            elements[i] = prism.element;
+            std::copy(prism.vertices.cbegin(), prism.vertices.cend(), vertices.begin() + i * 6);
+            std::copy(prism.neighbors.cbegin(), prism.neighbors.cend(), neighbors.begin() + i * 5);
+        }
+        EModelChunkWriter chunk;
+        chunk.WriteArray(layers);
+        chunk.WriteArray(elements);
+        chunk.WriteArray(vertices);
+        chunk.WriteArray(neighbors);
+        writer.AddChunk(EModelChunk::Prisms, 0, chunk);
+
+        for (size_t k = 0; k < 2; ++k) {
+            std::vector<size_t> offsets(1, 0), indices;
+            std::vector<EFloat> ratios;
+            for (const auto & prism : model.m_prisms) {
+                for (const auto & contact : prism.contactInstances.at(k)) {
+                    indices.emplace_back(contact.index);
+                    ratios.emplace_back(contact.ratio);
+                }
+                offsets.emplace_back(indices.size());
+            }
+            EModelChunkWriter contacts;
+            contacts.WriteArray(offsets);
+            contacts.WriteArray(indices);
+            contacts.WriteArray(ratios);
+            writer.AddChunk(EModelChunk::Contacts, k, contacts);
+        }
+    }
+
+    //line elements
+    {
+        auto size = model.m_lines.size();
+        std::vector<int32_t> netIds(size), matIds(size);
+        std::vector<EFloat> radius(size), currents(size);
+        std::vector<size_t> ids(size), scenarios(size), endPoints(size * 2);
+        std::array<std::vector<const std::vector<size_t> *>, 2> neighbors;
+        for (size_t i = 0; i < size; ++i) {
+            const auto & line = model.m_lines.at(i);
+            netIds[i] = static_cast<int32_t>(line.netId);
+            matIds[i] = static_cast<int32_t>(line.matId);
+            radius[i] = line.radius;
+            currents[i] = line.current;
+            ids[i] = line.id;
+            scenarios[i] = line.scenario;
+            endPoints[i * 2] = line.endPoints.front();
+            endPoints[i * 2 + 1] = line.endPoints.back();
+            neighbors[0].emplace_back(&line.neighbors.front());
+            neighbors[1].emplace_back(&line.neighbors.back());
+        }
+        EModelChunkWriter chunk;
+        chunk.WriteArray(netIds);
+        chunk.WriteArray(matIds);
+        chunk.WriteArray(radius);
+        chunk.WriteArray(currents);
+        chunk.WriteArray(ids);
+        chunk.WriteArray(scenarios);
+        chunk.WriteArray(endPoints);
+        detail::WriteIndexCSR(chunk, neighbors.front());
+        detail::WriteIndexCSR(chunk, neighbors.back());
+        writer.AddChunk(EModelChunk::Lines, 0, chunk);
+    }
+
+    if (not writer.Close()) return detail::Error(err, "Error: fail to write: " + std::string(filename));
+    return true;
+}
+
+ECAD_INLINE UPtr<EPrismThermalModel> EPrismThermalModelBinaryIO::Read(std::string_view filename, CPtr<ILayoutView> layout, std::string * err)
+{
+    EModelBinaryReader reader(filename);
+    if (not reader.isOpen()) {
+        detail::Error(err, "Error: invalid model file: " + std::string(filename));
+        return nullptr;
+    }
+
+    UPtr<EPrismThermalModel> model;
+    if (reader.GetModelType() == EModelType::ThermalPrism) model.reset(new EPrismThermalModel);
+    else if (reader.GetModelType() == EModelType::ThermalStackupPrism) model.reset(new EStackupPrismThermalModel);
+    else {
+        detail::Error(err, "Error: unsupported model type " + toString(reader.GetModelType()));
+        return nullptr;
+    }
+    model->m_layout = layout;
+
+    EModelChunkReader chunk;
+    if (not reader.GetChunk(EModelChunk::Settings, 0, chunk, err)) return nullptr;
+    if (not detail::ReadSettings(chunk, model->m_settings)) {
+        detail::Error(err, "Error: corrupted settings chunk");
+        return nullptr;
+    }
+
+    //meta
+    uint64_t layerSize{0};
+    {
+        if (not reader.GetChunk(EModelChunk::Meta, 0, chunk, err)) return nullptr;
+        std::vector<int32_t> orients, types;
+        std::vector<EFloat> values;
+        std::vector<ECoord> boxes;
+        chunk.Read(model->m_scaleH2Unit);
+        chunk.Read(model->m_scale2Meter);
+        chunk.Read(layerSize);
+        chunk.ReadArray(model->m_indexOffset);
+        chunk.ReadArray(orients); chunk.ReadArray(types); chunk.ReadArray(values);
+        if (not chunk.isValid() || orients.size() != types.size() || orients.size() != values.size()) {
+            detail::Error(err, "Error: corrupted meta chunk");
+            return nullptr;
+        }
+        for (size_t i = 0; i < orients.size(); ++i)
+            model->SetUniformBC(EOrientation(orients[i]), EThermalBoundaryCondition(values[i], EThermalBoundaryConditionType(types[i])));
+
+        chunk.ReadArray(orients); chunk.ReadArray(boxes); chunk.ReadArray(types); chunk.ReadArray(values);
+        if (not chunk.isValid() || boxes.size() != orients.size() * 4 || orients.size() != types.size() || orients.size() != values.size()) {
+            detail::Error(err, "Error: corrupted meta chunk");
+            return nullptr;
+        }
+        model->m_blockBCs.emplace(EOrientation::Top, std::vector<EPrismThermalModel::BlockBC>{});
+        model->m_blockBCs.emplace(EOrientation::Bot, std::vector<EPrismThermalModel::BlockBC>{});
+        for (size_t i = 0; i < orients.size(); ++i) {
+            EBox2D box(EPoint2D(boxes[i * 4], boxes[i * 4 + 1]), EPoint2D(boxes[i * 4 + 2], boxes[i * 4 + 3]));
+            model->m_blockBCs[EOrientation(orients[i])].emplace_back(box, EThermalBoundaryCondition(values[i], EThermalBoundaryConditionType(types[i])));
+        }
+
+        std::vector<size_t> templateLayers, templateIndices;
+        chunk.ReadArray(templateLayers); chunk.ReadArray(templateIndices);
+        if (not chunk.isValid() || templateLayers.size() != templateIndices.size()) {
+            detail::Error(err, "Error: corrupted meta chunk");
+            return nullptr;
+        }
+        std::vector<SPtr<EPrismThermalModel::PrismTemplate> > templates(reader.Chunks(EModelChunk::PrismTemplates));
+        for (size_t i = 0; i < templateLayers.size(); ++i) {
+            auto index = templateIndices.at(i);
+            if (index >= templates.size()) {
+                detail::Error(err, "Error: invalid prism template index " + std::to_string(index));
+                return nullptr;
+            }
+            if (nullptr == templates.at(index)) {
+                EModelChunkReader templateChunk;
+                if (not reader.GetChunk(EModelChunk::PrismTemplates, index, templateChunk, err)) return nullptr;
+                templates[index] = std::make_shared<EPrismThermalModel::PrismTemplate>();
+                if (not detail::ReadPrismTemplate(templateChunk, *templates[index])) {
+                    detail::Error(err, "Error: corrupted prism template chunk " + std::to_string(index));
+                    return nullptr;
+                }
+            }
+            model->m_prismTemplates.emplace(templateLayers.at(i), templates.at(index));
+        }
+    }
+
+    //layers
+    std::vector<SPtr<ELookupTable1D> > luts;
+    if (not ReadLookupTables(reader, luts, err)) return nullptr;
+    model->layers.reserve(layerSize);
+    for (size_t i = 0; i < layerSize; ++i) {
+        PrismLayer layer(i);
+        if (not ReadLayer(reader, i, luts, layer, err)) return nullptr;
+        model->layers.emplace_back(std::move(layer));
+    }
+
+    //points and prism instances
+    {
+        if (not reader.GetChunk(EModelChunk::Points, 0, chunk, err)) return nullptr;
+        const EFloat * coords{nullptr};
+        size_t size{0};
+        if (not chunk.ViewArray(coords, size) || size % 3) {
+            detail::Error(err, "Error: corrupted point chunk");
+            return nullptr;
+        }
+        model->m_points.reserve(size / 3);
+        for (size_t i = 0; i < size; i += 3)
+            model->m_points.emplace_back(coords[i], coords[i + 1], coords[i + 2]);
+    }
+    {
+        if (not reader.GetChunk(EModelChunk::Prisms, 0, chunk, err)) return nullptr;
+        size_t size{0}, eleSize{0}, vtxSize{0}, nbSize{0};
+        const size_t * layers{nullptr}, * elements{nullptr}, * vtx{nullptr}, * neighbors{nullptr};
+        chunk.ViewArray(layers, size);
+        chunk.ViewArray(elements, eleSize);
+        chunk.ViewArray(vtx, vtxSize);
+        chunk.ViewArray(neighbors, nbSize);
+        if (not chunk.isValid() || eleSize != size || vtxSize != size * 6 || nbSize != size * 5) {
+            detail::Error(err, "Error: corrupted prism chunk");
+            return nullptr;
+        }
+        model->m_prisms.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            auto & prism = model->m_prisms.emplace_back(layers[i], elements[i]);
+            std::copy(vtx + i * 6, vtx + i * 6 + 6, prism.vertices.begin());
+            std::copy(neighbors + i * 5, neighbors + i * 5 + 5, prism.neighbors.begin());
+        }
+
+        for (size_t k = 0; k < 2; ++k) {
+            if (not reader.GetChunk(EModelChunk::Contacts, k, chunk, err)) return nullptr;
+            const size_t * offsets{nullptr}, * indices{nullptr};
+            const EFloat * ratios{nullptr};
+            size_t ratioSize{0};
+            if (not detail::ViewCSR(chunk, size, offsets, indices) || not chunk.ViewArray(ratios, ratioSize) || ratioSize != offsets[size]) {
+                detail::Error(err, "Error: corrupted contact chunk");
+                return nullptr;
+            }
+            for (size_t i = 0; i < size; ++i) {
+                auto & contacts = model->m_prisms[i].contactInstances[k];
+                contacts.reserve(offsets[i + 1] - offsets[i]);
+                for (auto j = offsets[i]; j < offsets[i + 1]; ++j)
+                    contacts.emplace_back(indices[j], ratios[j]);
+            }
+        }
+    }
+
+    //line elements
+    {
+        if (not reader.GetChunk(EModelChunk::Lines, 0, chunk, err)) return nullptr;
+        std::vector<int32_t> netIds, matIds;
+        std::vector<EFloat> radius, currents;
+        std::vector<size_t> ids, scenarios, endPoints;
+        chunk.ReadArray(netIds); chunk.ReadArray(matIds);
+        chunk.ReadArray(radius); chunk.ReadArray(currents);
+        chunk.ReadArray(ids); chunk.ReadArray(scenarios); chunk.ReadArray(endPoints);
+        auto size = netIds.size();
+        std::array<const size_t *, 2> offsets{nullptr, nullptr}, indices{nullptr, nullptr};
+        if (not chunk.isValid() || matIds.size() != size || radius.size() != size || currents.size() != size ||
+            ids.size() != size || scenarios.size() != size || endPoints.size() != size * 2 ||
+            not detail::ViewCSR(chunk, size, offsets[0], indices[0]) || not detail::ViewCSR(chunk, size, offsets[1], indices[1])) {
+            detail::Error(err, "Error: corrupted line chunk");
+            return nullptr;
+        }
+        model->m_lines.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            auto & line = model->m_lines[i];
+            line.netId = ENetId(netIds[i]);
+            line.matId = EMaterialId(matIds[i]);
+            line.radius = radius[i];
+            line.current = currents[i];
+            line.id = ids[i];
+            line.scenario = scenarios[i];
+            line.endPoints = {endPoints[i * 2], endPoints[i * 2 + 1]};
+            for (size_t k = 0; k < 2; ++k)
+                line.neighbors[k].assign(indices[k] + offsets[k][i], indices[k] + offsets[k][i + 1]);
+        }
+    }
+    return model;
+}
+
+ECAD_INLINE bool EPrismThermalModelBinaryIO::ReadGeometry(std::string_view filename, std::vector<FPoint3D> & points, std::vector<std::array<size_t, 6> > & prisms, std::string * err)
+{
+    EModelBinaryReader reader(filename);
+    if (not reader.isOpen()) return detail::Error(err, "Error: invalid model file: " + std::string(filename));
+
+    EModelChunkReader chunk;
+    if (not reader.GetChunk(EModelChunk::Points, 0, chunk, err)) return false;
+    const EFloat * coords{nullptr};
+    size_t size{0};
+    if (not chunk.ViewArray(coords, size) || size % 3) return detail::Error(err, "Error: corrupted point chunk");
+    points.resize(size / 3);
+    for (size_t i = 0; i < points.size(); ++i)
+        points[i] = FPoint3D(coords[i * 3], coords[i * 3 + 1], coords[i * 3 + 2]);
+
+    if (not reader.GetChunk(EModelChunk::Prisms, 0, chunk, err)) return false;
+    const size_t * layers{nullptr}, * elements{nullptr}, * vertices{nullptr};
+    size_t eleSize{0}, vtxSize{0};
+    chunk.ViewArray(layers, size);
+    chunk.ViewArray(elements, eleSize);
+    chunk.ViewArray(vertices, vtxSize);
+    if (not chunk.isValid() || vtxSize != size * 6) return detail::Error(err, "Error: corrupted prism chunk");
+    prisms.resize(size);
+    for (size_t i = 0; i < size; ++i)
+        std::copy(vertices + i * 6, vertices + i * 6 + 6, prisms[i].begin());
+    return true;
+}
+
+ECAD_INLINE bool EPrismThermalModelBinaryIO::ReadLayer(std::string_view filename, size_t layer, PrismLayer & prismLayer, std::string * err)
+{
+    EModelBinaryReader reader(filename);
+    if (not reader.isOpen()) return detail::Error(err, "Error: invalid model file: " + std::string(filename));
+
+    std::vector<SPtr<ELookupTable1D> > luts;
+    if (not ReadLookupTables(reader, luts, err)) return false;
+    return ReadLayer(reader, layer, luts, prismLayer, err);
+}
+
+ECAD_INLINE bool EPrismThermalModelBinaryIO::ReadLookupTables(const EModelBinaryReader & reader, std::vector<SPtr<ELookupTable1D> > & luts, std::string * err)
+{
+    EModelChunkReader chunk;
+    if (not reader.GetChunk(EModelChunk::LookupTables, 0, chunk, err)) return false;
+    if (not io::ReadLookupTables(chunk, luts)) return detail::Error(err, "Error: corrupted lookup table chunk");
+    return true;
+}
+
+ECAD_INLINE bool EPrismThermalModelBinaryIO::ReadLayer(const EModelBinaryReader & reader, size_t layer, const std::vector<SPtr<ELookupTable1D> > & luts, PrismLayer & prismLayer, std::string * err)
+{
+    EModelChunkReader chunk;
+    if (not reader.GetChunk(EModelChunk::Layer, layer, chunk, err)) return false;
+
+    uint64_t id{0};
+    const int32_t * netIds{nullptr}, * matIds{nullptr};
+    const EFloat * powerRatios{nullptr};
+    const size_t * ids{nullptr}, * templateIds{nullptr}, * scenarios{nullptr}, * lutIndices{nullptr}, * neighbors{nullptr};
+    std::array<size_t, 8> sizes;
+    chunk.Read(id);
+    chunk.Read(prismLayer.elevation);
+    chunk.Read(prismLayer.thickness);
+    chunk.ViewArray(netIds, sizes[0]);
+    chunk.ViewArray(matIds, sizes[1]);
+    chunk.ViewArray(powerRatios, sizes[2]);
+    chunk.ViewArray(ids, sizes[3]);
+    chunk.ViewArray(templateIds, sizes[4]);
+    chunk.ViewArray(scenarios, sizes[5]);
+    chunk.ViewArray(lutIndices, sizes[6]);
+    chunk.ViewArray(neighbors, sizes[7]);
+    auto size = sizes.front();
+    if (not chunk.isValid() || sizes[7] != size * 5 ||
+        std::any_of(sizes.cbegin(), sizes.cbegin() + 7, [size](auto s){ return s != size; }))
+        return detail::Error(err, "Error: corrupted layer chunk " + std::to_string(layer));
+
+    prismLayer.id = id;
+    prismLayer.elements.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        auto & element = prismLayer.elements[i];
+        element.netId = ENetId(netIds[i]);
+        element.matId = EMaterialId(matIds[i]);
+        element.powerRatio = powerRatios[i];
+        element.id = ids[i];
+        element.templateId = templateIds[i];
+        element.powerScenario = scenarios[i];
+        if (invalidIndex == lutIndices[i]) element.powerLut = nullptr;
+        else if (lutIndices[i] < luts.size()) element.powerLut = luts[lutIndices[i]];
+        else return detail::Error(err, "Error: invalid lookup table index in layer " + std::to_string(layer));
+        std::copy(neighbors + i * 5, neighbors + i * 5 + 5, element.neighbors.begin());
+    }
+    return true;
+}
+
 } // namespace ecad::model::io
\ No newline at end of file
@@ -6,4 +6,22 @@ namespace ecad::model::io {
 template <typename Scalar>
 ECAD_API bool GenerateVTKFile(std::string_view filename, const EPrismThermalModel & model, const std::vector<Scalar> * temperature = nullptr, std::string * err = nullptr);
 
-} // namespace ecad::model::io
\ No newline at end of file
+class EModelBinaryReader;
+///native binary container of the prism and stackup prism models, see EModelBinaryFormat
+class ECAD_API EPrismThermalModelBinaryIO
+{
+public:
+    static bool Write(std::string_view filename, const EPrismThermalModel & model, std::string * err = nullptr);
+    static UPtr<EPrismThermalModel> Read(std::string_view filename, CPtr<ILayoutView> layout, std::string * err = nullptr);
+
+    ///reads the points and the prism vertices only
+    static bool ReadGeometry(std::string_view filename, std::vector<FPoint3D> & points, std::vector<std::array<size_t, 6> > & prisms, std::string * err = nullptr);
+    ///reads one layer only, the power lookup tables are loaded if the layer refers to them
+    static bool ReadLayer(std::string_view filename, size_t layer, PrismLayer & prismLayer, std::string * err = nullptr);
+
+private:
+    static bool ReadLookupTables(const EModelBinaryReader & reader, std::vector<SPtr<ELookupTable1D> > & luts, std::string * err);
+    static bool ReadLayer(const EModelBinaryReader & reader, size_t layer, const std::vector<SPtr<ELookupTable1D> > & luts, PrismLayer & prismLayer, std::string * err);
+};
+
+} // namespace ecad::model::io
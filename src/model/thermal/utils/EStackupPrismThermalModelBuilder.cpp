@@ -3,8 +3,8 @@
 #include "EStackupPrismThermalModelQuery.h"
 #include "model/geometry/ELayerCutModel.h"
 
-#include "generic/geometry/BooleanOperation.hpp"
 #include "generic/thread/ThreadPool.hpp"
+#include <algorithm>
 
 namespace ecad::model::utils {
 ECAD_INLINE EStackupPrismThermalModelBuilder::EStackupPrismThermalModelBuilder(Ptr<EStackupPrismThermalModel> model)
@@ -21,25 +21,50 @@ ECAD_INLINE void EStackupPrismThermalModelBuilder::BuildPrismModel(EFloat scaleH
 {
     m_model->m_scaleH2Unit = scaleH2Unit;
     m_model->m_scale2Meter = scale2Meter;
+    m_model->ReleaseSolverCache();
     m_model->m_indexOffset = std::vector<size_t>{0};
     for (size_t i = 0; i < m_model->TotalLayers(); ++i)
         m_model->m_indexOffset.emplace_back(m_model->m_indexOffset.back() + m_model->layers.at(i).TotalElements());
     
+    //one point plane per layer interface indexed by the template vertex, 
+    //the bottom plane of a layer is the top plane of the next layer if both share the prism template
+    std::vector<std::vector<size_t> > planes;
+    std::vector<CPtr<EPrismThermalModel::PrismTemplate> > templates(m_model->TotalLayers());
+    std::vector<size_t> topPlanes(m_model->TotalLayers()), botPlanes(m_model->TotalLayers());
+    for (size_t i = 0; i < m_model->TotalLayers(); ++i) {
+        templates[i] = m_model->GetLayerPrismTemplate(i).get();
+        if (i > 0 && templates.at(i) == templates.at(i - 1))
+            topPlanes[i] = botPlanes.at(i - 1);
+        else {
+            topPlanes[i] = planes.size();
+            planes.emplace_back(templates.at(i)->points.size(), invalidIndex);
+        }
+        botPlanes[i] = planes.size();
+        planes.emplace_back(templates.at(i)->points.size(), invalidIndex);
+    }
+
     auto total = m_model->TotalPrismElements();
     m_model->m_prisms.reserve(total);
-    m_model->m_points.resize(total * 6);
+    m_model->m_points.clear();
     for (size_t i = 0; i < total; ++i) {
         auto [lyrIdx, eleIdx] = m_model->PrismLocalIndex(i);
+        const auto & element = m_model->GetPrismElement(lyrIdx, eleIdx);
         auto & instance = m_model->m_prisms.emplace_back(lyrIdx, eleIdx);
   
         //points
-        for (size_t v = 0; v < 6; ++v) {
-            m_model->m_points[6 * i + v] = m_model->GetPoint(lyrIdx, eleIdx, v);
-            instance.vertices[v] = 6 * i + v;
+        auto & topPlane = planes[topPlanes.at(lyrIdx)];
+        auto & botPlane = planes[botPlanes.at(lyrIdx)];
+        const auto & vertices = templates.at(lyrIdx)->triangles.at(element.templateId).vertices;
+        for (size_t v = 0; v < vertices.size(); ++v) {
+            auto & top = topPlane[vertices.at(v)];
+            if (invalidIndex == top) top = m_model->AddPoint(m_model->GetPoint(lyrIdx, eleIdx, v));
+            instance.vertices[v] = top;
+            auto & bot = botPlane[vertices.at(v)];
+            if (invalidIndex == bot) bot = m_model->AddPoint(m_model->GetPoint(lyrIdx, eleIdx, v + 3));
+            instance.vertices[v + 3] = bot;
         }
 
         //side neighbors
-        const auto & element = m_model->GetPrismElement(lyrIdx, eleIdx);
         for (size_t n = 0; n < 3; ++n) {
             if (auto nid = element.neighbors.at(n); noNeighbor != nid) {
                 auto nb = m_model->GlobalIndex(lyrIdx, element.neighbors.at(n));
@@ -48,57 +73,118 @@ ECAD_INLINE void EStackupPrismThermalModelBuilder::BuildPrismModel(EFloat scaleH
         }
     }
 
-    if (threads > 1) {
-        generic::thread::ThreadPool pool(threads);
-        const auto & offset = m_model->m_indexOffset;
-        for (size_t i = 0; i < offset.size() - 1; ++i)
-            pool.Submit(std::bind(&EStackupPrismThermalModelBuilder::BuildPrismInstanceTopBotNeighbors, this, offset.at(i), offset.at(i + 1)));
-    }
-    else BuildPrismInstanceTopBotNeighbors(0, m_model->TotalPrismElements());
+    BuildPrismInstanceTopBotNeighbors(threads);
 }
 
-ECAD_INLINE void EStackupPrismThermalModelBuilder::BuildPrismInstanceTopBotNeighbors(size_t start, size_t end)
+ECAD_INLINE void EStackupPrismThermalModelBuilder::BuildPrismInstanceTopBotNeighbors(size_t threads)
 {
-    using RtVal = model::utils::EStackupPrismThermalModelQuery::RtVal;
-    for (size_t i = start; i < end; ++i) {
+    auto total = m_model->TotalPrismElements();
+    m_triangles.resize(total);
+    for (size_t i = 0; i < total; ++i) {
         auto & instance = m_model->m_prisms[i];
-        auto [lyrIdx, eleIdx] = m_model->PrismLocalIndex(i);
-        auto triangle1 = m_query->GetPrismInstanceTemplate(i);
-        auto triangle1Area = triangle1.Area();
-        if (m_model->isTopLayer(lyrIdx)) instance.neighbors[PrismElement::TOP_NEIGHBOR_INDEX] = noNeighbor;
-        else {
-            auto topLyr = lyrIdx - 1;
-            std::vector<RtVal> results;
-            m_query->IntersectsPrismInstances(topLyr, i, results);
-            for (size_t j = 0; j < results.size(); ++j) {
-                auto triangle2 = m_query->GetPrismInstanceTemplate(results.at(j).second);
-                if (auto area = GetIntersectArea(triangle1, triangle2); area > 0)
-                   instance.contactInstances.front().emplace_back(results.at(j).second, EFloat(area) / triangle1Area); 
-            }
-            if (instance.contactInstances.empty())
-                instance.neighbors[PrismElement::TOP_NEIGHBOR_INDEX] = noNeighbor;
-            else instance.neighbors[PrismElement::TOP_NEIGHBOR_INDEX] = i;
+        const auto & prismTemplate = *m_model->GetLayerPrismTemplate(instance.layer);
+        const auto & vertices = prismTemplate.triangles.at(m_model->GetPrismElement(instance.layer, instance.element).templateId).vertices;
+        for (size_t v = 0; v < vertices.size(); ++v) {
+            const auto & pt = prismTemplate.points.at(vertices.at(v));
+            m_triangles[i][v] = {EFloat(pt[0]), EFloat(pt[1])};
         }
+        instance.contactInstances.front().clear();
+        instance.contactInstances.back().clear();
+        instance.neighbors[PrismElement::TOP_NEIGHBOR_INDEX] = m_model->isTopLayer(instance.layer) ? noNeighbor : i;
+        instance.neighbors[PrismElement::BOT_NEIGHBOR_INDEX] = m_model->isBotLayer(instance.layer) ? noNeighbor : i;
+    }
 
-        if (m_model->isBotLayer(lyrIdx)) instance.neighbors[PrismElement::BOT_NEIGHBOR_INDEX] = noNeighbor;
-        else {
-            auto botLyr = lyrIdx + 1;
-            std::vector<RtVal> results;
-            m_query->IntersectsPrismInstances(botLyr, i, results);
-            for (size_t j = 0; j < results.size(); ++j) {
-                auto triangle2 = m_query->GetPrismInstanceTemplate(results.at(j).second);
-                if (auto area = GetIntersectArea(triangle1, triangle2); area > 0)
-                    instance.contactInstances.back().emplace_back(results.at(j).second, EFloat(area) / triangle1Area);
+    //candidates of each layer interface, then the contact areas in chunks over all interfaces, then the contact lists
+    auto interfaces = m_model->TotalLayers() - std::min<size_t>(1, m_model->TotalLayers());
+    std::vector<std::vector<ContactPair> > pairs(interfaces);
+    std::vector<std::vector<EFloat> > areas(interfaces);
+    if (threads > 1) {
+        {
+            generic::thread::ThreadPool pool(threads);
+            for (size_t i = 0; i < interfaces; ++i)
+                pool.Submit(std::bind(&EStackupPrismThermalModelBuilder::BuildContactCandidates, this, i, std::ref(pairs.at(i))));
+        }
+        {
+            constexpr size_t chunk = 4096;
+            generic::thread::ThreadPool pool(threads);
+            for (size_t i = 0; i < interfaces; ++i) {
+                areas[i].resize(pairs.at(i).size());
+                for (size_t start = 0; start < pairs.at(i).size(); start += chunk)
+                    pool.Submit(std::bind(&EStackupPrismThermalModelBuilder::BuildContactAreas, this, std::ref(pairs.at(i)), std::ref(areas.at(i)), start, std::min(start + chunk, pairs.at(i).size())));
             }
-            if (instance.contactInstances.empty())
-                instance.neighbors[PrismElement::BOT_NEIGHBOR_INDEX] = noNeighbor;
-            else instance.neighbors[PrismElement::BOT_NEIGHBOR_INDEX] = i;
+        }
+        generic::thread::ThreadPool pool(threads);
+        for (size_t i = 0; i < interfaces; ++i)
+            pool.Submit(std::bind(&EStackupPrismThermalModelBuilder::BuildContactInstances, this, std::ref(pairs.at(i)), std::ref(areas.at(i))));
+    }
+    else {
+        for (size_t i = 0; i < interfaces; ++i) {
+            BuildContactCandidates(i, pairs.at(i));
+            areas[i].resize(pairs.at(i).size());
+            BuildContactAreas(pairs.at(i), areas.at(i), 0, pairs.at(i).size());
+            BuildContactInstances(pairs.at(i), areas.at(i));
         }
     }
+    m_triangles.clear();
+    m_triangles.shrink_to_fit();
+}
+
+ECAD_INLINE void EStackupPrismThermalModelBuilder::BuildContactCandidates(size_t layer, std::vector<ContactPair> & pairs) const
+{
+    //sweep along x over the triangle boxes of the two layers, only boxes with overlapped interiors are paired
+    struct Box { EFloat xmin, xmax, ymin, ymax; size_t index; };
+    auto boxes = [&](size_t lyr) {
+        std::vector<Box> result;
+        const auto & offset = m_model->m_indexOffset;
+        result.reserve(offset.at(lyr + 1) - offset.at(lyr));
+        for (size_t i = offset.at(lyr); i < offset.at(lyr + 1); ++i) {
+            const auto & t = m_triangles.at(i);
+            auto [xmin, xmax] = std::minmax({t[0][0], t[1][0], t[2][0]});
+            auto [ymin, ymax] = std::minmax({t[0][1], t[1][1], t[2][1]});
+            result.emplace_back(Box{xmin, xmax, ymin, ymax, i});
+        }
+        std::sort(result.begin(), result.end(), [](const Box & b1, const Box & b2){ return b1.xmin < b2.xmin; });
+        return result;
+    };
+    
+    pairs.clear();
+    std::array<std::vector<Box>, 2> sorted{boxes(layer), boxes(layer + 1)};
+    std::array<std::vector<Box>, 2> active;
+    std::array<size_t, 2> next{0, 0};
+    while (next[0] < sorted[0].size() || next[1] < sorted[1].size()) {
+        size_t side = next[1] == sorted[1].size() ||
+            (next[0] < sorted[0].size() && sorted[0][next[0]].xmin <= sorted[1][next[1]].xmin) ? 0 : 1;
+        const auto & box = sorted[side][next[side]++];
+        auto & others = active[1 - side];
+        others.erase(std::remove_if(others.begin(), others.end(), [&box](const Box & b){ return b.xmax <= box.xmin; }), others.end());
+        for (const auto & other : others) {
+            if (other.ymin < box.ymax && box.ymin < other.ymax)
+                pairs.emplace_back(side == 0 ? ContactPair{box.index, other.index} : ContactPair{other.index, box.index});
+        }
+        active[side].emplace_back(box);
+    }
+}
+
+ECAD_INLINE void EStackupPrismThermalModelBuilder::BuildContactAreas(const std::vector<ContactPair> & pairs, std::vector<EFloat> & areas, size_t start, size_t end) const
+{
+    for (size_t i = start; i < end; ++i)
+        areas[i] = GetIntersectArea(m_triangles.at(pairs.at(i).first), m_triangles.at(pairs.at(i).second));
+}
+
+ECAD_INLINE void EStackupPrismThermalModelBuilder::BuildContactInstances(const std::vector<ContactPair> & pairs, const std::vector<EFloat> & areas)
+{
+    //each pair is clipped once and shared by the bot contacts of the upper prism and the top contacts of the lower prism
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (not (areas.at(i) > 0)) continue;
+        auto [top, bot] = pairs.at(i);
+        m_model->m_prisms[top].contactInstances.back().emplace_back(bot, areas.at(i) / GetTriangleArea(m_triangles.at(top)));
+        m_model->m_prisms[bot].contactInstances.front().emplace_back(top, areas.at(i) / GetTriangleArea(m_triangles.at(bot)));
+    }
 }
 
 ECAD_INLINE void EStackupPrismThermalModelBuilder::AddBondWiresFromLayerCutModel(CPtr<ELayerCutModel> lcm)
 {
+    m_model->ReleaseSolverCache();
     for (const auto & bondwire : lcm->GetAllBondwires()) {
         const auto & pts = bondwire.pt2ds;
         ECAD_ASSERT(pts.size() == bondwire.heights.size());
@@ -131,13 +217,63 @@ ECAD_INLINE void EStackupPrismThermalModelBuilder::AddBondWiresFromLayerCutModel
     }
 }
 
-ECAD_INLINE EFloat EStackupPrismThermalModelBuilder::GetIntersectArea(const ETriangle2D & t1, const ETriangle2D & t2)
+ECAD_INLINE EFloat EStackupPrismThermalModelBuilder::GetIntersectArea(const Triangle & t1, const Triangle & t2)
 {
+    //Sutherland-Hodgman, t2 is clipped by the three edges of t1, coordinates are relative to t1's first vertex for precision
+    using Point = std::array<EFloat, 2>;
+    auto cross = [](const Point & o, const Point & a, const Point & b) {
+        return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0]);
+    };
+    const auto & o = t1.front();
+    Triangle clipper;
+    for (size_t v = 0; v < 3; ++v)
+        clipper[v] = {t1[v][0] - o[0], t1[v][1] - o[1]};
+    //a degenerated clipper has no inside, every point would lie on its edges
+    auto orient = cross(clipper[0], clipper[1], clipper[2]);
+    if (orient == 0) return 0;
+    if (orient < 0) std::swap(clipper[1], clipper[2]);
+
+    //each edge adds at most one vertex to a convex polygon, twice the bound is kept for the degenerated cases
+    std::array<std::array<Point, 24>, 2> buffer;
+    std::array<size_t, 2> size{3, 0};
+    for (size_t v = 0; v < 3; ++v)
+        buffer[0][v] = {t2[v][0] - o[0], t2[v][1] - o[1]};
+
+    size_t curr = 0;
+    for (size_t e = 0; e < 3; ++e) {
+        const auto & a = clipper[e];
+        const auto & b = clipper[(e + 1) % 3];
+        const auto & in = buffer[curr];
+        auto & out = buffer[1 - curr];
+        size_t n = 0;
+        for (size_t j = 0; j < size[curr] && n + 2 <= out.size(); ++j) {
+            const auto & p = in[j];
+            const auto & q = in[(j + 1) % size[curr]];
+            auto dp = cross(a, b, p), dq = cross(a, b, q);
+            if (dp >= 0) out[n++] = p;
+            if ((dp >= 0) != (dq >= 0)) {
+                auto t = dp / (dp - dq);
+                out[n++] = {p[0] + t * (q[0] - p[0]), p[1] + t * (q[1] - p[1])};
+            }
+        }
+        if (n < 3) return 0;
+        size[1 - curr] = n;
+        curr = 1 - curr;
+    }
+
     EFloat area = 0;
-    std::vector<EPolygonData> output;
-    generic::geometry::boolean::Intersect(t1, t2, output);
-    std::for_each(output.begin(), output.end(), [&area](const EPolygonData & p) { area += p.Area(); });
-    return area;
+    const auto & polygon = buffer[curr];
+    for (size_t j = 0; j < size[curr]; ++j) {
+        const auto & p = polygon[j];
+        const auto & q = polygon[(j + 1) % size[curr]];
+        area += p[0] * q[1] - q[0] * p[1];
+    }
+    return std::fabs(area) * 0.5;
+}
+
+ECAD_INLINE EFloat EStackupPrismThermalModelBuilder::GetTriangleArea(const Triangle & t)
+{
+    return std::fabs((t[1][0] - t[0][0]) * (t[2][1] - t[0][1]) - (t[1][1] - t[0][1]) * (t[2][0] - t[0][0])) * 0.5;
 }
 
 } // namespace ecad::model::utils
@@ -14,14 +14,25 @@ public:
     explicit EStackupPrismThermalModelBuilder(Ptr<EStackupPrismThermalModel> model);
     virtual ~EStackupPrismThermalModelBuilder();
 
+    using Triangle = std::array<std::array<EFloat, 2>, 3>;
     void BuildPrismModel(EFloat scaleH2Unit, EFloat scale2Meter, size_t threads);
-    void BuildPrismInstanceTopBotNeighbors(size_t start, size_t end);
+    void BuildPrismInstanceTopBotNeighbors(size_t threads);
 
     void AddBondWiresFromLayerCutModel(CPtr<ELayerCutModel> lcm);
-    static EFloat GetIntersectArea(const ETriangle2D & t1, const ETriangle2D & t2);
+    ///exact overlap area of two triangles by convex clipping
+    static EFloat GetIntersectArea(const Triangle & t1, const Triangle & t2);
+    static EFloat GetTriangleArea(const Triangle & t);
+
+protected:
+    using ContactPair = std::pair<size_t, size_t>;//[top prism, bot prism]
+    void BuildContactCandidates(size_t layer, std::vector<ContactPair> & pairs) const;//between layer and layer + 1
+    void BuildContactAreas(const std::vector<ContactPair> & pairs, std::vector<EFloat> & areas, size_t start, size_t end) const;
+    void BuildContactInstances(const std::vector<ContactPair> & pairs, const std::vector<EFloat> & areas);
+
 protected:
     Ptr<EStackupPrismThermalModel> m_model;
     UPtr<EStackupPrismThermalModelQuery> m_query;
+    std::vector<Triangle> m_triangles;//top bot face of each prism instance, only kept while building the contacts
 };
 } // namespace utils
 } // namespace model
@@ -54,6 +54,38 @@ ECAD_API EPair<EFloat, EFloat> EThermalSimulation::RunStaticSimulation(std::vect
     return {invalidFloat, invalidFloat};
 }
 
+ECAD_API std::vector<EPair<EFloat, EFloat> > EThermalSimulation::RunStaticSimulation(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const
+{
+    ECAD_TRACE("run static thermal simulation of %1% cases at %2%", cases.size(), m_setup.workDir);
+    if (nullptr == m_model) {
+        ECAD_ASSERT(false)
+        return {};
+    }
+    if (not generic::fs::CreateDir(m_setup.workDir)) {
+        ThrowException("failed to create folder: " + m_setup.workDir);
+        return {};
+    }
+    auto modelType = m_model->GetModelType();
+    switch (modelType) {
+    case EModelType::ThermalGrid : {
+        if (auto grid = dynamic_cast<CPtr<EGridThermalModel> >(m_model); grid)
+            return EGridThermalSimulator(grid, m_setup).RunStaticSimulation(cases, temperatures);
+    }
+    case EModelType::ThermalPrism : {
+        if (auto prism = dynamic_cast<CPtr<EPrismThermalModel> >(m_model); prism)
+            return EPrismThermalSimulator(prism, m_setup).RunStaticSimulation(cases, temperatures);
+    }
+    case EModelType::ThermalStackupPrism : {
+        if (auto prism = dynamic_cast<CPtr<EStackupPrismThermalModel> >(m_model); prism)
+            return EStackupPrismThermalSimulator(prism, m_setup).RunStaticSimulation(cases, temperatures);
+    }
+    default :
+        ECAD_ASSERT(false)
+        return {};
+    }
+    return {};
+}
+
 ECAD_API EPair<EFloat, EFloat> EThermalSimulation::RunTransientSimulation(const EThermalTransientExcitation & excitation) const
 {
     if (nullptr == m_model){
@@ -109,6 +141,20 @@ ECAD_API EPair<EFloat, EFloat> EGridThermalSimulator::RunStaticSimulation(std::v
     return solver.Solve(temperatures);
 }
 
+ECAD_API std::vector<EPair<EFloat, EFloat> > EGridThermalSimulator::RunStaticSimulation(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const
+{
+    ECAD_EFFICIENCY_TRACK("grid thermal multiple cases static simulation")
+    auto model = dynamic_cast<CPtr<EGridThermalModel> >(m_model);
+    auto setup = dynamic_cast<CPtr<EThermalStaticSimulationSetup> >(&m_setup);
+    if (nullptr == model || nullptr == setup) return {};
+
+    EGridThermalNetworkStaticSolver solver(*model);
+    solver.settings.workDir = setup->workDir;
+    solver.settings = setup->settings;
+    model->SearchElementIndices(setup->monitors, solver.settings.probs);
+    return solver.Solve(cases, temperatures);
+}
+
 ECAD_API EPair<EFloat, EFloat> EGridThermalSimulator::RunTransientSimulation(const EThermalTransientExcitation & excitation) const
 {
     ECAD_EFFICIENCY_TRACK("grid thermal transient simulation")
@@ -142,6 +188,20 @@ ECAD_API EPair<EFloat, EFloat> EPrismThermalSimulator::RunStaticSimulation(std::
     return solver.Solve(temperatures);
 }
 
+ECAD_API std::vector<EPair<EFloat, EFloat> > EPrismThermalSimulator::RunStaticSimulation(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const
+{
+    ECAD_EFFICIENCY_TRACK("prism thermal multiple cases static simulation")
+    auto model = dynamic_cast<CPtr<EPrismThermalModel> >(m_model);
+    auto setup = dynamic_cast<CPtr<EThermalStaticSimulationSetup> >(&m_setup);
+    if (nullptr == model || nullptr == setup) return {};
+
+    EPrismThermalNetworkStaticSolver solver(*model);
+    solver.settings.workDir = setup->workDir;
+    solver.settings = setup->settings;
+    model->SearchElementIndices(setup->monitors, solver.settings.probs);
+    return solver.Solve(cases, temperatures);
+}
+
 ECAD_API EPair<EFloat, EFloat> EPrismThermalSimulator::RunTransientSimulation(const EThermalTransientExcitation & excitation) const
 {
     ECAD_EFFICIENCY_TRACK("prism thermal transient simulation")
@@ -176,6 +236,20 @@ ECAD_API EPair<EFloat, EFloat> EStackupPrismThermalSimulator::RunStaticSimulatio
     return solver.Solve(temperatures);
 }
 
+ECAD_API std::vector<EPair<EFloat, EFloat> > EStackupPrismThermalSimulator::RunStaticSimulation(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const
+{
+    ECAD_EFFICIENCY_TRACK("stackup prism thermal multiple cases static simulation")
+    auto model = dynamic_cast<CPtr<EStackupPrismThermalModel> >(m_model);
+    auto setup = dynamic_cast<CPtr<EThermalStaticSimulationSetup> >(&m_setup);
+    if (nullptr == model || nullptr == setup) return {};
+
+    EStackupPrismThermalNetworkStaticSolver solver(*model);
+    solver.settings.workDir = setup->workDir;
+    solver.settings = setup->settings;
+    model->SearchElementIndices(setup->monitors, solver.settings.probs);
+    return solver.Solve(cases, temperatures);
+}
+
 ECAD_API EPair<EFloat, EFloat> EStackupPrismThermalSimulator::RunTransientSimulation(const EThermalTransientExcitation & excitation) const
 {
     ECAD_EFFICIENCY_TRACK("stackup prism thermal transient simulation")
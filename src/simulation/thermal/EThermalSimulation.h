@@ -16,6 +16,7 @@ public:
     explicit EThermalSimulation(CPtr<IModel> model, const EThermalSimulationSetup & setup);
     virtual ~EThermalSimulation() = default;
     virtual EPair<EFloat, EFloat> RunStaticSimulation(std::vector<EFloat> & temperatures) const;
+    virtual std::vector<EPair<EFloat, EFloat> > RunStaticSimulation(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const;
     virtual EPair<EFloat, EFloat> RunTransientSimulation(const EThermalTransientExcitation & excitation) const;
 protected:
     CPtr<IModel> m_model{nullptr};
@@ -27,6 +28,7 @@ class ECAD_API EThermalSimulator
 public:
     virtual ~EThermalSimulator() = default;
     virtual EPair<EFloat, EFloat> RunStaticSimulation(std::vector<EFloat> & temperatures) const = 0;
+    virtual std::vector<EPair<EFloat, EFloat> > RunStaticSimulation(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const = 0;
     virtual EPair<EFloat, EFloat> RunTransientSimulation(const EThermalTransientExcitation & excitation) const = 0;
 protected:
     EThermalSimulator(CPtr<IModel> model, const EThermalSimulationSetup & setup);
@@ -40,6 +42,7 @@ public:
     explicit EGridThermalSimulator(CPtr<EGridThermalModel> model, const EThermalSimulationSetup & setup);
     virtual ~EGridThermalSimulator() = default;
     EPair<EFloat, EFloat> RunStaticSimulation(std::vector<EFloat> & temperatures) const override;
+    std::vector<EPair<EFloat, EFloat> > RunStaticSimulation(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const override;
     EPair<EFloat, EFloat> RunTransientSimulation(const EThermalTransientExcitation & excitation) const override;
 };
 
@@ -49,6 +52,7 @@ public:
     explicit EPrismThermalSimulator(CPtr<EPrismThermalModel> model, const EThermalSimulationSetup & setup);
     virtual ~EPrismThermalSimulator() = default;
     EPair<EFloat, EFloat> RunStaticSimulation(std::vector<EFloat> & temperatures) const override;
+    std::vector<EPair<EFloat, EFloat> > RunStaticSimulation(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const override;
     EPair<EFloat, EFloat> RunTransientSimulation(const EThermalTransientExcitation & excitation) const override;
 };
 
@@ -58,6 +62,7 @@ public:
     explicit EStackupPrismThermalSimulator(CPtr<EStackupPrismThermalModel> model, const EThermalSimulationSetup & setup);
     virtual ~EStackupPrismThermalSimulator() = default;
     EPair<EFloat, EFloat> RunStaticSimulation(std::vector<EFloat> & temperatures) const override;
+    std::vector<EPair<EFloat, EFloat> > RunStaticSimulation(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const override;
     EPair<EFloat, EFloat> RunTransientSimulation(const EThermalTransientExcitation & excitation) const override;
 };
 }//namespace simulations
@@ -37,6 +37,18 @@ ECAD_INLINE Scalar CalculateResidual(const std::vector<Scalar> & v1, const std::
     return residual;
 }
 
+///the solver is kept by the model, so a re-simulation after an in-place model update only refactorizes numerically,
+///it is taken out of the model while solving and kept back after a successful solve
+template <typename Scalar>
+ECAD_INLINE SPtr<thermal::solver::ThermalNetworkSolver<Scalar> > TakeStaticSolver(const EThermalModel & model, int solverType)
+{
+    using Solver = thermal::solver::ThermalNetworkSolver<Scalar>;
+    auto solver = model.GetSolverCache().Take<Solver>();
+    if (nullptr == solver || solver->SolverType() != solverType)
+        solver = std::make_shared<Solver>(solverType);
+    return solver;
+}
+
 template <typename ThermalNetworkBuilder>
 ECAD_INLINE bool EThermalNetworkStaticSolver::Solve(const typename ThermalNetworkBuilder::ModelType & model, std::vector<Scalar> & results) const
 {
@@ -48,23 +60,25 @@ ECAD_INLINE bool EThermalNetworkStaticSolver::Solve(const typename ThermalNetwor
     Scalar residual = 0;
     size_t iteration = 0;
     size_t maxIteration = traits::EThermalModelTraits<Model>::NeedIteration(model) ? settings.iteration : 1;
+    using namespace thermal::solver;
+    auto solver = TakeStaticSolver<Scalar>(model, static_cast<int>(settings.solverType));
     do {
         std::vector<Scalar> prevRes(results);
-        auto network = builder.Build(prevRes);
+        auto network = builder.Build(prevRes, settings.threads);
         if (nullptr == network) return false;
         ECAD_TRACE("total nodes: %1%", network->Size());
         ECAD_TRACE("total joule heat: %1%w", builder.summary.jouleHeat);
         ECAD_TRACE("intake  heat flow: %1%w", builder.summary.iHeatFlow);
         ECAD_TRACE("outtake heat flow: %1%w", builder.summary.oHeatFlow);
 
-        using namespace thermal::solver;
-        ThermalNetworkSolver<Scalar> solver(*network, static_cast<int>(settings.solverType));
-        solver.Solve(envT, results);
+        if (not solver->Solve(network->Freeze(), envT, results)) return false;
 
         residual = CalculateResidual(results, prevRes, settings.maximumRes);
         ECAD_TRACE("P-T Iteration: %1%, Residual: %2%.", ++iteration, residual);
         ECAD_TRACE("max T: %1%C", ETemperature::Kelvins2Celsius(*std::max_element(results.begin(), results.end())));
     } while (residual > settings.residual && --maxIteration > 0);
+    ECAD_TRACE("symbolic analysis: %1%, numeric factorization: %2%", solver->Analyzed(), solver->Factorized());
+    model.GetSolverCache().Keep(std::move(solver));
 
     if (settings.envTemperature.unit == ETemperatureUnit::Celsius) 
         std::for_each(results.begin(), results.end(), [](auto & t){ t = ETemperature::Kelvins2Celsius(t); });
@@ -82,10 +96,93 @@ ECAD_INLINE bool EThermalNetworkStaticSolver::Solve(const typename ThermalNetwor
     return true;   
 }
 
+template <typename ThermalNetworkBuilder>
+ECAD_INLINE bool EThermalNetworkStaticSolver::Solve(const typename ThermalNetworkBuilder::ModelType & model, const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<Scalar> > & results) const
+{
+    results.clear();
+    if (cases.empty()) return false;
+
+    auto envT = settings.envTemperature.inKelvins();
+    ThermalNetworkBuilder builder(model);
+    using Model = typename ThermalNetworkBuilder::ModelType;
+    using namespace thermal::solver;
+    auto solver = TakeStaticSolver<Scalar>(model, static_cast<int>(settings.solverType));
+
+    //a linear model shares one factorization between all cases, a temperature dependent model iterates P-T on the
+    //temperature field of each case, since the conductivities and power luts of one case depend on its own temperatures
+    bool nonlinear = traits::EThermalModelTraits<Model>::NeedIteration(model);
+    size_t batches = nonlinear ? cases.size() : 1;
+    results.resize(cases.size());
+    for (size_t batch = 0; batch < batches; ++batch) {
+        auto batchCases = nonlinear ? std::vector<EThermalStaticExcitation>{cases.at(batch)} : cases;
+        std::vector<std::vector<Scalar> > batchResults;
+        std::vector<Scalar> temperatures(traits::EThermalModelTraits<Model>::Size(model), envT);
+
+        Scalar residual = 0;
+        size_t iteration = 0;
+        size_t maxIteration = nonlinear ? settings.iteration : 1;
+        do {
+            std::vector<Scalar> prevRes(temperatures);
+            auto network = builder.Build(prevRes, settings.threads);
+            if (nullptr == network) return false;
+            ECAD_TRACE("total nodes: %1%, cases: %2%", network->Size(), batchCases.size());
+
+            if (not solver->Solve(network->Freeze(), envT, batchCases, batchResults)) return false;
+
+            temperatures = batchResults.front();
+            residual = CalculateResidual(temperatures, prevRes, settings.maximumRes);
+            ECAD_TRACE("P-T Iteration: %1%, Residual: %2%.", ++iteration, residual);
+        } while (residual > settings.residual && --maxIteration > 0);
+
+        if (nonlinear) results[batch] = std::move(batchResults.front());
+        else results = std::move(batchResults);
+    }
+    ECAD_TRACE("symbolic analysis: %1%, numeric factorization: %2%", solver->Analyzed(), solver->Factorized());
+    model.GetSolverCache().Keep(std::move(solver));
+
+    if (settings.envTemperature.unit == ETemperatureUnit::Celsius) {
+        for (auto & result : results)
+            std::for_each(result.begin(), result.end(), [](auto & t){ t = ETemperature::Kelvins2Celsius(t); });
+    }
+
+    if (settings.dumpResults && not settings.workDir.empty()) {
+        auto filename = settings.workDir + ECAD_SEPS + "static_cases.txt";
+        std::ofstream out(filename);
+        if (out.is_open()) {
+            for (const auto & result : results) {
+                for (auto index : settings.probs)
+                    out << result.at(index) << ',';
+                out << ECAD_EOL;
+            }
+            out.close();
+        }
+    }
+    return true;
+}
+
+template <typename Scalar>
+ECAD_INLINE std::vector<EPair<EFloat, EFloat> > CollectCaseResults(const std::vector<std::vector<Scalar> > & results, const std::vector<size_t> & probs, std::vector<std::vector<EFloat> > & temperatures)
+{
+    std::vector<EPair<EFloat, EFloat> > ranges;
+    ranges.reserve(results.size());
+    temperatures.assign(results.size(), std::vector<EFloat>(probs.size()));
+    for (size_t j = 0; j < results.size(); ++j) {
+        const auto & result = results.at(j);
+        auto [minT, maxT] = std::minmax_element(result.begin(), result.end());
+        ranges.emplace_back(*minT, *maxT);
+        for (size_t i = 0; i < probs.size(); ++i)
+            temperatures[j][i] = result.at(probs.at(i));
+    }
+    return ranges;
+}
+
 using StaticSolverNumType = typename EThermalNetworkStaticSolver::Scalar;
 ECAD_INLINE template bool EThermalNetworkStaticSolver::Solve<EGridThermalNetworkBuilder<StaticSolverNumType>>(const EGridThermalModel & model, std::vector<StaticSolverNumType> & results) const;
 ECAD_INLINE template bool EThermalNetworkStaticSolver::Solve<EPrismThermalNetworkBuilder<StaticSolverNumType>>(const EPrismThermalModel & model, std::vector<StaticSolverNumType> & results) const;
 ECAD_INLINE template bool EThermalNetworkStaticSolver::Solve<EStackupPrismThermalNetworkBuilder<StaticSolverNumType>>(const EStackupPrismThermalModel & model, std::vector<StaticSolverNumType> & results) const;
+ECAD_INLINE template bool EThermalNetworkStaticSolver::Solve<EGridThermalNetworkBuilder<StaticSolverNumType>>(const EGridThermalModel & model, const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<StaticSolverNumType> > & results) const;
+ECAD_INLINE template bool EThermalNetworkStaticSolver::Solve<EPrismThermalNetworkBuilder<StaticSolverNumType>>(const EPrismThermalModel & model, const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<StaticSolverNumType> > & results) const;
+ECAD_INLINE template bool EThermalNetworkStaticSolver::Solve<EStackupPrismThermalNetworkBuilder<StaticSolverNumType>>(const EStackupPrismThermalModel & model, const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<StaticSolverNumType> > & results) const;
 
 EThermalNetworkTransientSolver::EThermalNetworkTransientSolver(const EThermalTransientExcitation & excitation)
  : settings("", 1), m_excitation(excitation)
@@ -101,11 +198,21 @@ ECAD_INLINE bool EThermalNetworkTransientSolver::Solve(const typename ThermalNet
     maxT = -maxFloat;
     auto envT = settings.envTemperature.inKelvins();
     ThermalNetworkBuilder builder(model);
-    UPtr<typename ThermalNetworkBuilder::Network> network;
     using Model = typename ThermalNetworkBuilder::ModelType;
     
     size_t steps{0};
     Samples<Scalar> samples;
+    std::unique_ptr<thermal::utils::SampleSink<Scalar> > sink;
+    bool celsius = settings.envTemperature.unit == ETemperatureUnit::Celsius;
+    if (settings.sink.binary && settings.dumpResults && not settings.workDir.empty()) {
+        std::vector<std::string> names; names.reserve(settings.probs.size());
+        for (size_t i = 0; i < settings.probs.size(); ++i) names.emplace_back("probe" + std::to_string(i));
+        auto filename = settings.workDir + ECAD_SEPS + "trans.bin";
+        auto binary = std::make_unique<thermal::utils::BinarySampleSink<Scalar> >(filename, settings.probs, names, celsius, settings.sink.decimation, settings.sink.chunkRows);
+        if (binary->isOpen()) sink = std::move(binary);
+        else ECAD_TRACE("failed to open %1%, samples are kept in memory", filename);
+    }
+    if (nullptr == sink) sink = std::make_unique<thermal::utils::MemorySampleSink<Scalar> >(samples, celsius, settings.sink.decimation);
     TimeWindow<Scalar> window(settings.duration - settings.samplingWindow, settings.duration, settings.minSamplingInterval);
     ECAD_TRACE("duration: %1%, step: %2%, abs error: %3%, rel error: %4%", settings.duration, settings.step, settings.absoluteError, settings.relativeError);
     if (0 == settings.mor.order) {
@@ -114,73 +221,83 @@ ECAD_INLINE bool EThermalNetworkTransientSolver::Solve(const typename ThermalNet
         using StateType = typename TransSolver::StateType;
         using Sampler = typename TransSolver::Sampler;
         StateType initT(traits::EThermalModelTraits<Model>::Size(model), envT);
+        auto implicit = static_cast<int>(settings.integrator);
         if (settings.temperatureDepend) {
             Scalar time = 0;
             while (time < settings.duration) {
                 if (settings.verbose)
                     ECAD_TRACE("time:%1%/%2%", time, settings.duration);
-                auto network = builder.Build(initT);
-                TransSolver solver(*network, envT, settings.probs);
-                Sampler sampler(solver, samples, initT, window, settings.duration, settings.verbose);
-                steps += settings.adaptive ?
+                auto network = builder.Build(initT, settings.threads)->Freeze();
+                TransSolver solver(network, envT, settings.probs);
+                Sampler sampler(solver, *sink, initT, window, settings.duration, settings.verbose);
+                if (implicit)
+                    steps += solver.SolveImplicit(implicit, settings.adaptive, initT, time, settings.step, settings.adaptive ? settings.step : settings.minSamplingInterval,
+                                                  settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation);
+                else steps += settings.adaptive ?
                          solver.SolveAdaptive(initT, time, settings.step, settings.minSamplingInterval, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation) :
                          solver.Solve(initT, time, settings.step, settings.minSamplingInterval, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation);
                 time += settings.step;
             }
         }
         else {
-            auto network = builder.Build(initT);
-            TransSolver solver(*network, envT, settings.probs);
-            Sampler sampler(solver, samples, initT, window, settings.duration, settings.verbose);
-            steps = settings.adaptive ?
+            auto network = builder.Build(initT, settings.threads)->Freeze();
+            TransSolver solver(network, envT, settings.probs);
+            Sampler sampler(solver, *sink, initT, window, settings.duration, settings.verbose);
+            if (implicit)
+                steps = solver.SolveImplicit(implicit, settings.adaptive, initT, Scalar{0}, settings.duration, settings.adaptive ? settings.step : settings.minSamplingInterval,
+                                             settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation);
+            else steps = settings.adaptive ?
                     solver.SolveAdaptive(initT, Scalar{0}, settings.duration, settings.step, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation) :
                     solver.Solve(initT, Scalar{0}, settings.duration, settings.minSamplingInterval, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation);
         }
     }
     else {
         ECAD_EFFICIENCY_TRACK("transient mor")
+        if (settings.integrator != EThermalTransientIntegratorType::Explicit)
+            ECAD_TRACE("implicit integrators apply to the full network only, the reduced model is integrated explicitly");
         using TransSolver = ThermalNetworkReducedTransientSolver<Scalar>;
         using StateType = typename TransSolver::StateType;
         using Sampler = typename TransSolver::Sampler;
         StateType initT(traits::EThermalModelTraits<Model>::Size(model), envT);
         if (settings.temperatureDepend) {
             Scalar time = 0;
+            ParametricReducedModel<Scalar> prom(settings.mor.order, envT, settings.mor.bucket);
             while (time < settings.duration) {
                 ECAD_TRACE("time:%1%/%2%", time, settings.duration);
                 StateType initState;
-                auto network = builder.Build(initT);
-                TransSolver solver(*network, envT, settings.probs, settings.mor.order, {}, {});
-                if (not solver.Im().Input2State(initT, initState)) return false;
-                Sampler sampler(solver, samples, initState, window, settings.duration, settings.verbose);
+                auto network = builder.Build(initT, settings.threads)->Freeze();
+                auto solver = settings.mor.parametric ?
+                    std::make_unique<TransSolver>(network, envT, settings.probs, prom, initT) :
+                    std::make_unique<TransSolver>(network, envT, settings.probs, settings.mor.order, std::string{}, std::string{});
+                if (not solver->Im().Input2State(initT, initState)) return false;
+                Sampler sampler(*solver, *sink, initState, window, settings.duration, settings.verbose);
                 steps += settings.adaptive ?
-                         solver.SolveAdaptive(initState, time, settings.step, settings.minSamplingInterval, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation) :
-                         solver.Solve(initState, time, settings.step, settings.minSamplingInterval, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation);
+                         solver->SolveAdaptive(initState, time, settings.step, settings.minSamplingInterval, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation) :
+                         solver->Solve(initState, time, settings.step, settings.minSamplingInterval, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation);
 
-                solver.Im().State2Output(initState, initT);
+                solver->Im().State2Full(initState, initT);
                 time += settings.step;
             }
+            if (settings.mor.parametric)
+                ECAD_TRACE("parametric mor, reductions: %1%, projections: %2%", prom.Reductions(), prom.Projections());
         }
         else {
             StateType initState;
-            auto network = builder.Build(initT);
-            TransSolver solver(*network, envT, settings.probs, settings.mor.order, settings.mor.romLoadFile, settings.mor.romSaveFile);
+            auto network = builder.Build(initT, settings.threads)->Freeze();
+            TransSolver solver(network, envT, settings.probs, settings.mor.order, settings.mor.romLoadFile, settings.mor.romSaveFile);
             if (not solver.Im().Input2State(initT, initState)) return false;
-            Sampler sampler(solver, samples, initState, window, settings.duration, settings.verbose);
+            Sampler sampler(solver, *sink, initState, window, settings.duration, settings.verbose);
             steps = settings.adaptive ?
                     solver.SolveAdaptive(initState, Scalar{0}, settings.duration, settings.step, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation) :
                     solver.Solve(initState, Scalar{0}, settings.duration, settings.minSamplingInterval, settings.absoluteError, settings.relativeError, std::move(sampler), &m_excitation);
         }
     }
-    for (auto & sample : samples) {
-        auto begin = sample.begin(); begin++;
-        if (settings.envTemperature.unit == ETemperatureUnit::Celsius) {
-            std::for_each(begin, sample.end(), [](auto & t){ t = ETemperature::Kelvins2Celsius(t); });
-        }
-       
-        minT = std::min<EFloat>(minT, *std::min_element(begin, sample.end()));
-        maxT = std::max<EFloat>(maxT, *std::max_element(begin, sample.end()));
+    sink->Flush();
+    if (not sink->isEmpty()) {
+        minT = sink->MinT();
+        maxT = sink->MaxT();
     }
-    if (settings.dumpResults && not settings.workDir.empty()) {
+    if (settings.dumpResults && not settings.workDir.empty() && not samples.empty()) {
         auto filename = settings.workDir + ECAD_SEPS + "trans.txt";
         std::ofstream out(filename);
         if (out.is_open()) {
@@ -251,6 +368,15 @@ ECAD_INLINE EPair<EFloat, EFloat> EGridThermalNetworkStaticSolver::Solve(std::ve
     return {minT, maxT};
 }
 
+ECAD_INLINE std::vector<EPair<EFloat, EFloat> > EGridThermalNetworkStaticSolver::Solve(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const
+{
+    ECAD_EFFICIENCY_TRACK("grid thermal network multiple cases static solve")
+    std::vector<std::vector<Scalar> > results;
+    auto res = EThermalNetworkStaticSolver::template Solve<EGridThermalNetworkBuilder<Scalar>>(m_model, cases, results);
+    if (not res) return {};
+    return CollectCaseResults(results, settings.probs, temperatures);
+}
+
 ECAD_INLINE EGridThermalNetworkTransientSolver::EGridThermalNetworkTransientSolver(const EGridThermalModel & model, const EThermalTransientExcitation & excitation)
  : EGridThermalNetworkSolver(model), EThermalNetworkTransientSolver(excitation)
 {
@@ -297,6 +423,15 @@ ECAD_INLINE EPair<EFloat, EFloat> EPrismThermalNetworkStaticSolver::Solve(std::v
     return {minT, maxT};
 }
 
+ECAD_INLINE std::vector<EPair<EFloat, EFloat> > EPrismThermalNetworkStaticSolver::Solve(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const
+{
+    ECAD_EFFICIENCY_TRACK("prism thermal network multiple cases static solve")
+    std::vector<std::vector<Scalar> > results;
+    auto res = EThermalNetworkStaticSolver::template Solve<EPrismThermalNetworkBuilder<Scalar>>(m_model, cases, results);
+    if (not res) return {};
+    return CollectCaseResults(results, settings.probs, temperatures);
+}
+
 ECAD_INLINE EPrismThermalNetworkTransientSolver::EPrismThermalNetworkTransientSolver(const EPrismThermalModel & model, const EThermalTransientExcitation & excitation)
  : EPrismThermalNetworkSolver(model), EThermalNetworkTransientSolver(excitation)
 {
@@ -344,6 +479,15 @@ ECAD_INLINE EPair<EFloat, EFloat> EStackupPrismThermalNetworkStaticSolver::Solve
     return {minT, maxT};
 }
 
+ECAD_INLINE std::vector<EPair<EFloat, EFloat> > EStackupPrismThermalNetworkStaticSolver::Solve(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const
+{
+    ECAD_EFFICIENCY_TRACK("stackup prism thermal network multiple cases static solve")
+    std::vector<std::vector<Scalar> > results;
+    auto res = EThermalNetworkStaticSolver::template Solve<EStackupPrismThermalNetworkBuilder<Scalar>>(m_model, cases, results);
+    if (not res) return {};
+    return CollectCaseResults(results, settings.probs, temperatures);
+}
+
 ECAD_INLINE EStackupPrismThermalNetworkTransientSolver::EStackupPrismThermalNetworkTransientSolver(const EStackupPrismThermalModel & model, const EThermalTransientExcitation & excitation)
  : EStackupPrismThermalNetworkSolver(model), EThermalNetworkTransientSolver(excitation)
 {
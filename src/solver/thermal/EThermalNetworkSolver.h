@@ -22,6 +22,11 @@ public:
 
     template <typename ThermalNetworkBuilder>
     bool Solve(const typename ThermalNetworkBuilder::ModelType & model, std::vector<Scalar> & results) const;
+
+    ///results[j] are the temperatures of cases[j], a linear model factorizes once for all cases, 
+    ///a temperature dependent model is iterated case by case so each case matches a single case solve
+    template <typename ThermalNetworkBuilder>
+    bool Solve(const typename ThermalNetworkBuilder::ModelType & model, const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<Scalar> > & results) const;
 };
 
 class ECAD_API EThermalNetworkTransientSolver : public EThermalNetworkSolver
@@ -55,6 +60,7 @@ public:
     explicit EGridThermalNetworkStaticSolver(const EGridThermalModel & model);
     virtual ~EGridThermalNetworkStaticSolver() = default;
     EPair<EFloat, EFloat> Solve(std::vector<EFloat> & temperatures) const;
+    std::vector<EPair<EFloat, EFloat> > Solve(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const;
 };
 
 class ECAD_API EGridThermalNetworkTransientSolver : public EGridThermalNetworkSolver, EThermalNetworkTransientSolver
@@ -83,6 +89,7 @@ public:
     explicit EPrismThermalNetworkStaticSolver(const EPrismThermalModel & model);
     virtual ~EPrismThermalNetworkStaticSolver() = default;
     EPair<EFloat, EFloat> Solve(std::vector<EFloat> & temperatures) const;
+    std::vector<EPair<EFloat, EFloat> > Solve(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const;
 };
 
 class ECAD_API EPrismThermalNetworkTransientSolver : public EPrismThermalNetworkSolver, EThermalNetworkTransientSolver
@@ -111,6 +118,7 @@ public:
     explicit EStackupPrismThermalNetworkStaticSolver(const EStackupPrismThermalModel & model);
     virtual ~EStackupPrismThermalNetworkStaticSolver() = default;
     EPair<EFloat, EFloat> Solve(std::vector<EFloat> & temperatures) const;
+    std::vector<EPair<EFloat, EFloat> > Solve(const std::vector<EThermalStaticExcitation> & cases, std::vector<std::vector<EFloat> > & temperatures) const;
 };
 
 class ECAD_API EStackupPrismThermalNetworkTransientSolver : public EStackupPrismThermalNetworkSolver, EThermalNetworkTransientSolver
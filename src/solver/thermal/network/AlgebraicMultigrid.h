@@ -0,0 +1,269 @@
+#pragma once
+#include <Eigen/SparseCholesky>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+namespace thermal::solver {
+
+/**
+ * @brief smoothed aggregation algebraic multigrid for symmetric positive definite matrices,
+ *        solve() applies one symmetric V-cycle so it can be used as the preconditioner of Eigen::ConjugateGradient,
+ *        Iterate() repeats V-cycles as a standalone solver
+ */
+template <typename Scalar>
+class AlgebraicMultigrid
+{
+public:
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    using Matrix = Eigen::SparseMatrix<Scalar>;
+    using RowMatrix = Eigen::SparseMatrix<Scalar, Eigen::RowMajor>;
+    using StorageIndex = typename Vector::StorageIndex;
+    enum { ColsAtCompileTime = Eigen::Dynamic, MaxColsAtCompileTime = Eigen::Dynamic };
+
+    struct Settings
+    {
+        Scalar strength{0.08};//|a_ij| >= strength * sqrt(|a_ii * a_jj|) is a strong connection
+        Scalar omega{4.0 / 3};//prolongation smoothing weight, divided by the spectral radius of D^-1 * A
+        size_t coarseSize{500};//direct solve below this size
+        size_t maxLevels{20};
+        size_t sweeps{1};//pre and post Gauss-Seidel sweeps
+    };
+
+    AlgebraicMultigrid() = default;
+
+    template <typename MatType>
+    explicit AlgebraicMultigrid(const MatType & mat) { compute(mat); }
+
+    Eigen::Index rows() const { return m_levels.empty() ? 0 : m_levels.front().A.rows(); }
+    Eigen::Index cols() const { return rows(); }
+
+    Settings & settings() { return m_settings; }
+
+    template <typename MatType>
+    AlgebraicMultigrid & analyzePattern(const MatType &)
+    {
+        return *this;
+    }
+
+    template <typename MatType>
+    AlgebraicMultigrid & factorize(const MatType & mat)
+    {
+        m_levels.clear();
+        Matrix A(mat);
+        Vector nullspace = Vector::Ones(A.rows());//near null space, constant temperature on the finest level
+        while (true) {
+            auto & level = m_levels.emplace_back();
+            level.A = A;
+            level.A.makeCompressed();
+            level.invDiag = InvDiagonal(level.A);
+            level.x.resize(A.rows());
+            level.b.resize(A.rows());
+            level.r.resize(A.rows());
+
+            if (static_cast<size_t>(A.rows()) <= m_settings.coarseSize || m_levels.size() >= m_settings.maxLevels) break;
+            std::vector<StorageIndex> aggregates;
+            auto count = Aggregate(level.A, level.invDiag, aggregates);
+            if (0 == count || count == A.rows()) break;
+
+            level.P = Prolongator(level.A, level.invDiag, aggregates, count, nullspace);
+            level.R = level.P.transpose();
+            A = Matrix(level.R * Matrix(level.A * level.P));
+        }
+        m_coarse.compute(Matrix(m_levels.back().A));
+        m_info = m_coarse.info();
+        return *this;
+    }
+
+    template <typename MatType>
+    AlgebraicMultigrid & compute(const MatType & mat)
+    {
+        analyzePattern(mat);
+        return factorize(mat);
+    }
+
+    template <typename Rhs, typename Dest>
+    void _solve_impl(const Rhs & b, Dest & x) const
+    {
+        auto & top = m_levels.front();
+        top.b = b;
+        top.x.setZero();
+        VCycle(0);
+        x = top.x;
+    }
+
+    template <typename Rhs>
+    inline const Eigen::Solve<AlgebraicMultigrid, Rhs> solve(const Eigen::MatrixBase<Rhs> & b) const
+    {
+        return Eigen::Solve<AlgebraicMultigrid, Rhs>(*this, b.derived());
+    }
+
+    ///standalone solve by V-cycles starting from x, returns false if not converged to the relative residual tolerance
+    template <typename Rhs, typename Dest>
+    bool Iterate(const Rhs & b, Dest & x, Scalar tolerance, size_t maxIterations)
+    {
+        auto & top = m_levels.front();
+        Scalar bNorm = b.norm();
+        if (bNorm == 0) bNorm = 1;
+        top.x = x;
+        m_iterations = 0;
+        m_error = (b - top.A * top.x).norm() / bNorm;
+        while (m_error > tolerance && m_iterations < maxIterations) {
+            top.b = b;
+            VCycle(0);
+            auto last = m_error;
+            m_error = (b - top.A * top.x).norm() / bNorm;
+            m_iterations++;
+            if (m_error >= last) break;//stagnated at round-off level
+        }
+        x = top.x;
+        return m_error <= tolerance;
+    }
+
+    Eigen::ComputationInfo info() const { return m_info; }
+    size_t Levels() const { return m_levels.size(); }
+    size_t iterations() const { return m_iterations; }
+    Scalar error() const { return m_error; }
+
+private:
+    struct Level
+    {
+        RowMatrix A;
+        Matrix P;//next coarser level to this level
+        Matrix R;
+        Vector invDiag;
+        mutable Vector x, b, r;
+    };
+
+    void VCycle(size_t l) const
+    {
+        const auto & level = m_levels[l];
+        if (l + 1 == m_levels.size()) {
+            level.x = m_coarse.solve(level.b);
+            return;
+        }
+        for (size_t i = 0; i < m_settings.sweeps; ++i)
+            GaussSeidel(level, true);
+
+        level.r = level.b - level.A * level.x;
+        auto & coarse = m_levels[l + 1];
+        coarse.b = level.R * level.r;
+        coarse.x.setZero();
+        VCycle(l + 1);
+        level.x += level.P * coarse.x;
+
+        for (size_t i = 0; i < m_settings.sweeps; ++i)
+            GaussSeidel(level, false);
+    }
+
+    static void GaussSeidel(const Level & level, bool forward)
+    {
+        const auto & A = level.A;
+        const Eigen::Index n = A.rows();
+        for (Eigen::Index k = 0; k < n; ++k) {
+            auto i = forward ? k : n - 1 - k;
+            Scalar sum{0};
+            for (typename RowMatrix::InnerIterator it(A, i); it; ++it)
+                sum += it.value() * level.x[it.index()];
+            level.x[i] += (level.b[i] - sum) * level.invDiag[i];
+        }
+    }
+
+    static Vector InvDiagonal(const RowMatrix & A)
+    {
+        Vector invDiag = A.diagonal();
+        for (Eigen::Index i = 0; i < invDiag.size(); ++i)
+            invDiag[i] = invDiag[i] != 0 ? Scalar(1) / invDiag[i] : Scalar(1);
+        return invDiag;
+    }
+
+    Eigen::Index Aggregate(const RowMatrix & A, const Vector & invDiag, std::vector<StorageIndex> & aggregates) const
+    {
+        const Eigen::Index n = A.rows();
+        const StorageIndex none = -1;
+        auto isStrong = [&](Eigen::Index i, const typename RowMatrix::InnerIterator & it) {
+            if (it.index() == i) return false;
+            auto threshold = m_settings.strength * std::sqrt(std::abs(1 / (invDiag[i] * invDiag[it.index()])));
+            return std::abs(it.value()) >= threshold;
+        };
+
+        StorageIndex count{0};
+        aggregates.assign(n, none);
+        //pass 1, seed aggregates from nodes whose strong neighbors are all free
+        for (Eigen::Index i = 0; i < n; ++i) {
+            if (aggregates[i] != none) continue;
+            bool free = true;
+            for (typename RowMatrix::InnerIterator it(A, i); it && free; ++it)
+                if (isStrong(i, it) && aggregates[it.index()] != none) free = false;
+            if (not free) continue;
+            aggregates[i] = count;
+            for (typename RowMatrix::InnerIterator it(A, i); it; ++it)
+                if (isStrong(i, it)) aggregates[it.index()] = count;
+            count++;
+        }
+        //pass 2, join the aggregate of a strong neighbor
+        auto seeds = aggregates;
+        for (Eigen::Index i = 0; i < n; ++i) {
+            if (aggregates[i] != none) continue;
+            for (typename RowMatrix::InnerIterator it(A, i); it; ++it) {
+                if (isStrong(i, it) && seeds[it.index()] != none) {
+                    aggregates[i] = seeds[it.index()];
+                    break;
+                }
+            }
+        }
+        //pass 3, the leftovers form their own aggregates
+        for (Eigen::Index i = 0; i < n; ++i) {
+            if (aggregates[i] != none) continue;
+            aggregates[i] = count;
+            for (typename RowMatrix::InnerIterator it(A, i); it; ++it)
+                if (isStrong(i, it) && aggregates[it.index()] == none) aggregates[it.index()] = count;
+            count++;
+        }
+        return count;
+    }
+
+    ///nullspace is replaced by its coarse representation
+    Matrix Prolongator(const RowMatrix & A, const Vector & invDiag, const std::vector<StorageIndex> & aggregates, Eigen::Index count, Vector & nullspace) const
+    {
+        const Eigen::Index n = A.rows();
+        Vector norms = Vector::Zero(count);
+        for (Eigen::Index i = 0; i < n; ++i)
+            norms[aggregates[i]] += nullspace[i] * nullspace[i];
+        norms = norms.cwiseSqrt();
+
+        //tentative prolongator, the near null space restricted to each aggregate and normalized
+        std::vector<Eigen::Triplet<Scalar> > triplets;
+        triplets.reserve(n);
+        for (Eigen::Index i = 0; i < n; ++i)
+            triplets.emplace_back(i, aggregates[i], nullspace[i] / norms[aggregates[i]]);
+        nullspace = std::move(norms);
+        Matrix P0(n, count);
+        P0.setFromTriplets(triplets.begin(), triplets.end());
+
+        //Jacobi smoothing, spectral radius of D^-1 * A bounded by Gershgorin
+        Scalar rho{0};
+        for (Eigen::Index i = 0; i < n; ++i) {
+            Scalar sum{0};
+            for (typename RowMatrix::InnerIterator it(A, i); it; ++it)
+                sum += std::abs(it.value());
+            rho = std::max(rho, sum * std::abs(invDiag[i]));
+        }
+        if (rho == 0) return P0;
+        Matrix DinvA = Matrix(invDiag.asDiagonal() * Matrix(A));
+        Matrix P = P0 - (m_settings.omega / rho) * Matrix(DinvA * P0);
+        P.prune(Scalar(0));
+        return P;
+    }
+
+private:
+    Settings m_settings;
+    size_t m_iterations{0};
+    Scalar m_error{0};
+    std::vector<Level> m_levels;
+    Eigen::SimplicialLDLT<Matrix> m_coarse;
+    Eigen::ComputationInfo m_info{Eigen::InvalidInput};
+};
+
+} // namespace thermal::solver
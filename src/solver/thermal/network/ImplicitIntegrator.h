@@ -0,0 +1,267 @@
+#pragma once
+#include <Eigen/SparseCholesky>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+namespace thermal::solver {
+
+/**
+ * @brief implicit integrators of C * dx/dt = u(t) - G * x for stiff thermal RC networks,
+ *        every stage solves (coeff * C + G) * x = rhs, the matrix is factorized only when coeff changes,
+ *        so a run of steps with constant step size and order costs one factorization
+ */
+template <typename Scalar>
+class ImplicitIntegrator
+{
+public:
+    using State = std::vector<Scalar>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    using Matrix = Eigen::SparseMatrix<Scalar>;
+    using DenseMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    enum class Method { BackwardEuler = 1, TRBDF2 = 2, BDF = 3 };
+
+    static constexpr size_t maxOrder = 5;
+
+    ImplicitIntegrator(Vector c, Matrix g)
+     : m_c(std::move(c)), m_G(std::move(g))
+    {
+        std::vector<Eigen::Triplet<Scalar> > triplets;
+        triplets.reserve(m_c.size());
+        for (Eigen::Index i = 0; i < m_c.size(); ++i)
+            triplets.emplace_back(i, i, m_c[i]);
+        m_C = Matrix(m_c.size(), m_c.size());
+        m_C.setFromTriplets(triplets.begin(), triplets.end());
+        m_solver.analyzePattern(Matrix(m_G + m_C));
+    }
+
+    /**
+     * @brief integrates from t0 to t1, with local error control if adaptive, otherwise with constant step dt
+     * @param input input(t, u) fills the excitation u(t)
+     * @param observer observer(x, t) is called at t0 and after every accepted step
+     * @return number of accepted steps, 0 if failed
+     */
+    template <typename Input, typename Observer>
+    size_t Integrate(Method method, bool adaptive, State & x, Scalar t0, Scalar t1, Scalar dt, Scalar absErr, Scalar relErr, Input && input, Observer && observer)
+    {
+        if (static_cast<Eigen::Index>(x.size()) != m_c.size() || not (dt > 0) || not (t1 > t0)) return 0;
+        m_absErr = absErr; m_relErr = relErr;
+        switch (method) {
+            case Method::BackwardEuler : return IntegrateBDF(1, adaptive, x, t0, t1, dt, input, observer);
+            case Method::TRBDF2 : return IntegrateTRBDF2(adaptive, x, t0, t1, dt, input, observer);
+            case Method::BDF : return IntegrateBDF(maxOrder, adaptive, x, t0, t1, dt, input, observer);
+        }
+        return 0;
+    }
+
+    size_t Factorized() const { return m_factorized; }
+    size_t Rejected() const { return m_rejected; }
+
+private:
+    template <typename Input, typename Observer>
+    size_t IntegrateBDF(size_t maxK, bool adaptive, State & state, Scalar t0, Scalar t1, Scalar dt, Input & input, Observer & observer)
+    {
+        //backward differences formulation of ode15s without the NDF modification, dif.col(j) holds the (j + 1)th backward difference
+        static const Scalar G[maxOrder + 1] = {1, Scalar(3) / 2, Scalar(11) / 6, Scalar(25) / 12, Scalar(137) / 60, Scalar(49) / 20};
+        const Eigen::Index n = m_c.size();
+        Eigen::Map<Vector> x(state.data(), n);
+        const Scalar hMax = adaptive ? Scalar(0.1) * (t1 - t0) : t1 - t0;
+        const Scalar hMin = std::max(std::abs(t0), std::abs(t1)) * std::numeric_limits<Scalar>::epsilon() * 16;
+        Scalar h = std::min(dt, hMax);
+        Vector u(n), y0(n), psi(n), d(n), y(n);
+        DenseMatrix dif = DenseMatrix::Zero(n, maxK + 2);
+        input(t0, u);
+        dif.col(0) = h * Derivative(x, u);
+        observer(state, t0);
+
+        Scalar t = t0;
+        size_t k = 1, steps = 0, sameSteps = 0, failures = 0;
+        while (t < t1) {
+            if (t + h * Scalar(1.0001) >= t1) {//hit t1 exactly
+                Rescale(dif, k, (t1 - t) / h);
+                h = t1 - t;
+            }
+            if (h <= hMin) return 0;
+
+            const Scalar tn = t + h;
+            y0 = x + dif.leftCols(k).rowwise().sum();
+            psi = dif.leftCols(k) * (Eigen::Map<const Vector>(G, k) / G[k - 1]);
+            const Scalar coeff = G[k - 1] / h;
+            if (not Factorize(coeff)) return 0;
+            input(tn, u);
+            y = m_solver.solve(u + coeff * m_c.cwiseProduct(y0 - psi));
+            d = y - y0;
+
+            if (adaptive) {
+                Scalar err = ErrorNorm(d, x, y) / (k + 1);
+                if (err > 1) {
+                    m_rejected++;
+                    failures++;
+                    if (failures > 1 && k > 1) k--;
+                    auto hNew = h * std::max(Scalar(0.1), Scalar(0.833) * std::pow(1 / err, Scalar(1) / (k + 1)));
+                    Rescale(dif, k, hNew / h);
+                    h = hNew;
+                    sameSteps = 0;
+                    continue;
+                }
+            }
+            failures = 0;
+            dif.col(k + 1) = d - dif.col(k);
+            dif.col(k) = d;
+            for (size_t j = k; j > 0; --j)
+                dif.col(j - 1) += dif.col(j);
+            x = y;
+            t = tn;
+            steps++;
+            sameSteps++;
+            observer(state, t);
+
+            if (sameSteps < k + 2) continue;
+            if (adaptive) {
+                //choose the order and step size for the next steps
+                auto err = ErrorNorm(d, x, y) / (k + 1);
+                auto hOpt = h * std::max(Scalar(0.1), Scalar(0.833) * std::pow(1 / std::max(err, Scalar(1e-10)), Scalar(1) / (k + 1)));
+                auto kNew = k;
+                if (k > 1) {
+                    auto errKm1 = ErrorNorm(dif.col(k - 1), x, y) / k;
+                    auto hKm1 = h * std::max(Scalar(0.1), Scalar(0.769) * std::pow(1 / std::max(errKm1, Scalar(1e-10)), Scalar(1) / k));
+                    if (hKm1 > hOpt) { hOpt = std::min(h, hKm1); kNew = k - 1; }
+                }
+                if (k < maxK) {
+                    auto errKp1 = ErrorNorm(dif.col(k + 1), x, y) / (k + 2);
+                    auto hKp1 = h * std::max(Scalar(0.1), Scalar(0.714) * std::pow(1 / std::max(errKp1, Scalar(1e-10)), Scalar(1) / (k + 2)));
+                    if (hKp1 > hOpt) { hOpt = std::max(h, hKp1); kNew = k + 1; }
+                }
+                //keep the step and its factorization unless it grows enough to pay for a new one
+                hOpt = std::min(hOpt, hMax);
+                if (hOpt < Scalar(1.2) * h) hOpt = h;
+                if (hOpt != h || kNew != k) {
+                    k = kNew;
+                    Rescale(dif, k, hOpt / h);
+                    h = hOpt;
+                    sameSteps = 0;
+                }
+            }
+            else if (k < maxK) {
+                k++;//raise the order at constant step after the start up
+                sameSteps = 0;
+            }
+        }
+        return steps;
+    }
+
+    template <typename Input, typename Observer>
+    size_t IntegrateTRBDF2(bool adaptive, State & state, Scalar t0, Scalar t1, Scalar dt, Input & input, Observer & observer)
+    {
+        //trapezoidal stage to t + gamma * h followed by a BDF2 stage, both stages share the matrix (2 + sqrt(2)) / h * C + G
+        const Scalar gamma = 2 - std::sqrt(Scalar(2));
+        const Scalar a = 1 / (gamma * (2 - gamma)), b = (1 - gamma) * (1 - gamma) / (gamma * (2 - gamma));
+        const Scalar ke = (-3 * gamma * gamma + 4 * gamma - 2) / (12 * (2 - gamma));
+        const Eigen::Index n = m_c.size();
+        Eigen::Map<Vector> x(state.data(), n);
+        const Scalar hMax = adaptive ? Scalar(0.1) * (t1 - t0) : t1 - t0;
+        const Scalar hMin = std::max(std::abs(t0), std::abs(t1)) * std::numeric_limits<Scalar>::epsilon() * 16;
+        Scalar h = std::min(dt, hMax);
+        Vector u0(n), ug(n), u1(n), f0(n), fg(n), f1(n), xg(n), y(n), est(n);
+        observer(state, t0);
+
+        Scalar t = t0;
+        size_t steps = 0;
+        while (t < t1) {
+            Scalar hStep = t + h * Scalar(1.0001) >= t1 ? t1 - t : h;
+            if (hStep <= hMin) return 0;
+
+            const Scalar coeff = 2 / (gamma * hStep);
+            if (not Factorize(coeff)) return 0;
+            input(t, u0);
+            input(t + gamma * hStep, ug);
+            input(t + hStep, u1);
+            f0 = u0 - m_G * x;
+            xg = m_solver.solve(coeff * m_c.cwiseProduct(x) + f0 + ug);
+            y = m_solver.solve(coeff * m_c.cwiseProduct(a * xg - b * x) + u1);
+
+            if (adaptive) {
+                //Hosea and Shampine estimate, filtered by the stage matrix to stay bounded on stiff components
+                fg = ug - m_G * xg;
+                f1 = u1 - m_G * y;
+                est = 2 * ke * hStep * (f0 / gamma - fg / (gamma * (1 - gamma)) + f1 / (1 - gamma));
+                est = m_solver.solve(Vector(coeff * est));
+                auto err = ErrorNorm(est, x, y);
+                auto hNew = hStep * std::min(Scalar(5), std::max(Scalar(0.2), Scalar(0.9) * std::pow(1 / std::max(err, Scalar(1e-10)), Scalar(1) / 3)));
+                if (err > 1) {
+                    m_rejected++;
+                    h = hNew;
+                    continue;
+                }
+                //keep the step and its factorization unless it grows enough to pay for a new one
+                if (hNew > Scalar(1.2) * h) h = std::min(hNew, hMax);
+            }
+            x = y;
+            t += hStep;
+            steps++;
+            observer(state, t);
+        }
+        return steps;
+    }
+
+    bool Factorize(Scalar coeff)
+    {
+        if (m_factorized > 0 && coeff == m_coeff) return true;
+        m_solver.factorize(Matrix(m_G + coeff * m_C));
+        m_coeff = coeff;
+        m_factorized++;
+        return m_solver.info() == Eigen::Success;
+    }
+
+    ///C^-1 * (u - G * x), zero on nodes without capacitance
+    Vector Derivative(const Eigen::Map<Vector> & x, const Vector & u) const
+    {
+        Vector f = u - m_G * x;
+        for (Eigen::Index i = 0; i < f.size(); ++i)
+            f[i] = m_c[i] > 0 ? f[i] / m_c[i] : 0;
+        return f;
+    }
+
+    template <typename Err>
+    Scalar ErrorNorm(const Err & err, const Eigen::Map<Vector> & x, const Vector & y) const
+    {
+        Scalar norm{0};
+        for (Eigen::Index i = 0; i < err.size(); ++i) {
+            auto scale = m_absErr + m_relErr * std::max(std::abs(x[i]), std::abs(y[i]));
+            norm = std::max(norm, std::abs(err[i]) / scale);
+        }
+        return norm;
+    }
+
+    ///rescales the first k backward differences from step h to step rho * h
+    static void Rescale(DenseMatrix & dif, size_t k, Scalar rho)
+    {
+        if (rho == 1) return;
+        auto cumprod = [k](Scalar r) {
+            DenseMatrix m(k, k);
+            for (size_t j = 1; j <= k; ++j) {
+                Scalar p{1};
+                for (size_t i = 1; i <= k; ++i) {
+                    p *= (Scalar(i) - 1 - j * r) / i;
+                    m(i - 1, j - 1) = p;
+                }
+            }
+            return m;
+        };
+        dif.leftCols(k) = dif.leftCols(k) * (cumprod(rho) * cumprod(1));
+    }
+
+private:
+    Vector m_c;
+    Matrix m_C;
+    Matrix m_G;
+    Scalar m_coeff{0};
+    Scalar m_absErr{0};
+    Scalar m_relErr{0};
+    size_t m_rejected{0};
+    size_t m_factorized{0};
+    Eigen::SimplicialLDLT<Matrix> m_solver;
+};
+
+} // namespace thermal::solver
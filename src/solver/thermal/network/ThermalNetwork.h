@@ -5,12 +5,16 @@
 #include "generic/tools/Format.hpp"
 #include "generic/circuit/MNA.hpp"
 #include <unordered_map>
+#include <numeric>
 #include <memory>
 #include <set>
 
 namespace thermal {
 namespace model {
 
+template <typename num_type>
+class CompactThermalNetwork;
+
 template <typename num_type>
 class ThermalNetwork
 {
@@ -24,19 +28,10 @@ public:
         num_type c = 0;
         num_type hf = 0;//unit: W
         num_type htc = 0;//unit: W/k
-        std::unordered_map<size_t, num_type> ns;
         std::string msg(size_t index) const
         {
             using namespace generic::fmt;
-            std::stringstream ss;
-            ss << Fmt2Str("ID: %1%, T:%2%, C:%3%, HF:%4%, HTC:%5%", index, t, c, hf, htc);
-            if (not ns.empty()) {
-                ss << ", N:[";
-                for (const auto & [id, r] : ns)
-                    ss << Fmt2Str("%1%(%2%) ", id, r);
-                ss << ']';
-            }
-            return ss.str();
+            return Fmt2Str("ID: %1%, T:%2%, C:%3%, HF:%4%, HTC:%5%", index, t, c, hf, htc);
         }
     };
 
@@ -136,17 +131,26 @@ public:
         m_nodes[node].c = c;
     }
 
-    void SetR(size_t node1, size_t node2, num_type r)
+    static Edge MakeEdge(size_t node1, size_t node2, num_type r)
     {
-        r = std::max(r, minR);
         if (node1 > node2) std::swap(node1, node2);
-        auto & n1 = m_nodes[node1];
-        auto iter = n1.ns.find(node2);
-        if (iter != n1.ns.cend()) {
-            iter->second = 1 / (1 / r + 1 / iter->second);
-            return;
-        }
-        n1.ns.emplace(node2, r);
+        return Edge{node1, node2, std::max(r, minR)};
+    }
+
+    ///parallel resistors between the same nodes are merged when the network is frozen
+    void SetR(size_t node1, size_t node2, num_type r)
+    {
+        m_edges.emplace_back(MakeEdge(node1, node2, r));
+    }
+
+    void AppendEdges(const std::vector<Edge> & edges)
+    {
+        m_edges.insert(m_edges.end(), edges.begin(), edges.end());
+    }
+
+    const std::vector<Edge> & GetEdges() const
+    {
+        return m_edges;
     }
 
     std::vector<Node> & GetNodes()
@@ -187,50 +191,199 @@ public:
         return maxT;
     }
 
+    ///convert to the solver layout, the assembly data is released
+    CompactThermalNetwork<num_type> Freeze();
+
 private:
     std::vector<Node> m_nodes;
+    std::vector<Edge> m_edges;
+};
+
+template <typename num_type>
+class CompactThermalNetwork
+{
+public:
+    inline static constexpr num_type unknownT = ThermalNetwork<num_type>::unknownT;
+
+    CompactThermalNetwork() = default;
+    virtual ~CompactThermalNetwork() = default;
+
+    size_t Size() const
+    {
+        return m_c.size();
+    }
+
+    size_t Edges() const
+    {
+        return m_cols.size();
+    }
+
+    size_t Source(bool includeBonds) const
+    {
+        size_t size{0};
+        for (size_t i = 0; i < Size(); ++i) {
+            if (m_hf[i] != 0 || (includeBonds && m_htc[i] != 0))
+                size++;
+        }
+        return size;
+    }
+
+    ///neighbors with larger index of node i are in [RowBegin(i), RowEnd(i)) of Cols() and Conductances()
+    size_t RowBegin(size_t i) const { return m_rowOffsets[i]; }
+    size_t RowEnd(size_t i) const { return m_rowOffsets[i + 1]; }
+
+    const std::vector<size_t> & RowOffsets() const { return m_rowOffsets; }
+    const std::vector<size_t> & Cols() const { return m_cols; }
+    const std::vector<num_type> & Conductances() const { return m_g; }//unit: W/K
+
+    size_t GetScenario(size_t node) const { return m_scen[node]; }
+    num_type GetT(size_t node) const { return m_t[node]; }
+    num_type GetC(size_t node) const { return m_c[node]; }
+    num_type GetHF(size_t node) const { return m_hf[node]; }
+    num_type GetHTC(size_t node) const { return m_htc[node]; }
+
+    const std::vector<size_t> & Scenarios() const { return m_scen; }
+    const std::vector<num_type> & T() const { return m_t; }
+    const std::vector<num_type> & C() const { return m_c; }
+    const std::vector<num_type> & HF() const { return m_hf; }
+    const std::vector<num_type> & HTC() const { return m_htc; }
+
+    num_type TotalHF() const
+    {
+        return std::accumulate(m_hf.begin(), m_hf.end(), num_type{0});
+    }
+
+    num_type MinT() const
+    {
+        num_type minT = std::numeric_limits<num_type>::max();
+        for (auto t : m_t) {
+            if (t == unknownT) continue;
+            minT = std::min<num_type>(minT, t);
+        }
+        return minT;
+    }
+
+    num_type MaxT() const
+    {
+        num_type maxT = -std::numeric_limits<num_type>::max();
+        for (auto t : m_t) {
+            if (t == unknownT) continue;
+            maxT = std::max<num_type>(maxT, t);
+        }
+        return maxT;
+    }
+
+private:
+    friend class ThermalNetwork<num_type>;
+    std::vector<size_t> m_rowOffsets;
+    std::vector<size_t> m_cols;
+    std::vector<num_type> m_g;
+    std::vector<size_t> m_scen;
+    std::vector<num_type> m_t;
+    std::vector<num_type> m_c;
+    std::vector<num_type> m_hf;
+    std::vector<num_type> m_htc;
 };
 
+template <typename num_type>
+inline CompactThermalNetwork<num_type> ThermalNetwork<num_type>::Freeze()
+{
+    CompactThermalNetwork<num_type> compact;
+    const size_t nodes = m_nodes.size();
+    compact.m_scen.resize(nodes);
+    compact.m_t.resize(nodes);
+    compact.m_c.resize(nodes);
+    compact.m_hf.resize(nodes);
+    compact.m_htc.resize(nodes);
+    for (size_t i = 0; i < nodes; ++i) {
+        const auto & node = m_nodes[i];
+        compact.m_scen[i] = node.scen;
+        compact.m_t[i] = node.t;
+        compact.m_c[i] = node.c;
+        compact.m_hf[i] = node.hf;
+        compact.m_htc[i] = node.htc;
+    }
+    std::vector<Node>().swap(m_nodes);
+
+    //bucket edges by row in insertion order
+    auto & offsets = compact.m_rowOffsets;
+    offsets.assign(nodes + 1, 0);
+    for (const auto & edge : m_edges) offsets[edge.x + 1]++;
+    for (size_t i = 0; i < nodes; ++i) offsets[i + 1] += offsets[i];
+
+    std::vector<size_t> pos(offsets.begin(), offsets.end() - 1);
+    std::vector<std::pair<size_t, num_type> > entries(m_edges.size());
+    for (const auto & edge : m_edges)
+        entries[pos[edge.x]++] = std::make_pair(edge.y, 1 / edge.r);
+    std::vector<Edge>().swap(m_edges);
+
+    //sort each row by column and merge parallel resistors, stable to keep the result deterministic
+    auto & cols = compact.m_cols;
+    auto & g = compact.m_g;
+    cols.reserve(entries.size());
+    g.reserve(entries.size());
+    size_t begin = 0;
+    for (size_t i = 0; i < nodes; ++i) {
+        size_t end = offsets[i + 1];
+        std::stable_sort(entries.begin() + begin, entries.begin() + end, [](const auto & a, const auto & b){ return a.first < b.first; });
+        offsets[i] = cols.size();
+        for (size_t k = begin; k < end; ++k) {
+            if (k > begin && entries[k].first == cols.back())
+                g.back() += entries[k].second;
+            else {
+                cols.emplace_back(entries[k].first);
+                g.emplace_back(entries[k].second);
+            }
+        }
+        begin = end;
+    }
+    offsets[nodes] = cols.size();
+    cols.shrink_to_fit();
+    g.shrink_to_fit();
+    return compact;
+}
+
 using namespace generic::ckt;
 
 template <typename num_type>
-inline DenseVector<num_type> makeRhs(const ThermalNetwork<num_type> & network, bool includeBonds, num_type refT)
+inline DenseVector<num_type> makeRhs(const CompactThermalNetwork<num_type> & network, bool includeBonds, num_type refT)
 {
     const size_t nodes = network.Size();
     const size_t source = network.Source(includeBonds);
+    const auto & hf = network.HF();
+    const auto & htc = network.HTC();
     DenseVector<num_type> rhs(source);
     for(size_t i = 0, s = 0; i < nodes; ++i) {
-        const auto & node = network[i];
-        if (node.hf != 0 || (includeBonds && node.htc != 0))
-            rhs[s++] = node.hf + node.htc * refT;
+        if (hf[i] != 0 || (includeBonds && htc[i] != 0))
+            rhs[s++] = hf[i] + htc[i] * refT;
     }
     return rhs;
 }
 
 template <typename num_type>
-inline DenseVector<num_type> makeFullRhs(const ThermalNetwork<num_type> & network, num_type refT)
+inline DenseVector<num_type> makeFullRhs(const CompactThermalNetwork<num_type> & network, num_type refT)
 {
     const size_t nodes = network.Size();
+    const auto & hf = network.HF();
+    const auto & htc = network.HTC();
     DenseVector<num_type> rhs(nodes);
-    for(size_t i = 0 ; i < nodes; ++i) {
-        const auto & node = network[i];
-        rhs[i] = node.hf + node.htc * refT;
-    }
+    for(size_t i = 0 ; i < nodes; ++i)
+        rhs[i] = hf[i] + htc[i] * refT;
     return rhs;
 }
 
 template <typename num_type>
-inline SparseMatrix<num_type> makeBondsRhs(const ThermalNetwork<num_type> & network, num_type refT)
+inline SparseMatrix<num_type> makeBondsRhs(const CompactThermalNetwork<num_type> & network, num_type refT)
 {
     using Matrix = SparseMatrix<num_type>;
     using Triplets = std::vector<Eigen::Triplet<num_type> >;
 
     Triplets triplets;
     const size_t nodes = network.Size();
+    const auto & htc = network.HTC();
     for(size_t i = 0 ; i < nodes; ++i) {
-        const auto & node = network[i];
-        if (node.htc != 0)
-            triplets.emplace_back(i, 0, node.htc * refT);
+        if (htc[i] != 0)
+            triplets.emplace_back(i, 0, htc[i] * refT);
     }
     Matrix rhs(nodes, 1);
     rhs.setFromTriplets(triplets.begin(), triplets.end());
@@ -238,17 +391,17 @@ inline SparseMatrix<num_type> makeBondsRhs(const ThermalNetwork<num_type> & netw
 }
 
 template <typename num_type>
-inline SparseMatrix<num_type> makeSourceProjMatrix(const ThermalNetwork<num_type> & network, std::unordered_map<size_t, size_t> & rhs2Nodes)
+inline SparseMatrix<num_type> makeSourceProjMatrix(const CompactThermalNetwork<num_type> & network, std::unordered_map<size_t, size_t> & rhs2Nodes)
 {
     using Matrix = SparseMatrix<num_type>;
     using Triplets = std::vector<Eigen::Triplet<num_type> >;
     
     rhs2Nodes.clear();
     Triplets triplets;
-    const size_t nodes = network.Size();    
+    const size_t nodes = network.Size();
+    const auto & hf = network.HF();
     for (size_t i = 0, s = 0; i < nodes; ++i) {
-        const auto & node = network[i];
-        if (node.hf != 0) {
+        if (hf[i] != 0) {
             rhs2Nodes.emplace(s, i);
             triplets.emplace_back(i, s++, 1);
         }
@@ -258,22 +411,44 @@ inline SparseMatrix<num_type> makeSourceProjMatrix(const ThermalNetwork<num_type
     return B;
 }
 
+///one column per case, the heat flow of node i in case j is hf[i] * cases[j](scenario of node i)
+template <typename num_type, typename Excitation>
+inline DenseMatrix<num_type> makeScenarioRhs(const CompactThermalNetwork<num_type> & network, num_type refT, const std::vector<Excitation> & cases)
+{
+    std::unordered_map<size_t, size_t> rhs2Nodes;
+    auto B = makeSourceProjMatrix(network, rhs2Nodes);
+    DenseMatrix<num_type> hf(rhs2Nodes.size(), cases.size());
+    for (auto [rhs, node] : rhs2Nodes) {
+        auto scen = network.GetScenario(node);
+        for (size_t j = 0; j < cases.size(); ++j)
+            hf(rhs, j) = network.GetHF(node) * static_cast<num_type>(cases[j](scen));
+    }
+    DenseMatrix<num_type> rhs = B * hf;
+    rhs.colwise() += DenseMatrix<num_type>(makeBondsRhs(network, refT)).col(0);
+    return rhs;
+}
+
 template <typename num_type>
-inline std::pair<SparseMatrix<num_type>, SparseMatrix<num_type>> makeInvCandNegG(const ThermalNetwork<num_type> & network)
+inline std::pair<SparseMatrix<num_type>, SparseMatrix<num_type>> makeInvCandNegG(const CompactThermalNetwork<num_type> & network)
 {
     using Matrix = SparseMatrix<num_type>;
     using Triplets = std::vector<Eigen::Triplet<num_type> >;
     
     const size_t nodes = network.Size();
+    const auto & cols = network.Cols();
+    const auto & g = network.Conductances();
+    const auto & c = network.C();
+    const auto & htc = network.HTC();
     auto invC = Matrix(nodes, nodes);
     auto negG = Matrix(nodes, nodes);
     Triplets tG, tC;
+    tG.reserve(4 * network.Edges() + nodes);
+    tC.reserve(nodes);
     for (size_t i = 0; i < nodes; ++i) {
-        const auto & node = network[i];
-        for (const auto & [n, r] : node.ns)
-            mna::Stamp(tG, i, n, - 1 / r);
-        if (node.htc != 0) mna::Stamp(tG, i, -node.htc);
-        if (node.c > 0) mna::Stamp(tC, i, 1 / node.c);
+        for (size_t k = network.RowBegin(i); k < network.RowEnd(i); ++k)
+            mna::Stamp(tG, i, cols[k], -g[k]);
+        if (htc[i] != 0) mna::Stamp(tG, i, -htc[i]);
+        if (c[i] > 0) mna::Stamp(tC, i, 1 / c[i]);
     }
     negG.setFromTriplets(tG.begin(), tG.end());
     invC.setFromTriplets(tC.begin(), tC.end());
@@ -281,7 +456,7 @@ inline std::pair<SparseMatrix<num_type>, SparseMatrix<num_type>> makeInvCandNegG
 }
 
 template <typename num_type>
-inline MNA<SparseMatrix<num_type> > makeMNA(const ThermalNetwork<num_type> & network, bool includeBonds, const std::vector<size_t> & probs = {})
+inline MNA<SparseMatrix<num_type> > makeMNA(const CompactThermalNetwork<num_type> & network, bool includeBonds, const std::vector<size_t> & probs = {})
 {
     using Matrix = SparseMatrix<num_type>;
     using Triplets = std::vector<Eigen::Triplet<num_type> >;
@@ -289,17 +464,24 @@ inline MNA<SparseMatrix<num_type> > makeMNA(const ThermalNetwork<num_type> & net
     MNA<Matrix> m;
     const size_t nodes = network.Size();
     const size_t source = network.Source(includeBonds);
+    const auto & cols = network.Cols();
+    const auto & g = network.Conductances();
+    const auto & c = network.C();
+    const auto & hf = network.HF();
+    const auto & htc = network.HTC();
     Triplets tG, tC, tB;
+    tG.reserve(4 * network.Edges() + nodes);
+    tC.reserve(nodes);
+    tB.reserve(source);
     m.G = Matrix(nodes, nodes);
     m.C = Matrix(nodes, nodes);
     m.B = Matrix(nodes, source);
     for (size_t i = 0, s = 0; i < nodes; ++i) {
-        const auto & node = network[i];
-        for (const auto & [n, r] : node.ns)
-            mna::Stamp(tG, i, n, 1 / r);
-        if (node.htc != 0) mna::Stamp(tG, i, node.htc);
-        if (node.c > 0) mna::Stamp(tC, i, node.c);
-        if (node.hf != 0 || (includeBonds && node.htc != 0))
+        for (size_t k = network.RowBegin(i); k < network.RowEnd(i); ++k)
+            mna::Stamp(tG, i, cols[k], g[k]);
+        if (htc[i] != 0) mna::Stamp(tG, i, htc[i]);
+        if (c[i] > 0) mna::Stamp(tC, i, c[i]);
+        if (hf[i] != 0 || (includeBonds && htc[i] != 0))
             tB.emplace_back(i, s++, 1);
     }
     m.G.setFromTriplets(tG.begin(), tG.end());
@@ -1,11 +1,15 @@
 #pragma once
+#include "AlgebraicMultigrid.h"
+#include "ImplicitIntegrator.h"
 #include "ThermalNetwork.h"
+#include "utils/SampleSink.h"
 #include "generic/tools/Tools.hpp"
 #include "generic/circuit/MNA.hpp"
 #include "generic/circuit/MOR.hpp"
 
 #include <boost/numeric/odeint.hpp>
 #include <memory>
+#include <map>
 #include <list>
 
 #include <Eigen/IterativeLinearSolvers>
@@ -23,67 +27,221 @@ namespace thermal::solver {
     template <typename Scalar>
     class ThermalNetworkSolver
     {
+        struct LinearSolver
+        {
+            virtual ~LinearSolver() = default;
+            virtual void AnalyzePattern(const SparseMatrix<Scalar> & G) = 0;
+            virtual bool Factorize(const SparseMatrix<Scalar> & G) = 0;
+            virtual bool Solve(const DenseVector<Scalar> & rhs, Eigen::Map<DenseVector<Scalar>> & x) = 0;
+            virtual bool Solve(const DenseMatrix<Scalar> & rhs, DenseMatrix<Scalar> & x) = 0;
+            virtual size_t Iterations() const { return 0; }
+            virtual Scalar Error() const { return 0; }
+        };
+
+        template <typename Impl>
+        struct DirectSolver : public LinearSolver
+        {
+            Impl impl;
+            void AnalyzePattern(const SparseMatrix<Scalar> & G) override { impl.analyzePattern(G); }
+            bool Factorize(const SparseMatrix<Scalar> & G) override
+            {
+                impl.factorize(G);
+                return impl.info() == Eigen::Success;
+            }
+            bool Solve(const DenseVector<Scalar> & rhs, Eigen::Map<DenseVector<Scalar>> & x) override
+            {
+                x = impl.solve(rhs);
+                return impl.info() == Eigen::Success;
+            }
+            bool Solve(const DenseMatrix<Scalar> & rhs, DenseMatrix<Scalar> & x) override
+            {
+                //all columns go through the triangular solves together
+                x = impl.solve(rhs);
+                return impl.info() == Eigen::Success;
+            }
+        };
+
+        template <typename Impl>
+        struct IterativeSolver : public LinearSolver
+        {
+            Impl impl;
+            void AnalyzePattern(const SparseMatrix<Scalar> & G) override { impl.analyzePattern(G); }
+            bool Factorize(const SparseMatrix<Scalar> & G) override
+            {
+                impl.factorize(G);
+                return impl.info() == Eigen::Success;
+            }
+            bool Solve(const DenseVector<Scalar> & rhs, Eigen::Map<DenseVector<Scalar>> & x) override
+            {
+                //warm start from previous result, P-T iteration changes it only slightly
+                x = impl.solveWithGuess(rhs, DenseVector<Scalar>(x));
+                return Report();
+            }
+            bool Solve(const DenseMatrix<Scalar> & rhs, DenseMatrix<Scalar> & x) override
+            {
+                x = impl.solve(rhs);
+                return Report();
+            }
+            bool Report() const
+            {
+                ECAD_TRACE("#iterations: %1%", impl.iterations());
+                ECAD_TRACE("estimated error: %1%", impl.error());
+                if (impl.info() == Eigen::Success) return true;
+                ECAD_ERROR("iterative solver failed to converge, info: %1%, #iterations: %2%, estimated error: %3%", 
+                            static_cast<int>(impl.info()), impl.iterations(), impl.error());
+                return false;
+            }
+            size_t Iterations() const override { return impl.iterations(); }
+            Scalar Error() const override { return impl.error(); }
+        };
+
+        struct MultigridSolver : public LinearSolver
+        {
+            AlgebraicMultigrid<Scalar> impl;
+            void AnalyzePattern(const SparseMatrix<Scalar> & G) override { impl.analyzePattern(G); }
+            bool Factorize(const SparseMatrix<Scalar> & G) override
+            {
+                impl.factorize(G);
+                ECAD_TRACE("amg levels: %1%", impl.Levels());
+                return impl.info() == Eigen::Success;
+            }
+            bool Solve(const DenseVector<Scalar> & rhs, Eigen::Map<DenseVector<Scalar>> & x) override
+            {
+                bool converged = impl.Iterate(rhs, x, Tolerance(), 500);
+                ECAD_TRACE("#iterations: %1%", impl.iterations());
+                ECAD_TRACE("estimated error: %1%", impl.error());
+                if (not converged) ECAD_ERROR("multigrid failed to converge, #iterations: %1%, estimated error: %2%", impl.iterations(), impl.error());
+                return converged;
+            }
+            bool Solve(const DenseMatrix<Scalar> & rhs, DenseMatrix<Scalar> & x) override
+            {
+                bool converged = true;
+                x = DenseMatrix<Scalar>::Zero(rhs.rows(), rhs.cols());
+                for (Eigen::Index j = 0; j < rhs.cols(); ++j) {
+                    DenseVector<Scalar> col = x.col(j);
+                    converged = impl.Iterate(rhs.col(j), col, Tolerance(), 500) && converged;
+                    x.col(j) = col;
+                }
+                if (not converged) ECAD_ERROR("multigrid failed to converge, estimated error: %1%", impl.error());
+                return converged;
+            }
+            static Scalar Tolerance() { return std::max<Scalar>(Eigen::NumTraits<Scalar>::epsilon() * 100, 1e-10); }
+            size_t Iterations() const override { return impl.iterations(); }
+            Scalar Error() const override { return impl.error(); }
+        };
+
     public:
-        explicit ThermalNetworkSolver(ThermalNetwork<Scalar> & network, int solverType = 2)
-            : m_network(network), m_solverType(solverType)
+        /**
+         * @brief persistent static solver, the sparsity pattern and symbolic analysis of G are cached between Solve() calls,
+         *        G is only refactorized numerically when its values change, and a pure rhs change reuses the factorization
+         */
+        explicit ThermalNetworkSolver(int solverType = 2)
+            : m_solverType(solverType)
         {
         }
 
         virtual ~ThermalNetworkSolver() = default;
 
-        void Solve(Scalar refT, std::vector<Scalar> & result) const
+        bool Solve(const CompactThermalNetwork<Scalar> & network, Scalar refT, std::vector<Scalar> & result)
         {
-            using namespace generic::math::la;
-            auto m = makeMNA(m_network, true);
-            auto rhs = makeRhs(m_network, true, refT);
-            result.resize(m_network.GetNodes().size(), refT);
+            auto m = makeMNA(network, true);
+            auto rhs = makeFullRhs(network, refT);
+            if (not Update(m.G)) return false;
+
+            result.resize(network.Size(), refT);
             Eigen::Map<DenseVector<Scalar>> x(result.data(), result.size());
+            return m_solver->Solve(rhs, x);
+        }
+
+        /**
+         * @brief multiple scenario solve, G is factorized once and all cases are back substituted as one dense rhs block
+         * @param cases ratio = cases[j](scenario) of the heat flow on the nodes of a scenario in case j
+         * @param results temperatures of each case
+         */
+        template <typename Excitation>
+        bool Solve(const CompactThermalNetwork<Scalar> & network, Scalar refT, const std::vector<Excitation> & cases, std::vector<std::vector<Scalar>> & results)
+        {
+            auto m = makeMNA(network, true);
+            auto rhs = makeScenarioRhs(network, refT, cases);
+            if (not Update(m.G)) return false;
+
+            DenseMatrix<Scalar> x;
+            if (not m_solver->Solve(rhs, x)) return false;
+            results.resize(cases.size());
+            for (size_t j = 0; j < cases.size(); ++j)
+                results[j].assign(x.col(j).data(), x.col(j).data() + x.rows());
+            return true;
+        }
+
+        int SolverType() const { return m_solverType; }
+        size_t Analyzed() const { return m_analyzed; }
+        size_t Factorized() const { return m_factorized; }
+        ///iterative solvers only, of the last Solve()
+        size_t Iterations() const { return m_solver ? m_solver->Iterations() : 0; }
+        Scalar Error() const { return m_solver ? m_solver->Error() : 0; }
+
+    private:
+        bool Update(SparseMatrix<Scalar> & G)
+        {
+            G.makeCompressed();
+            if (nullptr == m_solver) m_solver = CreateLinearSolver();
+            if (nullptr == m_solver) return false;
+
+            bool samePattern = m_analyzed > 0 && SamePattern(G, m_G);
+            if (samePattern && SameValues(G, m_G)) return true;
+            if (not samePattern) {
+                m_solver->AnalyzePattern(G);
+                m_analyzed++;
+            }
+            m_G = std::move(G);
+            m_factorized++;
+            if (m_solver->Factorize(m_G)) return true;
+            m_analyzed = 0;//force re-analyze next time
+            return false;
+        }
+
+        std::unique_ptr<LinearSolver> CreateLinearSolver() const
+        {
             switch (m_solverType) {
-                case 0 : {
-                    Eigen::SparseLU<Eigen::SparseMatrix<Scalar> > solver(m.G);
-                    x = m.L * solver.solve(m.B * rhs);
-                    break;
-                }
-                case 1 : {
-                    Eigen::SimplicialCholesky<Eigen::SparseMatrix<Scalar> > solver(m.G);
-                    x = m.L * solver.solve(m.B * rhs);
-                    break;
-                }
-                case 2: {
+                case 0 : return std::make_unique<DirectSolver<Eigen::SparseLU<SparseMatrix<Scalar>>>>();
+                case 1 : return std::make_unique<DirectSolver<Eigen::SimplicialCholesky<SparseMatrix<Scalar>>>>();
 #ifdef ECAD_APPLE_ACCELERATE_SUPPORT
-                    Eigen::AccelerateLLT<Eigen::SparseMatrix<Scalar> > solver(m.G);
+                case 2 : return std::make_unique<DirectSolver<Eigen::AccelerateLLT<SparseMatrix<Scalar>>>>();
+                case 3 : return std::make_unique<DirectSolver<Eigen::AccelerateLDLT<SparseMatrix<Scalar>, 0>>>();
 #else
-                    Eigen::SimplicialLLT<Eigen::SparseMatrix<Scalar> > solver(m.G);
+                case 2 : return std::make_unique<DirectSolver<Eigen::SimplicialLLT<SparseMatrix<Scalar>>>>();
+                case 3 : return std::make_unique<DirectSolver<Eigen::SimplicialLDLT<SparseMatrix<Scalar>>>>();
 #endif //ECAD_APPLE_ACCELERATE_SUPPORT
-                    x = m.L * solver.solve(m.B * rhs);
-                    break;
-                }
-                case 3: {
-#ifdef ECAD_APPLE_ACCELERATE_SUPPORT
-                    Eigen::AccelerateLDLT<Eigen::SparseMatrix<Scalar>,0> solver(m.G);
-#else
-                    Eigen::SimplicialLDLT<Eigen::SparseMatrix<Scalar> > solver(m.G);
-#endif //ECAD_APPLE_ACCELERATE_SUPPORT
-                    x = m.L * solver.solve(m.B * rhs);
-                    break;
-                }
-                case 10 : {
-                    Eigen::ConjugateGradient<Eigen::SparseMatrix<Scalar>, Eigen::Lower | Eigen::Upper> solver(m.G);
-                    x = m.L * solver.solve(m.B * rhs);
-                    ECAD_TRACE("#iterations: %1%", solver.iterations());
-                    ECAD_TRACE("estimated error: %1%", solver.error());
-                    break;
-                }
+                case 10 : return std::make_unique<IterativeSolver<Eigen::ConjugateGradient<SparseMatrix<Scalar>, Eigen::Lower | Eigen::Upper>>>();
+                case 11 : return std::make_unique<IterativeSolver<Eigen::ConjugateGradient<SparseMatrix<Scalar>, Eigen::Lower, Eigen::IncompleteCholesky<Scalar>>>>();
+                case 12 : return std::make_unique<IterativeSolver<Eigen::BiCGSTAB<SparseMatrix<Scalar>, Eigen::IncompleteLUT<Scalar>>>>();
+                case 13 : return std::make_unique<IterativeSolver<Eigen::ConjugateGradient<SparseMatrix<Scalar>, Eigen::Lower | Eigen::Upper, AlgebraicMultigrid<Scalar>>>>();
+                case 14 : return std::make_unique<MultigridSolver>();
                 default : {
                     ECAD_ASSERT(false)
-                    break;
+                    return nullptr;
                 }
             }
         }
 
+        static bool SamePattern(const SparseMatrix<Scalar> & m1, const SparseMatrix<Scalar> & m2)
+        {
+            if (m1.rows() != m2.rows() || m1.cols() != m2.cols() || m1.nonZeros() != m2.nonZeros()) return false;
+            return std::equal(m1.outerIndexPtr(), m1.outerIndexPtr() + m1.outerSize() + 1, m2.outerIndexPtr()) &&
+                   std::equal(m1.innerIndexPtr(), m1.innerIndexPtr() + m1.nonZeros(), m2.innerIndexPtr());
+        }
+
+        static bool SameValues(const SparseMatrix<Scalar> & m1, const SparseMatrix<Scalar> & m2)
+        {
+            return std::equal(m1.valuePtr(), m1.valuePtr() + m1.nonZeros(), m2.valuePtr());
+        }
+
     private:
-        ThermalNetwork<Scalar> & m_network;
         int m_solverType{2};
+        size_t m_analyzed{0};
+        size_t m_factorized{0};
+        SparseMatrix<Scalar> m_G;
+        std::unique_ptr<LinearSolver> m_solver{nullptr};
     };
 
     template <typename Scalar>
@@ -92,6 +250,16 @@ namespace thermal::solver {
     template <typename Scalar>
     using Samples = std::vector<Sample<Scalar>>;
 
+    ///traces t followed by the probe temperatures in celsius
+    template <typename Scalar>
+    inline void TraceSample(Scalar t, const std::vector<Scalar> & values)
+    {
+        Sample<Scalar> sample; sample.reserve(values.size() + 1);
+        sample.emplace_back(t);
+        for (auto v : values) sample.emplace_back(generic::unit::Kelvins2Celsius(v));
+        ECAD_TRACE(generic::fmt::Fmt2Str(sample, ","));
+    }
+
     template <typename Scalar>
     struct TimeWindow
     {
@@ -127,15 +295,13 @@ namespace thermal::solver {
             Scalar count{0};
             bool verbose{false};
             StateType & lastState;
-            Samples<Scalar> & samples;
+            utils::SampleSink<Scalar> & sink;
             TimeWindow<Scalar> window;
             const ThermalNetworkTransientSolver & solver;
-            Sampler(const ThermalNetworkTransientSolver & solver, Samples<Scalar> & samples, StateType & lastState, TimeWindow<Scalar> window, Scalar endT, bool verbose)
-             : endT(endT), verbose(verbose), lastState(lastState), samples(samples), window(std::move(window)), solver(solver)
+            Sampler(const ThermalNetworkTransientSolver & solver, utils::SampleSink<Scalar> & sink, StateType & lastState, TimeWindow<Scalar> window, Scalar endT, bool verbose)
+             : endT(endT), verbose(verbose), lastState(lastState), sink(sink), window(std::move(window)), solver(solver)
             {
-                if (not samples.empty())
-                    prev = samples.back().front();
-                samples.reserve(window.EsitimateSamples());
+                prev = sink.LastTime();
             }
             virtual ~Sampler() = default;
             void operator() (const StateType & x, Scalar t)
@@ -143,16 +309,10 @@ namespace thermal::solver {
                 if (window.isInside(t)) {
                     if (count += t - prev; count > window.interval) {
                         const auto & probs = solver.Probs();
-                        Sample<Scalar> sample; sample.reserve(probs.size() + 1);
-                        sample.emplace_back(t);
-                        for (auto p : probs) sample.emplace_back(x[p]);
-                        if (verbose) {
-                            auto res = sample;
-                            auto begin = res.begin(); begin++;
-                            std::for_each(begin, res.end(), [](auto & t){ t = generic::unit::Kelvins2Celsius(t); });
-                            ECAD_TRACE(generic::fmt::Fmt2Str(res, ","));
-                        }
-                        samples.emplace_back(std::move(sample));
+                        StateType values; values.reserve(probs.size());
+                        for (auto p : probs) values.emplace_back(x[p]);
+                        if (verbose) TraceSample(t, values);
+                        sink.Append(t, std::move(values));
                         count = 0;
                     }
                     prev = t;
@@ -169,9 +329,9 @@ namespace thermal::solver {
             SparseMatrix<Scalar> hfP;
             SparseMatrix<Scalar> htcM;
             SparseMatrix<Scalar> coeff;
-            const ThermalNetwork<Scalar> & network;
+            const CompactThermalNetwork<Scalar> & network;
             std::unordered_map<size_t, size_t> rhs2Nodes;
-            Intermidiate(const ThermalNetwork<Scalar> & network, Scalar refT)
+            Intermidiate(const CompactThermalNetwork<Scalar> & network, Scalar refT)
                 : refT(refT), network(network)
             {
                 auto [invC, negG] = makeInvCandNegG(network);
@@ -182,8 +342,8 @@ namespace thermal::solver {
                 scen = DenseVector<Scalar>(rhs2Nodes.size());
                 hf = DenseVector<Scalar>(rhs2Nodes.size());
                 for (auto [rhs, node] : rhs2Nodes) {
-                    scen[rhs] = network[node].scen;
-                    hf[rhs] = network[node].hf;
+                    scen[rhs] = network.GetScenario(node);
+                    hf[rhs] = network.GetHF(node);
                 }
             }
             virtual ~Intermidiate() = default;
@@ -212,7 +372,7 @@ namespace thermal::solver {
             }
         };
         
-        ThermalNetworkTransientSolver(const ThermalNetwork<Scalar> & network, Scalar refT, std::vector<size_t> probs)
+        ThermalNetworkTransientSolver(const CompactThermalNetwork<Scalar> & network, Scalar refT, std::vector<size_t> probs)
             : m_refT(refT), m_probs(std::move(probs)), m_network(network)
         {
             m_im.reset(new Intermidiate(m_network, m_refT));
@@ -240,13 +400,126 @@ namespace thermal::solver {
             return integrate_const(Stepper{}, Solver<Excitation>(*m_im, e), initState, Scalar{t0}, Scalar{t0 + duration}, Scalar{dt}, std::move(observer));
         }
 
+        /**
+         * @brief integrates C * dT/dt = u(t) - G * T with an implicit method, (coeff * C + G) is factorized once per step size,
+         *        the factorization is kept across calls on the same solver
+         * @param method 1: backward Euler, 2: TR-BDF2, 3: variable order BDF
+         * @param adaptive local error control with absErr and relErr, otherwise constant step dt
+         */
+        template <typename Observer = Sampler, typename Excitation>
+        size_t SolveImplicit(int method, bool adaptive, StateType & initState, Scalar t0, Scalar duration, Scalar dt, Scalar absErr, Scalar relErr, Observer observer, const Excitation * e = nullptr)
+        {
+            if (initState.size() != StateSize()) return 0;
+            if (nullptr == m_implicit) {
+                auto m = makeMNA(m_network, false);
+                m_ub = DenseMatrix<Scalar>(makeBondsRhs(m_network, m_refT)).col(0);
+                m_hfB = std::move(m.B);
+                m_implicit.reset(new ImplicitIntegrator<Scalar>(m.C.diagonal(), std::move(m.G)));
+            }
+            DenseVector<Scalar> hf(m_im->hf.size());
+            auto input = [&](Scalar t, DenseVector<Scalar> & u) {
+                for (int i = 0; i < m_im->hf.size(); ++i) {
+                    Scalar excitation = e ? (*e)(t, m_im->scen[i]) : 1;
+                    hf[i] = m_im->hf[i] * excitation;
+                }
+                u = m_ub + m_hfB * hf;
+            };
+            using Method = typename ImplicitIntegrator<Scalar>::Method;
+            auto steps = m_implicit->Integrate(static_cast<Method>(method), adaptive, initState, t0, t0 + duration, dt, absErr, relErr, input, observer);
+            ECAD_TRACE("implicit steps: %1%, rejected: %2%, factorizations: %3%", steps, m_implicit->Rejected(), m_implicit->Factorized());
+            return steps;
+        }
+
         const std::vector<size_t> Probs() const { return m_probs; }
         const Intermidiate & Im() const { return *m_im; }
     private:
         Scalar m_refT;
         std::vector<size_t> m_probs;
-        const ThermalNetwork<Scalar> & m_network;
+        const CompactThermalNetwork<Scalar> & m_network;
         std::unique_ptr<Intermidiate> m_im{nullptr};
+        DenseVector<Scalar> m_ub;
+        SparseMatrix<Scalar> m_hfB;
+        std::unique_ptr<ImplicitIntegrator<Scalar>> m_implicit{nullptr};
+    };
+
+    ///projection bases kept across the outer steps of a temperature dependent run, one basis per bucket of the mean temperature,
+    ///a network in a known bucket is projected on its basis and only the entries changed since the last projection are multiplied
+    template <typename Scalar>
+    class ParametricReducedModel
+    {
+    public:
+        ParametricReducedModel(size_t order, Scalar refT, Scalar bucket)
+            : m_order(order), m_refT(refT), m_bucket(bucket) {}
+
+        ReducedModel<Scalar> Project(const CompactThermalNetwork<Scalar> & network, const std::vector<Scalar> & temperature, const std::vector<size_t> & probs, bool includeBonds)
+        {
+            auto m = makeMNA(network, includeBonds, probs);
+            auto iter = m_buckets.find(BucketIndex(temperature));
+            if (iter == m_buckets.end()) {
+                tools::ProgressTimer t("reduce");
+                auto rom = Reduce(m, std::max(m_order, network.Source(includeBonds)));
+                ECAD_TRACE("mor %1% -> %2%, bucket: %3%", rom.x.rows(), rom.x.cols(), BucketIndex(temperature));
+                m_reductions++;
+                iter = m_buckets.emplace(BucketIndex(temperature), Bucket{std::move(m), std::move(rom)}).first;
+                return iter->second.rom;
+            }
+
+            auto & [last, rom] = iter->second;
+            if (m.G.rows() != last.G.rows() || m.L.cols() != last.L.cols()) {
+                //the network topology changed, the basis no longer applies
+                rom = Reduce(m, std::max(m_order, network.Source(includeBonds)));
+                last = std::move(m);
+                m_reductions++;
+                return rom;
+            }
+            rom.m.G += ProjectChange(m.G, last.G, rom.x);
+            rom.m.C += ProjectChange(m.C, last.C, rom.x);
+            if (m.B.cols() != last.B.cols() || not m.B.isApprox(last.B))
+                rom.m.B = rom.xT * m.B;
+            last = std::move(m);
+            m_projections++;
+            return rom;
+        }
+
+        size_t Reductions() const { return m_reductions; }
+        size_t Projections() const { return m_projections; }
+
+    private:
+        int64_t BucketIndex(const std::vector<Scalar> & temperature) const
+        {
+            if (m_bucket <= 0 || temperature.empty()) return 0;
+            auto meanT = std::accumulate(temperature.begin(), temperature.end(), Scalar{0}) / temperature.size();
+            return static_cast<int64_t>(std::floor((meanT - m_refT) / m_bucket));
+        }
+
+        static DenseMatrix<Scalar> ProjectChange(const SparseMatrix<Scalar> & curr, const SparseMatrix<Scalar> & prev, const DenseMatrix<Scalar> & x)
+        {
+            SparseMatrix<Scalar> delta = (curr - prev).pruned(Scalar{0}, Scalar{0});
+            const size_t order = x.cols();
+            //x^T * delta * x, entry by entry costs nnz * order^2, as a whole nnz * order + rows * order^2
+            const size_t nnz = delta.nonZeros();
+            if (nnz * order * order > nnz * order + x.rows() * order * order)
+                return x.transpose() * (delta * x);
+            DenseMatrix<Scalar> result = DenseMatrix<Scalar>::Zero(order, order);
+            for (int k = 0; k < delta.outerSize(); ++k) {
+                for (typename SparseMatrix<Scalar>::InnerIterator it(delta, k); it; ++it)
+                    result.noalias() += it.value() * x.row(it.row()).transpose() * x.row(it.col());
+            }
+            return result;
+        }
+
+    private:
+        struct Bucket
+        {
+            MNA<SparseMatrix<Scalar> > last;//full model of the last projection
+            ReducedModel<Scalar> rom;
+        };
+        size_t m_order;
+        Scalar m_refT;
+        Scalar m_bucket;
+        size_t m_reductions{0};
+        size_t m_projections{0};
+        std::map<int64_t, Bucket> m_buckets;
     };
 
     template <typename Scalar>
@@ -254,19 +527,36 @@ namespace thermal::solver {
     {
     public:
         using StateType = std::vector<Scalar>;    
+        ///input column s of the reduced model is uh[s] = hf * excitation(t, scenario) + bias, compiled once from the network
+        struct ExcitationMap
+        {
+            struct Source
+            {
+                size_t node;
+                size_t slot;//index of the scenario in scenarios
+                Scalar hf;
+                Scalar bias;
+            };
+            std::vector<Source> sources;//one per input column
+            std::vector<size_t> scenarios;//distinct scenarios, the excitation is evaluated once per scenario
+        };
+
         struct Intermidiate
         {
             Scalar refT;
             const std::vector<size_t> & probs;
-            const ThermalNetwork<Scalar> & network;
+            const CompactThermalNetwork<Scalar> & network;
 
             bool includeBonds{true};
             DenseVector<Scalar> uh;
             DenseVector<Scalar> ub;
+            DenseVector<Scalar> u0;//input * uh without excitation
             DenseMatrix<Scalar> rLT;
             ReducedModel<Scalar> rom;
             DenseMatrix<Scalar> coeff, input;
-            Intermidiate(const ThermalNetwork<Scalar> & network, Scalar refT, const std::vector<size_t> & probs, size_t order, const std::string & romLoadFile, const std::string & romSaveFile)
+            ExcitationMap excitationMap;
+            std::vector<Scalar> excitations;
+            Intermidiate(const CompactThermalNetwork<Scalar> & network, Scalar refT, const std::vector<size_t> & probs, size_t order, const std::string & romLoadFile, const std::string & romSaveFile)
                 : refT(refT), probs(probs), network(network)
             {
                 bool loadFromFile{false};
@@ -295,16 +585,14 @@ namespace thermal::solver {
                         }
                     }
                 }
-                auto dcomp = rom.m.C.ldlt();
-                coeff = dcomp.solve(-1 * rom.m.G);
-                input = dcomp.solve(rom.m.B);
-                rLT = rom.m.L.transpose();
-                uh.resize(input.cols());
-                if (not includeBonds) {
-                    auto bondsRhs = makeBondsRhs(network, refT);
-                    ub = rom.xT * bondsRhs;
-                }
-            }           
+                Init();
+            }
+
+            Intermidiate(const CompactThermalNetwork<Scalar> & network, Scalar refT, const std::vector<size_t> & probs, ReducedModel<Scalar> rom)
+                : refT(refT), probs(probs), network(network), rom(std::move(rom))
+            {
+                Init();
+            }
 
             virtual ~Intermidiate() = default;
 
@@ -328,7 +616,49 @@ namespace thermal::solver {
                 ovec = rLT * xvec;
             }
 
+            ///full network temperature, the input of the next outer step
+            void State2Full(const StateType & x, StateType & out) const
+            {
+                using VectorType = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+                out.resize(rom.x.rows());
+                Eigen::Map<VectorType> ovec(out.data(), out.size());
+                Eigen::Map<const VectorType> xvec(x.data(), x.size());
+                ovec = rom.x * xvec;
+            }
+
             size_t StateSize() const { return rom.m.G.cols(); }
+
+        private:
+            void Init()
+            {
+                auto dcomp = rom.m.C.ldlt();
+                coeff = dcomp.solve(-1 * rom.m.G);
+                input = dcomp.solve(rom.m.B);
+                rLT = rom.m.L.transpose();
+                if (not includeBonds) {
+                    auto bondsRhs = makeBondsRhs(network, refT);
+                    ub = rom.xT * bondsRhs;
+                }
+
+                const size_t nodes = network.Size();
+                const auto & hf = network.HF();
+                const auto & htc = network.HTC();
+                const auto & scen = network.Scenarios();
+                std::unordered_map<size_t, size_t> slots;
+                for (size_t i = 0; i < nodes; ++i) {
+                    if (hf[i] != 0 || (includeBonds && htc[i] != 0)) {
+                        auto [iter, added] = slots.emplace(scen[i], excitationMap.scenarios.size());
+                        if (added) excitationMap.scenarios.emplace_back(scen[i]);
+                        excitationMap.sources.emplace_back(typename ExcitationMap::Source{i, iter->second, hf[i], htc[i] * refT});
+                    }
+                }
+                ECAD_ASSERT(excitationMap.sources.size() == static_cast<size_t>(input.cols()))
+                excitations.assign(excitationMap.scenarios.size(), 1);
+                uh.resize(input.cols());
+                for (size_t s = 0; s < excitationMap.sources.size(); ++s)
+                    uh[s] = excitationMap.sources[s].hf + excitationMap.sources[s].bias;
+                u0 = input * uh;
+            }
         };
 
         struct Sampler
@@ -340,14 +670,12 @@ namespace thermal::solver {
             bool verbose{false};
             StateType & lastState;
             TimeWindow<Scalar> window;
-            Samples<Scalar> & samples;
+            utils::SampleSink<Scalar> & sink;
             const ThermalNetworkReducedTransientSolver & solver;
-            Sampler(const ThermalNetworkReducedTransientSolver & solver, Samples<Scalar> & samples, StateType & lastState, TimeWindow<Scalar> window, Scalar endT, bool verbose)
-             : endT(endT), verbose(verbose), lastState(lastState), window(std::move(window)), samples(samples), solver(solver)
+            Sampler(const ThermalNetworkReducedTransientSolver & solver, utils::SampleSink<Scalar> & sink, StateType & lastState, TimeWindow<Scalar> window, Scalar endT, bool verbose)
+             : endT(endT), verbose(verbose), lastState(lastState), window(std::move(window)), sink(sink), solver(solver)
             {
-                if (not samples.empty())
-                    prev = samples.back().front();
-                samples.reserve(window.EsitimateSamples());
+                prev = sink.LastTime();
             }
             virtual ~Sampler() = default;
             void operator() (const StateType & x, Scalar t)
@@ -355,17 +683,8 @@ namespace thermal::solver {
                 if (window.isInside(t)) {
                     if (count += t - prev; count > window.interval) {
                         solver.Im().State2Output(x, out);
-                        Sample<Scalar> sample; sample.reserve(out.size() + 1);
-                        sample.emplace_back(t);
-                        for (const auto & o : out)
-                            sample.emplace_back(o);
-                        if (verbose) {
-                            auto res = sample;
-                            auto begin = res.begin(); begin++;
-                            std::for_each(begin, res.end(), [](auto & t){ t = generic::unit::Kelvins2Celsius(t); });
-                            ECAD_TRACE(generic::fmt::Fmt2Str(res, ","));
-                        }
-                        samples.emplace_back(std::move(sample));
+                        if (verbose) TraceSample(t, out);
+                        sink.Append(t, out);
                         count = 0;
                     }
                     prev = t;
@@ -383,27 +702,36 @@ namespace thermal::solver {
             virtual ~Solver() = default;
             void operator() (const StateType & x, StateType & dxdt, Scalar t)
             {
-                const size_t nodes = im.network.Size();
-                for (size_t i = 0, s = 0; i < nodes; ++i) {
-                    const auto & node = im.network[i];
-                    Scalar excitation = e ? (*e)(t, node.scen) : 1;
-                    if (node.hf != 0 || (im.includeBonds && node.htc != 0))
-                        im.uh[s++] = node.hf * excitation + node.htc * im.refT;
-                }
                 Eigen::Map<DenseVector<Scalar>> result(dxdt.data(), dxdt.size());
                 Eigen::Map<const DenseVector<Scalar>> xvec(x.data(), x.size());
-                Eigen::Map<DenseVector<Scalar>> dxdtM(dxdt.data(), dxdt.size());
-                result = im.coeff * xvec + im.input * im.uh;
+                if (e) {
+                    const auto & map = im.excitationMap;
+                    for (size_t k = 0; k < map.scenarios.size(); ++k)
+                        im.excitations[k] = (*e)(t, map.scenarios[k]);
+                    for (size_t s = 0; s < map.sources.size(); ++s) {
+                        const auto & source = map.sources[s];
+                        im.uh[s] = source.hf * im.excitations[source.slot] + source.bias;
+                    }
+                    result = im.coeff * xvec + im.input * im.uh;
+                }
+                else result = im.coeff * xvec + im.u0;
                 if (not im.includeBonds) result += im.ub;
             }
         };
 
-        ThermalNetworkReducedTransientSolver(const ThermalNetwork<Scalar> & network, Scalar refT, std::vector<size_t> probs, size_t order, const std::string & romLoadFile = {}, const std::string & romSaveFile = {})
+        ThermalNetworkReducedTransientSolver(const CompactThermalNetwork<Scalar> & network, Scalar refT, std::vector<size_t> probs, size_t order, const std::string & romLoadFile = {}, const std::string & romSaveFile = {})
             : m_refT(refT), m_probs(std::move(probs)), m_network(network)
         {
             m_im.reset(new Intermidiate(m_network, m_refT, m_probs, order, romLoadFile, romSaveFile));
         }
 
+        ///reuses the basis of the parametric model, temperature is the full network temperature the network was built at
+        ThermalNetworkReducedTransientSolver(const CompactThermalNetwork<Scalar> & network, Scalar refT, std::vector<size_t> probs, ParametricReducedModel<Scalar> & prom, const StateType & temperature)
+            : m_refT(refT), m_probs(std::move(probs)), m_network(network)
+        {
+            m_im.reset(new Intermidiate(m_network, m_refT, m_probs, prom.Project(m_network, temperature, m_probs, true)));
+        }
+
         virtual ~ThermalNetworkReducedTransientSolver() = default;
 
         template <typename Observer = Sampler, typename Excitation>
@@ -428,7 +756,7 @@ namespace thermal::solver {
     private:
         Scalar m_refT;
         std::vector<size_t> m_probs;
-        const ThermalNetwork<Scalar> & m_network;
+        const CompactThermalNetwork<Scalar> & m_network;
         std::unique_ptr<Intermidiate> m_im{nullptr};
     };
 } // namespace thermal::solver
\ No newline at end of file
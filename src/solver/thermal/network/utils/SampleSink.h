@@ -0,0 +1,243 @@
+#pragma once
+#include "generic/tools/Units.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <limits>
+namespace thermal::utils {
+
+/**
+ * @brief receives the probe samples of a transient run one row at a time,
+ *        keeps the running range so the samples themselves need not stay in memory
+ */
+template <typename Scalar>
+class SampleSink
+{
+public:
+    /**
+     * @param celsius converts the kelvins from the solver before storing
+     * @param decimation keeps every n-th sample
+     */
+    explicit SampleSink(bool celsius = false, size_t decimation = 1)
+     : m_celsius(celsius), m_decimation(std::max<size_t>(1, decimation)) {}
+    virtual ~SampleSink() = default;
+
+    ///values are the probe temperatures in kelvins at time t
+    void Append(Scalar t, std::vector<Scalar> values)
+    {
+        m_lastTime = t;
+        if (m_received++ % m_decimation) return;
+        if (m_celsius) std::for_each(values.begin(), values.end(), [](auto & v){ v = generic::unit::Kelvins2Celsius(v); });
+        for (auto v : values) {
+            m_minT = std::min(m_minT, v);
+            m_maxT = std::max(m_maxT, v);
+        }
+        m_count++;
+        Write(t, values);
+    }
+
+    virtual void Flush() {}
+
+    bool isEmpty() const { return 0 == m_count; }
+    size_t Count() const { return m_count; }
+    Scalar LastTime() const { return m_lastTime; }
+    Scalar MinT() const { return m_minT; }
+    Scalar MaxT() const { return m_maxT; }
+    const char * Unit() const { return m_celsius ? "C" : "K"; }
+
+protected:
+    virtual void Write(Scalar t, const std::vector<Scalar> & values) = 0;
+
+private:
+    bool m_celsius{false};
+    size_t m_decimation{1};
+    size_t m_received{0};
+    size_t m_count{0};
+    Scalar m_lastTime{0};
+    Scalar m_minT{std::numeric_limits<Scalar>::max()};
+    Scalar m_maxT{std::numeric_limits<Scalar>::lowest()};
+};
+
+///keeps all samples in memory, each row is t followed by the probe values
+template <typename Scalar>
+class MemorySampleSink : public SampleSink<Scalar>
+{
+public:
+    using Samples = std::vector<std::vector<Scalar> >;
+    explicit MemorySampleSink(Samples & samples, bool celsius = false, size_t decimation = 1)
+     : SampleSink<Scalar>(celsius, decimation), m_samples(samples) {}
+
+protected:
+    void Write(Scalar t, const std::vector<Scalar> & values) override
+    {
+        auto & sample = m_samples.emplace_back();
+        sample.reserve(values.size() + 1);
+        sample.emplace_back(t);
+        sample.insert(sample.end(), values.begin(), values.end());
+    }
+
+private:
+    Samples & m_samples;
+};
+
+/**
+ * @brief append only binary columnar sample file
+ *        header: "ECADSMPL", uint32 version, uint32 scalar bytes, uint64 probes, then per probe uint64 id, name and unit as uint32 length + chars
+ *        chunk : uint32 "CHNK", uint32 rows, rows times, then rows values of each probe
+ *        every complete chunk is flushed to disk, so the file can be read while the run is going on
+ */
+template <typename Scalar>
+class BinarySampleSink : public SampleSink<Scalar>
+{
+public:
+    static constexpr uint32_t version = 1;
+    BinarySampleSink(const std::string & filename, const std::vector<size_t> & ids, const std::vector<std::string> & names,
+                    bool celsius = false, size_t decimation = 1, size_t chunkRows = 1024)
+     : SampleSink<Scalar>(celsius, decimation), m_probes(ids.size()), m_chunkRows(std::max<size_t>(1, chunkRows))
+    {
+        m_out.open(filename, std::ios::binary | std::ios::trunc);
+        if (not m_out.is_open()) return;
+        m_out.write("ECADSMPL", 8);
+        WritePod(version);
+        WritePod(uint32_t(sizeof(Scalar)));
+        WritePod(uint64_t(m_probes));
+        std::string unit = this->Unit();
+        for (size_t i = 0; i < m_probes; ++i) {
+            WritePod(uint64_t(ids.at(i)));
+            WriteString(i < names.size() ? names.at(i) : std::to_string(ids.at(i)));
+            WriteString(unit);
+        }
+        m_out.flush();
+        m_times.reserve(m_chunkRows);
+        m_values.reserve(m_chunkRows * m_probes);
+    }
+
+    virtual ~BinarySampleSink() { Flush(); }
+
+    bool isOpen() const { return m_out.is_open(); }
+
+    void Flush() override
+    {
+        if (m_times.empty() || not m_out.is_open()) return;
+        const uint32_t rows = m_times.size();
+        m_out.write("CHNK", 4);
+        WritePod(rows);
+        m_out.write(reinterpret_cast<const char *>(m_times.data()), rows * sizeof(Scalar));
+        //row major buffer to columns
+        std::vector<Scalar> column(rows);
+        for (size_t p = 0; p < m_probes; ++p) {
+            for (size_t r = 0; r < rows; ++r)
+                column[r] = m_values[r * m_probes + p];
+            m_out.write(reinterpret_cast<const char *>(column.data()), rows * sizeof(Scalar));
+        }
+        m_out.flush();
+        m_times.clear();
+        m_values.clear();
+    }
+
+protected:
+    void Write(Scalar t, const std::vector<Scalar> & values) override
+    {
+        m_times.emplace_back(t);
+        m_values.insert(m_values.end(), values.begin(), values.end());
+        if (m_times.size() >= m_chunkRows) Flush();
+    }
+
+private:
+    template <typename T>
+    void WritePod(T value) { m_out.write(reinterpret_cast<const char *>(&value), sizeof(T)); }
+    void WriteString(const std::string & str)
+    {
+        WritePod(uint32_t(str.size()));
+        m_out.write(str.data(), str.size());
+    }
+
+private:
+    size_t m_probes{0};
+    size_t m_chunkRows{1024};
+    std::ofstream m_out;
+    std::vector<Scalar> m_times;
+    std::vector<Scalar> m_values;
+};
+
+///reads the complete chunks of a BinarySampleSink file, an unfinished trailing chunk is ignored
+class BinarySampleReader
+{
+public:
+    BinarySampleReader() = default;
+    explicit BinarySampleReader(const std::string & filename) { Read(filename); }
+
+    ///reads or re-reads the file, returns false if it is not a sample file
+    bool Read(const std::string & filename)
+    {
+        m_ids.clear(); m_names.clear(); m_units.clear(); m_times.clear(); m_values.clear();
+        std::ifstream in(filename, std::ios::binary);
+        if (not in.is_open()) return false;
+
+        char magic[8];
+        uint32_t ver{0}, bytes{0};
+        uint64_t probes{0};
+        if (not in.read(magic, 8) || std::string(magic, 8) != "ECADSMPL") return false;
+        if (not ReadPod(in, ver) || not ReadPod(in, bytes) || not ReadPod(in, probes)) return false;
+        if (ver != 1 || (bytes != sizeof(float) && bytes != sizeof(double))) return false;
+        for (uint64_t i = 0; i < probes; ++i) {
+            uint64_t id{0};
+            std::string name, unit;
+            if (not ReadPod(in, id) || not ReadString(in, name) || not ReadString(in, unit)) return false;
+            m_ids.emplace_back(id);
+            m_names.emplace_back(std::move(name));
+            m_units.emplace_back(std::move(unit));
+        }
+        m_values.assign(probes, {});
+
+        char tag[4];
+        uint32_t rows{0};
+        std::vector<char> buffer;
+        while (in.read(tag, 4) && ReadPod(in, rows)) {
+            if (std::string(tag, 4) != "CHNK") break;
+            buffer.resize(size_t(rows) * (probes + 1) * bytes);
+            if (not in.read(buffer.data(), buffer.size())) break;
+            auto value = [&](size_t i) -> double {
+                if (bytes == sizeof(float)) return reinterpret_cast<const float *>(buffer.data())[i];
+                return reinterpret_cast<const double *>(buffer.data())[i];
+            };
+            for (size_t r = 0; r < rows; ++r)
+                m_times.emplace_back(value(r));
+            for (size_t p = 0; p < probes; ++p) {
+                for (size_t r = 0; r < rows; ++r)
+                    m_values[p].emplace_back(value((p + 1) * rows + r));
+            }
+        }
+        return true;
+    }
+
+    size_t Probes() const { return m_ids.size(); }
+    size_t Samples() const { return m_times.size(); }
+    const std::vector<uint64_t> & Ids() const { return m_ids; }
+    const std::vector<std::string> & Names() const { return m_names; }
+    const std::vector<std::string> & Units() const { return m_units; }
+    const std::vector<double> & Times() const { return m_times; }
+    const std::vector<double> & Values(size_t probe) const { return m_values.at(probe); }
+
+private:
+    template <typename T>
+    static bool ReadPod(std::ifstream & in, T & value) { return bool(in.read(reinterpret_cast<char *>(&value), sizeof(T))); }
+    static bool ReadString(std::ifstream & in, std::string & str)
+    {
+        uint32_t size{0};
+        if (not ReadPod(in, size)) return false;
+        str.resize(size);
+        return bool(in.read(str.data(), size));
+    }
+
+private:
+    std::vector<uint64_t> m_ids;
+    std::vector<std::string> m_names;
+    std::vector<std::string> m_units;
+    std::vector<double> m_times;
+    std::vector<std::vector<double> > m_values;
+};
+
+} // namespace thermal::utils
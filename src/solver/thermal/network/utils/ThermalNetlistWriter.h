@@ -19,7 +19,7 @@ public:
         num_type totalTime{10};
     };
 
-    explicit ThermalNetlistWriter(const ThermalNetwork<num_type> & network)
+    explicit ThermalNetlistWriter(const CompactThermalNetwork<num_type> & network)
      : m_network(network) {}
 
     virtual ~ThermalNetlistWriter() = default;
@@ -43,39 +43,40 @@ public:
         const size_t w = 10;
         formatOs(0, "* SPICE SIMULATION");
         formatOs(w, "V" + ref, ref, 0, m_settings.refT);        
-        const auto & nodes = m_network.GetNodes();
-        size_t sIndex = nodes.size();
-        for (size_t i = 0; i < nodes.size(); ++i) {
-            const auto & nd = nodes.at(i);
+        const auto & cols = m_network.Cols();
+        const auto & g = m_network.Conductances();
+        const size_t nodes = m_network.Size();
+        size_t sIndex = nodes;
+        for (size_t i = 0; i < nodes; ++i) {
 
             //cap
-            if (nd.c > 0) {
+            if (auto c = m_network.GetC(i); c > 0) {
                 auto name = "C" + std::to_string(i);
-                formatOs(w, name, node(i), ref, nd.c);
+                formatOs(w, name, node(i), ref, c);
             }
 
             //res
-            for (const auto & [n, r] : nd.ns) {
-                auto name = "R" + std::to_string(i) + "_" + std::to_string(n);
-                formatOs(w, name, node(i), node(n), r);
+            for (size_t k = m_network.RowBegin(i); k < m_network.RowEnd(i); ++k) {
+                auto name = "R" + std::to_string(i) + "_" + std::to_string(cols[k]);
+                formatOs(w, name, node(i), node(cols[k]), 1 / g[k]);
             }
 
             //t
-            if (math::NE(nd.t, ThermalNetwork<num_type>::unknownT)) {
+            if (auto t = m_network.GetT(i); math::NE(t, CompactThermalNetwork<num_type>::unknownT)) {
                 auto name  = "V" + std::to_string(i);
-                formatOs(w, name, node(i), ref, nd.t);
+                formatOs(w, name, node(i), ref, t);
             }
 
             //hf
-            if (nd.hf != 0) {
+            if (auto hf = m_network.GetHF(i); hf != 0) {
                 auto name = "I" + std::to_string(sIndex) + "_" + std::to_string(i);
-                formatOs(w, name, node(sIndex), node(i), nd.hf);//todo dynamic
+                formatOs(w, name, node(sIndex), node(i), hf);//todo dynamic
             }
 
             //htc
-            if (nd.htc != 0) {
+            if (auto htc = m_network.GetHTC(i); htc != 0) {
                 auto name = "R" + std::to_string(i) + "_" + ref;
-                formatOs(w, name, node(i), ref, 1 / nd.htc);
+                formatOs(w, name, node(i), ref, 1 / htc);
             }
         }
 
@@ -87,7 +88,7 @@ public:
     }
 private:
     SimulationSettings m_settings;
-    const ThermalNetwork<num_type> & m_network;
+    const CompactThermalNetwork<num_type> & m_network;
 };
 
 } // namespace thermal::utils
\ No newline at end of file
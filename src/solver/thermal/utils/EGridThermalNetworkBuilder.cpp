@@ -13,7 +13,7 @@ ECAD_INLINE EGridThermalNetworkBuilder<Scalar>::EGridThermalNetworkBuilder(const
 }
 
 template <typename Scalar>
-ECAD_INLINE UPtr<typename EGridThermalNetworkBuilder<Scalar>::Network> EGridThermalNetworkBuilder<Scalar>::Build(const std::vector<Scalar> & iniT) const
+ECAD_INLINE UPtr<typename EGridThermalNetworkBuilder<Scalar>::Network> EGridThermalNetworkBuilder<Scalar>::Build(const std::vector<Scalar> & iniT, [[maybe_unused]] size_t threads) const
 {
     const size_t size = m_model.TotalGrids(); 
     if (iniT.size() != size) return nullptr;
@@ -18,7 +18,7 @@ public:
     explicit EGridThermalNetworkBuilder(const ModelType & model);
     virtual ~EGridThermalNetworkBuilder() = default;
 
-    UPtr<Network> Build(const std::vector<Scalar> & iniT) const;
+    UPtr<Network> Build(const std::vector<Scalar> & iniT, size_t threads = 1) const;
 
 private:
     void ApplyHeatFlowForLayer(const std::vector<Scalar> & iniT, const EGridDataTable & dataTable, size_t layer, Network & network) const;
@@ -0,0 +1,118 @@
+#include "EMaterialPropCache.h"
+
+#include "interface/IMaterialDefCollection.h"
+#include "interface/IMaterialProp.h"
+#include "interface/IMaterialDef.h"
+namespace ecad::solver {
+
+ECAD_INLINE EMaterialPropCache::EMaterialPropCache(CPtr<IMaterialDefCollection> library, EFloat minT, EFloat maxT, EFloat step)
+ : m_minT(minT), m_step(step)
+{
+    ECAD_ASSERT(library && step > 0)
+    if (std::isfinite(minT) && std::isfinite(maxT)) {
+        if (maxT > minT) {
+            m_step = std::max(m_step, (maxT - minT) / (MAX_SAMPLES - 1));
+            m_samples = std::min(static_cast<size_t>(std::ceil((maxT - minT) / m_step)) + 1, MAX_SAMPLES);
+        }
+    }
+    else if (not std::isfinite(m_minT)) m_minT = std::isfinite(maxT) ? maxT : EFloat{0};
+
+    auto matIter = library->GetMaterialDefIter();
+    while (auto * material = matIter->Next()) {
+        auto id = material->GetMaterialId();
+        if (id < 0) continue;
+        if (m_materials.size() <= static_cast<size_t>(id))
+            m_materials.resize(id + 1);
+        Build(material, m_materials[id]);
+    }
+}
+
+ECAD_INLINE std::array<EFloat, 3> EMaterialPropCache::GetThermalConductivity(EMaterialId matId, EFloat refT) const
+{
+    return {Lookup(matId, Slot::ThermalConductivity, refT),
+            Lookup(matId, Slot(Slot::ThermalConductivity + 1), refT),
+            Lookup(matId, Slot(Slot::ThermalConductivity + 2), refT)};
+}
+
+ECAD_INLINE EFloat EMaterialPropCache::GetMassDensity(EMaterialId matId, EFloat refT) const
+{
+    return Lookup(matId, Slot::MassDensity, refT);
+}
+
+ECAD_INLINE EFloat EMaterialPropCache::GetSpecificHeat(EMaterialId matId, EFloat refT) const
+{
+    return Lookup(matId, Slot::SpecificHeat, refT);
+}
+
+ECAD_INLINE EFloat EMaterialPropCache::GetResistivity(EMaterialId matId, EFloat refT) const
+{
+    return Lookup(matId, Slot::Resistivity, refT);
+}
+
+ECAD_INLINE void EMaterialPropCache::Build(CPtr<IMaterialDef> material, Material & cache) const
+{
+    cache.material = material;
+    cache.values.assign(m_samples * Slot::Total, 0);
+    for (size_t slot = 0; slot < Slot::Total; ++slot) {
+        auto s = static_cast<Slot>(slot);
+        EFloat value{0};
+        cache.valid[slot] = Evaluate(material, s, m_minT, value);
+        cache.values[slot] = value;
+        cache.temperatureDepend[slot] = false;
+        if (not cache.valid[slot]) continue;
+
+        auto propId = slot < Slot::MassDensity ? EMaterialPropId::ThermalConductivity :
+                      slot == Slot::MassDensity ? EMaterialPropId::MassDensity :
+                      slot == Slot::SpecificHeat ? EMaterialPropId::SpecificHeat : EMaterialPropId::Resistivity;
+        if (material->GetProperty(propId)->isPropValue()) continue;
+
+        cache.temperatureDepend[slot] = true;
+        for (size_t i = 1; i < m_samples; ++i)
+            Evaluate(material, s, m_minT + i * m_step, cache.values[i * Slot::Total + slot]);
+    }
+}
+
+ECAD_INLINE EFloat EMaterialPropCache::Lookup(EMaterialId matId, Slot slot, EFloat refT) const
+{
+    ECAD_ASSERT(matId >= 0 && static_cast<size_t>(matId) < m_materials.size())
+    const auto & cache = m_materials[matId];
+    ECAD_ASSERT(cache.valid[slot])
+    if (not cache.temperatureDepend[slot]) return cache.values[slot];
+
+    EFloat pos = (refT - m_minT) / m_step;
+    if (not (pos >= 0 && pos <= m_samples - 1)) {
+        EFloat value{0};
+        Evaluate(cache.material, slot, refT, value);
+        return value;
+    }
+    if (1 == m_samples) return cache.values[slot];
+    size_t i = std::min(static_cast<size_t>(pos), m_samples - 2);
+    EFloat ratio = pos - i;
+    const auto & v1 = cache.values[i * Slot::Total + slot];
+    const auto & v2 = cache.values[(i + 1) * Slot::Total + slot];
+    return v1 + ratio * (v2 - v1);
+}
+
+ECAD_INLINE bool EMaterialPropCache::Evaluate(CPtr<IMaterialDef> material, Slot slot, EFloat refT, EFloat & value)
+{
+    switch (slot) {
+        case Slot::MassDensity : {
+            auto prop = material->GetProperty(EMaterialPropId::MassDensity);
+            return prop && prop->GetSimpleProperty(refT, value);
+        }
+        case Slot::SpecificHeat : {
+            auto prop = material->GetProperty(EMaterialPropId::SpecificHeat);
+            return prop && prop->GetSimpleProperty(refT, value);
+        }
+        case Slot::Resistivity : {
+            auto prop = material->GetProperty(EMaterialPropId::Resistivity);
+            return prop && prop->GetSimpleProperty(refT, value);
+        }
+        default : {
+            auto prop = material->GetProperty(EMaterialPropId::ThermalConductivity);
+            return prop && prop->GetAnisotropicProperty(refT, slot - Slot::ThermalConductivity, value);
+        }
+    }
+}
+
+}//namespace ecad::solver
@@ -0,0 +1,52 @@
+#pragma once
+#include "basic/ECadCommon.h"
+#include <array>
+namespace ecad {
+
+class IMaterialDef;
+class IMaterialDefCollection;
+namespace solver {
+
+/**
+ * @brief thermal network assembly material properties, evaluated once per build on a uniform temperature grid
+ *        covering [minT, maxT] and looked up by linear interpolation, temperatures outside the grid fall back to
+ *        the material definition
+ */
+class ECAD_API EMaterialPropCache
+{
+public:
+    inline static constexpr EFloat DEFAULT_STEP = 0.1;//unit: K
+    inline static constexpr size_t MAX_SAMPLES = 4096;//a wider range widens the step, non finite bounds keep one sample
+    explicit EMaterialPropCache(CPtr<IMaterialDefCollection> library, EFloat minT, EFloat maxT, EFloat step = DEFAULT_STEP);
+    virtual ~EMaterialPropCache() = default;
+
+    std::array<EFloat, 3> GetThermalConductivity(EMaterialId matId, EFloat refT) const;
+    EFloat GetMassDensity(EMaterialId matId, EFloat refT) const;
+    EFloat GetSpecificHeat(EMaterialId matId, EFloat refT) const;
+    EFloat GetResistivity(EMaterialId matId, EFloat refT) const;
+
+    size_t Samples() const { return m_samples; }
+
+private:
+    enum Slot { ThermalConductivity = 0, MassDensity = 3, SpecificHeat = 4, Resistivity = 5, Total = 6 };
+    struct Material
+    {
+        CPtr<IMaterialDef> material{nullptr};
+        std::array<bool, Slot::Total> temperatureDepend{};
+        std::array<bool, Slot::Total> valid{};
+        std::vector<EFloat> values;//temperature major, Slot::Total values per sample
+    };
+
+    void Build(CPtr<IMaterialDef> material, Material & cache) const;
+    EFloat Lookup(EMaterialId matId, Slot slot, EFloat refT) const;
+    static bool Evaluate(CPtr<IMaterialDef> material, Slot slot, EFloat refT, EFloat & value);
+
+private:
+    EFloat m_minT;
+    EFloat m_step;
+    size_t m_samples{1};
+    std::vector<Material> m_materials;//index: material id
+};
+
+}//namespace solver
+}//namespace ecad
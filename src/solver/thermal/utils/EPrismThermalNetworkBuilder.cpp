@@ -2,10 +2,6 @@
 #include "model/thermal/utils/EPrismThermalModelQuery.h"
 #include "basic/ELookupTable.h"
 
-#include "interface/IMaterialDefCollection.h"
-#include "interface/IMaterialProp.h"
-#include "interface/IMaterialDef.h"
-
 #include "generic/thread/ThreadPool.hpp"
 namespace ecad::solver {
 
@@ -26,24 +22,26 @@ ECAD_INLINE UPtr<typename EPrismThermalNetworkBuilder<Scalar>::Network> EPrismTh
     summary.Reset();
     summary.totalNodes = size;
     auto network = std::make_unique<Network>(size);
+    if (size > 0) {
+        auto [minT, maxT] = std::minmax_element(iniT.begin(), iniT.end());
+        m_matCache.reset(new EMaterialPropCache(m_model.GetMaterialLibrary(), *minT, *maxT));
+    }
 
-    if (threads > 1) {
+    const size_t prisms = m_model.TotalPrismElements();
+    const size_t blocks = std::max<size_t>(1, std::min(threads, prisms));
+    std::vector<BuildBlock> results(blocks);
+    if (blocks > 1) {
         generic::thread::ThreadPool pool(threads);
-        size_t size = m_model.TotalPrismElements();
-        size_t blocks = pool.Threads();
-        size_t blockSize = size / blocks;
-
-        size_t begin = 0;
-        for(size_t i = 0; i < blocks && blockSize > 0; ++i){
-            size_t end = begin + blockSize;
-            pool.Submit(std::bind(&EPrismThermalNetworkBuilder::BuildPrismElement, this, std::ref(iniT), network.get(), begin, end));
-            begin = end;
+        for (size_t i = 0; i < blocks; ++i) {
+            size_t begin = i * prisms / blocks;
+            size_t end = (i + 1) * prisms / blocks;
+            pool.Submit(std::bind(&EPrismThermalNetworkBuilder::BuildPrismElement, this, std::ref(iniT), network.get(), begin, end, std::ref(results[i])));
         }
-        size_t end = size;
-        if(begin != end)
-            pool.Submit(std::bind(&EPrismThermalNetworkBuilder::BuildPrismElement, this, std::ref(iniT), network.get(), begin, end));        
     }
-    else BuildPrismElement(iniT, network.get(), 0, m_model.TotalPrismElements());
+    else BuildPrismElement(iniT, network.get(), 0, prisms, results.front());
+
+    for (auto & block : results)
+        block.MergeTo(*network, summary);
     
     BuildLineElement(iniT, network.get());
     ApplyBlockBCs(network.get());
@@ -51,8 +49,9 @@ ECAD_INLINE UPtr<typename EPrismThermalNetworkBuilder<Scalar>::Network> EPrismTh
 }
 
 template <typename Scalar>
-ECAD_INLINE void EPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const std::vector<Scalar> & iniT, Ptr<Network> network, size_t start, size_t end) const
+ECAD_INLINE void EPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const std::vector<Scalar> & iniT, Ptr<Network> network, size_t start, size_t end, BuildBlock & block) const
 {
+    auto & summary = block.summary;
     auto topBC = m_model.GetUniformBC(EOrientation::Top);
     auto botBC = m_model.GetUniformBC(EOrientation::Bot);
     
@@ -95,7 +94,7 @@ ECAD_INLINE void EPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const st
                 auto kNb = GetMatThermalConductivity(nbEle.matId, iniT.at(nid));
                 auto kNbXY = 0.5 * (kNb[0] + kNb[1]);
                 auto r2 = (dist - dist2edge) / kNbXY / vArea;
-                network->SetR(i, nid, r1 + r2);
+                block.SetR(i, nid, r1 + r2);
             }
         }
         auto height = GetPrismHeight(i);
@@ -123,7 +122,7 @@ ECAD_INLINE void EPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const st
             auto hNb = GetPrismHeight(nTop);
             auto kNb = GetMatThermalConductivity(nbEle.matId, iniT.at(nTop));
             auto r = (0.5 * height / k[2] + 0.5 * hNb / kNb[2]) / hArea;
-            network->SetR(i, nTop, r);
+            block.SetR(i, nTop, r);
         }
         //bot
         auto nBot = neighbors.at(PrismElement::BOT_NEIGHBOR_INDEX);
@@ -148,7 +147,7 @@ ECAD_INLINE void EPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const st
             auto hNb = GetPrismHeight(nBot);
             auto kNb = GetMatThermalConductivity(nbEle.matId, iniT.at(nBot));
             auto r = (0.5 * height / k[2] + 0.5 * hNb / kNb[2]) / hArea;
-            network->SetR(i, nBot, r);
+            block.SetR(i, nBot, r);
         }
     }
 }
@@ -349,43 +348,29 @@ ECAD_INLINE EFloat EPrismThermalNetworkBuilder<Scalar>::GetLineArea(size_t index
 template <typename Scalar>
 ECAD_INLINE std::array<EFloat, 3> EPrismThermalNetworkBuilder<Scalar>::GetMatThermalConductivity(EMaterialId matId, EFloat refT) const
 {
-    std::array<EFloat, 3> result;
-    auto material = m_model.GetMaterialLibrary()->FindMaterialDefById(matId); { ECAD_ASSERT(material) }
-    for (size_t i = 0; i < result.size(); ++i) {
-        [[maybe_unused]] auto check = material->GetProperty(EMaterialPropId::ThermalConductivity)->GetAnisotropicProperty(refT, i, result[i]);
-        ECAD_ASSERT(check)
-    }
-    return result;
+    ECAD_ASSERT(m_matCache)
+    return m_matCache->GetThermalConductivity(matId, refT);
 }
 
 template <typename Scalar>
 ECAD_INLINE EFloat EPrismThermalNetworkBuilder<Scalar>::GetMatMassDensity(EMaterialId matId, EFloat refT) const
 {
-    EFloat result{0};
-    auto material = m_model.GetMaterialLibrary()->FindMaterialDefById(matId); { ECAD_ASSERT(material) }
-    [[maybe_unused]] auto check = material->GetProperty(EMaterialPropId::MassDensity)->GetSimpleProperty(refT, result);
-    ECAD_ASSERT(check)
-    return result;
+    ECAD_ASSERT(m_matCache)
+    return m_matCache->GetMassDensity(matId, refT);
 }
 
 template <typename Scalar>
 ECAD_INLINE EFloat EPrismThermalNetworkBuilder<Scalar>::GetMatSpecificHeat(EMaterialId matId, EFloat refT) const
 {
-    EFloat result{0};
-    auto material = m_model.GetMaterialLibrary()->FindMaterialDefById(matId); { ECAD_ASSERT(material) }
-    [[maybe_unused]] auto check = material->GetProperty(EMaterialPropId::SpecificHeat)->GetSimpleProperty(refT, result);
-    ECAD_ASSERT(check)
-    return result;
+    ECAD_ASSERT(m_matCache)
+    return m_matCache->GetSpecificHeat(matId, refT);
 }
 
 template <typename Scalar>
 ECAD_INLINE EFloat EPrismThermalNetworkBuilder<Scalar>::GetMatResistivity(EMaterialId matId, EFloat refT) const
 {
-    EFloat result{0};
-    auto material = m_model.GetMaterialLibrary()->FindMaterialDefById(matId); { ECAD_ASSERT(material) }
-    [[maybe_unused]] auto check = material->GetProperty(EMaterialPropId::Resistivity)->GetSimpleProperty(refT, result);
-    ECAD_ASSERT(check)
-    return result; 
+    ECAD_ASSERT(m_matCache)
+    return m_matCache->GetResistivity(matId, refT);
 }
 
 template ECAD_INLINE class EPrismThermalNetworkBuilder<Float32>;
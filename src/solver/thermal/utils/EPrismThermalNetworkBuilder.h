@@ -1,5 +1,6 @@
 #pragma once
 #include "EThermalNetworkBuilder.h"
+#include "EMaterialPropCache.h"
 #include "model/thermal/EPrismThermalModel.h"
 #include "solver/thermal/network/ThermalNetwork.h"
 namespace ecad::solver {
@@ -19,7 +20,9 @@ public:
     UPtr<Network > Build(const std::vector<Scalar> & iniT, size_t threads = 1) const;
 
 protected:
-    virtual void BuildPrismElement(const std::vector<Scalar> & iniT, Ptr<Network> network, size_t start, size_t end) const;
+    using BuildBlock = EThermalNetworkBuildBlock<Scalar>;
+    /// only writes nodes in [start, end) of network, edges and summary go to block
+    virtual void BuildPrismElement(const std::vector<Scalar> & iniT, Ptr<Network> network, size_t start, size_t end, BuildBlock & block) const;
     virtual void ApplyBlockBCs(Ptr<Network> network) const;
     void BuildLineElement(const std::vector<Scalar> & iniT, Ptr<Network> network) const;
 
@@ -48,6 +51,7 @@ protected:
 
 protected:
     const ModelType & m_model;
+    mutable UPtr<EMaterialPropCache> m_matCache;//rebuilt for each Build()
 };
 } // namespace ecad::solver
 
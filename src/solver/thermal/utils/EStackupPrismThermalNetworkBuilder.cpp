@@ -18,13 +18,13 @@ ECAD_INLINE EStackupPrismThermalNetworkBuilder<Scalar>::EStackupPrismThermalNetw
 }
 
 template <typename Scalar>
-ECAD_INLINE void EStackupPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const std::vector<Scalar> & iniT, Ptr<Network> network, size_t start, size_t end) const
+ECAD_INLINE void EStackupPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const std::vector<Scalar> & iniT, Ptr<Network> network, size_t start, size_t end, BuildBlock & block) const
 {
     const auto & model = this->m_model;
     auto topBC = model.GetUniformBC(EOrientation::Top);
     auto botBC = model.GetUniformBC(EOrientation::Bot);
     
-    auto & summary = EThermalNetworkBuilder::summary;
+    auto & summary = block.summary;
     for (size_t i = start; i < end; ++i) {
         const auto & inst = model.GetPrism(i);
         const auto & element = model.GetPrismElement(inst.layer, inst.element);
@@ -64,7 +64,7 @@ ECAD_INLINE void EStackupPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(c
                 auto kNb = this->GetMatThermalConductivity(nbEle.matId, iniT.at(nid));
                 auto kNbXY = 0.5 * (kNb[0] + kNb[1]);
                 auto r2 = (dist - dist2edge) / kNbXY / vArea;
-                network->SetR(i, nid, r1 + r2);
+                block.SetR(i, nid, r1 + r2);
             }
         }
         auto height = this->GetPrismHeight(i);
@@ -99,7 +99,7 @@ ECAD_INLINE void EStackupPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(c
                 auto area = hArea * contact.ratio;
                 auto r =  (0.5 * height / k[2] + 0.5 * hNb / kNb[2]) / area;
                 // auto r = 0.5 * height / k[2] / hArea + 0.5 * hNb / kNb[2] / GetPrismTopBotArea(nTop);
-                network->SetR(i, nTop, r);
+                block.SetR(i, nTop, r);
             }
             if (ratio > 0 && nullptr != topBC && topBC->isValid()) {
                 if (EThermalBoundaryCondition::BCType::HTC == topBC->type) {
@@ -147,7 +147,7 @@ ECAD_INLINE void EStackupPrismThermalNetworkBuilder<Scalar>::BuildPrismElement(c
                 auto area = hArea * contact.ratio;
                 auto r =  (0.5 * height / k[2] + 0.5 * hNb / kNb[2]) / area;
                 // auto r = 0.5 * height / k[2] / hArea + 0.5 * hNb / kNb[2] / GetPrismTopBotArea(nBot);
-                network->SetR(i, nBot, r);
+                block.SetR(i, nBot, r);
             }
             if (ratio > 0 && nullptr != botBC && botBC->isValid()) {
                 if (EThermalBoundaryCondition::BCType::HTC == botBC->type) {
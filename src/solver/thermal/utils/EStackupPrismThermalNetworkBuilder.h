@@ -17,7 +17,8 @@ public:
     virtual ~EStackupPrismThermalNetworkBuilder() = default;
 
 private:
-    void BuildPrismElement(const std::vector<Scalar> & iniT, Ptr<Network> network, size_t start, size_t end) const override;
+    using BuildBlock = typename EPrismThermalNetworkBuilder<Scalar>::BuildBlock;
+    void BuildPrismElement(const std::vector<Scalar> & iniT, Ptr<Network> network, size_t start, size_t end, BuildBlock & block) const override;
     void ApplyBlockBCs(Ptr<Network> network) const override;
 };
 } // namespace ecad::solver
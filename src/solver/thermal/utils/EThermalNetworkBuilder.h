@@ -1,4 +1,5 @@
 #pragma once
+#include "solver/thermal/network/ThermalNetwork.h"
 #include "basic/ECadCommon.h"
 namespace ecad {
 namespace solver {
@@ -10,6 +11,38 @@ struct EThermalNetworkBuildSummary
     size_t boundaryNodes = 0;
     double iHeatFlow = 0, oHeatFlow = 0, jouleHeat = 0;
     void Reset() { *this = EThermalNetworkBuildSummary{}; }
+    void Merge(const EThermalNetworkBuildSummary & other)
+    {
+        fixedTNodes += other.fixedTNodes;
+        boundaryNodes += other.boundaryNodes;
+        iHeatFlow += other.iHeatFlow;
+        oHeatFlow += other.oHeatFlow;
+        jouleHeat += other.jouleHeat;
+    }
+};
+
+/**
+ * @brief thread-local result of building a contiguous range of elements,
+ *        blocks are merged into the network in range order so the parallel build is deterministic
+ */
+template <typename Scalar>
+struct EThermalNetworkBuildBlock
+{
+    using Network = thermal::model::ThermalNetwork<Scalar>;
+    EThermalNetworkBuildSummary summary;
+    std::vector<typename Network::Edge> edges;
+
+    void SetR(size_t node1, size_t node2, Scalar r)
+    {
+        edges.emplace_back(Network::MakeEdge(node1, node2, r));
+    }
+
+    void MergeTo(Network & network, EThermalNetworkBuildSummary & total)
+    {
+        network.AppendEdges(edges);
+        total.Merge(summary);
+        std::vector<typename Network::Edge>().swap(edges);
+    }
 };
 
 class ECAD_API EThermalNetworkBuilder
@@ -1,13 +1,26 @@
 #include "utility/EFlattenUtility.h"
 
 #include "generic/thread/TaskFlow.hpp"
+#include "utility/ELayoutMergeUtility.h"
+#include "interface/ICellInstCollection.h"
+#include "interface/ILayerCollection.h"
 #include "interface/ILayoutView.h"
+#include "interface/ILayerMap.h"
 #include "interface/IDatabase.h"
 #include "interface/ICellInst.h"
 #include "interface/ICell.h"
 namespace ecad {
 namespace utils {
 
+///flatten state of one cell, the buffers are only written by their own copy task and read by the commit task
+struct EFlattenJob
+{
+    Ptr<ILayoutView> layout{nullptr};
+    UPtr<ILayerMap> defaultLyrMap{nullptr};
+    std::vector<CPtr<ICellInst> > cellInsts;
+    std::vector<ELayoutMergeBuffer> buffers;
+};
+
 ECAD_INLINE bool EFlattenUtility::Flatten(Ptr<IDatabase> database, Ptr<ICell> cell, size_t threads)
 {
     ECAD_EFFICIENCY_TRACK("flatten")
@@ -17,8 +30,37 @@ ECAD_INLINE bool EFlattenUtility::Flatten(Ptr<IDatabase> database, Ptr<ICell> ce
     auto cellNodeMap = BuildCellNodeMap(database);
     if(!(cellNodeMap->count(cell))) return false;
 
+    std::vector<CPtr<ECellNode> > cells;
+    std::unordered_set<CPtr<ECellNode> > visited;
+    CollectCells(cellNodeMap->at(cell).get(), visited, cells);
+
     auto flattenFlow = UPtr<FlattenFlow>(new FlattenFlow);
-    ScheduleFlattenTasks(flattenFlow.get(), nullptr, *(cellNodeMap->at(cell)));
+    std::vector<UPtr<EFlattenJob> > jobs;
+    std::unordered_map<CPtr<ICell>, Ptr<FlattenNode> > commits;
+    for (auto node : cells) {
+        auto layout = node->cell->GetLayoutView();
+        auto job = std::make_unique<EFlattenJob>();
+        job->layout = layout;
+        auto cellInstIter = layout->GetCellInstIter();
+        while (auto * cellInst = cellInstIter->Next()) {
+            job->cellInsts.emplace_back(cellInst);
+            if (nullptr == cellInst->GetLayerMap() && nullptr == job->defaultLyrMap)
+                job->defaultLyrMap = layout->GetLayerCollection()->GetDefaultLayerMap();
+        }
+        if (job->cellInsts.empty()) continue;
+        job->buffers.resize(job->cellInsts.size());
+
+        auto commit = flattenFlow->Emplace(std::bind(&EFlattenUtility::CommitOneCell, job.get()), node->cell->GetName());
+        for (size_t i = 0; i < job->cellInsts.size(); ++i) {
+            auto copy = flattenFlow->Emplace(std::bind(&EFlattenUtility::CopyOneInst, job.get(), i), job->cellInsts.at(i)->GetName());
+            copy->Precede(commit);
+            auto iter = commits.find(job->cellInsts.at(i)->GetDefLayoutView()->GetCell());
+            if (iter != commits.cend()) iter->second->Precede(copy);
+        }
+        commits.emplace(node->cell, commit);
+        jobs.emplace_back(std::move(job));
+    }
+    if (jobs.empty()) return true;
 
     taskflow::Executor executor(threads);
     return executor.Run(*flattenFlow);
@@ -64,18 +106,25 @@ ECAD_INLINE bool EFlattenUtility::GetTopCells(Ptr<IDatabase> database, std::vect
     return not tops.empty();
 }
 
-ECAD_INLINE void EFlattenUtility::ScheduleFlattenTasks(Ptr<FlattenFlow> flattenFlow, Ptr<FlattenNode> successor, const ECellNode & node)
+ECAD_INLINE void EFlattenUtility::CollectCells(CPtr<ECellNode> node, std::unordered_set<CPtr<ECellNode> > & visited, std::vector<CPtr<ECellNode> > & cells)
+{
+    if (not visited.insert(node).second) return;
+    for (auto dependent : node->dependents)
+        CollectCells(dependent, visited, cells);
+    cells.emplace_back(node);
+}
+
+ECAD_INLINE void EFlattenUtility::CopyOneInst(Ptr<EFlattenJob> job, size_t index)
 {
-    auto task = flattenFlow->Emplace(std::bind(&EFlattenUtility::FlattenOneCell, this, node.cell), node.cell->GetName());
-    if(successor) task->Precede(successor);
-    for(auto dependent : node.dependents)
-        ScheduleFlattenTasks(flattenFlow, task, *dependent);
+    ELayoutMergeUtility::Copy(job->layout, job->cellInsts.at(index), job->defaultLyrMap.get(), job->buffers.at(index));
 }
 
-ECAD_INLINE void EFlattenUtility::FlattenOneCell(Ptr<ICell> cell)
+ECAD_INLINE void EFlattenUtility::CommitOneCell(Ptr<EFlattenJob> job)
 {
-    std::lock_guard<std::mutex> lock(m_flattenMutex);
-    cell->GetFlattenedLayoutView();
+    for (auto & buffer : job->buffers)
+        ELayoutMergeUtility::Commit(job->layout, buffer);
+    job->layout->GetCellInstCollection()->Clear();
+    job->buffers.clear();
 }
 
 }//namespace utils
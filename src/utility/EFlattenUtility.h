@@ -1,13 +1,14 @@
 #pragma once
 #include "basic/ECadCommon.h"
 #include <unordered_map>
-#include <mutex>
+#include <unordered_set>
 #include <list>
 namespace generic { namespace thread { namespace taskflow { class TaskNode; class TaskFlow; } } }
 namespace ecad {
 class ICell;
 class IDatabase;
 namespace utils {
+struct EFlattenJob;
 class ECAD_API ECellNode
 {
 public:
@@ -30,10 +31,11 @@ public:
     static bool GetTopCells(Ptr<IDatabase> database, std::vector<Ptr<ICell> > & tops);
 
 private:
-    void ScheduleFlattenTasks(Ptr<FlattenFlow> flattenFlow, Ptr<FlattenNode> successor, const ECellNode & node);
-    void FlattenOneCell(Ptr<ICell> cell);
-private:
-    mutable std::mutex m_flattenMutex;
+    ///definitions first, every cell once
+    static void CollectCells(CPtr<ECellNode> node, std::unordered_set<CPtr<ECellNode> > & visited, std::vector<CPtr<ECellNode> > & cells);
+    ///the instances of a cell are copied by independent tasks and committed to the cell's layout in instance order by one task
+    static void CopyOneInst(Ptr<EFlattenJob> job, size_t index);
+    static void CommitOneCell(Ptr<EFlattenJob> job);
 };
 
 }//namespace utils
@@ -0,0 +1,197 @@
+#include "EInstancedLayout.h"
+
+#include "generic/geometry/Transform.hpp"
+
+#include "interface/IPrimitiveCollection.h"
+#include "interface/ILayerCollection.h"
+#include "interface/ILayoutView.h"
+#include "interface/IPrimitive.h"
+#include "interface/ICellInst.h"
+#include "interface/ILayerMap.h"
+#include "interface/ILayer.h"
+namespace ecad {
+namespace utils {
+
+namespace detail {
+ECAD_INLINE EVector2D TransformVector(const EInstancedLayout::Transform & transform, EVector2D v)
+{
+    EPoint2D o(0, 0);
+    generic::geometry::Transform(o, transform);
+    generic::geometry::Transform(v, transform);
+    return EVector2D(v[0] - o[0], v[1] - o[1]);
+}
+}//namespace detail
+
+ECAD_INLINE EInstancedLayout::Transform EInstancedLayout::Placement::GetTransform(size_t index) const
+{
+    if (1 == Size()) return transform;
+    auto c = static_cast<ECoord>(index % cols), r = static_cast<ECoord>(index / cols);
+    EVector2D offset(c * colPitch[0] + r * rowPitch[0], c * colPitch[1] + r * rowPitch[1]);
+    return generic::geometry::makeShiftTransform2D<EFloat>(offset) * transform;
+}
+
+ECAD_INLINE size_t EInstancedLayout::Master::Placements() const
+{
+    size_t size{0};
+    for (const auto & placement : placements)
+        size += placement.Size();
+    return size;
+}
+
+ECAD_INLINE EPolygonWithHolesData EInstancedLayout::Shape::GetPolygonWithHoles() const
+{
+    auto geom = primitive->GetGeometry2DFromPrimitive();
+    if (nullptr == geom || nullptr == geom->GetShape()) return EPolygonWithHolesData{};
+    auto pwh = geom->GetShape()->GetPolygonWithHoles();
+    if (transformed) generic::geometry::Transform(pwh, transform);
+    return pwh;
+}
+
+ECAD_INLINE UPtr<EShape> EInstancedLayout::Shape::GetShape() const
+{
+    auto geom = primitive->GetGeometry2DFromPrimitive();
+    if (nullptr == geom || nullptr == geom->GetShape()) return nullptr;
+    if (not transformed) return geom->GetShape()->Clone();
+    auto shape = new EPolygonWithHoles;
+    shape->shape = GetPolygonWithHoles();
+    return UPtr<EShape>(shape);
+}
+
+ECAD_INLINE EPoint2D EInstancedLayout::Shape::GetPoint(EPoint2D point) const
+{
+    if (transformed) generic::geometry::Transform(point, transform);
+    return point;
+}
+
+ECAD_INLINE EInstancedLayout::ShapeIter::ShapeIter(const EInstancedLayout & layout)
+ : m_layout(layout)
+{
+}
+
+ECAD_INLINE CPtr<EInstancedLayout::Shape> EInstancedLayout::ShapeIter::Next()
+{
+    const auto & masters = m_layout.m_masters;
+    while (m_master < masters.size()) {
+        const auto & master = masters.at(m_master);
+        auto primitives = master.layout->GetPrimitiveCollection();
+        if (m_placement < master.placements.size() && m_primitive < primitives->Size()) {
+            if (0 == m_primitive) {
+                //master 0 is the top layout with its identity placement
+                m_shape.master = master.layout;
+                m_shape.transformed = m_master > 0;
+                m_shape.transform = master.placements.at(m_placement).GetTransform(m_index);
+            }
+            auto primitive = primitives->GetPrimitive(m_primitive++);
+            m_shape.primitive = primitive;
+            m_shape.layer = m_layout.MapLayer(master.layerMapping, primitive->GetLayer());
+            m_shape.net = primitive->GetNet();
+            return &m_shape;
+        }
+        if (m_placement < master.placements.size() && primitives->Size() > 0) {
+            m_primitive = 0;
+            if (++m_index < master.placements.at(m_placement).Size()) continue;
+            m_index = 0;
+            if (++m_placement < master.placements.size()) continue;
+        }
+        m_primitive = m_index = m_placement = 0;
+        m_master++;
+    }
+    return nullptr;
+}
+
+ECAD_INLINE EInstancedLayout::EInstancedLayout(CPtr<ILayoutView> top)
+ : m_top(top)
+{
+    m_layerMappings.emplace_back();
+    if (m_top) Build(m_top, 0, Placement{});
+}
+
+ECAD_INLINE UPtr<EInstancedLayout::ShapeIter> EInstancedLayout::GetShapeIter() const
+{
+    return std::make_unique<ShapeIter>(*this);
+}
+
+ECAD_INLINE size_t EInstancedLayout::FlattenedPrimitives() const
+{
+    size_t size{0};
+    for (const auto & master : m_masters)
+        size += master.layout->GetPrimitiveCollection()->Size() * master.Placements();
+    return size;
+}
+
+ECAD_INLINE ELayerId EInstancedLayout::MapLayer(size_t layerMapping, ELayerId layer) const
+{
+    if (0 == layerMapping) return layer;
+    const auto & mapping = m_layerMappings.at(layerMapping);
+    auto iter = mapping.find(layer);
+    return iter == mapping.cend() ? ELayerId::noLayer : iter->second;
+}
+
+ECAD_INLINE void EInstancedLayout::Build(CPtr<ILayoutView> layout, size_t layerMapping, Placement placement)
+{
+    m_masters[GetMaster(layout, layerMapping)].placements.emplace_back(placement);
+
+    auto cellInstIter = layout->GetCellInstIter();
+    while (auto * cellInst = cellInstIter->Next()) {
+        auto defLayout = cellInst->GetDefLayoutView();
+        if (nullptr == defLayout) continue;
+
+        auto childMapping = GetLayerMapping(layerMapping, layout, cellInst);
+        const auto & local = cellInst->GetTransform().GetTransform();
+
+        size_t cols, rows;
+        EVector2D colPitch, rowPitch;
+        cellInst->GetArray(cols, rows, colPitch, rowPitch);
+        //an array inside an array can not be one record, so the children are placed for each placement of the parent array
+        for (size_t i = 0; i < placement.Size(); ++i) {
+            auto transform = placement.GetTransform(i);
+            Placement child;
+            child.transform = transform * local;
+            child.cols = cols;
+            child.rows = rows;
+            child.colPitch = detail::TransformVector(transform, colPitch);
+            child.rowPitch = detail::TransformVector(transform, rowPitch);
+            Build(defLayout, childMapping, std::move(child));
+        }
+    }
+}
+
+ECAD_INLINE size_t EInstancedLayout::GetMaster(CPtr<ILayoutView> layout, size_t layerMapping)
+{
+    auto key = std::make_pair(layout, layerMapping);
+    auto iter = m_masterIndices.find(key);
+    if (iter != m_masterIndices.cend()) return iter->second;
+
+    Master master;
+    master.layout = layout;
+    master.layerMapping = layerMapping;
+    m_masters.emplace_back(std::move(master));
+    return m_masterIndices.emplace(key, m_masters.size() - 1).first->second;
+}
+
+ECAD_INLINE size_t EInstancedLayout::GetLayerMapping(size_t parentMapping, CPtr<ILayoutView> parent, CPtr<ICellInst> cellInst)
+{
+    auto defLayout = cellInst->GetDefLayoutView();
+    auto key = std::make_tuple(parentMapping, cellInst->GetLayerMap(), parent, defLayout);
+    auto iter = m_layerMappingIndices.find(key);
+    if (iter != m_layerMappingIndices.cend()) return iter->second;
+
+    UPtr<ILayerMap> defaultLyrMap;
+    auto layerMap = cellInst->GetLayerMap();
+    if (nullptr == layerMap) {
+        defaultLyrMap = parent->GetLayerCollection()->GetDefaultLayerMap();
+        layerMap = defaultLyrMap.get();
+    }
+
+    std::unordered_map<ELayerId, ELayerId> mapping;
+    auto layerIter = defLayout->GetLayerIter();
+    while (auto * layer = layerIter->Next()) {
+        auto parentLayer = layerMap->GetMappingForward(layer->GetLayerId());
+        mapping.emplace(layer->GetLayerId(), MapLayer(parentMapping, parentLayer));
+    }
+    m_layerMappings.emplace_back(std::move(mapping));
+    return m_layerMappingIndices.emplace(key, m_layerMappings.size() - 1).first->second;
+}
+
+}//namespace utils
+}//namespace ecad
@@ -0,0 +1,93 @@
+#pragma once
+#include "basic/ECadCommon.h"
+#include "basic/ETransform.h"
+#include "basic/EShape.h"
+#include <unordered_map>
+#include <tuple>
+#include <map>
+namespace ecad {
+
+class ICellInst;
+class ILayerMap;
+class IPrimitive;
+class ILayoutView;
+namespace utils {
+
+/**
+ * @brief instanced view of a hierarchical layout, the primitives of each cell definition are kept once as a master
+ *        and every placement of the master is a transform record, an array instance stays one record with its cols, rows and pitches,
+ *        so the memory scales with the masters instead of the instances, the shapes are flattened lazily by ShapeIter
+ */
+class ECAD_API EInstancedLayout
+{
+public:
+    using Transform = ETransform2D::Transform;
+    struct Placement
+    {
+        Transform transform;//master to top coordinates
+        size_t cols{1}, rows{1};
+        EVector2D colPitch{0, 0}, rowPitch{0, 0};//in top coordinates
+        size_t Size() const { return cols * rows; }
+        Transform GetTransform(size_t index) const;
+    };
+
+    struct Master
+    {
+        CPtr<ILayoutView> layout{nullptr};
+        size_t layerMapping{0};//index of the mapping from the master layers to the top layers
+        std::vector<Placement> placements;
+        size_t Placements() const;
+    };
+
+    ///one primitive of a master at one placement, the layer is mapped to the top layout and the net belongs to the master layout
+    struct Shape
+    {
+        Ptr<IPrimitive> primitive{nullptr};
+        CPtr<ILayoutView> master{nullptr};
+        ELayerId layer{ELayerId::noLayer};
+        ENetId net{ENetId::noNet};
+        bool transformed{false};
+        Transform transform;
+
+        ///transformed outline of a geometry primitive
+        EPolygonWithHolesData GetPolygonWithHoles() const;
+        UPtr<EShape> GetShape() const;
+        EPoint2D GetPoint(EPoint2D point) const;
+    };
+
+    class ECAD_API ShapeIter
+    {
+    public:
+        explicit ShapeIter(const EInstancedLayout & layout);
+        CPtr<Shape> Next();
+    private:
+        const EInstancedLayout & m_layout;
+        size_t m_master{0}, m_placement{0}, m_index{0}, m_primitive{0};
+        Shape m_shape;
+    };
+
+    explicit EInstancedLayout(CPtr<ILayoutView> top);
+
+    CPtr<ILayoutView> GetTopLayoutView() const { return m_top; }
+    const std::vector<Master> & GetMasters() const { return m_masters; }
+    UPtr<ShapeIter> GetShapeIter() const;
+
+    ///total number of placed primitives, as if the layout was flattened
+    size_t FlattenedPrimitives() const;
+    ELayerId MapLayer(size_t layerMapping, ELayerId layer) const;
+
+private:
+    void Build(CPtr<ILayoutView> layout, size_t layerMapping, Placement placement);
+    size_t GetMaster(CPtr<ILayoutView> layout, size_t layerMapping);
+    size_t GetLayerMapping(size_t parentMapping, CPtr<ILayoutView> parent, CPtr<ICellInst> cellInst);
+
+private:
+    CPtr<ILayoutView> m_top{nullptr};
+    std::vector<Master> m_masters;
+    std::map<std::pair<CPtr<ILayoutView>, size_t>, size_t> m_masterIndices;
+    std::vector<std::unordered_map<ELayerId, ELayerId> > m_layerMappings;//index 0 is the identity of the top layout
+    std::map<std::tuple<size_t, CPtr<ILayerMap>, CPtr<ILayoutView>, CPtr<ILayoutView> >, size_t> m_layerMappingIndices;
+};
+
+}//namespace utils
+}//namespace ecad
@@ -5,35 +5,65 @@
 namespace ecad {
 namespace utils {
 
+namespace detail {
+ECAD_INLINE EVector2D TransformVector(const ETransform2D & transform, EVector2D v)
+{
+    EPoint2D o(0, 0);
+    generic::geometry::Transform(o, transform.GetTransform());
+    generic::geometry::Transform(v, transform.GetTransform());
+    return EVector2D(v[0] - o[0], v[1] - o[1]);
+}
+}//namespace detail
+
 ECAD_INLINE bool ELayoutMergeUtility::Merge(Ptr<ILayoutView> layout, CPtr<ICellInst> cellInst)
 {
     auto other = cellInst->GetFlattenedLayoutView();
     if(layout == other) return false;
 
-    const auto & prefix = cellInst->GetName();
-    const auto & transform = cellInst->GetTransform();
+    UPtr<ILayerMap> defaultLyrMap;
+    if (nullptr == cellInst->GetLayerMap())
+        defaultLyrMap = layout->GetLayerCollection()->GetDefaultLayerMap();
+
+    ELayoutMergeBuffer buffer;
+    Copy(layout, cellInst, defaultLyrMap.get(), buffer);
+    Commit(layout, buffer);
+    return true;
+}
+
+ECAD_INLINE void ELayoutMergeUtility::Copy(Ptr<ILayoutView> layout, CPtr<ICellInst> cellInst, CPtr<ILayerMap> defaultLyrMap, ELayoutMergeBuffer & buffer)
+{
     const auto * layermap = cellInst->GetLayerMap();
+    if (nullptr == layermap) layermap = defaultLyrMap;
 
+    //array placements are copied one by one, each with its index as name suffix
+    auto placements = cellInst->Placements();
+    if (1 == placements)
+        return CopyPlacement(layout, cellInst->GetDefLayoutView(), cellInst->GetName(), cellInst->GetTransform(), layermap, buffer);
+
+    for (size_t i = 0; i < placements; ++i)
+        CopyPlacement(layout, cellInst->GetDefLayoutView(), cellInst->GetName() + "_" + std::to_string(i), cellInst->GetPlacementTransform(i), layermap, buffer);
+}
+
+ECAD_INLINE void ELayoutMergeUtility::CopyPlacement(Ptr<ILayoutView> layout, CPtr<ILayoutView> other, const std::string & prefix, const ETransform2D & transform, CPtr<ILayerMap> layermap, ELayoutMergeBuffer & buffer)
+{
     char sep = EDataMgr::Instance().HierSep();
     auto getName = [sep, &prefix](const std::string & name) { return prefix + sep + name; };
 
     //Net
-    std::unordered_map<ENetId, ENetId> netIdMap;//<other, this>
+    std::unordered_map<ENetId, ENetId> netIdMap;//<other, index in buffer>
     netIdMap.emplace(ENetId::noNet, ENetId::noNet);
     auto netIter = other->GetNetIter();
     while (auto * net = netIter->Next()){
         auto clone = net->Clone();
         clone->SetName(getName(net->GetName()));
-        auto added = layout->GetNetCollection()->AddNet(std::move(clone));
-        netIdMap.emplace(net->GetNetId(), added->GetNetId());
+        netIdMap.emplace(net->GetNetId(), static_cast<ENetId>(buffer.nets.size()));
+        buffer.nets.emplace_back(std::move(clone));
     }
+    auto mapNet = [&netIdMap](ENetId net) {
+        auto iter = netIdMap.find(net);
+        return iter == netIdMap.cend() ? ENetId::noNet : iter->second;
+    };
 
-    UPtr<ILayerMap> defaultLyrMap;
-    if (nullptr == layermap) {
-        defaultLyrMap = layout->GetLayerCollection()->GetDefaultLayerMap();
-        layermap = defaultLyrMap.get();
-    }
-    
     //HierarchyObj/Cellinst
     auto cellInstIter = other->GetCellInstIter();
     while (auto * cellInst = cellInstIter->Next()){
@@ -41,9 +71,16 @@ ECAD_INLINE bool ELayoutMergeUtility::Merge(Ptr<ILayoutView> layout, CPtr<ICellI
         clone->SetName(getName(cellInst->GetName()));
         clone->SetRefLayoutView(layout);
         clone->AddTransform(transform);
-        layout->GetCellInstCollection()->AddCellInst(std::move(clone));
+        if (clone->isArray()) {
+            //pitches are in the coordinates of other, so they follow the rotation, mirror and scale of the transform
+            size_t cols, rows;
+            EVector2D colPitch, rowPitch;
+            clone->GetArray(cols, rows, colPitch, rowPitch);
+            clone->SetArray(cols, rows, detail::TransformVector(transform, colPitch), detail::TransformVector(transform, rowPitch));
+        }
+        buffer.cellInsts.emplace_back(std::move(clone));
     }
-    
+
     //HierarchyObj/Component
     std::unordered_map<CPtr<IComponent>, CPtr<IComponent> > compMap;
     auto compIter = other->GetComponentIter();
@@ -52,7 +89,8 @@ ECAD_INLINE bool ELayoutMergeUtility::Merge(Ptr<ILayoutView> layout, CPtr<ICellI
         clone->SetName(getName(comp->GetName()));
         clone->SetPlacementLayer(layermap->GetMappingForward(clone->GetPlacementLayer()));
         clone->AddTransform(transform);
-        compMap.emplace(comp, layout->GetComponentCollection()->AddComponent(std::move(clone)));
+        compMap.emplace(comp, clone.get());
+        buffer.components.emplace_back(std::move(clone));
     }
 
     //Connobj/Primitive
@@ -60,9 +98,7 @@ ECAD_INLINE bool ELayoutMergeUtility::Merge(Ptr<ILayoutView> layout, CPtr<ICellI
     while(auto * primitive = primIter->Next()){
         auto clone = primitive->Clone();
         //Net
-        if(netIdMap.count(clone->GetNet()))
-            clone->SetNet(netIdMap.at(clone->GetNet()));
-        else clone->SetNet(ENetId::noNet);
+        clone->SetNet(mapNet(clone->GetNet()));
 
         //Layer
         clone->SetLayer(layermap->GetMappingForward(clone->GetLayer()));
@@ -95,8 +131,7 @@ ECAD_INLINE bool ELayoutMergeUtility::Merge(Ptr<ILayoutView> layout, CPtr<ICellI
                 break;
             }
         }
-
-        layout->GetPrimitiveCollection()->AddPrimitive(std::move(clone));
+        buffer.primitives.emplace_back(std::move(clone));
     }
 
     //Connobj/Padstackinst
@@ -104,17 +139,39 @@ ECAD_INLINE bool ELayoutMergeUtility::Merge(Ptr<ILayoutView> layout, CPtr<ICellI
     while(auto * psInst = psInstIter->Next()){
         auto clone = psInst->Clone();
         //Net
-        if(netIdMap.count(clone->GetNet()))
-            clone->SetNet(netIdMap.at(clone->GetNet()));
-        else clone->SetNet(ENetId::noNet);
+        clone->SetNet(mapNet(clone->GetNet()));
 
         //todo, Layermap
 
         //Transform
         clone->AddTransform(transform);
-        layout->GetPadstackInstCollection()->AddPadstackInst(std::move(clone));
+        buffer.psInsts.emplace_back(std::move(clone));
     }
-    return true;
+}
+
+ECAD_INLINE void ELayoutMergeUtility::Commit(Ptr<ILayoutView> layout, ELayoutMergeBuffer & buffer)
+{
+    auto netId = [first = layout->GetNetCollection()->AddNets(std::move(buffer.nets))](ENetId index) {
+        return index == ENetId::noNet ? ENetId::noNet : static_cast<ENetId>(first + index);
+    };
+
+    for (auto & cellInst : buffer.cellInsts)
+        layout->GetCellInstCollection()->AddCellInst(std::move(cellInst));
+
+    for (auto & comp : buffer.components)
+        layout->GetComponentCollection()->AddComponent(std::move(comp));
+
+    auto primitives = layout->GetPrimitiveCollection();
+    for (auto & primitive : buffer.primitives) {
+        primitive->SetNet(netId(primitive->GetNet()));
+        primitives->AddPrimitive(std::move(primitive));
+    }
+
+    for (auto & psInst : buffer.psInsts) {
+        psInst->SetNet(netId(psInst->GetNet()));
+        layout->GetPadstackInstCollection()->AddPadstackInst(std::move(psInst));
+    }
+    buffer = ELayoutMergeBuffer{};
 }
 
 }//namespace utils
@@ -2,14 +2,40 @@
 #include "basic/ECadCommon.h"
 namespace ecad {
 
+class INet;
 class ICellInst;
+class ILayerMap;
+class IComponent;
+class IPrimitive;
 class ILayoutView;
+class IPadstackInst;
 class ETransform2D;
 namespace utils {
+
+///transformed clones of a cell instance's definition, not owned by the parent layout until committed
+struct ECAD_API ELayoutMergeBuffer
+{
+    std::vector<UPtr<INet> > nets;//before commit, the net of a primitive or padstack instance is its index in nets
+    std::vector<UPtr<ICellInst> > cellInsts;
+    std::vector<UPtr<IComponent> > components;
+    std::vector<UPtr<IPrimitive> > primitives;
+    std::vector<UPtr<IPadstackInst> > psInsts;
+};
+
 class ECAD_API ELayoutMergeUtility
 {
 public:
     static bool Merge(Ptr<ILayoutView> layout, CPtr<ICellInst> cellInst);
+
+    ///copies the definition of cellInst into buffer, only reads the definition so it can run concurrently with other copies,
+    ///defaultLyrMap is used if cellInst has no layer map
+    static void Copy(Ptr<ILayoutView> layout, CPtr<ICellInst> cellInst, CPtr<ILayerMap> defaultLyrMap, ELayoutMergeBuffer & buffer);
+
+    ///moves the buffer into layout, the nets get one block of ids
+    static void Commit(Ptr<ILayoutView> layout, ELayoutMergeBuffer & buffer);
+
+private:
+    static void CopyPlacement(Ptr<ILayoutView> layout, CPtr<ILayoutView> other, const std::string & prefix, const ETransform2D & transform, CPtr<ILayerMap> layermap, ELayoutMergeBuffer & buffer);
 };
 
 }//namespace utils
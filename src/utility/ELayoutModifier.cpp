@@ -1,4 +1,6 @@
 #include "ELayoutModifier.h"
+#include "model/thermal/EPrismThermalModel.h"
+#include "interface/IModelCollection.h"
 #include "interface/Interface.h"
 namespace ecad {
 namespace utils {
@@ -10,11 +12,45 @@ ECAD_INLINE bool ELayoutModifier::ModifyStackupLayerThickness(Ptr<ILayoutView> l
     auto stackupLayer = layer->GetStackupLayerFromLayer();
     if (nullptr == stackupLayer) return false;
 
+    auto elevation = stackupLayer->GetElevation();
+    auto prevThickness = stackupLayer->GetThickness();
+    std::vector<Ptr<IStackupLayer> > stackupLayers;
+    layout->GetStackupLayers(stackupLayers);
+    std::vector<EFloat> prevElevations;
+    for (auto lyr : stackupLayers)
+        prevElevations.emplace_back(lyr->GetElevation());
+
     stackupLayer->SetThickness(thickness);
     UpdateLayerStackupElevation(layout);
+
+    //the cached models are updated in place only if the edit shifts all layers below by the same offset
+    bool shifted = true;
+    for (size_t i = 0; i < stackupLayers.size() && shifted; ++i) {
+        auto prev = prevElevations.at(i);
+        auto expected = prev < elevation ? prev - thickness + prevThickness : prev;
+        shifted = generic::math::EQ<EFloat>(expected, stackupLayers.at(i)->GetElevation());
+    }
+    UpdateModels(layout, shifted, elevation, prevThickness, thickness);
     return true;
 }
 
+ECAD_INLINE void ELayoutModifier::UpdateModels(Ptr<ILayoutView> layout, bool shifted, EFloat elevation, EFloat prevThickness, EFloat thickness)
+{
+    auto collection = layout->GetModelCollection();
+    if (nullptr == collection) return;
+
+    //the layer cut and grid models are rebuilt on next extraction, prism models keep their mesh and only move the heights
+    collection->RemoveModel(EModelType::LayerCut);
+    collection->RemoveModel(EModelType::ThermalGrid);
+    for (auto type : {EModelType::ThermalPrism, EModelType::ThermalStackupPrism}) {
+        auto model = dynamic_cast<Ptr<model::EPrismThermalModel> >(collection->GetModel(type));
+        if (nullptr == model) continue;
+        if (shifted && model->UpdateStackupThickness(elevation, prevThickness, thickness))
+            ECAD_TRACE("update %1% model in place", toString(type));
+        else collection->RemoveModel(type);
+    }
+}
+
 ECAD_INLINE void ELayoutModifier::UpdateLayerStackupElevation(Ptr<ILayoutView> layout)
 {
     std::vector<Ptr<IStackupLayer> > stackupLayers;
@@ -15,6 +15,7 @@ public:
 
 private:
     static void UpdateLayerStackupElevation(Ptr<ILayoutView> layout);
+    static void UpdateModels(Ptr<ILayoutView> layout, bool shifted, EFloat elevation, EFloat prevThickness, EFloat thickness);
 };
 
 }//namespace utils
@@ -1,4 +1,5 @@
 #include "ELayoutViewRenderer.h"
+#include "EInstancedLayout.h"
 
 #include "generic/tools/Color.hpp"
 
@@ -49,34 +50,35 @@ ECAD_INLINE bool ELayoutViewRenderer::RendererPNG(CPtr<ILayoutView> layout)
             outs.emplace_back(std::move(h));
     }
 
-    //primitives
-    auto primIter = layout->GetPrimitiveIter();
-    while (auto * prim = primIter->Next()) {
-        if (not m_settings.selectNets.empty()) {
-            auto net = prim->GetNet();
+    //primitives, cell instances are placed lazily
+    EInstancedLayout instances(layout);
+    auto shapeIter = instances.GetShapeIter();
+    while (auto * shape = shapeIter->Next()) {
+        //net ids of the masters are not nets of the top layout, so the net filter applies to top shapes only
+        if (not m_settings.selectNets.empty() && shape->master == instances.GetTopLayoutView()) {
+            auto net = shape->net;
             if (m_settings.selectNets.count(net))
                 continue;
         }
         if (not m_settings.selectLayers.empty()) {
-            auto layer = prim->GetLayer();
+            auto layer = shape->layer;
             if (m_settings.selectLayers.count(layer))
                 continue;
         }
+        auto * prim = shape->primitive;
         if (auto * bw = prim->GetBondwireFromPrimitive(); bw) {
             EPolygonData pd;
-            pd << bw->GetStartPt() << bw->GetEndPt();
+            pd << shape->GetPoint(bw->GetStartPt()) << shape->GetPoint(bw->GetEndPt());
             outs.emplace_back(std::move(pd));
         }
         else if (auto * geom = prim->GetGeometry2DFromPrimitive(); geom) {
-            auto pwh = geom->GetShape()->GetPolygonWithHoles();
+            auto pwh = shape->GetPolygonWithHoles();
             outs.emplace_back(std::move(pwh.outline));
             for (auto hole : pwh.holes)
                 outs.emplace_back(std::move(hole));
         }
     }
 
-    //todo flatten cell inst
-
     auto cellName = layout->GetCell()->GetName();
     auto filename = m_settings.dirName  + ECAD_SEPS + cellName + ".png";
     return GeometryIO::WritePNG(filename.c_str(), outs.begin(), outs.end(), m_settings.width);
@@ -1,10 +1,12 @@
 #include "EMetalFractionMapping.h"
+#include "EInstancedLayout.h"
 
 #include "generic/geometry/Transform.hpp"
 #include "generic/tools/StringHelper.hpp"
 #include "generic/tools/FileSystem.hpp"
 #include "generic/tools/Format.hpp"
 #include "generic/tools/Color.hpp"
+#include "generic/thread/ThreadPool.hpp"
 
 #include "interface/ILayoutView.h"
 #include "interface/IPrimitive.h"
@@ -15,6 +17,15 @@ namespace ecad {
 namespace utils {
 using namespace generic::geometry;
 
+namespace detail {
+using FPoint = std::array<FCoord, 2>;
+using FPoints = std::vector<FPoint>;
+///Sutherland-Hodgman clip by the half plane p[axis] >= bound if lower, p[axis] <= bound otherwise,
+///the area of the result is exact for any simple polygon since the clip region is convex
+void ClipHalfPlane(const FPoints & in, FPoints & out, size_t axis, FCoord bound, bool lower);
+FCoord Area(const FPoints & points);
+}//namespace detail
+
 ECAD_INLINE ELayerMetalFractionMapper::ELayerMetalFractionMapper(const Setting & settings, ELayerMetalFraction & fraction, ELayerId layerId)
  : m_layerId(layerId)
  , m_settings(settings)
@@ -26,58 +37,109 @@ ECAD_INLINE ELayerMetalFractionMapper::~ELayerMetalFractionMapper()
 {
 }
 
-ECAD_INLINE void ELayerMetalFractionMapper::GenerateMetalFractionMapping(CPtr<ILayoutView> layout, const MapCtrl & ctrl)
+ECAD_INLINE void ELayerMetalFractionMapper::GenerateMetalFractionMapping(CPtr<ILayoutView> layout, const EBox2D & region, const std::array<ECoord, 2> & stride)
+{
+    auto polygons = CollectLayerPolygons(layout, m_settings.selectNets);
+    auto iter = polygons.find(m_layerId);
+    if (iter == polygons.end()) GenerateMetalFractionMapping(ELayerPolygons{}, region, stride);
+    else GenerateMetalFractionMapping(std::move(iter->second), region, stride);
+}
+
+ECAD_INLINE void ELayerMetalFractionMapper::GenerateMetalFractionMapping(ELayerPolygons polygons, const EBox2D & region, const std::array<ECoord, 2> & stride)
+{
+    m_solids = std::move(polygons.solids);
+    m_holes = std::move(polygons.holes);
+    Mapping(region, stride);
+}
+
+ECAD_INLINE std::unordered_map<ELayerId, ELayerPolygons> ELayerMetalFractionMapper::CollectLayerPolygons(CPtr<ILayoutView> layout, const ENetIdSet & selectNets)
+{
+    //cell instances are flattened on the fly, so a hierarchical layout is mapped without a flattened copy
+    return CollectLayerPolygons(EInstancedLayout(layout), selectNets);
+}
+
+ECAD_INLINE std::unordered_map<ELayerId, ELayerPolygons> ELayerMetalFractionMapper::CollectLayerPolygons(const EInstancedLayout & layout, const ENetIdSet & selectNets)
 {
-    m_solids.clear();
-    m_holes.clear();
-
-    bool bSelNet = m_settings.selectNets.size() > 0;
-    const auto & selNets = m_settings.selectNets;
-    auto primIter = layout->GetPrimitiveIter();
-    while(auto primitive = primIter->Next()){
-        auto layer = primitive->GetLayer();
+    std::unordered_map<ELayerId, ELayerPolygons> polygons;
+    bool bSelNet = selectNets.size() > 0;
+    auto shapeIter = layout.GetShapeIter();
+    while(auto shape = shapeIter->Next()){
+        auto layer = shape->layer;
         if(noLayer == layer) continue;
-        if(m_layerId != layer) continue;
 
-        auto netId = primitive->GetNet();
-        if(bSelNet && !selNets.count(netId)) continue;
+        //selected nets are nets of the top layout
+        if(bSelNet && (shape->master != layout.GetTopLayoutView() || !selectNets.count(shape->net))) continue;
 
-        auto geom = primitive->GetGeometry2DFromPrimitive();
-        if(nullptr == geom) continue;
-        auto shape = geom->GetShape();
-        if(nullptr == shape) continue;
+        auto geom = shape->primitive->GetGeometry2DFromPrimitive();
+        if(nullptr == geom || nullptr == geom->GetShape()) continue;
 
-        if(shape->hasHole()){
-            auto pwh = shape->GetPolygonWithHoles();
-            m_solids.emplace_back(std::move(pwh.outline));
-            for(auto & hole : pwh.holes)
-                m_holes.emplace_back(std::move(hole));
-        }
-        else {
-            auto polygon = shape->GetContour();
-            m_solids.emplace_back(std::move(polygon));
-        }
+        auto & layerPolygons = polygons[layer];
+        auto pwh = shape->GetPolygonWithHoles();
+        layerPolygons.solids.emplace_back(std::move(pwh.outline));
+        for(auto & hole : pwh.holes)
+            layerPolygons.holes.emplace_back(std::move(hole));
     }
-    Mapping(ctrl);
+    return polygons;
 }
 
-ECAD_INLINE void ELayerMetalFractionMapper::Mapping(const MapCtrl & ctrl)
+ECAD_INLINE void ELayerMetalFractionMapper::Mapping(const EBox2D & region, const std::array<ECoord, 2> & stride)
 {
-    auto solidBlend = [](typename ELayerMetalFraction::ResultType & res, const Product & p) { res += p.ratio; };
-    auto holeBlend =  [](typename ELayerMetalFraction::ResultType & res, const Product & p) { res -= p.ratio; };
-
-    std::vector<CPtr<IntPolygon> > solids(m_solids.size());
-    std::vector<CPtr<IntPolygon> > holes(m_holes.size());
-    for(size_t i = 0; i < m_solids.size(); ++i) solids[i] = &m_solids[i];
-    for(size_t i = 0; i < m_holes.size(); ++i) holes[i] = &m_holes[i];
-    std::vector<Property> solidProps(m_solids.size(), nullptr);//property not used now
-    std::vector<Property> holePorps(m_holes.size(), nullptr);//property not used now
-    Factory::Map2Grid<Property>(solidProps, solids, ctrl, m_fraction, solidBlend);
-    Factory::Map2Grid<Property>(holePorps, holes, ctrl, m_fraction, holeBlend);
-
+    //tile columns are split into blocks, every block is written by one thread only
     auto width = m_fraction.Width();
-    auto height = m_fraction.Height();
-    for (size_t i = 0; i < width; ++i) {
+    auto blocks = std::max<size_t>(1, std::min<size_t>(m_settings.threads, width));
+    if (blocks > 1) {
+        generic::thread::ThreadPool pool(blocks);
+        for (size_t i = 0; i < blocks; ++i)
+            pool.Submit(std::bind(&ELayerMetalFractionMapper::MappingColumns, this, i * width / blocks, (i + 1) * width / blocks, std::cref(region), std::cref(stride)));
+    }
+    else MappingColumns(0, width, region, stride);
+}
+
+ECAD_INLINE void ELayerMetalFractionMapper::MappingColumns(size_t begin, size_t end, const EBox2D & region, const std::array<ECoord, 2> & stride)
+{
+    using namespace detail;
+    const auto height = m_fraction.Height();
+    const auto & ref = region[0];
+    const FCoord tileArea = FCoord(stride[0]) * stride[1];
+    const ECoord xMin = ref[0] + stride[0] * ECoord(begin);
+    const ECoord xMax = ref[0] + stride[0] * ECoord(end);
+
+    FPoints points, strip, temp, tile;
+    auto mapping = [&](const IntPolygon & polygon, FCoord sign) {
+        if (polygon.Size() < 3) return;
+        auto bbox = Extent(polygon);
+        if (bbox[1][0] <= xMin || bbox[0][0] >= xMax) return;
+        auto index = [&](ECoord c, size_t axis, size_t lower, size_t upper, bool ceil) {
+            auto d = FCoord(c - ref[axis]) / stride[axis];
+            auto i = ceil ? std::ceil(d) : std::floor(d);
+            return std::clamp<ECoord>(ECoord(i), lower, upper);
+        };
+        size_t c0 = index(bbox[0][0], 0, begin, end, false), c1 = index(bbox[1][0], 0, begin, end, true);
+        size_t r0 = index(bbox[0][1], 1, 0, height, false), r1 = index(bbox[1][1], 1, 0, height, true);
+        if (c0 >= c1 || r0 >= r1) return;
+
+        //local coordinates of the region keep the clipping accurate on large layouts
+        points.resize(polygon.Size());
+        for (size_t i = 0; i < polygon.Size(); ++i)
+            points[i] = {FCoord(polygon[i][0] - ref[0]), FCoord(polygon[i][1] - ref[1])};
+
+        for (size_t c = c0; c < c1; ++c) {
+            ClipHalfPlane(points, temp, 0, FCoord(stride[0]) * c, true);
+            ClipHalfPlane(temp, strip, 0, FCoord(stride[0]) * (c + 1), false);
+            if (strip.size() < 3) continue;
+            for (size_t r = r0; r < r1; ++r) {
+                ClipHalfPlane(strip, temp, 1, FCoord(stride[1]) * r, true);
+                ClipHalfPlane(temp, tile, 1, FCoord(stride[1]) * (r + 1), false);
+                if (tile.size() < 3) continue;
+                m_fraction(c, r) += sign * Area(tile) / tileArea;
+            }
+        }
+    };
+
+    for (const auto & solid : m_solids) mapping(solid, 1);
+    for (const auto & hole : m_holes) mapping(hole, -1);
+
+    for (size_t i = begin; i < end; ++i) {
         for (size_t j = 0; j < height; ++j) {
             auto & res = m_fraction(i, j);
             if(res < 0.0f) res = 0.0f;
@@ -86,6 +148,40 @@ ECAD_INLINE void ELayerMetalFractionMapper::Mapping(const MapCtrl & ctrl)
     }
 }
 
+namespace detail {
+
+ECAD_INLINE void ClipHalfPlane(const FPoints & in, FPoints & out, size_t axis, FCoord bound, bool lower)
+{
+    out.clear();
+    if (in.empty()) return;
+    auto inside = [axis, bound, lower](const FPoint & p) { return lower ? p[axis] >= bound : p[axis] <= bound; };
+    auto prev = in.back();
+    bool prevIn = inside(prev);
+    for (const auto & curr : in) {
+        bool currIn = inside(curr);
+        if (currIn != prevIn) {
+            FPoint p;
+            auto t = (bound - prev[axis]) / (curr[axis] - prev[axis]);
+            p[axis] = bound;
+            p[1 - axis] = prev[1 - axis] + t * (curr[1 - axis] - prev[1 - axis]);
+            out.emplace_back(p);
+        }
+        if (currIn) out.emplace_back(curr);
+        prev = curr;
+        prevIn = currIn;
+    }
+}
+
+ECAD_INLINE FCoord Area(const FPoints & points)
+{
+    FCoord area{0};
+    for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++)
+        area += points[j][0] * points[i][1] - points[i][0] * points[j][1];
+    return std::abs(area) / 2;
+}
+
+}//namespace detail
+
 ECAD_INLINE ELayoutMetalFractionMapper::ELayoutMetalFractionMapper(EMetalFractionMappingSettings settings)
  : m_settings(settings)
 {
@@ -129,8 +225,8 @@ ECAD_INLINE bool ELayoutMetalFractionMapper::GenerateMetalFractionMapping(Ptr<IL
 
 
     m_result.reset(new ELayoutMetalFraction);
-    MapCtrl ctrl(bbox, {m_mfInfo->stride[0], m_mfInfo->stride[1]}, m_settings.threads);
-    
+    auto layerPolygons = ELayerMetalFractionMapper::CollectLayerPolygons(layout, m_settings.selectNets);
+
     auto layerIter = layout->GetLayerIter();
     //stackuplayer
     while(auto * layer = layerIter->Next()){
@@ -139,7 +235,9 @@ ECAD_INLINE bool ELayoutMetalFractionMapper::GenerateMetalFractionMapping(Ptr<IL
         bool isMetal = layer->GetLayerType() == ELayerType::ConductingLayer;
         auto layerFraction = std::make_shared<ELayerMetalFraction>(m_mfInfo->grid[0], m_mfInfo->grid[1], 0.0);
         ELayerMetalFractionMapper mapper(m_settings, *layerFraction, layer->GetLayerId());
-        mapper.GenerateMetalFractionMapping(layout, ctrl);
+        auto iter = layerPolygons.find(layer->GetLayerId());
+        if (iter != layerPolygons.end())
+            mapper.GenerateMetalFractionMapping(std::move(iter->second), bbox, m_mfInfo->stride);
         m_result->push_back(layerFraction);
 
         EStackupLayerInfo lyrInfo{ isMetal, stackupLayer->GetElevation(), stackupLayer->GetThickness(), layer->GetName() };
@@ -2,33 +2,48 @@
 #include "basic/ECadSettings.h"
 #include "generic/geometry/OccupancyGridMap.hpp"
 #include "generic/tools/FileSystem.hpp"
+#include <unordered_map>
 #include <vector>
 namespace ecad {
 
 class ILayoutView;
 namespace utils {
 
+class EInstancedLayout;
+
 using namespace generic::geometry;
 
 using IntPolygon = Polygon2D<ECoord>;
 using ELayerMetalFraction = OccupancyGridMap<EFloat>;
 using ELayoutMetalFraction = std::vector<SPtr<ELayerMetalFraction> >;
-using ELayoutMetalFractionMapCtrl = typename OccupancyGridMappingFactory::GridCtrl<ECoord>;
+
+///shapes of one layer, holes are subtracted from the solids
+struct ELayerPolygons
+{
+    std::vector<IntPolygon> solids;
+    std::vector<IntPolygon> holes;
+};
+
 class ECAD_API ELayerMetalFractionMapper
 {
 public:
-    using Property = void*;//not used now
-    using Factory = OccupancyGridMappingFactory;
-    using MapCtrl = ELayoutMetalFractionMapCtrl;
-    using Product = typename Factory::Product<Property>;
     using Setting = EMetalFractionMappingSettings;
     explicit ELayerMetalFractionMapper(const Setting & settings, ELayerMetalFraction & fraction, ELayerId layerId);
     virtual ~ELayerMetalFractionMapper();
 
-    void GenerateMetalFractionMapping(CPtr<ILayoutView> layout, const MapCtrl & ctrl);
+    ///maps the primitives of this layer, tile (i, j) covers region[0] + stride * [(i, j), (i + 1, j + 1)]
+    void GenerateMetalFractionMapping(CPtr<ILayoutView> layout, const EBox2D & region, const std::array<ECoord, 2> & stride);
+    ///maps shapes collected beforehand, see CollectLayerPolygons
+    void GenerateMetalFractionMapping(ELayerPolygons polygons, const EBox2D & region, const std::array<ECoord, 2> & stride);
+
+    ///buckets the shapes of all primitives by layer in one pass
+    static std::unordered_map<ELayerId, ELayerPolygons> CollectLayerPolygons(CPtr<ILayoutView> layout, const ENetIdSet & selectNets);
+    ///same as above with the cell instances placed lazily, selectNets only match the primitives of the top layout
+    static std::unordered_map<ELayerId, ELayerPolygons> CollectLayerPolygons(const EInstancedLayout & layout, const ENetIdSet & selectNets);
 
 private:
-    void Mapping(const MapCtrl & ctrl);
+    void Mapping(const EBox2D & region, const std::array<ECoord, 2> & stride);
+    void MappingColumns(size_t begin, size_t end, const EBox2D & region, const std::array<ECoord, 2> & stride);
 
 private:
     ELayerId m_layerId;
@@ -67,7 +82,6 @@ struct EMetalFractionInfo
 
 class ECAD_API ELayoutMetalFractionMapper
 {
-    using MapCtrl = ELayoutMetalFractionMapCtrl;
 public:
     explicit ELayoutMetalFractionMapper(EMetalFractionMappingSettings settings);
     virtual ~ELayoutMetalFractionMapper();
@@ -0,0 +1,499 @@
+#include "EModelCache.h"
+#include "model/thermal/EStackupPrismThermalModel.h"
+#include "model/thermal/EPrismThermalModel.h"
+#include "model/geometry/ELayerCutModel.h"
+#include "model/geometry/io/ELayerCutModelIO.h"
+#include "model/thermal/io/EPrismThermalModelIO.h"
+#include "model/io/EModelBinaryFormat.h"
+#include "interface/Interface.h"
+#include "basic/ELookupTable.h"
+#include "basic/EShape.h"
+
+#include "generic/geometry/Transform.hpp"
+#include "generic/tools/FileSystem.hpp"
+#include <unordered_map>
+#include <filesystem>
+#include <algorithm>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <tuple>
+namespace ecad {
+namespace utils {
+
+namespace detail {
+///FNV-1a over the content, independent of the object uuids and the memory layout
+class EContentHasher
+{
+public:
+    template <typename T, typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value, bool>::type = true>
+    void Add(T value) { AddBytes(&value, sizeof(T)); }
+
+    void Add(std::string_view str)
+    {
+        Add(str.size());
+        AddBytes(str.data(), str.size());
+    }
+
+    void Add(const EPoint2D & point)
+    {
+        Add(point[0]); Add(point[1]);
+    }
+
+    void Add(const EPolygonData & polygon)
+    {
+        const auto & points = polygon.GetPoints();
+        Add(points.size());
+        for (const auto & point : points) Add(point);
+    }
+
+    void Add(const EPolygonWithHolesData & pwh)
+    {
+        Add(pwh.outline);
+        Add(pwh.holes.size());
+        for (const auto & hole : pwh.holes) Add(hole);
+    }
+
+    void Add(CPtr<EShape> shape)
+    {
+        Add(nullptr != shape);
+        if (shape) Add(shape->GetPolygonWithHoles());
+    }
+
+#ifdef ECAD_BOOST_SERIALIZATION_SUPPORT
+    template <typename T>
+    void AddArchive(const T & t)
+    {
+        std::ostringstream oss;
+        {
+            boost::archive::text_oarchive oa(oss, boost::archive::no_header);
+            oa & boost::serialization::make_nvp("t", t);
+        }
+        Add(oss.str());
+    }
+#endif//ECAD_BOOST_SERIALIZATION_SUPPORT
+
+    void AddBytes(const void * data, size_t size)
+    {
+        auto bytes = reinterpret_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            m_value ^= bytes[i];
+            m_value *= 1099511628211ull;
+        }
+    }
+
+    uint64_t Value() const { return m_value; }
+
+private:
+    uint64_t m_value{14695981039346656037ull};
+};
+
+ECAD_INLINE std::string toHex(uint64_t value)
+{
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << value;
+    return oss.str();
+}
+
+ECAD_INLINE void AddMaterials(EContentHasher & hasher, CPtr<IDatabase> database)
+{
+    static const std::vector<EMaterialPropId> props {
+        EMaterialPropId::Permittivity, EMaterialPropId::Permeability, EMaterialPropId::Conductivity,
+        EMaterialPropId::DielectricLossTangent, EMaterialPropId::MagneticLossTangent, EMaterialPropId::Resistivity,
+        EMaterialPropId::ThermalConductivity, EMaterialPropId::MassDensity, EMaterialPropId::SpecificHeat,
+        EMaterialPropId::YoungsModulus, EMaterialPropId::PoissonsRatio, EMaterialPropId::ThermalExpansionCoefficient };
+    if (nullptr == database) return;
+    auto iter = database->GetMaterialDefIter();
+    while (auto * material = iter->Next()) {
+        hasher.Add(material->GetName());
+        hasher.Add(material->GetMaterialId());
+        hasher.Add(material->GetMaterialType());
+        for (auto id : props) {
+            if (not material->hasProperty(id)) continue;
+            hasher.Add(id);
+#ifdef ECAD_BOOST_SERIALIZATION_SUPPORT
+            auto prop = const_cast<Ptr<IMaterialProp>>(material->GetProperty(id));
+            hasher.AddArchive(prop);
+#endif//ECAD_BOOST_SERIALIZATION_SUPPORT
+        }
+    }
+}
+
+ECAD_INLINE void AddBondwire(EContentHasher & hasher, CPtr<IBondwire> bw)
+{
+    hasher.Add(bw->GetName());
+    hasher.Add(bw->GetStartPt());
+    hasher.Add(bw->GetEndPt());
+    hasher.Add(bw->GetStartLayer());
+    hasher.Add(bw->GetEndLayer());
+    hasher.Add(bw->GetRadius());
+    hasher.Add(bw->GetHeight());
+    hasher.Add(bw->GetMaterial());
+    hasher.Add(bw->GetCurrent());
+    hasher.Add(bw->GetBondwireType());
+    hasher.Add(bw->GetDynamicPowerScenario());
+    hasher.Add(bw->GetStartComponentPin());
+    hasher.Add(bw->GetEndComponentPin());
+    hasher.Add(bw->GetStartComponent() ? bw->GetStartComponent()->GetName() : std::string{});
+    hasher.Add(bw->GetEndComponent() ? bw->GetEndComponent()->GetName() : std::string{});
+    hasher.Add(bw->GetSolderJoints() ? bw->GetSolderJoints()->GetName() : std::string{});
+}
+
+ECAD_INLINE void AddPadstackDef(EContentHasher & hasher, CPtr<IPadstackDef> def)
+{
+    hasher.Add(def->GetName());
+    auto data = def->GetPadstackDefData();
+    if (nullptr == data) return;
+    hasher.Add(data->GetMaterial());
+    EFloat thickness{0};
+    CPtr<EShape> shape{nullptr};
+    if (data->hasTopSolderBump() && data->GetTopSolderBumpParameters(shape, thickness)) {
+        hasher.Add(shape);
+        hasher.Add(thickness);
+        hasher.Add(data->GetTopSolderBumpMaterial());
+    }
+    if (data->hasBotSolderBall() && data->GetBotSolderBallParameters(shape, thickness)) {
+        hasher.Add(shape);
+        hasher.Add(thickness);
+        hasher.Add(data->GetBotSolderBallMaterial());
+    }
+}
+
+ECAD_INLINE void AddComponent(EContentHasher & hasher, CPtr<IComponent> component)
+{
+    hasher.Add(component->GetName());
+    hasher.Add(component->GetPlacementLayer());
+    hasher.Add(component->GetBoundary().get());
+    hasher.Add(component->isFlipped());
+    hasher.Add(component->GetHeight());
+    hasher.Add(component->GetDynamicPowerScenario());
+    hasher.Add(component->hasLossPower());
+#ifdef ECAD_BOOST_SERIALIZATION_SUPPORT
+    if (component->hasLossPower()) hasher.AddArchive(component->GetLossPowerTable());
+#endif//ECAD_BOOST_SERIALIZATION_SUPPORT
+    auto def = component->GetComponentDef();
+    if (nullptr == def) return;
+    hasher.Add(def->GetName());
+    hasher.Add(def->GetMaterial());
+    hasher.Add(def->GetHeight());
+    hasher.Add(def->GetSolderBallBumpHeight());
+    hasher.Add(def->GetSolderFillingMaterial());
+}
+
+///the placement is hashed by its action on a few reference points, so equal transforms hash equally however they are composed
+ECAD_INLINE void AddTransform(EContentHasher & hasher, const ETransform2D & transform)
+{
+    constexpr ECoord lever = 1 << 20;
+    for (auto point : {EPoint2D(0, 0), EPoint2D(lever, 0), EPoint2D(0, lever)}) {
+        generic::geometry::Transform(point, transform.GetTransform());
+        hasher.Add(point);
+    }
+}
+
+///content of the layout and of the definitions it places, the hash of each definition is computed once
+ECAD_INLINE uint64_t LayoutContentHash(CPtr<ILayoutView> layout, std::unordered_map<CPtr<ILayoutView>, uint64_t> & hashes)
+{
+    if (auto iter = hashes.find(layout); iter != hashes.cend()) return iter->second;
+    hashes.emplace(layout, 0);//breaks cyclic placements
+
+    EContentHasher hasher;
+    hasher.Add(layout->GetBoundary());
+
+    std::vector<CPtr<IStackupLayer> > stackupLayers;
+    layout->GetStackupLayers(stackupLayers);
+    hasher.Add(stackupLayers.size());
+    for (auto layer : stackupLayers) {
+        hasher.Add(layer->GetName());
+        hasher.Add(layer->GetLayerId());
+        hasher.Add(layer->GetLayerType());
+        hasher.Add(layer->GetElevation());
+        hasher.Add(layer->GetThickness());
+        hasher.Add(layer->GetConductingMaterial());
+        hasher.Add(layer->GetDielectricMaterial());
+    }
+
+    auto primitiveIter = layout->GetPrimitiveIter();
+    while (auto * primitive = primitiveIter->Next()) {
+        hasher.Add(primitive->GetPrimitiveType());
+        hasher.Add(primitive->GetLayer());
+        hasher.Add(primitive->GetNet());
+        if (auto geom = primitive->GetGeometry2DFromPrimitive(); geom)
+            hasher.Add(geom->GetShape());
+        else if (auto bw = primitive->GetBondwireFromPrimitive(); bw)
+            AddBondwire(hasher, bw);
+    }
+
+    auto psInstIter = layout->GetPadstackInstIter();
+    while (auto * psInst = psInstIter->Next()) {
+        ELayerId top, bot;
+        psInst->GetLayerRange(top, bot);
+        hasher.Add(psInst->GetNet());
+        hasher.Add(top);
+        hasher.Add(bot);
+        if (auto def = psInst->GetPadstackDef(); def)
+            AddPadstackDef(hasher, def);
+        for (auto layer : stackupLayers)
+            hasher.Add(psInst->GetLayerShape(layer->GetLayerId()).get());
+    }
+
+    auto compIter = layout->GetComponentIter();
+    while (auto * component = compIter->Next())
+        AddComponent(hasher, component);
+
+    auto cellInstIter = layout->GetCellInstIter();
+    while (auto * cellInst = cellInstIter->Next()) {
+        auto defLayout = cellInst->GetDefLayoutView();
+        hasher.Add(cellInst->GetName());
+        hasher.Add(nullptr != defLayout);
+        if (nullptr == defLayout) continue;
+        hasher.Add(LayoutContentHash(defLayout, hashes));
+        AddTransform(hasher, cellInst->GetTransform());
+
+        size_t cols, rows;
+        EVector2D colPitch, rowPitch;
+        cellInst->GetArray(cols, rows, colPitch, rowPitch);
+        hasher.Add(cols);
+        hasher.Add(rows);
+        hasher.Add(colPitch);
+        hasher.Add(rowPitch);
+
+        //without layer map the definition layers are mapped by name, which the stackup hashes already cover
+        auto layerMap = cellInst->GetLayerMap();
+        hasher.Add(nullptr != layerMap);
+        if (nullptr == layerMap) continue;
+        std::vector<CPtr<IStackupLayer> > defLayers;
+        defLayout->GetStackupLayers(defLayers);
+        for (auto layer : defLayers)
+            hasher.Add(layerMap->GetMappingForward(layer->GetLayerId()));
+    }
+    return hashes[layout] = hasher.Value();
+}
+
+ECAD_INLINE void Normalize(EThermalModelExtractionSettings & settings)
+{
+    settings.forceRebuild = false;
+    settings.threads = 1;
+    settings.workDir.clear();
+}
+
+ECAD_INLINE void Normalize(ELayoutPolygonMergeSettings & settings)
+{
+    settings.threads = 1;
+    settings.outFile.clear();
+}
+
+ECAD_INLINE void Normalize(EMetalFractionMappingSettings & settings)
+{
+    settings.threads = 1;
+    settings.outFile.clear();
+    Normalize(settings.polygonMergeSettings);
+}
+}//namespace detail
+
+ECAD_INLINE EModelCache::EModelCache(std::string dir, size_t limit)
+ : m_dir(std::move(dir)), m_limit(limit)
+{
+}
+
+ECAD_INLINE std::string EModelCache::Key(CPtr<ILayoutView> layout, const ECadSettings & settings, const std::string & tag) const
+{
+    detail::EContentHasher hasher;
+    hasher.Add(tag);
+    return detail::toHex(LayoutHash(layout)) + detail::toHex(SettingsHash(settings)) + detail::toHex(hasher.Value());
+}
+
+ECAD_INLINE std::string EModelCache::Path(const std::string & key, const std::string & ext) const
+{
+    return m_dir + ECAD_SEPS + key + "." + ext;
+}
+
+ECAD_INLINE UPtr<IModel> EModelCache::Load(const std::string & key, CPtr<ILayoutView> layout) const
+{
+#ifdef ECAD_BOOST_SERIALIZATION_SUPPORT
+    if (not isEnabled()) return nullptr;
+    if (auto filename = Path(key, "ecm"); generic::fs::FileExists(filename)) {
+        std::string err;
+        UPtr<IModel> model{nullptr};
+        auto type = model::io::EModelBinaryReader(filename).GetModelType();
+        if (type == EModelType::LayerCut)
+            model = model::io::ELayerCutModelBinaryIO::Read(filename, &err);
+        else model = model::io::EPrismThermalModelBinaryIO::Read(filename, layout, &err);
+        if (nullptr == model) {
+            ECAD_TRACE("failed to load cached model %1%: %2%", filename, err);
+            return nullptr;
+        }
+        Touch(filename);
+        ECAD_TRACE("load cached %1% model from %2%", toString(model->GetModelType()), filename);
+        return model;
+    }
+
+    auto filename = Path(key, "mdl");
+    if (not generic::fs::FileExists(filename)) return nullptr;
+
+    std::ifstream ifs(filename, std::ios::binary);
+    if (not ifs.is_open()) return nullptr;
+
+    Ptr<IModel> model{nullptr};
+    try {
+        unsigned int version{0};
+        boost::archive::binary_iarchive ia(ifs);
+        ia & boost::serialization::make_nvp("version", version);
+        if (version != toInt(CURRENT_VERSION)) return nullptr;
+        ia & boost::serialization::make_nvp("model", model);
+    }
+    catch (const std::exception & e) {
+        ECAD_TRACE("failed to load cached model %1%: %2%", filename, e.what());
+        return nullptr;
+    }
+    if (nullptr == model) return nullptr;
+    if (auto prism = dynamic_cast<Ptr<model::EPrismThermalModel>>(model); prism)
+        prism->SetLayoutView(layout);
+    Touch(filename);
+    ECAD_TRACE("load cached %1% model from %2%", toString(model->GetModelType()), filename);
+    return UPtr<IModel>(model);
+#else
+    ECAD_UNUSED(key)
+    ECAD_UNUSED(layout)
+    return nullptr;
+#endif//ECAD_BOOST_SERIALIZATION_SUPPORT
+}
+
+ECAD_INLINE bool EModelCache::Save(const std::string & key, CPtr<IModel> model) const
+{
+#ifdef ECAD_BOOST_SERIALIZATION_SUPPORT
+    if (not isEnabled() || nullptr == model) return false;
+    if (model->GetModelType() == EModelType::ThermalGrid) return false;//not serializable
+    if (not generic::fs::CreateDir(m_dir)) return false;
+
+    //the prism and layer cut models use the native container, which loads much faster than the archive
+    if (auto type = model->GetModelType(); type == EModelType::ThermalPrism ||
+        type == EModelType::ThermalStackupPrism || type == EModelType::LayerCut) {
+        std::string err;
+        auto filename = Path(key, "ecm");
+        auto tmpFile = filename + ".tmp";
+        bool res{false};
+        if (type == EModelType::LayerCut)
+            res = model::io::ELayerCutModelBinaryIO::Write(tmpFile, dynamic_cast<const model::ELayerCutModel &>(*model), &err);
+        else res = model::io::EPrismThermalModelBinaryIO::Write(tmpFile, dynamic_cast<const model::EPrismThermalModel &>(*model), &err);
+        if (not res) {
+            ECAD_TRACE("failed to save model to cache %1%: %2%", filename, err);
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmpFile, filename, ec);
+        if (ec) return false;
+        ECAD_TRACE("save %1% model to cache %2%", toString(type), filename);
+        Evict();
+        return true;
+    }
+
+    //the layout is owned by the database and bound again when loading
+    auto prism = dynamic_cast<Ptr<model::EPrismThermalModel>>(const_cast<Ptr<IModel>>(model));
+    auto layout = prism ? prism->GetLayoutView() : nullptr;
+    if (prism) prism->SetLayoutView(nullptr);
+
+    //write to a temporary file first so that a concurrent reader never sees a partial model
+    auto filename = Path(key, "mdl");
+    auto tmpFile = filename + ".tmp";
+    bool res{false};
+    if (std::ofstream ofs(tmpFile, std::ios::binary); ofs.is_open()) {
+        unsigned int version = toInt(CURRENT_VERSION);
+        boost::archive::binary_oarchive oa(ofs);
+        oa & boost::serialization::make_nvp("version", version);
+        oa & boost::serialization::make_nvp("model", model);
+        res = true;
+    }
+    if (prism) prism->SetLayoutView(layout);
+    if (not res) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(tmpFile, filename, ec);
+    if (ec) return false;
+    ECAD_TRACE("save %1% model to cache %2%", toString(model->GetModelType()), filename);
+    Evict();
+    return true;
+#else
+    ECAD_UNUSED(key)
+    ECAD_UNUSED(model)
+    return false;
+#endif//ECAD_BOOST_SERIALIZATION_SUPPORT
+}
+
+ECAD_INLINE void EModelCache::Touch(const std::string & filename) const
+{
+    std::error_code ec;
+    std::filesystem::last_write_time(filename, std::filesystem::file_time_type::clock::now(), ec);
+}
+
+ECAD_INLINE void EModelCache::Evict() const
+{
+    if (not isEnabled() || 0 == m_limit) return;
+    using Entry = std::tuple<std::filesystem::file_time_type, std::filesystem::path, size_t>;
+    std::error_code ec;
+    size_t total{0};
+    std::vector<Entry> entries;
+    for (const auto & entry : std::filesystem::directory_iterator(m_dir, ec)) {
+        if (not entry.is_regular_file(ec)) continue;
+        auto size = entry.file_size(ec);
+        if (ec) continue;
+        total += size;
+        entries.emplace_back(entry.last_write_time(ec), entry.path(), size);
+    }
+    if (total <= m_limit) return;
+
+    std::sort(entries.begin(), entries.end());
+    for (const auto & [time, path, size] : entries) {
+        if (total <= m_limit) break;
+        if (not std::filesystem::remove(path, ec)) continue;
+        total -= size;
+        ECAD_TRACE("evict cached file %1%", path.string());
+    }
+}
+
+ECAD_INLINE uint64_t EModelCache::LayoutHash(CPtr<ILayoutView> layout)
+{
+    detail::EContentHasher hasher;
+    if (nullptr == layout) return hasher.Value();
+
+    const auto & coordUnits = layout->GetCoordUnits();
+    hasher.Add(coordUnits.Scale2Unit());
+    hasher.Add(coordUnits.toUnit(ECoord(1), ECoordUnits::Unit::Meter));
+    detail::AddMaterials(hasher, layout->GetDatabase());
+
+    std::unordered_map<CPtr<ILayoutView>, uint64_t> hashes;
+    hasher.Add(detail::LayoutContentHash(layout, hashes));
+    return hasher.Value();
+}
+
+ECAD_INLINE uint64_t EModelCache::SettingsHash(const ECadSettings & settings)
+{
+    detail::EContentHasher hasher;
+#ifdef ECAD_BOOST_SERIALIZATION_SUPPORT
+    if (auto lcm = dynamic_cast<CPtr<ELayerCutModelExtractionSettings>>(&settings); lcm) {
+        auto copy = *lcm;
+        copy.dumpSketchImg = false;
+        hasher.AddArchive(copy);
+    }
+    else if (auto prism = dynamic_cast<CPtr<EPrismThermalModelExtractionSettings>>(&settings); prism) {
+        auto copy = *prism;
+        detail::Normalize(copy);
+        detail::Normalize(copy.polygonMergeSettings);
+        copy.meshSettings.dumpMeshFile = false;
+        copy.layerCutSettings.dumpSketchImg = false;
+        hasher.AddArchive(copy);
+    }
+    else if (auto grid = dynamic_cast<CPtr<EGridThermalModelExtractionSettings>>(&settings); grid) {
+        auto copy = *grid;
+        detail::Normalize(copy);
+        detail::Normalize(copy.metalFractionMappingSettings);
+        hasher.AddArchive(copy);
+    }
+#else
+    ECAD_UNUSED(settings)
+#endif//ECAD_BOOST_SERIALIZATION_SUPPORT
+    return hasher.Value();
+}
+
+}//namespace utils
+}//namespace ecad
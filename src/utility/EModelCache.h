@@ -0,0 +1,43 @@
+#pragma once
+#include "basic/ECadCommon.h"
+namespace ecad {
+
+class IModel;
+class ILayoutView;
+struct ECadSettings;
+namespace utils {
+
+/**
+ * @brief on-disk cache of extracted models and reduced-order models, content-addressed by a hash of the layout geometry,
+ *        the stackup, the materials and the extraction settings, the object uuids, thread counts and work dirs are not part of the key,
+ *        the total size of the cache dir is kept under the limit by evicting the least recently used files
+ */
+class ECAD_API EModelCache
+{
+public:
+    explicit EModelCache(std::string dir, size_t limit);
+
+    bool isEnabled() const { return not m_dir.empty(); }
+
+    ///tag distinguishes artifacts that share the layout and settings, e.g. the model type or the reduction parameters
+    std::string Key(CPtr<ILayoutView> layout, const ECadSettings & settings, const std::string & tag) const;
+    std::string Path(const std::string & key, const std::string & ext) const;
+
+    ///returns nullptr if missed, the loaded model is bound to layout
+    UPtr<IModel> Load(const std::string & key, CPtr<ILayoutView> layout) const;
+    bool Save(const std::string & key, CPtr<IModel> model) const;
+
+    ///marks the file as recently used
+    void Touch(const std::string & filename) const;
+    void Evict() const;
+
+    static uint64_t LayoutHash(CPtr<ILayoutView> layout);
+    static uint64_t SettingsHash(const ECadSettings & settings);
+
+private:
+    std::string m_dir;
+    size_t m_limit;//bytes, 0 means unlimited
+};
+
+}//namespace utils
+}//namespace ecad
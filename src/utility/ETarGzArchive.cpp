@@ -0,0 +1,231 @@
+#include "ETarGzArchive.h"
+
+#include "generic/tools/FileSystem.hpp"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <zlib.h>
+namespace ecad {
+namespace utils {
+
+namespace detail {
+inline static constexpr size_t TAR_BLOCK = 512;
+
+struct TarHeader
+{
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char chksum[8];
+    char typeflag;
+    char linkname[100];
+    char magic[6];
+    char version[2];
+    char uname[32];
+    char gname[32];
+    char devmajor[8];
+    char devminor[8];
+    char prefix[155];
+    char pad[12];
+};
+static_assert(sizeof(TarHeader) == TAR_BLOCK);
+
+ECAD_ALWAYS_INLINE size_t Padding(size_t size)
+{
+    return (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK;
+}
+
+ECAD_ALWAYS_INLINE uint64_t ParseNumber(const char * p, size_t n)
+{
+    //base-256 for the sizes that do not fit in the octal field
+    if (n > 0 && (static_cast<unsigned char>(p[0]) & 0x80)) {
+        uint64_t value = static_cast<unsigned char>(p[0]) & 0x7f;
+        for (size_t i = 1; i < n; ++i)
+            value = (value << 8) | static_cast<unsigned char>(p[i]);
+        return value;
+    }
+    uint64_t value{0};
+    for (size_t i = 0; i < n && p[i]; ++i) {
+        if (p[i] == ' ') continue;
+        if (p[i] < '0' || p[i] > '7') break;
+        value = (value << 3) | static_cast<uint64_t>(p[i] - '0');
+    }
+    return value;
+}
+
+ECAD_ALWAYS_INLINE void WriteOctal(char * p, size_t n, uint64_t value)
+{
+    std::memset(p, '0', n - 1);
+    p[n - 1] = '\0';
+    for (size_t i = n - 1; i > 0 && value; --i, value >>= 3)
+        p[i - 1] = static_cast<char>('0' + (value & 7));
+}
+
+ECAD_ALWAYS_INLINE uint64_t Checksum(const TarHeader & header)
+{
+    //the checksum field itself counts as spaces
+    auto bytes = reinterpret_cast<const unsigned char *>(&header);
+    uint64_t sum{0};
+    for (size_t i = 0; i < TAR_BLOCK; ++i)
+        sum += (i >= offsetof(TarHeader, chksum) && i < offsetof(TarHeader, chksum) + sizeof(header.chksum)) ? ' ' : bytes[i];
+    return sum;
+}
+
+ECAD_ALWAYS_INLINE std::string FieldString(const char * p, size_t n)
+{
+    return std::string(p, std::find(p, p + n, '\0'));
+}
+}//namespace detail
+
+ECAD_INLINE ETarGzReader::ETarGzReader(std::string_view filename)
+{
+    m_file = gzopen(std::string(filename).c_str(), "rb");
+    if (m_file) gzbuffer(static_cast<gzFile>(m_file), 1 << 17);
+}
+
+ECAD_INLINE ETarGzReader::~ETarGzReader()
+{
+    if (m_file) gzclose(static_cast<gzFile>(m_file));
+}
+
+ECAD_INLINE bool ETarGzReader::Next(std::string & name, std::string & data)
+{
+    if (not isOpen() || not m_good) return false;
+
+    std::string longName;
+    detail::TarHeader header;
+    while (Read(&header, sizeof(header))) {
+        auto bytes = reinterpret_cast<const char *>(&header);
+        if (std::all_of(bytes, bytes + sizeof(header), [](char c){ return c == '\0'; })) return false;//end of archive
+        if (detail::Checksum(header) != detail::ParseNumber(header.chksum, sizeof(header.chksum))) return m_good = false;
+
+        auto size = detail::ParseNumber(header.size, sizeof(header.size));
+        if (header.typeflag == 'L') {
+            longName.resize(size);
+            if (not Read(longName.data(), size) || not Skip(detail::Padding(size))) return m_good = false;
+            longName = detail::FieldString(longName.data(), longName.size());
+            continue;
+        }
+        if (header.typeflag != '0' && header.typeflag != '\0') {
+            longName.clear();
+            if (not Skip(size + detail::Padding(size))) return m_good = false;
+            continue;
+        }
+
+        if (longName.empty()) {
+            name = detail::FieldString(header.name, sizeof(header.name));
+            if (auto prefix = detail::FieldString(header.prefix, sizeof(header.prefix)); not prefix.empty())
+                name = prefix + "/" + name;
+        }
+        else name = std::move(longName);
+        while (name.size() > 1 && name.compare(0, 2, "./") == 0) name.erase(0, 2);
+
+        data.resize(size);
+        if (not Read(data.data(), size) || not Skip(detail::Padding(size))) return m_good = false;
+        return true;
+    }
+    return false;
+}
+
+ECAD_INLINE bool ETarGzReader::Read(void * data, size_t size)
+{
+    auto file = static_cast<gzFile>(m_file);
+    auto p = static_cast<char *>(data);
+    while (size > 0) {
+        auto chunk = static_cast<unsigned>(std::min<size_t>(size, 1u << 30));
+        auto n = gzread(file, p, chunk);
+        if (n <= 0) return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+ECAD_INLINE bool ETarGzReader::Skip(size_t size)
+{
+    char buffer[detail::TAR_BLOCK * 8];
+    while (size > 0) {
+        auto chunk = std::min(size, sizeof(buffer));
+        if (not Read(buffer, chunk)) return false;
+        size -= chunk;
+    }
+    return true;
+}
+
+ECAD_INLINE ETarGzWriter::ETarGzWriter(std::string_view filename)
+{
+    auto dir = generic::fs::DirName(filename);
+    if (not dir.empty() && not generic::fs::CreateDir(dir)) return;
+    m_file = gzopen(std::string(filename).c_str(), "wb6");
+    if (m_file) gzbuffer(static_cast<gzFile>(m_file), 1 << 17);
+}
+
+ECAD_INLINE ETarGzWriter::~ETarGzWriter()
+{
+    Close();
+}
+
+ECAD_INLINE bool ETarGzWriter::Add(std::string_view name, std::string_view data)
+{
+    if (not isOpen() || not m_good) return false;
+    if (name.size() >= sizeof(detail::TarHeader::name)) {
+        //gnu long name entry
+        std::string longName(name);
+        longName.push_back('\0');
+        if (not WriteHeader("././@LongLink", longName.size(), 'L')) return false;
+        if (not Write(longName.data(), longName.size())) return false;
+        if (not Write(std::string(detail::Padding(longName.size()), '\0').data(), detail::Padding(longName.size()))) return false;
+        name = name.substr(0, sizeof(detail::TarHeader::name) - 1);
+    }
+    if (not WriteHeader(name, data.size(), '0')) return false;
+    if (not Write(data.data(), data.size())) return false;
+    return Write(std::string(detail::Padding(data.size()), '\0').data(), detail::Padding(data.size()));
+}
+
+ECAD_INLINE bool ETarGzWriter::Close()
+{
+    if (not isOpen()) return false;
+    char end[detail::TAR_BLOCK * 2] = {};
+    Write(end, sizeof(end));
+    auto res = gzclose(static_cast<gzFile>(m_file));
+    m_file = nullptr;
+    return m_good && res == Z_OK;
+}
+
+ECAD_INLINE bool ETarGzWriter::Write(const void * data, size_t size)
+{
+    auto file = static_cast<gzFile>(m_file);
+    auto p = static_cast<const char *>(data);
+    while (m_good && size > 0) {
+        auto chunk = static_cast<unsigned>(std::min<size_t>(size, 1u << 30));
+        auto n = gzwrite(file, p, chunk);
+        if (n <= 0) m_good = false;
+        p += n;
+        size -= n;
+    }
+    return m_good;
+}
+
+ECAD_INLINE bool ETarGzWriter::WriteHeader(std::string_view name, size_t size, char type)
+{
+    detail::TarHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.name, name.data(), std::min(name.size(), sizeof(header.name)));
+    detail::WriteOctal(header.mode, sizeof(header.mode), 0644);
+    detail::WriteOctal(header.uid, sizeof(header.uid), 0);
+    detail::WriteOctal(header.gid, sizeof(header.gid), 0);
+    detail::WriteOctal(header.size, sizeof(header.size), size);
+    detail::WriteOctal(header.mtime, sizeof(header.mtime), static_cast<uint64_t>(std::time(nullptr)));
+    header.typeflag = type;
+    std::memcpy(header.magic, "ustar", 6);
+    std::memcpy(header.version, "00", 2);
+    detail::WriteOctal(header.chksum, sizeof(header.chksum) - 1, detail::Checksum(header));
+    header.chksum[sizeof(header.chksum) - 1] = ' ';
+    return Write(&header, sizeof(header));
+}
+
+}//namespace utils
+}//namespace ecad
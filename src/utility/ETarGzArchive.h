@@ -0,0 +1,54 @@
+#pragma once
+#include "basic/ECadCommon.h"
+#include <string_view>
+namespace ecad {
+namespace utils {
+
+/**
+ * @brief streaming reader of the regular files in a tar.gz archive, the entries are inflated in place without temp files,
+ *        ustar and gnu long names are supported, other entry types are skipped
+ */
+class ECAD_API ETarGzReader
+{
+public:
+    explicit ETarGzReader(std::string_view filename);
+    ~ETarGzReader();
+
+    bool isOpen() const { return nullptr != m_file; }
+    ///false if the archive is truncated or corrupted
+    bool isGood() const { return m_good; }
+
+    ///reads the next regular file, the leading "./" of the name is removed, returns false at the end of the archive
+    bool Next(std::string & name, std::string & data);
+
+private:
+    bool Read(void * data, size_t size);
+    bool Skip(size_t size);
+
+private:
+    void * m_file{nullptr};
+    bool m_good{true};
+};
+
+class ECAD_API ETarGzWriter
+{
+public:
+    explicit ETarGzWriter(std::string_view filename);
+    ~ETarGzWriter();
+
+    bool isOpen() const { return nullptr != m_file; }
+    bool Add(std::string_view name, std::string_view data);
+    ///writes the end of archive blocks, nothing can be added afterwards
+    bool Close();
+
+private:
+    bool Write(const void * data, size_t size);
+    bool WriteHeader(std::string_view name, size_t size, char type);
+
+private:
+    void * m_file{nullptr};
+    bool m_good{true};
+};
+
+}//namespace utils
+}//namespace ecad
@@ -3,8 +3,11 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_tools.hpp>
 #include "extension/ECadExtension.h"
+#include "extension/kicad/ECadExtKiCadHandler.h"
 #include "TestData.hpp"
 #include "EDataMgr.h"
+#include <array>
+#include <map>
 using namespace boost::unit_test;
 using namespace ecad;
 
@@ -32,6 +35,50 @@ void t_extension_dmcdom()
     EDataMgr::Instance().ShutDown();
 }
 
+void t_extension_kicad()
+{
+    //geometry items are extracted by batches, the result should not depend on the threads
+    using namespace ext::kicad;
+    std::string kicad = ecad_test::GetTestDataPath() + "/kicad/test.kicad_pcb";
+    using Summary = std::map<std::string, std::array<size_t, 8> >;//component -> vias, arcs, pads, lines, polys, zones, circles, segments
+    std::vector<std::array<size_t, 4> > counts;//layers, nets, ecad layers, ecad nets
+    std::vector<Summary> summaries;
+    for (size_t threads : {1, 4}) {
+        std::string err;
+        ECadExtKiCadHandler handler(kicad, threads);
+        auto database = handler.CreateDatabase("test_kicad_" + std::to_string(threads), &err);
+        BOOST_CHECK(err.empty());
+        BOOST_CHECK(database != nullptr);
+        auto objects = handler.GetKiCadDatabase();
+        if (nullptr == database || nullptr == objects) continue;
+
+        std::vector<Ptr<ICell> > cells;
+        database->GetCircuitCells(cells);
+        BOOST_CHECK(cells.size() == 1);
+        if (cells.empty()) continue;
+        auto layout = cells.front()->GetLayoutView();
+        counts.push_back({objects->layers.size(), objects->nets.size(), layout->GetLayerCollection()->Size(), layout->GetNetCollection()->Size()});
+
+        auto summary = [](const Component & comp) {
+            return std::array<size_t, 8>{comp.vias.size(), comp.arcs.size(), comp.pads.size(), comp.lines.size(),
+                                         comp.polys.size(), comp.zones.size(), comp.circles.size(), comp.segments.size()};
+        };
+        auto & result = summaries.emplace_back();
+        result.emplace(std::string{}, summary(*objects));
+        for (const auto & [name, comp] : objects->components)
+            result.emplace(name, summary(comp));
+    }
+    BOOST_CHECK(counts.size() == 2 && summaries.size() == 2);
+    if (counts.size() == 2 && summaries.size() == 2) {
+        BOOST_CHECK(counts.front() == counts.back());
+        BOOST_CHECK(summaries.front() == summaries.back());
+        BOOST_CHECK(counts.front().at(0) > 0 && counts.front().at(1) > 0);
+        BOOST_CHECK(summaries.front().size() > 1);
+    }
+
+    EDataMgr::Instance().ShutDown();
+}
+
 void t_extension_gds()
 {
     std::string err;
@@ -44,6 +91,49 @@ void t_extension_gds()
     EDataMgr::Instance().ShutDown();
 }
 
+void t_extension_gds_threads()
+{
+    //the structures are parsed in parallel, the result should not depend on the threads
+    auto & eDataMgr = EDataMgr::Instance();
+    auto threads = eDataMgr.Threads();
+    std::string ringoGds = ecad_test::GetTestDataPath() + "/gdsii/ringo.gds";
+    std::vector<Ptr<IDatabase> > databases;
+    for (size_t t : {1, 4}) {
+        std::string err;
+        eDataMgr.SetThreads(t);
+        databases.emplace_back(ext::CreateDatabaseFromGds("ringo_" + std::to_string(t), ringoGds, std::string{}, &err));
+        BOOST_CHECK(err.empty());
+        BOOST_CHECK(databases.back() != nullptr);
+    }
+    eDataMgr.SetThreads(threads);
+    if (nullptr == databases.front() || nullptr == databases.back()) {
+        EDataMgr::Instance().ShutDown();
+        return;
+    }
+
+    const auto & units1 = databases.front()->GetCoordUnits();
+    const auto & units4 = databases.back()->GetCoordUnits();
+    BOOST_CHECK(units1.Scale2Unit() == units4.Scale2Unit());
+    BOOST_CHECK(units1.toUnit(1, ECoordUnits::Unit::Meter) == units4.toUnit(1, ECoordUnits::Unit::Meter));
+
+    auto summary = [](Ptr<IDatabase> database) {
+        std::vector<Ptr<ICell> > cells;
+        database->GetCircuitCells(cells);
+        std::map<std::string, std::array<size_t, 2> > result;
+        for (auto cell : cells) {
+            auto layout = cell->GetLayoutView();
+            result.emplace(cell->GetName(), std::array<size_t, 2>{layout->GetPrimitiveCollection()->Size(), layout->GetCellInstCollection()->Size()});
+        }
+        return result;
+    };
+    auto cells1 = summary(databases.front());
+    auto cells4 = summary(databases.back());
+    BOOST_CHECK(not cells1.empty());
+    BOOST_CHECK(cells1 == cells4);
+
+    EDataMgr::Instance().ShutDown();
+}
+
 void t_extension_xfl()
 {
     std::string err;
@@ -59,13 +149,69 @@ void t_extension_xfl()
     EDataMgr::Instance().ShutDown(); 
 }
 
+void t_extension_xfl_threads()
+{
+    //the route section of qcom.xfl is about 2MB, it is cut into several 256KB record chunks parsed in parallel
+    auto & eDataMgr = EDataMgr::Instance();
+    auto threads = eDataMgr.Threads();
+    std::string qcomXfl = ecad_test::GetTestDataPath() + "/xfl/qcom.xfl";
+    std::vector<Ptr<IDatabase> > databases;
+    for (size_t t : {1, 4}) {
+        std::string err;
+        eDataMgr.SetThreads(t);
+        databases.emplace_back(ext::CreateDatabaseFromXfl("qcom_" + std::to_string(t), qcomXfl, &err));
+        BOOST_CHECK(err.empty());
+        BOOST_CHECK(databases.back() != nullptr);
+    }
+    eDataMgr.SetThreads(threads);
+    if (nullptr == databases.front() || nullptr == databases.back()) {
+        EDataMgr::Instance().ShutDown();
+        return;
+    }
+
+    auto padstackDefs = [](Ptr<IDatabase> database) {
+        std::vector<std::string> names;
+        auto iter = database->GetPadstackDefIter();
+        while (auto psDef = iter->Next())
+            names.emplace_back(psDef->GetName());
+        return names;
+    };
+    auto psDefs1 = padstackDefs(databases.front());
+    auto psDefs4 = padstackDefs(databases.back());
+    BOOST_CHECK(not psDefs1.empty());
+    BOOST_CHECK(psDefs1 == psDefs4);
+
+    auto summary = [](Ptr<IDatabase> database) {
+        std::vector<Ptr<ICell> > cells;
+        database->GetCircuitCells(cells);
+        std::map<std::string, std::array<size_t, 5> > result;
+        for (auto cell : cells) {
+            auto layout = cell->GetLayoutView();
+            result.emplace(cell->GetName(), std::array<size_t, 5>{layout->GetNetCollection()->Size(), layout->GetLayerCollection()->Size(),
+                layout->GetComponentCollection()->Size(), layout->GetPrimitiveCollection()->Size(), layout->GetPadstackInstCollection()->Size()});
+        }
+        return result;
+    };
+    auto cells1 = summary(databases.front());
+    auto cells4 = summary(databases.back());
+    BOOST_CHECK(not cells1.empty());
+    BOOST_CHECK(cells1 == cells4);
+    for (const auto & [name, counts] : cells1)
+        BOOST_CHECK(counts.at(0) > 0 && counts.at(3) > 0);
+
+    EDataMgr::Instance().ShutDown();
+}
+
 test_suite * create_ecad_extension_test_suite()
 {
     test_suite * extension_suite = BOOST_TEST_SUITE("s_extension_test");
     //
     extension_suite->add(BOOST_TEST_CASE(&t_extension_dmcdom));
+    extension_suite->add(BOOST_TEST_CASE(&t_extension_kicad));
     extension_suite->add(BOOST_TEST_CASE(&t_extension_gds));
+    extension_suite->add(BOOST_TEST_CASE(&t_extension_gds_threads));
     extension_suite->add(BOOST_TEST_CASE(&t_extension_xfl));
+    extension_suite->add(BOOST_TEST_CASE(&t_extension_xfl_threads));
     //
     return extension_suite;
 }
\ No newline at end of file
@@ -2,7 +2,12 @@
 #define BOOST_TEST_INCLUDED
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_tools.hpp>
+#include "generic/tools/FileSystem.hpp"
 #include "generic/tools/StringHelper.hpp"
+#include "model/thermal/io/EPrismThermalModelIO.h"
+#include "model/geometry/io/ELayerCutModelIO.h"
+#include "interface/IModelCollection.h"
+#include "utility/EModelCache.h"
 #include "TestData.hpp"
 #include "EDataMgr.h"
 using namespace boost::unit_test;
@@ -72,6 +77,67 @@ void t_thermal_static_flow1()
 
     EPrismThermalModelExtractionSettings prismSettings(gridSettings.workDir, 4, {});
     auto model2 = layout->ExtractThermalModel(prismSettings); BOOST_CHECK(model2);
+
+    //model cache, the key does not depend on threads and work dir
+    auto cacheDir = ecad_test::GetTestDataPath() + "/simulation/thermal/cache";
+    generic::fs::RemoveDir(cacheDir);
+    utils::EModelCache cache(cacheDir, 0);
+    EPrismThermalModelExtractionSettings prismSettings1(gridSettings.workDir + "/cache", 1, {});
+    auto key = cache.Key(layout, prismSettings, toString(prismSettings.GetModelType()));
+    BOOST_CHECK(key == cache.Key(layout, prismSettings1, toString(prismSettings1.GetModelType())));
+    prismSettings1.meshSettings.iteration += 1;
+    BOOST_CHECK(key != cache.Key(layout, prismSettings1, toString(prismSettings1.GetModelType())));
+
+    eDataMgr.SetModelCache(cacheDir);
+    auto collection = layout->GetModelCollection();
+    BOOST_CHECK(collection->RemoveModel(prismSettings.GetModelType()));
+    auto model3 = layout->ExtractThermalModel(prismSettings); BOOST_CHECK(model3);
+    //the collection owns the model, so its size is taken before the model is removed
+    auto prism3 = dynamic_cast<CPtr<model::EPrismThermalModel>>(model3);
+    BOOST_CHECK(prism3);
+    size_t elements = prism3 ? prism3->TotalElements() : 0;
+    BOOST_CHECK(collection->RemoveModel(prismSettings.GetModelType()));
+    auto model4 = layout->ExtractThermalModel(prismSettings); BOOST_CHECK(model4);
+    auto prism4 = dynamic_cast<CPtr<model::EPrismThermalModel>>(model4);
+    BOOST_CHECK(prism4 && prism4->TotalElements() == elements);
+    BOOST_CHECK(prism4 && prism4->GetLayoutView() == layout);
+    eDataMgr.SetModelCache(std::string{});
+    generic::fs::RemoveDir(cacheDir);
+
+    //native container, full and partial reads
+    auto ecmFile = ecad_test::GetTestDataPath() + "/simulation/thermal/prism.ecm";
+    BOOST_CHECK(prism4 && model::io::EPrismThermalModelBinaryIO::Write(ecmFile, *prism4));
+    auto prism5 = model::io::EPrismThermalModelBinaryIO::Read(ecmFile, layout);
+    BOOST_CHECK(prism4 && prism5 && prism5->TotalElements() == prism4->TotalElements());
+    BOOST_CHECK(prism4 && prism5 && prism5->GetPoints().size() == prism4->GetPoints().size());
+    BOOST_CHECK(prism5 && prism5->Match(prismSettings));
+    BOOST_CHECK(prism4 && prism5 && prism5->GetLayerPrismTemplate(0)->triangles.size() == prism4->GetLayerPrismTemplate(0)->triangles.size());
+    std::vector<FPoint3D> points;
+    std::vector<std::array<size_t, 6> > prisms;
+    BOOST_CHECK(model::io::EPrismThermalModelBinaryIO::ReadGeometry(ecmFile, points, prisms));
+    BOOST_CHECK(prism4 && prisms.size() == prism4->TotalPrismElements());
+    model::PrismLayer prismLayer(0);
+    BOOST_CHECK(model::io::EPrismThermalModelBinaryIO::ReadLayer(ecmFile, 0, prismLayer));
+    BOOST_CHECK(prism4 && prismLayer.TotalElements() == prism4->layers.front().TotalElements());
+    generic::fs::RemoveFile(ecmFile);
+
+    //layer cut container, the settings are stored field by field
+    ELayerCutModelExtractionSettings layerCutSettings;
+    layerCutSettings.dumpSketchImg = false;
+    layerCutSettings.addCircleCenterAsSteinerPoint = true;
+    layerCutSettings.layerCutPrecision = 5;
+    layerCutSettings.layerTransitionRatio = 3;
+    layerCutSettings.imprintBox.emplace_back(FPoint2D(-1, -2), FPoint2D(3, 4));
+    auto lcm = dynamic_cast<CPtr<model::ELayerCutModel>>(layout->ExtractLayerCutModel(layerCutSettings));
+    BOOST_CHECK(lcm && lcm->Match(layerCutSettings));
+    auto lcmFile = ecad_test::GetTestDataPath() + "/simulation/thermal/layer_cut.ecm";
+    BOOST_CHECK(lcm && model::io::ELayerCutModelBinaryIO::Write(lcmFile, *lcm));
+    auto lcm1 = model::io::ELayerCutModelBinaryIO::Read(lcmFile);
+    BOOST_CHECK(lcm1 && lcm1->Match(layerCutSettings));
+    BOOST_CHECK(lcm1 && not lcm1->Match(ELayerCutModelExtractionSettings{}));
+    BOOST_CHECK(lcm && lcm1 && lcm1->GetAllPolygonData().size() == lcm->GetAllPolygonData().size());
+    BOOST_CHECK(lcm && lcm1 && lcm1->TotalLayers() == lcm->TotalLayers());
+    generic::fs::RemoveFile(lcmFile);
     EDataMgr::Instance().ShutDown();
 }
 
@@ -356,6 +422,14 @@ void t_thermal_static_flow2()
     auto [minT, maxT] = layout->RunThermalSimulation(setup, temperatures);    
     BOOST_CHECK_CLOSE(minT, 33.7, 2);
     BOOST_CHECK_CLOSE(maxT, 242, 2);
+
+    //the cached model is updated in place after a stackup edit and matches a rebuilt one
+    BOOST_CHECK(layout->ModifyStackupLayerThickness("Substrate", 500));
+    auto [minT1, maxT1] = layout->RunThermalSimulation(setup, temperatures);
+    setup.extractionSettings->forceRebuild = true;
+    auto [minT2, maxT2] = layout->RunThermalSimulation(setup, temperatures);
+    BOOST_CHECK_CLOSE(minT1, minT2, 1);
+    BOOST_CHECK_CLOSE(maxT1, maxT2, 1);
     EDataMgr::Instance().ShutDown();
 }
 
@@ -4,6 +4,7 @@
 #include <boost/test/test_tools.hpp>
 #include "generic/tools/FileSystem.hpp"
 #include "model/thermal/io/EChipThermalModelIO.h"
+#include "model/thermal/utils/EStackupPrismThermalModelBuilder.h"
 #include "TestData.hpp"
 using namespace boost::unit_test;
 using namespace ecad;
@@ -14,8 +15,7 @@ void s_ctm_model_io_test()
     std::string ctm = ecad_test::GetTestDataPath() + "/ctm/test.tar.gz";
     std::string ctmFolder = ecad_test::GetTestDataPath() + "/ctm/test";
     auto model = io::makeChipThermalModelFromCTMv1File(ctm, &err);
-    BOOST_CHECK(generic::fs::PathExists(ctmFolder));
-    generic::fs::RemoveDir(ctmFolder);
+    BOOST_CHECK(not generic::fs::PathExists(ctmFolder));
     BOOST_CHECK(err.empty());
     BOOST_CHECK(model);
 
@@ -23,6 +23,39 @@ void s_ctm_model_io_test()
     std::string outFolder = ecad_test::GetTestDataPath() + "/ctm/out";
     bool res = io::GenerateCTMv1FileFromChipThermalModelV1(*model, outFolder, outFile, &err);
     BOOST_CHECK(res);
+
+    auto reload = io::makeChipThermalModelFromCTMv1File(outFolder + "/test.tar.gz", &err);
+    BOOST_CHECK(not generic::fs::PathExists(outFolder + "/test"));
+    BOOST_CHECK(reload && reload->header.temperatures == model->header.temperatures);
+}
+
+void s_prism_triangle_intersect_area_test()
+{
+    using Builder = utils::EStackupPrismThermalModelBuilder;
+    using Triangle = Builder::Triangle;
+    auto reverse = [](Triangle t) { std::swap(t[1], t[2]); return t; };
+    auto shift = [](Triangle t, EFloat d) { for (auto & p : t) { p[0] += d; p[1] += d; } return t; };
+    //overlap is symmetric and independent of the windings and the location
+    auto check = [&](const Triangle & t1, const Triangle & t2, EFloat expected) {
+        std::vector<std::pair<Triangle, Triangle> > pairs{{t1, t2}, {reverse(t1), t2}, {t1, reverse(t2)}, {reverse(t1), reverse(t2)}, {shift(t1, 1e6), shift(t2, 1e6)}};
+        for (const auto & [a, b] : pairs) {
+            BOOST_CHECK_SMALL(Builder::GetIntersectArea(a, b) - expected, 1e-6);
+            BOOST_CHECK_SMALL(Builder::GetIntersectArea(b, a) - expected, 1e-6);
+        }
+    };
+
+    Triangle t{{{0, 0}, {2, 0}, {0, 2}}};
+    BOOST_CHECK_CLOSE(Builder::GetTriangleArea(t), 2, 1e-9);
+    BOOST_CHECK_CLOSE(Builder::GetTriangleArea(reverse(t)), 2, 1e-9);
+    check(t, t, 2);//identical
+    check(t, Triangle{{{3, 3}, {4, 3}, {3, 4}}}, 0);//disjoint
+    check(t, Triangle{{{2, 0}, {2, 2}, {0, 2}}}, 0);//touching edge
+    check(t, Triangle{{{2, 0}, {3, 0}, {2, 1}}}, 0);//touching vertex
+    check(t, Triangle{{{0.25, 0.25}, {1, 0.25}, {0.25, 1}}}, 0.28125);//contained
+    check(t, Triangle{{{1, 0}, {3, 0}, {1, 2}}}, 0.5);//partial
+    check(t, Triangle{{{-1, 1}, {3, 1}, {1, -1}}}, 1.5);//hexagon
+    check(t, Triangle{{{0, 0}, {1, 1}, {2, 2}}}, 0);//degenerated
+    check(t, Triangle{{{1, 1}, {1, 1}, {1, 1}}}, 0);//point
 }
 
 test_suite * create_ecad_model_test_suite()
@@ -30,6 +63,7 @@ test_suite * create_ecad_model_test_suite()
     test_suite * model_suite = BOOST_TEST_SUITE("s_model_test");
     //
     model_suite->add(BOOST_TEST_CASE(&s_ctm_model_io_test));
+    model_suite->add(BOOST_TEST_CASE(&s_prism_triangle_intersect_area_test));
     //
     return model_suite;
 }
\ No newline at end of file
@@ -4,11 +4,16 @@
 #include <boost/test/test_tools.hpp>
 #include "generic/tools/Format.hpp"
 #include "generic/tools/FileSystem.hpp"
+#include "solver/thermal/utils/EPrismThermalNetworkBuilder.h"
+#include "solver/thermal/utils/EMaterialPropCache.h"
 #include "solver/thermal/EThermalNetworkSolver.h"
+#include "solver/thermal/network/utils/SampleSink.h"
+#include "solver/thermal/network/ThermalNetworkSolver.h"
 #include "model/thermal/io/EThermalModelIO.h"
 #include "model/thermal/io/EGridThermalModelIO.h"
 #include "model/thermal/utils/EThermalModelReduction.h"
 #include "TestData.hpp"
+#include "EDataMgr.h"
 using namespace boost::unit_test;
 using namespace ecad;
 using namespace ecad::solver;
@@ -20,8 +25,7 @@ void t_grid_thermal_model_solver_test()
     std::string ctm = ecad_test::GetTestDataPath() + "/ctm/test.tar.gz";
     std::string ctmFolder = ecad_test::GetTestDataPath() + "/ctm/test";
     auto model = io::makeGridThermalModelFromCTMv1File(ctm, 0, &err);
-    BOOST_CHECK(generic::fs::PathExists(ctmFolder));
-    generic::fs::RemoveDir(ctmFolder);
+    BOOST_CHECK(not generic::fs::PathExists(ctmFolder));
     BOOST_CHECK(model);
     
     auto size = model->ModelSize();
@@ -42,6 +46,293 @@ void t_grid_thermal_model_solver_test()
     BOOST_CHECK(isValid(maxT));
     ECAD_TRACE("maxT: %1%, minT: %2%", maxT, minT);
     //max: 99.4709, min: 81.9183
+
+    //batched cases should match the single case solves of a temperature dependent model
+    solver.settings.probs = {0, model->TotalGrids() / 2, model->TotalGrids() - 1};
+    std::vector<EThermalStaticExcitation> cases{[](size_t){ return 1.0; }, [](size_t){ return 0.5; }};
+    std::vector<std::vector<EFloat> > temperatures;
+    auto ranges = solver.Solve(cases, temperatures);
+    BOOST_CHECK(ranges.size() == cases.size());
+    for (size_t j = 0; j < std::min(ranges.size(), cases.size()); ++j) {
+        std::vector<std::vector<EFloat> > single;
+        auto range = solver.Solve({cases.at(j)}, single);
+        BOOST_CHECK(range.size() == 1 && single.size() == 1);
+        if (range.size() != 1 || single.size() != 1) continue;
+        BOOST_CHECK_CLOSE(ranges.at(j).first, range.front().first, 1e-3);
+        BOOST_CHECK_CLOSE(ranges.at(j).second, range.front().second, 1e-3);
+        for (size_t i = 0; i < solver.settings.probs.size(); ++i)
+            BOOST_CHECK_CLOSE(temperatures.at(j).at(i), single.front().at(i), 1e-3);
+    }
+}
+
+void t_thermal_network_solver_types_test()
+{
+    //plate of nx * ny nodes, heated in the center and cooled by htc on the borders
+    using namespace thermal;
+    const size_t nx = 40, ny = 40;
+    model::ThermalNetwork<EFloat> network(nx * ny);
+    auto index = [&](size_t x, size_t y) { return y * nx + x; };
+    for (size_t y = 0; y < ny; ++y) {
+        for (size_t x = 0; x < nx; ++x) {
+            if (x + 1 < nx) network.SetR(index(x, y), index(x + 1, y), 0.5);
+            if (y + 1 < ny) network.SetR(index(x, y), index(x, y + 1), 0.5 + 0.01 * x);
+            if (x == 0 || y == 0 || x + 1 == nx || y + 1 == ny) network.SetHTC(index(x, y), 0.2);
+        }
+    }
+    network.SetHF(index(nx / 2, ny / 2), 10);
+    network.SetHF(index(nx / 4, ny / 3), 5);
+    auto compact = network.Freeze();
+
+    std::vector<EFloat> ref;
+    thermal::solver::ThermalNetworkSolver<EFloat> direct(static_cast<int>(EThermalNetworkStaticSolverType::LLT));
+    BOOST_CHECK(direct.Solve(compact, 25, ref));
+    BOOST_CHECK(ref.size() == nx * ny);
+
+    for (auto type : {EThermalNetworkStaticSolverType::ICConjugateGradient,
+                      EThermalNetworkStaticSolverType::ILUTBiCGSTAB,
+                      EThermalNetworkStaticSolverType::AMGConjugateGradient,
+                      EThermalNetworkStaticSolverType::AlgebraicMultigrid}) {
+        std::vector<EFloat> results;
+        thermal::solver::ThermalNetworkSolver<EFloat> solver(static_cast<int>(type));
+        BOOST_CHECK(solver.Solve(compact, 25, results));
+        BOOST_CHECK(solver.Iterations() > 0);
+        BOOST_CHECK(results.size() == ref.size());
+        if (results.size() != ref.size()) continue;
+        EFloat maxDiff{0};
+        for (size_t i = 0; i < ref.size(); ++i)
+            maxDiff = std::max<EFloat>(maxDiff, std::fabs(results.at(i) - ref.at(i)));
+        BOOST_CHECK_SMALL(maxDiff, 1e-4);
+    }
+}
+
+void t_thermal_network_implicit_integrator_test()
+{
+    //decoupled rc nodes with constant heat flow, x(t) = p / g + (x0 - p / g) * exp(-g * t / c)
+    using Integrator = thermal::solver::ImplicitIntegrator<EFloat>;
+    const std::vector<EFloat> c{2, 0.5, 10}, g{0.5, 2, 0.1}, p{1, 0, 3};
+    Integrator::Vector cv(c.size());
+    Integrator::Matrix gm(g.size(), g.size());
+    for (size_t i = 0; i < c.size(); ++i) {
+        cv[i] = c.at(i);
+        gm.insert(i, i) = g.at(i);
+    }
+    auto analytic = [&](size_t i, EFloat t) { return p.at(i) / g.at(i) + (25 - p.at(i) / g.at(i)) * std::exp(-g.at(i) * t / c.at(i)); };
+    auto input = [&](EFloat, Integrator::Vector & u) { for (size_t i = 0; i < p.size(); ++i) u[i] = p.at(i); };
+    auto integrate = [&](Integrator::Method method, bool adaptive, EFloat dt, size_t & factorized) {
+        EFloat maxErr{0};
+        auto observer = [&](const Integrator::State & x, EFloat t) {
+            for (size_t i = 0; i < x.size(); ++i)
+                maxErr = std::max<EFloat>(maxErr, std::fabs(x.at(i) - analytic(i, t)));
+        };
+        Integrator integrator(cv, gm);
+        Integrator::State x(c.size(), 25);
+        auto steps = integrator.Integrate(method, adaptive, x, 0, 20, dt, 1e-6, 1e-6, input, observer);
+        BOOST_CHECK(steps > 0);
+        BOOST_CHECK_CLOSE(x.back(), analytic(x.size() - 1, 20), 1e-2);
+        factorized = integrator.Factorized();
+        BOOST_CHECK(factorized * 4 < steps);
+        return maxErr;
+    };
+
+    //constant step, the factorization is reused after the start up (and the order ramp of BDF)
+    size_t factorized{0};
+    BOOST_CHECK_SMALL(integrate(Integrator::Method::TRBDF2, false, 0.025, factorized), 5e-3);
+    BOOST_CHECK(factorized <= 2);
+    BOOST_CHECK_SMALL(integrate(Integrator::Method::BDF, false, 0.0125, factorized), 1e-1);
+    BOOST_CHECK(factorized <= Integrator::maxOrder + 1);
+    BOOST_CHECK_SMALL(integrate(Integrator::Method::BackwardEuler, false, 0.0125, factorized), 0.25);
+    BOOST_CHECK(factorized <= 2);
+
+    //error control
+    BOOST_CHECK_SMALL(integrate(Integrator::Method::TRBDF2, true, 0.025, factorized), 1e-3);
+    BOOST_CHECK_SMALL(integrate(Integrator::Method::BDF, true, 0.025, factorized), 1e-3);
+}
+
+void t_thermal_network_parametric_reduction_test()
+{
+    //plate with temperature dependent conductances, the parametric model reuses the basis of the first network
+    using namespace thermal;
+    using TransSolver = thermal::solver::ThermalNetworkReducedTransientSolver<EFloat>;
+    const size_t nx = 12, ny = 12;
+    auto index = [&](size_t x, size_t y) { return y * nx + x; };
+    auto makeNetwork = [&](EFloat scale, size_t changed) {
+        model::ThermalNetwork<EFloat> network(nx * ny);
+        for (size_t y = 0; y < ny; ++y) {
+            for (size_t x = 0; x < nx; ++x) {
+                auto s = index(x, y) < changed ? scale : EFloat{1};
+                if (x + 1 < nx) network.SetR(index(x, y), index(x + 1, y), 0.5 * s);
+                if (y + 1 < ny) network.SetR(index(x, y), index(x, y + 1), 0.5 * s);
+                if (x == 0 || y == 0 || x + 1 == nx || y + 1 == ny) network.SetHTC(index(x, y), 0.2);
+                network.SetC(index(x, y), 1 / s);
+            }
+        }
+        network.SetHF(index(nx / 2, ny / 2), 10);
+        network.SetHF(index(nx / 4, ny / 3), 5);
+        return network.Freeze();
+    };
+
+    const std::vector<size_t> probs{index(nx / 2, ny / 2), index(nx / 4, ny / 3), index(0, 0)};
+    const std::vector<EFloat> temperature(nx * ny, 25);
+    auto base = makeNetwork(1, 0);
+    auto local = makeNetwork(1.05, 3);//small change, projected entry by entry
+    auto global = makeNetwork(1.05, nx * ny);//whole network changed, projected as a whole
+    thermal::solver::ParametricReducedModel<EFloat> prom(8, 25, 0);
+    prom.Project(base, temperature, probs, true);
+    for (const auto * network : {&local, &global}) {
+        auto rom = prom.Project(*network, temperature, probs, true);
+        auto m = thermal::model::makeMNA(*network, true, probs);
+        Eigen::MatrixXd g = rom.x.transpose() * (m.G * rom.x);
+        Eigen::MatrixXd c = rom.x.transpose() * (m.C * rom.x);
+        BOOST_CHECK(g.isApprox(rom.m.G, 1e-8));
+        BOOST_CHECK(c.isApprox(rom.m.C, 1e-8));
+    }
+    BOOST_CHECK(prom.Reductions() == 1);
+    BOOST_CHECK(prom.Projections() == 2);
+
+    //parametric and non-parametric runs of the changed network should agree on the probs
+    auto excitation = [](EFloat, size_t) { return EFloat{1}; };
+    auto observer = [](const TransSolver::StateType &, EFloat) {};
+    auto solve = [&](TransSolver & solver) {
+        TransSolver::StateType state, out;
+        BOOST_CHECK(solver.Im().Input2State(temperature, state));
+        solver.Solve(state, 0, 5, 0.01, 1e-6, 1e-6, observer, &excitation);
+        solver.Im().State2Output(state, out);
+        return out;
+    };
+    TransSolver parametric(global, 25, probs, prom, temperature);
+    TransSolver reduced(global, 25, probs, 8);
+    auto pt = solve(parametric);
+    auto rt = solve(reduced);
+    BOOST_CHECK(pt.size() == probs.size() && rt.size() == probs.size());
+    for (size_t i = 0; i < std::min(pt.size(), rt.size()); ++i)
+        BOOST_CHECK_CLOSE(pt.at(i), rt.at(i), 1);
+}
+
+void t_material_prop_cache_test()
+{
+    EDataMgr::Instance().Init();
+    auto & eDataMgr = EDataMgr::Instance();
+    auto database = eDataMgr.CreateDatabase("MaterialPropCache"); BOOST_CHECK(database);
+    auto matCu = database->CreateMaterialDef("Cu"); BOOST_CHECK(matCu);
+    matCu->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreatePolynomialMaterialProp({{437.6, -0.165}}));
+    matCu->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(380));
+    auto matId = matCu->GetMaterialId();
+    auto library = database->GetMaterialDefCollection();
+    auto k = [](EFloat t) { return 437.6 - 0.165 * t; };
+
+    //the conductivity is linear, so the interpolation is exact on any grid
+    EMaterialPropCache cache(library, 300, 400);
+    BOOST_CHECK(cache.Samples() == 1001);
+    BOOST_CHECK_CLOSE(cache.GetThermalConductivity(matId, 350.05).front(), k(350.05), 1e-6);
+    BOOST_CHECK_CLOSE(cache.GetThermalConductivity(matId, 500).front(), k(500), 1e-6);
+    BOOST_CHECK_CLOSE(cache.GetSpecificHeat(matId, 350), 380, 1e-6);
+
+    //a diverged field widens the step instead of growing the table
+    EMaterialPropCache wide(library, -1e9, 1e9);
+    BOOST_CHECK(wide.Samples() <= EMaterialPropCache::MAX_SAMPLES);
+    BOOST_CHECK_CLOSE(wide.GetThermalConductivity(matId, 350).front(), k(350), 1e-3);
+    BOOST_CHECK_CLOSE(wide.GetThermalConductivity(matId, 5e8).front(), k(5e8), 1e-6);
+
+    //non finite bounds keep one sample and evaluate the material
+    for (auto [minT, maxT] : {std::make_pair<EFloat, EFloat>(300, std::numeric_limits<EFloat>::infinity()),
+                              std::make_pair<EFloat, EFloat>(-std::numeric_limits<EFloat>::infinity(), 400),
+                              std::make_pair<EFloat, EFloat>(std::numeric_limits<EFloat>::quiet_NaN(), 400)}) {
+        EMaterialPropCache infinite(library, minT, maxT);
+        BOOST_CHECK(infinite.Samples() == 1);
+        BOOST_CHECK_CLOSE(infinite.GetThermalConductivity(matId, 300).front(), k(300), 1e-6);
+        BOOST_CHECK_CLOSE(infinite.GetThermalConductivity(matId, 350).front(), k(350), 1e-6);
+        BOOST_CHECK_CLOSE(infinite.GetSpecificHeat(matId, 350), 380, 1e-6);
+    }
+    eDataMgr.RemoveDatabase("MaterialPropCache");
+}
+
+void t_prism_thermal_network_builder_test()
+{
+    EDataMgr::Instance().Init();
+    auto & eDataMgr = EDataMgr::Instance();
+
+    auto database = eDataMgr.CreateDatabase("PrismBuilder"); BOOST_CHECK(database);
+    auto matCu = database->CreateMaterialDef("Cu"); BOOST_CHECK(matCu);
+    matCu->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(398));
+    matCu->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(380));
+    matCu->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(8850));
+
+    ECoordUnits coordUnits(ECoordUnits::Unit::Micrometer);
+    database->SetCoordUnits(coordUnits);
+
+    auto topCell = eDataMgr.CreateCircuitCell(database, "TopCell"); BOOST_CHECK(topCell);
+    auto topLayout = topCell->GetLayoutView(); BOOST_CHECK(topLayout);
+    auto topBonds = std::make_unique<EPolygon>(eDataMgr.CreatePolygon(coordUnits, {{-5000, -5000}, {5000, -5000}, {5000, 5000}, {-5000, 5000}}));
+    topLayout->SetBoundary(std::move(topBonds));
+    auto iLyrTopCu = topLayout->AppendLayer(eDataMgr.CreateStackupLayer("TopCu", ELayerType::ConductingLayer, 0, 400, matCu->GetName(), matCu->GetName()));
+    BOOST_CHECK(iLyrTopCu != ELayerId::noLayer);
+
+    auto compDef = eDataMgr.CreateComponentDef(database, "Die"); BOOST_CHECK(compDef);
+    compDef->SetBoundary(eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(-2000, -2000), FPoint2D(2000, 2000)));
+    compDef->SetMaterial(matCu->GetName());
+    compDef->SetHeight(365);
+    compDef->SetSolderFillingMaterial(matCu->GetName());
+    auto comp = eDataMgr.CreateComponent(topLayout, "M1", compDef, iLyrTopCu, makeETransform2D(1, 0, EVector2D(0, 0)), false);
+    BOOST_CHECK(comp);
+    comp->SetLossPower(ETemperature::Celsius2Kelvins(25), 10);
+
+    database->Flatten(topCell, 1);
+    auto layout = topCell->GetFlattenedLayoutView(); BOOST_CHECK(layout);
+
+    EPrismThermalModelExtractionSettings settings(ecad_test::GetTestDataPath() + "/simulation/thermal", 1, {});
+    settings.botUniformBC.type = EThermalBoundaryConditionType::HTC;
+    settings.botUniformBC.value = 2750;
+    auto model = dynamic_cast<CPtr<EPrismThermalModel>>(layout->ExtractThermalModel(settings));
+    BOOST_CHECK(model);
+    if (nullptr == model) return;
+
+    //parallel build should be race free and give the same network every time
+    using Builder = EPrismThermalNetworkBuilder<EFloat>;
+    Builder builder(*model);
+    std::vector<EFloat> iniT(model->TotalElements(), ETemperature::Celsius2Kelvins(25));
+    auto ref = builder.Build(iniT, 1)->Freeze();
+    auto refSummary = builder.summary;
+    EThermalNetworkBuildSummary mtSummary;
+    for (size_t i = 0; i < 3; ++i) {
+        auto network = builder.Build(iniT, 8)->Freeze();
+        BOOST_CHECK(network.RowOffsets() == ref.RowOffsets());
+        BOOST_CHECK(network.Cols() == ref.Cols());
+        BOOST_CHECK(network.Conductances() == ref.Conductances());
+        BOOST_CHECK(network.C() == ref.C());
+        BOOST_CHECK(network.HF() == ref.HF());
+        BOOST_CHECK(network.HTC() == ref.HTC());
+        if (i > 0) BOOST_CHECK(builder.summary.iHeatFlow == mtSummary.iHeatFlow);
+        BOOST_CHECK(builder.summary.boundaryNodes == refSummary.boundaryNodes);
+        BOOST_CHECK_CLOSE(builder.summary.iHeatFlow, refSummary.iHeatFlow, 1e-3);
+        mtSummary = builder.summary;
+    }
+    EDataMgr::Instance().ShutDown();
+}
+
+void t_thermal_sample_sink_test()
+{
+    using namespace thermal::utils;
+    std::string dir = ecad_test::GetTestDataPath() + "/simulation/thermal";
+    BOOST_CHECK(generic::fs::CreateDir(dir));
+    std::string filename = dir + "/samples.bin";
+    {
+        BinarySampleSink<float> sink(filename, {3, 7}, {"die", "board"}, true, 2, 4);
+        BOOST_CHECK(sink.isOpen());
+        for (size_t i = 0; i < 10; ++i)
+            sink.Append(i * 0.1f, {300.f + i, 290.f - i});
+        BOOST_CHECK(sink.Count() == 5);
+        BOOST_CHECK_CLOSE(sink.MaxT(), 34.85, 1e-3);
+        BOOST_CHECK_CLOSE(sink.MinT(), 8.85, 1e-3);
+    }
+    BinarySampleReader reader(filename);
+    BOOST_CHECK(reader.Probes() == 2);
+    BOOST_CHECK(reader.Samples() == 5);
+    BOOST_CHECK(reader.Ids().back() == 7);
+    BOOST_CHECK(reader.Names().front() == "die");
+    BOOST_CHECK(reader.Units().front() == "C");
+    BOOST_CHECK_CLOSE(reader.Times().back(), 0.8, 1e-3);
+    BOOST_CHECK_CLOSE(reader.Values(1).back(), 8.85, 1e-3);
+    generic::fs::RemoveFile(filename);
 }
 
 test_suite * create_ecad_solver_test_suite()
@@ -49,6 +340,12 @@ test_suite * create_ecad_solver_test_suite()
     test_suite * solver_suite = BOOST_TEST_SUITE("s_solver_test");
     //
     solver_suite->add(BOOST_TEST_CASE(&t_grid_thermal_model_solver_test));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_solver_types_test));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_implicit_integrator_test));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_parametric_reduction_test));
+    solver_suite->add(BOOST_TEST_CASE(&t_material_prop_cache_test));
+    solver_suite->add(BOOST_TEST_CASE(&t_prism_thermal_network_builder_test));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_sample_sink_test));
     //
     return solver_suite;
 }
\ No newline at end of file
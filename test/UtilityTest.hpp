@@ -4,6 +4,14 @@
 #include <boost/test/test_tools.hpp>
 #include "generic/geometry/Utility.hpp"
 #include "extension/ECadExtension.h"
+#include "utility/EInstancedLayout.h"
+#include "utility/EModelCache.h"
+#include "utility/EMetalFractionMapping.h"
+#include "utility/ETarGzArchive.h"
+#include "model/thermal/io/EChipThermalModelIO.h"
+#include "generic/tools/FileSystem.hpp"
+#include <zlib.h>
+#include <cstdio>
 #include "TestData.hpp"
 #include "EDataMgr.h"
 using namespace boost::unit_test;
@@ -27,9 +35,118 @@ void t_flatten_utility()
     BOOST_CHECK(cells.size() == 9);
 
     auto topCell = topCells.front();
+    //the instanced view places as many primitives as the flatten copies
+    auto instanced = utils::EInstancedLayout(topCell->GetLayoutView()).FlattenedPrimitives();
     auto res = database->Flatten(topCell, 1);
     BOOST_CHECK(res);
 
+    //concurrent flatten gives the same layout
+    auto mtDatabase = ext::CreateDatabaseFromGds(name + "_mt", gds, std::string{}, &err);
+    BOOST_CHECK(mtDatabase != nullptr);
+    BOOST_CHECK(mtDatabase->GetTopCells(topCells));
+    auto mtTopCell = topCells.front();
+    BOOST_CHECK(mtDatabase->Flatten(mtTopCell, 4));
+
+    auto layout = topCell->GetFlattenedLayoutView();
+    auto mtLayout = mtTopCell->GetFlattenedLayoutView();
+    BOOST_CHECK(layout->GetCellInstCollection()->Size() == 0);
+    BOOST_CHECK(mtLayout->GetCellInstCollection()->Size() == 0);
+    BOOST_CHECK(layout->GetPrimitiveCollection()->Size() == mtLayout->GetPrimitiveCollection()->Size());
+    BOOST_CHECK(layout->GetPrimitiveCollection()->Size() == instanced);
+    BOOST_CHECK(layout->GetNetCollection()->Size() == mtLayout->GetNetCollection()->Size());
+    for (size_t i = 0; i < layout->GetPrimitiveCollection()->Size(); ++i) {
+        auto prim = layout->GetPrimitiveCollection()->GetPrimitive(i);
+        auto mtPrim = mtLayout->GetPrimitiveCollection()->GetPrimitive(i);
+        BOOST_CHECK(prim->GetLayer() == mtPrim->GetLayer());
+        BOOST_CHECK(prim->GetNet() == mtPrim->GetNet());
+    }
+
+    EDataMgr::Instance().ShutDown();
+}
+
+void t_instanced_layout_array()
+{
+    auto & eDataMgr = EDataMgr::Instance();
+    auto database = eDataMgr.CreateDatabase("aref");
+    BOOST_CHECK(database);
+    ECoordUnits coordUnits(ECoordUnits::Unit::Micrometer);
+    database->SetCoordUnits(coordUnits);
+
+    //unit cell with one rectangle, placed as a 3 x 2 array with skewed pitches
+    auto unitCell = eDataMgr.CreateCircuitCell(database, "Unit");
+    auto unitLayout = unitCell->GetLayoutView();
+    auto iLyrUnit = unitLayout->AppendLayer(eDataMgr.CreateStackupLayer("M1", ELayerType::ConductingLayer, 0, 10, "Cu", "Air"));
+    auto unitNet = eDataMgr.CreateNet(unitLayout, "Unit");
+    BOOST_CHECK(eDataMgr.CreateGeometry2D(unitLayout, iLyrUnit, unitNet->GetNetId(), eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(0, 0), FPoint2D(10, 5))));
+
+    auto topCell = eDataMgr.CreateCircuitCell(database, "Top");
+    auto topLayout = topCell->GetLayoutView();
+    auto iLyrTop = topLayout->AppendLayer(eDataMgr.CreateStackupLayer("Top", ELayerType::ConductingLayer, 0, 10, "Cu", "Air"));
+    auto topNet = eDataMgr.CreateNet(topLayout, "Top");
+    BOOST_CHECK(eDataMgr.CreateGeometry2D(topLayout, iLyrTop, topNet->GetNetId(), eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(-50, -50), FPoint2D(-40, -40))));
+
+    auto layerMap = eDataMgr.CreateLayerMap(database, "Unit2Top");
+    layerMap->SetMapping(iLyrUnit, iLyrTop);
+    auto inst = eDataMgr.CreateCellInst(topLayout, "Array", unitLayout, eDataMgr.CreateTransform2D(coordUnits, 1, 0, {100, 200}));
+    BOOST_CHECK(inst);
+    inst->SetLayerMap(layerMap);
+    const size_t cols = 3, rows = 2;
+    inst->SetArray(cols, rows, coordUnits.toCoord(FPoint2D(20, 2)), coordUnits.toCoord(FPoint2D(-3, 30)));
+
+    std::vector<EBox2D> expected{coordUnits.toCoord(FBox2D(FPoint2D(-50, -50), FPoint2D(-40, -40)))};
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < cols; ++c) {
+            FPoint2D ll(100 + 20 * EFloat(c) - 3 * EFloat(r), 200 + 2 * EFloat(c) + 30 * EFloat(r));
+            expected.emplace_back(coordUnits.toCoord(FBox2D(ll, FPoint2D(ll[0] + 10, ll[1] + 5))));
+        }
+    }
+    auto sortBoxes = [](std::vector<EBox2D> & boxes) {
+        std::sort(boxes.begin(), boxes.end(), [](const EBox2D & a, const EBox2D & b) {
+            return std::make_pair(a[0][0], a[0][1]) < std::make_pair(b[0][0], b[0][1]);
+        });
+    };
+    auto sameBoxes = [&sortBoxes](std::vector<EBox2D> boxes, std::vector<EBox2D> ref) {
+        if (boxes.size() != ref.size()) return false;
+        sortBoxes(boxes); sortBoxes(ref);
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            if (boxes[i][0][0] != ref[i][0][0] || boxes[i][0][1] != ref[i][0][1]) return false;
+            if (boxes[i][1][0] != ref[i][1][0] || boxes[i][1][1] != ref[i][1][1]) return false;
+        }
+        return true;
+    };
+
+    //the array stays one placement record and its shapes land on the array positions in top coordinates
+    utils::EInstancedLayout instanced(topLayout);
+    BOOST_CHECK(instanced.FlattenedPrimitives() == cols * rows + 1);
+    std::vector<EBox2D> placed;
+    auto shapeIter = instanced.GetShapeIter();
+    while (auto * shape = shapeIter->Next()) {
+        BOOST_CHECK(shape->layer == iLyrTop);
+        if (shape->master != topLayout) BOOST_CHECK(shape->net == unitNet->GetNetId());
+        placed.emplace_back(generic::geometry::Extent(shape->GetPolygonWithHoles().outline));
+    }
+    BOOST_CHECK(sameBoxes(placed, expected));
+
+    //the model cache key follows the placements of the definitions
+    auto hash = utils::EModelCache::LayoutHash(topLayout);
+    BOOST_CHECK(hash == utils::EModelCache::LayoutHash(topLayout));
+    inst->SetArray(cols, rows, coordUnits.toCoord(FPoint2D(20, 2)), coordUnits.toCoord(FPoint2D(-3, 31)));
+    BOOST_CHECK(hash != utils::EModelCache::LayoutHash(topLayout));
+    inst->SetArray(cols, rows, coordUnits.toCoord(FPoint2D(20, 2)), coordUnits.toCoord(FPoint2D(-3, 30)));
+    BOOST_CHECK(hash == utils::EModelCache::LayoutHash(topLayout));
+
+    //flatten places the same boxes
+    BOOST_CHECK(database->Flatten(topCell, 1));
+    auto flattened = topCell->GetFlattenedLayoutView();
+    std::vector<EBox2D> flattenedBoxes;
+    for (size_t i = 0; i < flattened->GetPrimitiveCollection()->Size(); ++i) {
+        auto prim = flattened->GetPrimitiveCollection()->GetPrimitive(i);
+        auto geom = prim->GetGeometry2DFromPrimitive();
+        BOOST_CHECK(geom);
+        if (geom) flattenedBoxes.emplace_back(geom->GetShape()->GetBBox());
+    }
+    BOOST_CHECK(sameBoxes(flattenedBoxes, expected));
+
     EDataMgr::Instance().ShutDown();
 }
 
@@ -128,6 +245,157 @@ void t_metal_fraction_mapping_select_nets()
     EDataMgr::Instance().ShutDown();
 }
 
+void t_metal_fraction_mapping_values()
+{
+    using namespace utils;
+    //4 x 4 tiles of 10 x 10 in region [0, 40] x [0, 40]
+    const EBox2D region(EPoint2D(0, 0), EPoint2D(40, 40));
+    const std::array<ECoord, 2> stride{10, 10};
+    auto rect = [](ECoord llx, ECoord lly, ECoord urx, ECoord ury) {
+        return IntPolygon(std::vector<EPoint2D>{{llx, lly}, {urx, lly}, {urx, ury}, {llx, ury}});
+    };
+    auto mapping = [&](ELayerPolygons polygons, size_t threads) {
+        EMetalFractionMappingSettings settings(threads, {});
+        ELayerMetalFraction fraction(4, 4, 0.0);
+        ELayerMetalFractionMapper mapper(settings, fraction, ELayerId(0));
+        mapper.GenerateMetalFractionMapping(std::move(polygons), region, stride);
+        return fraction;
+    };
+    auto check = [](const ELayerMetalFraction & fraction, const std::map<std::pair<size_t, size_t>, EFloat> & expected) {
+        for (size_t i = 0; i < fraction.Width(); ++i) {
+            for (size_t j = 0; j < fraction.Height(); ++j) {
+                auto iter = expected.find({i, j});
+                BOOST_CHECK_SMALL(fraction(i, j) - (iter == expected.cend() ? 0 : iter->second), 1e-9);
+            }
+        }
+    };
+
+    //rectangle covering parts of 4 tiles
+    ELayerPolygons partial;
+    partial.solids.emplace_back(rect(5, 5, 15, 12));
+    check(mapping(partial, 1), {{{0, 0}, 0.25}, {{1, 0}, 0.25}, {{0, 1}, 0.1}, {{1, 1}, 0.1}});
+
+    //square with a square hole
+    ELayerPolygons holed;
+    holed.solids.emplace_back(rect(20, 20, 40, 40));
+    holed.holes.emplace_back(rect(25, 25, 35, 35));
+    check(mapping(holed, 1), {{{2, 2}, 0.75}, {{3, 2}, 0.75}, {{2, 3}, 0.75}, {{3, 3}, 0.75}});
+
+    //shapes crossing the region boundary only count inside
+    ELayerPolygons outside;
+    outside.solids.emplace_back(std::vector<EPoint2D>{{30, 0}, {50, 0}, {30, 20}});
+    outside.solids.emplace_back(rect(-10, 35, 5, 45));
+    check(mapping(outside, 1), {{{3, 0}, 1}, {{3, 1}, 0.5}, {{0, 3}, 0.25}});
+
+    //the column blocks of the threads give the same grid
+    ELayerPolygons all;
+    for (const auto * polygons : {&partial, &holed, &outside}) {
+        all.solids.insert(all.solids.end(), polygons->solids.begin(), polygons->solids.end());
+        all.holes.insert(all.holes.end(), polygons->holes.begin(), polygons->holes.end());
+    }
+    auto serial = mapping(all, 1);
+    for (size_t threads : {3, 4, 8}) {
+        auto parallel = mapping(all, threads);
+        for (size_t i = 0; i < serial.Width(); ++i)
+            for (size_t j = 0; j < serial.Height(); ++j)
+                BOOST_CHECK(serial(i, j) == parallel(i, j));
+    }
+}
+
+void t_tar_gz_archive()
+{
+    using namespace utils;
+    std::string dir = ecad_test::GetTestDataPath() + "/tar";
+    generic::fs::RemoveDir(dir);
+    generic::fs::CreateDir(dir);
+
+    //plain tar content of a tar.gz file
+    auto inflate = [](const std::string & filename) {
+        std::string raw;
+        if (auto file = gzopen(filename.c_str(), "rb"); file) {
+            char buffer[4096];
+            for (int n = 0; (n = gzread(file, buffer, sizeof(buffer))) > 0;)
+                raw.append(buffer, n);
+            gzclose(file);
+        }
+        return raw;
+    };
+    auto deflate = [](const std::string & filename, const std::string & raw) {
+        auto file = gzopen(filename.c_str(), "wb");
+        if (nullptr == file) return false;
+        auto n = gzwrite(file, raw.data(), static_cast<unsigned>(raw.size()));
+        return gzclose(file) == Z_OK && n == static_cast<int>(raw.size());
+    };
+    auto readAll = [](const std::string & filename, std::vector<std::pair<std::string, std::string> > & entries) {
+        std::string name, data;
+        ETarGzReader reader(filename);
+        while (reader.isOpen() && reader.Next(name, data))
+            entries.emplace_back(name, data);
+        return reader.isOpen() && reader.isGood();
+    };
+
+    //round trip, the long name is stored as a gnu long name entry
+    std::string longName = "layer/" + std::string(120, 'n') + ".txt";
+    std::string payload(1500, '\0');
+    for (size_t i = 0; i < payload.size(); ++i) payload[i] = static_cast<char>(i * 31);
+    std::vector<std::pair<std::string, std::string> > expected{{"empty.txt", ""}, {longName, payload}, {"last.txt", "end"}};
+    std::string archive = dir + "/test.tar.gz";
+    {
+        ETarGzWriter writer(archive);
+        BOOST_CHECK(writer.isOpen());
+        for (const auto & [name, data] : expected)
+            BOOST_CHECK(writer.Add(name, data));
+        BOOST_CHECK(writer.Close());
+    }
+    std::vector<std::pair<std::string, std::string> > entries;
+    BOOST_CHECK(readAll(archive, entries));
+    BOOST_CHECK(entries == expected);
+
+    //base-256 size field, blocks: empty.txt, long name header, long name, payload header
+    std::string raw = inflate(archive);
+    BOOST_CHECK(raw.size() % 512 == 0 && raw.size() > 4 * 512);
+    if (raw.size() > 4 * 512) {
+        const size_t size = 124, chksum = 148;
+        char * header = raw.data() + 3 * 512;
+        std::fill(header + size, header + size + 12, '\0');
+        header[size] = static_cast<char>(0x80);
+        header[size + 10] = static_cast<char>(payload.size() >> 8);
+        header[size + 11] = static_cast<char>(payload.size() & 0xff);
+        std::fill(header + chksum, header + chksum + 8, ' ');
+        uint64_t sum{0};
+        for (size_t i = 0; i < 512; ++i) sum += static_cast<unsigned char>(header[i]);
+        std::snprintf(header + chksum, 8, "%06o", static_cast<unsigned>(sum));
+        header[chksum + 7] = ' ';
+        BOOST_CHECK(deflate(archive, raw));
+        entries.clear();
+        BOOST_CHECK(readAll(archive, entries));
+        BOOST_CHECK(entries == expected);
+    }
+
+    //truncated in the middle of the payload
+    raw.resize(4 * 512 + 100);
+    BOOST_CHECK(deflate(archive, raw));
+    entries.clear();
+    BOOST_CHECK(not readAll(archive, entries));
+    BOOST_CHECK(entries.size() == 1);
+
+    //entries must not escape the untar folder
+    for (std::string name : {"../escape.txt", "a/../../escape.txt", "/tmp/ecad_escape.txt"}) {
+        {
+            ETarGzWriter writer(archive);
+            BOOST_CHECK(writer.Add("header.txt", "#Version"));
+            BOOST_CHECK(writer.Add(name, "escape"));
+            BOOST_CHECK(writer.Close());
+        }
+        std::string err;
+        BOOST_CHECK(model::io::detail::UntarCTMv1File(archive, &err).empty());
+        BOOST_CHECK(not err.empty());
+        BOOST_CHECK(not generic::fs::FileExists(dir + "/escape.txt"));
+        BOOST_CHECK(not generic::fs::FileExists("/tmp/ecad_escape.txt"));
+    }
+    generic::fs::RemoveDir(dir);
+}
+
 void t_layout_to_ctm()
 {
     std::string err;
@@ -156,10 +424,13 @@ test_suite * create_ecad_utility_test_suite()
     test_suite * utility_suite = BOOST_TEST_SUITE("s_utility_test");
     //
     utility_suite->add(BOOST_TEST_CASE(&t_flatten_utility));
+    utility_suite->add(BOOST_TEST_CASE(&t_instanced_layout_array));
     utility_suite->add(BOOST_TEST_CASE(&t_connectivity_extraction));
     utility_suite->add(BOOST_TEST_CASE(&t_layout_polygon_merge));
     utility_suite->add(BOOST_TEST_CASE(&t_metal_fraction_mapping));
     utility_suite->add(BOOST_TEST_CASE(&t_metal_fraction_mapping_select_nets));
+    utility_suite->add(BOOST_TEST_CASE(&t_metal_fraction_mapping_values));
+    utility_suite->add(BOOST_TEST_CASE(&t_tar_gz_archive));
     utility_suite->add(BOOST_TEST_CASE(&t_layout_to_ctm));
     //
     return utility_suite;